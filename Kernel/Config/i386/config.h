@@ -104,12 +104,77 @@
  * depth.
  */
 #define MAX_SUPPORTED_BPP    32
+/** @brief When the buffered VESA driver is enabled, defines the maximal number
+ * of frames per second copied to the screen.
+ */
+#define VESA_MAX_FRAME_RATE  60
+/** @brief When the buffered VESA driver is enabled, draws in a hidden page of
+ * the video memory and displays it on vertical retrace. Only used when the
+ * video memory can hold two frames.
+ */
+#define VESA_PAGE_FLIPPING   0
+/** @brief Number of console lines kept in the scrollback history once they
+ * leave the screen.
+ */
+#define SCROLLBACK_LINE_COUNT 64
+/** @brief Decodes the keyboard scancodes in a deferred work tasklet. Set to 0
+ * to decode them in the keyboard interrupt handler.
+ */
+#define KEYBOARD_DEFERRED_DECODE 1
+
+/** @brief Spreads the IO-APIC IRQs over the booted CPUs once the secondary
+ * CPUs are started. Set to 0 to route all the IRQs to the boot CPU.
+ */
+#define IOAPIC_IRQ_BALANCE       0
+/** @brief Mask of the latency critical CPUs, the IRQ balancing does not route
+ * device IRQs to them.
+ */
+#define IOAPIC_IRQ_RESERVED_CPUS 0x00000001
 
 /*******************************************************************************
  * Global Arch Settings
  ******************************************************************************/
 /** @brief Defines which serial port is used for debug purposes. */
 #define SERIAL_DEBUG_PORT  COM1
+/** @brief Enables the interrupt driven serial transmissions. */
+#define SERIAL_IRQ_MODE       1
+/** @brief Size of the serial ports transmit ring buffers, power of 2. */
+#define SERIAL_TX_BUFFER_SIZE 1024
+/** @brief Size of the serial ports receive ring buffers, power of 2. */
+#define SERIAL_RX_BUFFER_SIZE 256
+/** @brief Sleep period in ms of the serial reads with a timeout. */
+#define SERIAL_RX_WAIT_PERIOD 10
+
+/** @brief Defers the kernel output to the log flusher thread once the scheduler
+ * runs. Test mode keeps the immediate output since the tests stop QEMU right
+ * after their last message.
+ */
+#define KERNEL_OUTPUT_DEFERRED     1
+/** @brief Number of records of the per CPU kernel output rings, power of 2. */
+#define KERNEL_OUTPUT_BUFFER_SIZE  128
+/** @brief Period in ms of the kernel output flusher thread. */
+#define KERNEL_OUTPUT_FLUSH_PERIOD 10
+
+/** @brief Enables the kernel trace events, the tracepoints are removed when
+ * set to 0.
+ */
+#define TRACE_ENABLED         1
+/** @brief Mask of the trace events categories compiled in. */
+#define TRACE_CATEGORIES      0xFFFFFFFF
+/** @brief Mask of the trace events categories enabled at boot. */
+#define TRACE_BOOT_CATEGORIES 0x00000000
+/** @brief Number of events of the per CPU trace rings, power of 2. */
+#define TRACE_BUFFER_SIZE     512
+
+/** @brief Counts the interrupts and the handlers cycles of each interrupt
+ * line.
+ */
+#define INTERRUPT_STATS_ENABLED   1
+/** @brief Tracks the longest window with the interrupts disabled and its call
+ * sites. Adds a time stamp read to each kernel_interrupt_disable and
+ * kernel_interrupt_restore pair.
+ */
+#define INTERRUPT_LATENCY_ENABLED 1
 
 
 /*******************************************************************************
@@ -149,6 +214,21 @@
 #define ATA_PIO_DETECT_THIRD_PORT     0
 /** @brief Enables ATA PIO detection on the fourth ATA port. */
 #define ATA_PIO_DETECT_FOURTH_PORT    0
+/** @brief Enables interrupt driven ATA PIO transfers on the primary and
+ * secondary ports once the scheduler runs.
+ */
+#define ATA_PIO_IRQ_MODE              1
+/** @brief Enables the bus master DMA transfers, requires ATA_PIO_IRQ_MODE. */
+#define ATA_DMA_ENABLED               1
+
+/** @brief Number of page sized buffers of the block cache. */
+#define BLOCK_CACHE_SIZE     64
+/** @brief Maximal read-ahead window of the block devices in blocks. */
+#define BLOCK_READ_AHEAD_MAX 16
+/** @brief Maximal size in bytes of the merged block I/O requests. */
+#define BLOCK_IO_MERGE_SIZE  0x20000
+/** @brief Time in ms after which a block I/O request is served first. */
+#define BLOCK_IO_DEADLINE    100
 
 /*******************************************************************************
  * DEBUG CONFIGURATION
@@ -201,6 +281,9 @@
 /** @brief Enables kernel ata pio debuging feature. */
 #define ATA_PIO_KERNEL_DEBUG 0
 
+/** @brief Enables kernel ata dma debuging feature. */
+#define ATA_DMA_KERNEL_DEBUG 0
+
 /** @brief Enables kernel queue debuging feature. */
 #define QUEUE_KERNEL_DEBUG 0
 
@@ -213,6 +296,12 @@
 /** @brief Enables kernel semaphore debuging feature. */
 #define SEMAPHORE_KERNEL_DEBUG 0
 
+/** @brief Enables kernel futex debuging feature. */
+#define FUTEX_KERNEL_DEBUG 0
+
+/** @brief Enables kernel RCU debuging feature. */
+#define RCU_KERNEL_DEBUG 0
+
 /** @brief Enables kernel mailbox debuging feature. */
 #define MAILBOX_KERNEL_DEBUG 0
 
@@ -630,6 +630,48 @@ __inline__ static uint32_t cpu_inl(const uint16_t port)
     return rega;
 }
 
+/**
+ * @brief Reads a string of words from a port.
+ *
+ * @details Reads count words from the port and stores them in the buffer
+ * using a single rep insw instruction.
+ *
+ * @param[in] port The port from which the words have to be read.
+ * @param[out] buffer The buffer that receives the words.
+ * @param[in] count The number of words to read.
+ */
+__inline__ static void cpu_insw(const uint16_t port, void* buffer,
+                                const uint32_t count)
+{
+    void*    dst = buffer;
+    uint32_t cnt = count;
+    __asm__ __volatile__("rep insw"
+                         : "+D" (dst), "+c" (cnt)
+                         : "d" (port)
+                         : "memory");
+}
+
+/**
+ * @brief Writes a string of words to a port.
+ *
+ * @details Writes count words from the buffer to the port using a single
+ * rep outsw instruction.
+ *
+ * @param[in] port The port to which the words have to be written.
+ * @param[in] buffer The buffer containing the words to write.
+ * @param[in] count The number of words to write.
+ */
+__inline__ static void cpu_outsw(const uint16_t port, const void* buffer,
+                                 const uint32_t count)
+{
+    const void* src = buffer;
+    uint32_t    cnt = count;
+    __asm__ __volatile__("rep outsw"
+                         : "+S" (src), "+c" (cnt)
+                         : "d" (port)
+                         : "memory");
+}
+
 /**
  * @brief Reads the TSC value of the CPU.
  *
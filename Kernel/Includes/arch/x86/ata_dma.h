@@ -0,0 +1,226 @@
+/*******************************************************************************
+ * @file ata_dma.h
+ *
+ * @see ata_dma.c
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief ATA bus master DMA driver.
+ *
+ * @details ATA bus master DMA driver. The driver uses the bus master IDE
+ * function of the PCI IDE controller to transfer ranges of sectors without
+ * moving the data with the CPU. The PRD (Physical Region Descriptor) table of
+ * the channel describes the physical pages of the caller's buffer. Each
+ * channel also owns a physically contiguous bounce buffer used when the
+ * caller's buffer cannot be reached by the engine. The completion is signaled
+ * by the channel interrupt handled by the ATA PIO driver. The driver falls back to PIO transfers when bus mastering is not
+ * available.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#ifndef __X86_ATA_DMA_H_
+#define __X86_ATA_DMA_H_
+
+#include <lib/stdint.h> /* Generic int types */
+#include <lib/stddef.h> /* Standard definitions */
+#include <ata_pio.h>    /* ATA PIO driver */
+#include <io/block.h>   /* Block devices */
+#include <arch_paging.h> /* Architecture specific memory settings */
+
+/* UTK Configuration file */
+#include <config.h>
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/** @brief PCI configuration space address port. */
+#define ATA_DMA_PCI_CONFIG_ADDRESS 0xCF8
+/** @brief PCI configuration space data port. */
+#define ATA_DMA_PCI_CONFIG_DATA    0xCFC
+
+/** @brief PCI command register offset. */
+#define ATA_DMA_PCI_COMMAND_OFFSET 0x04
+/** @brief PCI class register offset. */
+#define ATA_DMA_PCI_CLASS_OFFSET   0x08
+/** @brief PCI header type register offset. */
+#define ATA_DMA_PCI_HEADER_OFFSET  0x0C
+/** @brief PCI BAR4 register offset, bus master registers base. */
+#define ATA_DMA_PCI_BAR4_OFFSET    0x20
+
+/** @brief PCI mass storage class code. */
+#define ATA_DMA_PCI_CLASS_STORAGE      0x01
+/** @brief PCI IDE controller subclass code. */
+#define ATA_DMA_PCI_SUBCLASS_IDE       0x01
+/** @brief PCI IDE programming interface bus master flag. */
+#define ATA_DMA_PCI_PROGIF_BUS_MASTER  0x80
+/** @brief PCI multi function header flag. */
+#define ATA_DMA_PCI_HEADER_MULTI       0x80
+/** @brief PCI command IO space enable flag. */
+#define ATA_DMA_PCI_COMMAND_IO         0x0001
+/** @brief PCI command bus master enable flag. */
+#define ATA_DMA_PCI_COMMAND_BUS_MASTER 0x0004
+
+/** @brief Bus master command register offset. */
+#define ATA_DMA_BM_COMMAND_OFFSET   0x00
+/** @brief Bus master status register offset. */
+#define ATA_DMA_BM_STATUS_OFFSET    0x02
+/** @brief Bus master PRD table address register offset. */
+#define ATA_DMA_BM_PRDT_OFFSET      0x04
+/** @brief Offset of the secondary channel bus master registers. */
+#define ATA_DMA_BM_SECONDARY_OFFSET 0x08
+
+/** @brief Bus master command start flag. */
+#define ATA_DMA_BM_COMMAND_START  0x01
+/** @brief Bus master command direction flag, set to write to the memory. */
+#define ATA_DMA_BM_COMMAND_READ   0x08
+/** @brief Bus master status active flag. */
+#define ATA_DMA_BM_STATUS_ACTIVE  0x01
+/** @brief Bus master status error flag. */
+#define ATA_DMA_BM_STATUS_ERR     0x02
+/** @brief Bus master status interrupt flag. */
+#define ATA_DMA_BM_STATUS_IRQ     0x04
+
+/** @brief ATA read DMA command. */
+#define ATA_DMA_READ_COMMAND  0xC8
+/** @brief ATA write DMA command. */
+#define ATA_DMA_WRITE_COMMAND 0xCA
+
+/** @brief PRD end of table flag. */
+#define ATA_DMA_PRD_END      0x8000
+/** @brief A PRD region cannot cross this boundary. */
+#define ATA_DMA_PRD_BOUNDARY 0x10000
+
+/** @brief Size of the bounce buffer of a channel. */
+#define ATA_DMA_BUFFER_SIZE \
+    (ATA_PIO_MAX_SECTORS_PER_COMMAND * ATA_PIO_SECTOR_SIZE)
+
+/** @brief Maximal number of PRD entries needed to describe a transfer, one
+ * per page of an unaligned caller's buffer.
+ */
+#define ATA_DMA_PRD_COUNT (ATA_DMA_BUFFER_SIZE / KERNEL_PAGE_SIZE + 1)
+
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/** @brief Bus master PRD table entry. */
+typedef struct ata_dma_prd
+{
+    /** @brief Physical address of the region. */
+    uint32_t address;
+    /** @brief Size of the region in bytes, 0 stands for 64KB. */
+    uint16_t size;
+    /** @brief Entry flags. */
+    uint16_t flags;
+} __attribute__ ((packed)) ata_dma_prd_t;
+
+/** @brief ATA DMA channel representation in the driver. */
+struct ata_dma_channel
+{
+    /** @brief Set to 1 if bus master transfers are available on the channel. */
+    uint32_t enabled;
+
+    /** @brief Bus master registers base port. */
+    uint16_t bm_port;
+
+    /** @brief PRD table virtual address. */
+    ata_dma_prd_t* prd_table;
+    /** @brief PRD table physical address. */
+    uintptr_t prd_table_phys;
+
+    /** @brief Bounce buffer virtual address. */
+    uint8_t* buffer;
+    /** @brief Bounce buffer physical address. */
+    uintptr_t buffer_phys;
+};
+
+/**
+ * @brief Defines ata_dma_channel_t type as a shorcut for struct
+ * ata_dma_channel.
+ */
+typedef struct ata_dma_channel ata_dma_channel_t;
+
+/** @brief ATA block driver, the driver's devices are ata_pio_device_t. */
+extern block_driver_t ata_block_driver;
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Initializes the ATA DMA driver.
+ *
+ * @details Looks for a bus master capable PCI IDE controller, enables bus
+ * mastering and allocates the transfer buffer and PRD table of the primary and
+ * secondary channels. If no controller is found, the driver keeps using PIO
+ * transfers.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - Other error codes can be returned by the memory allocator.
+ */
+OS_RETURN_E ata_dma_init(void);
+
+/**
+ * @brief Tells if bus master transfers are available for a device.
+ *
+ * @param[in] device The device to check.
+ *
+ * @return 1 if the device channel supports bus master transfers, 0 otherwise.
+ */
+uint32_t ata_dma_is_available(const ata_pio_device_t* device);
+
+/**
+ * @brief Reads a range of sectors from the ATA device.
+ *
+ * @details Reads a range of sectors with bus master DMA transfers. The calling
+ * thread sleeps until each transfer completes. PIO transfers are used if bus
+ * mastering is not available or if the caller cannot sleep.
+ *
+ * @param[in] device The device to read the data from.
+ * @param[in] sector The first sector to read.
+ * @param[out] buffer The buffer that receives the data.
+ * @param[in] count The number of sectors to read.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the device or the buffer is NULL.
+ * - OS_ERR_ATA_BAD_SECTOR_NUMBER is returned if the range is out of bound.
+ * - OS_ERR_ATA_DEVICE_ERROR is returned if an errored device is detected.
+ * - OS_ERR_ATA_DEVICE_NOT_PRESENT is returned if the device was not detected.
+ */
+OS_RETURN_E ata_dma_read_sectors(ata_pio_device_t* device,
+                                 const uint32_t sector,
+                                 void* buffer, const uint32_t count);
+
+/**
+ * @brief Writes a range of sectors to the ATA device.
+ *
+ * @details Writes a range of sectors with bus master DMA transfers then
+ * flushes the device cache. The calling thread sleeps until each transfer
+ * completes. PIO transfers are used if bus mastering is not available or if the
+ * caller cannot sleep.
+ *
+ * @param[in] device The device to write the data to.
+ * @param[in] sector The first sector to write.
+ * @param[in] buffer The buffer that contains the data.
+ * @param[in] count The number of sectors to write.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the device or the buffer is NULL.
+ * - OS_ERR_ATA_BAD_SECTOR_NUMBER is returned if the range is out of bound.
+ * - OS_ERR_ATA_DEVICE_ERROR is returned if an errored device is detected.
+ * - OS_ERR_ATA_DEVICE_NOT_PRESENT is returned if the device was not detected.
+ */
+OS_RETURN_E ata_dma_write_sectors(ata_pio_device_t* device,
+                                  const uint32_t sector,
+                                  const void* buffer, const uint32_t count);
+
+#endif /* #ifndef __X86_ATA_DMA_H_ */
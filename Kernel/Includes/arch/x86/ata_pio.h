@@ -13,7 +13,9 @@
  *
  * @details ATA (Advanced Technology Attachment) driver. Supports hard drive IO
  * through the CPU PIO. The driver can read and write data. No utility function
- * are provided.
+ * are provided. Once the scheduler runs, the transfers on the primary and
+ * secondary ports are interrupt driven: the requesting thread sleeps while the
+ * IRQ handler moves each block of data.
  *
  * @copyright Alexy Torres Aurora Dugo
  ******************************************************************************/
@@ -21,9 +23,12 @@
 #ifndef __X86_ATA_PIO_H_
 #define __X86_ATA_PIO_H_
 
-#include <lib/stdint.h>    /* Generic int types */
-#include <lib/stddef.h>    /* Standard definitions */
-#include <sync/critical.h> /* Critical sections */
+#include <lib/stdint.h>          /* Generic int types */
+#include <lib/stddef.h>          /* Standard definitions */
+#include <sync/critical.h>       /* Critical sections */
+#include <sync/mutex.h>          /* Mutex */
+#include <sync/semaphore.h>      /* Semaphores */
+#include <interrupt/deferred.h>  /* Interrupt deferred work */
 
 /* UTK Configuration file */
 #include <config.h>
@@ -68,15 +73,31 @@
 #define ATA_PIO_WRITE_SECTOR_COMMAND 0x30
 /** @brief ATA PIO flush command. */
 #define ATA_PIO_FLUSH_SECTOR_COMMAND 0xE7
+/** @brief ATA PIO read multiple command. */
+#define ATA_PIO_READ_MULTIPLE_COMMAND  0xC4
+/** @brief ATA PIO write multiple command. */
+#define ATA_PIO_WRITE_MULTIPLE_COMMAND 0xC5
+/** @brief ATA PIO set multiple mode command. */
+#define ATA_PIO_SET_MULTIPLE_COMMAND   0xC6
 
 /** @brief ATA status busy flag. */
 #define ATA_PIO_FLAG_BUSY 0x80
 /** @brief ATA status error flag. */
 #define ATA_PIO_FLAG_ERR  0x01
+/** @brief ATA status data request flag. */
+#define ATA_PIO_FLAG_DRQ  0x08
 
 /** @brief ATA ssupported sector size. */
 #define ATA_PIO_SECTOR_SIZE 512
 
+/** @brief Maximal number of sectors transfered by a single command. */
+#define ATA_PIO_MAX_SECTORS_PER_COMMAND 256
+
+/** @brief IDENTIFY word containing the maximal number of sectors per block in
+ * multiple mode.
+ */
+#define ATA_PIO_IDENTIFY_MULTIPLE_WORD 47
+
 /*******************************************************************************
  * STRUCTURES
  ******************************************************************************/
@@ -121,6 +142,11 @@ struct ata_pio_device
     /** @brief Device type. */
     ATA_PIO_TYPE_E type;
 
+    /** @brief Number of sectors transfered per data request in multiple mode,
+     * set by ata_pio_identify_device. 0 if multiple mode is not enabled.
+     */
+    uint16_t multiple_sectors;
+
 #if MAX_CPU_COUNT > 1
     /** @brief Critical section spinlock. */
     spinlock_t lock;
@@ -132,6 +158,50 @@ struct ata_pio_device
  */
 typedef struct ata_pio_device ata_pio_device_t;
 
+/** @brief ATA PIO channel interrupt driven transfer state. */
+struct ata_pio_channel
+{
+    /** @brief Channel port. */
+    ATA_PIO_PORT_E port;
+
+    /** @brief Set to 1 once the channel IRQ handler is registered. */
+    volatile uint32_t irq_enabled;
+
+    /** @brief Serializes the requests on the channel. */
+    mutex_t lock;
+    /** @brief Posted by the IRQ handler when the current request completes. */
+    semaphore_t done;
+
+    /** @brief Set to 1 while a request waits for the channel IRQ. */
+    volatile uint32_t active;
+    /** @brief Current request buffer position. */
+    uint8_t* volatile buffer;
+    /** @brief Current request sectors left to transfer. */
+    volatile uint32_t left;
+    /** @brief Current request sectors per data request. */
+    uint32_t block;
+    /** @brief Set to 1 if the current request writes to the device. */
+    uint32_t write;
+    /** @brief Current request status. */
+    volatile OS_RETURN_E status;
+
+    /** @brief Moves the data blocks out of the channel interrupt handler. */
+    deferred_work_t transfer;
+    /** @brief Device status read by the last channel interrupt. */
+    volatile uint8_t irq_status;
+
+    /** @brief Set to 1 if the current request is a bus master DMA transfer. */
+    volatile uint32_t dma;
+    /** @brief Bus master registers base port of the channel. */
+    uint16_t dma_port;
+};
+
+/**
+ * @brief Defines ata_pio_channel_t type as a shorcut for struct
+ * ata_pio_channel.
+ */
+typedef struct ata_pio_channel ata_pio_channel_t;
+
 /*******************************************************************************
  * FUNCTIONS
  ******************************************************************************/
@@ -153,6 +223,8 @@ OS_RETURN_E ata_pio_init(void);
  *
  * @details Identify the ATA device given as parameter. The function will check
  * the presence of a device conected to the port pointed by the device argument.
+ * If the device supports it, multiple mode is enabled with the largest block
+ * size supported and the device multiple_sectors field is set accordingly.
  *
  * @param[in] device The device to identify.
  *
@@ -182,6 +254,8 @@ OS_RETURN_E ata_pio_identify_device(ata_pio_device_t* device);
  * - OS_NO_ERR is returned if no error is encountered.
  * - OS_ERR_ATA_DEVICE_ERROR is returned if an errored device is detected.
  * - OS_ERR_ATA_DEVICE_NOT_PRESENT is returned if the device was not detected.
+ * - OS_MUTEX_LOCKED is returned if the caller cannot sleep and the channel of
+ *   the device executes another request.
  * - OS_ERR_ATA_BAD_SECTOR_NUMBER is returned if the sector given in parameters
  *   is not supported.
  * - OS_ERR_ATA_SIZE_TO_HUGE is returned if the size of the data to read is more
@@ -211,6 +285,8 @@ OS_RETURN_E ata_pio_read_sector(ata_pio_device_t* device,
  * - OS_NO_ERR is returned if no error is encountered.
  * - OS_ERR_ATA_DEVICE_ERROR is returned if an errored device is detected.
  * - OS_ERR_ATA_DEVICE_NOT_PRESENT is returned if the device was not detected.
+ * - OS_MUTEX_LOCKED is returned if the caller cannot sleep and the channel of
+ *   the device executes another request.
  * - OS_ERR_ATA_BAD_SECTOR_NUMBER is returned if the sector given in parameters
  *   is not supported.
  * - OS_ERR_ATA_SIZE_TO_HUGE is returned if the size of the data to write is
@@ -220,6 +296,64 @@ OS_RETURN_E ata_pio_write_sector(ata_pio_device_t* device,
                                  const uint32_t sector,
 	                             const void* buffer, const uint32_t size);
 
+/**
+ * @brief Reads a range of sectors in a buffer.
+ *
+ * @details Reads count consecutive sectors starting at the given sector. Up to
+ * ATA_PIO_MAX_SECTORS_PER_COMMAND sectors are read per command. If the device
+ * has multiple mode enabled, READ MULTIPLE is used and each data request
+ * transfers a block of sectors, otherwise each data request transfers one
+ * sector. The data are moved with string IO instructions.
+ *
+ * @param[in] device The device to read the data from.
+ * @param[in] sector The first sector to read.
+ * @param[out] buffer The buffer that is used to store the read data, it must be
+ * at least count * ATA_PIO_SECTOR_SIZE bytes long.
+ * @param[in] count The number of sectors to read.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the device or the buffer is NULL.
+ * - OS_ERR_ATA_DEVICE_ERROR is returned if an errored device is detected.
+ * - OS_ERR_ATA_DEVICE_NOT_PRESENT is returned if the device was not detected.
+ * - OS_MUTEX_LOCKED is returned if the caller cannot sleep and the channel of
+ *   the device executes another request.
+ * - OS_ERR_ATA_BAD_SECTOR_NUMBER is returned if the range given in parameters
+ *   is not supported.
+ */
+OS_RETURN_E ata_pio_read_sectors(ata_pio_device_t* device,
+                                 const uint32_t sector,
+                                 void* buffer, const uint32_t count);
+
+/**
+ * @brief Writes a buffer to a range of sectors.
+ *
+ * @details Writes count consecutive sectors starting at the given sector. Up to
+ * ATA_PIO_MAX_SECTORS_PER_COMMAND sectors are written per command. If the
+ * device has multiple mode enabled, WRITE MULTIPLE is used and each data
+ * request transfers a block of sectors, otherwise each data request transfers
+ * one sector. The device is flushed once all the sectors are written.
+ *
+ * @param[in] device The device to write the data to.
+ * @param[in] sector The first sector to write.
+ * @param[in] buffer The buffer containing the data to write, it must be at
+ * least count * ATA_PIO_SECTOR_SIZE bytes long.
+ * @param[in] count The number of sectors to write.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the device or the buffer is NULL.
+ * - OS_ERR_ATA_DEVICE_ERROR is returned if an errored device is detected.
+ * - OS_ERR_ATA_DEVICE_NOT_PRESENT is returned if the device was not detected.
+ * - OS_MUTEX_LOCKED is returned if the caller cannot sleep and the channel of
+ *   the device executes another request.
+ * - OS_ERR_ATA_BAD_SECTOR_NUMBER is returned if the range given in parameters
+ *   is not supported.
+ */
+OS_RETURN_E ata_pio_write_sectors(ata_pio_device_t* device,
+                                  const uint32_t sector,
+                                  const void* buffer, const uint32_t count);
+
 /**
  * @brief Asks the device to flush it's buffer.
  *
@@ -232,7 +366,23 @@ OS_RETURN_E ata_pio_write_sector(ata_pio_device_t* device,
  * - OS_NO_ERR is returned if no error is encountered.
  * - OS_ERR_ATA_DEVICE_ERROR is returned if an errored device is detected.
  * - OS_ERR_ATA_DEVICE_NOT_PRESENT is returned if the device was not detected.
+ * - OS_MUTEX_LOCKED is returned if the caller cannot sleep and the channel of
+ *   the device executes another request.
  */
 OS_RETURN_E ata_pio_flush(ata_pio_device_t* device);
 
+/**
+ * @brief Returns the interrupt driven channel to use for a request.
+ *
+ * @details Returns the channel of the device if its transfers can be interrupt
+ * driven. The calling thread must be able to sleep: the scheduler must run and
+ * the interrupts must be enabled. The caller must hold the channel lock while
+ * it issues a command and waits for its completion.
+ *
+ * @param[in] device The device to transfer the data with.
+ *
+ * @return The channel to use, NULL if the request must be polled.
+ */
+ata_pio_channel_t* ata_pio_get_irq_channel(const ata_pio_device_t* device);
+
 #endif /* #ifndef __X86_ATA_PIO_H_ */
\ No newline at end of file
@@ -59,6 +59,10 @@
 #define RTC_IRQ_LINE              8
 /** @brief Mouse IRQ number. */
 #define MOUSE_IRQ_LINE            12
+/** @brief Primary ATA channel IRQ number. */
+#define ATA_PRIMARY_IRQ_LINE      14
+/** @brief Secondary ATA channel IRQ number. */
+#define ATA_SECONDARY_IRQ_LINE    15
 
 /** @brief Divide by zero exception line. */
 #define DIV_BY_ZERO_LINE           0x00
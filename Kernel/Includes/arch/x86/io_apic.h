@@ -13,7 +13,8 @@
  *
  * @details IO-APIC (IO advanced programmable interrupt controler) driver.
  * Allows to remmap the IO-APIC IRQ, set the IRQs mask and manage EoI for the
- * X86 IO-APIC.
+ * X86 IO-APIC. The IRQs are routed to the boot CPU unless their affinity is
+ * set or the IRQs are balanced over the CPUs.
  *
  * @warning This driver also use the LAPIC driver to function correctly.
  *
@@ -50,6 +51,15 @@
 /** @brief IO-APIC redirection register. */
 #define IOREDTBL  0x10
 
+/** @brief IO-APIC redirection entry lowest priority delivery mode. */
+#define IO_APIC_DELIVERY_LOWEST 0x00000100
+/** @brief IO-APIC redirection entry logical destination mode. */
+#define IO_APIC_DEST_LOGICAL    0x00000800
+/** @brief IO-APIC redirection entry mask flag. */
+#define IO_APIC_IRQ_MASKED      0x00010000
+/** @brief IO-APIC redirection entry destination shift. */
+#define IO_APIC_DEST_SHIFT      24
+
 /*******************************************************************************
  * STRUCTURES
  ******************************************************************************/
@@ -130,6 +140,75 @@ INTERRUPT_TYPE_E io_apic_handle_spurious_irq(const uint32_t int_number);
  */
 int32_t io_apic_get_irq_int_line(const uint32_t irq_number);
 
+/**
+ * @brief Routes an IRQ to a CPU.
+ *
+ * @details Routes an IRQ to a CPU in physical destination mode. The IRQ mask is
+ * kept and the IRQ is no longer moved by io_apic_balance_irqs.
+ *
+ * @param[in] irq_number The IRQ number to route.
+ * @param[in] cpu_id The CPU that receives the IRQ.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NO_SUCH_IRQ_LINE is returned if the IRQ number is not supported.
+ * - OS_ERR_OUT_OF_BOUND is returned if the CPU is not booted.
+ * - OS_ERR_NOT_SUPPORTED is returned if the IO-APIC is not initialized.
+ */
+OS_RETURN_E io_apic_set_irq_affinity(const uint32_t irq_number,
+                                     const uint32_t cpu_id);
+
+/**
+ * @brief Routes an IRQ to a set of CPUs.
+ *
+ * @details Routes an IRQ to a set of CPUs in logical destination mode, each
+ * interrupt is delivered to the CPU of the set that runs at the lowest
+ * priority. A set of one CPU is routed in physical destination mode. The IRQ
+ * mask is kept and the IRQ is no longer moved by io_apic_balance_irqs.
+ *
+ * @param[in] irq_number The IRQ number to route.
+ * @param[in] cpu_mask The CPUs that receive the IRQ, bit N is set for CPU N.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NO_SUCH_IRQ_LINE is returned if the IRQ number is not supported.
+ * - OS_ERR_OUT_OF_BOUND is returned if the set is empty, holds a CPU that is
+ * not booted or a CPU that has no logical destination ID.
+ * - OS_ERR_NOT_SUPPORTED is returned if the IO-APIC is not initialized.
+ */
+OS_RETURN_E io_apic_set_irq_affinity_mask(const uint32_t irq_number,
+                                          const uint32_t cpu_mask);
+
+/**
+ * @brief Returns the CPUs an IRQ is routed to.
+ *
+ * @param[in] irq_number The IRQ number to get the destination of.
+ * @param[out] cpu_mask The buffer that receives the CPUs that receive the IRQ,
+ * bit N is set for CPU N.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the buffer is NULL.
+ * - OS_ERR_NO_SUCH_IRQ_LINE is returned if the IRQ number is not supported.
+ */
+OS_RETURN_E io_apic_get_irq_affinity(const uint32_t irq_number,
+                                     uint32_t* cpu_mask);
+
+/**
+ * @brief Spreads the IRQs over the booted CPUs.
+ *
+ * @details Routes the IRQs whose affinity was not set to the booted CPUs in
+ * turn, the enabled IRQs are spread first. The reserved CPUs do not receive
+ * IRQs unless all the booted CPUs are reserved.
+ *
+ * @param[in] reserved_cpus The latency critical CPUs, bit N is set for CPU N.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NOT_SUPPORTED is returned if the IO-APIC is not initialized.
+ */
+OS_RETURN_E io_apic_balance_irqs(const uint32_t reserved_cpus);
+
 /** 
  * @brief Returns the IO-APIC availability.
  * 
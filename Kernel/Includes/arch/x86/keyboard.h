@@ -20,8 +20,14 @@
 #ifndef __X86_KEYBOARD_H_
 #define __X86_KEYBOARD_H_
 
-#include <lib/stdint.h> /* Generic int types */
-#include <lib/stddef.h> /* Standard definitions */
+#include <lib/stdint.h>        /* Generic int types */
+#include <lib/stddef.h>        /* Standard definitions */
+#include <core/kernel_queue.h> /* Kernel queues */
+#include <sync/critical.h>     /* Critical sections */
+#include <interrupt/deferred.h> /* Interrupt deferred work */
+
+/* UTK configuration file */
+#include <config.h>
 
 /*******************************************************************************
  * CONSTANTS
@@ -32,8 +38,19 @@
 /** @brief Keyboard's CPU data port. */
 #define KEYBOARD_DATA_PORT      0x60
 
-/** @brief Kayboard's input buffer size in bytes. */
+/** @brief Kayboard's input buffer size in bytes, power of 2. */
 #define KEYBOARD_BUFFER_SIZE 512
+/** @brief Kayboard's scancode buffer size in bytes, power of 2. */
+#define KEYBOARD_SCANCODE_BUFFER_SIZE 64
+/** @brief Sleep period in ms of the keyboard reads with a timeout. */
+#define KEYBOARD_WAIT_PERIOD 10
+
+#if (KEYBOARD_BUFFER_SIZE & (KEYBOARD_BUFFER_SIZE - 1)) != 0
+#error "KEYBOARD_BUFFER_SIZE must be a power of 2"
+#endif
+#if (KEYBOARD_SCANCODE_BUFFER_SIZE & (KEYBOARD_SCANCODE_BUFFER_SIZE - 1)) != 0
+#error "KEYBOARD_SCANCODE_BUFFER_SIZE must be a power of 2"
+#endif
 
 /** @brief Keyboard specific key code: backspace. */
 #define KEY_BACKSPACE                   '\b'
@@ -99,17 +116,40 @@ struct key_mapper
  */
 typedef struct key_mapper key_mapper_t;
 
-/** @brief Keyboard input buffer definition, */
+/**
+ * @brief Keyboard input ring buffer definition. The interrupt handler stores
+ * the scancodes, the decoding tasklet writes the characters and the readers
+ * consume them.
+ */
 struct kbd_buffer
 {
-    /** @brief Current buffer mode (0: not initialized, 1: read, 2: getchar). */
-    int32_t     type;
-    /** @brief Character array as buffer. */
-    char*       char_buf;
-    /** @brief Number of characters to read. */
-    uint32_t    read_size;
-    /** @brief Number of characters already read. */
-    uint32_t    read;
+    /** @brief Scancodes not decoded yet. */
+    uint8_t scancodes[KEYBOARD_SCANCODE_BUFFER_SIZE];
+    /** @brief Scancodes ring buffer write index. */
+    volatile uint32_t scan_head;
+    /** @brief Scancodes ring buffer read index. */
+    volatile uint32_t scan_tail;
+    /** @brief Scancodes decoding tasklet. */
+    deferred_work_t decoder;
+
+    /** @brief Input ring buffer. */
+    char char_buf[KEYBOARD_BUFFER_SIZE];
+    /** @brief Input ring buffer write index. */
+    volatile uint32_t head;
+    /** @brief Input ring buffer read index. */
+    volatile uint32_t tail;
+    /** @brief Number of characters and scancodes dropped because a ring was
+     * full.
+     */
+    volatile uint32_t dropped;
+
+    /** @brief Readers waiting for input, the nodes data are thread nodes. */
+    kernel_queue_t waiters;
+
+#if MAX_CPU_COUNT > 1
+    /** @brief Buffer lock. */
+    spinlock_t lock;
+#endif
 };
 
 /** 
@@ -134,7 +174,8 @@ OS_RETURN_E keyboard_init(void);
 /**
  * @brief Fills the buffer with at maximum size characters.
  * @details Fills the buffer with keyboard buffer. This function is blocking 
- * while the keyboard buffer is empty.
+ * until a return character is read or the buffer is full. Backspace characters
+ * remove the previous character of the buffer.
  *
  * @param[out] buffer The bufer to fill with the user input.
  * @param[in] size The maximum size of the buffer.
@@ -143,6 +184,69 @@ OS_RETURN_E keyboard_init(void);
  */
 uint32_t keyboard_read(char* buffer, const size_t size);
 
+/**
+ * @brief Reads the characters typed on the keyboard.
+ *
+ * @details Copies up to size characters from the keyboard ring buffer. If no
+ * character is available, the calling thread is blocked until characters are
+ * typed.
+ *
+ * @param[out] buffer The buffer that receives the characters.
+ * @param[in] size The size of the buffer.
+ * @param[out] read The buffer that receives the number of characters read.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if a pointer parameter is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the size is 0.
+ * - OS_ERR_UNAUTHORIZED_ACTION is returned if the caller cannot sleep.
+ */
+OS_RETURN_E keyboard_receive(char* buffer, const size_t size, size_t* read);
+
+/**
+ * @brief Reads the characters typed on the keyboard with a timeout.
+ *
+ * @details Copies up to size characters from the keyboard ring buffer. If no
+ * character is available, the calling thread sleeps by periods of
+ * KEYBOARD_WAIT_PERIOD milliseconds until characters are typed or the timeout
+ * expires.
+ *
+ * @param[out] buffer The buffer that receives the characters.
+ * @param[in] size The size of the buffer.
+ * @param[out] read The buffer that receives the number of characters read.
+ * @param[in] timeout The timeout in milliseconds.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_TIMEOUT is returned if no character was typed before the timeout.
+ * - OS_ERR_NULL_POINTER is returned if a pointer parameter is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the size is 0.
+ * - OS_ERR_UNAUTHORIZED_ACTION is returned if the caller cannot sleep.
+ */
+OS_RETURN_E keyboard_receive_timeout(char* buffer, const size_t size,
+                                     size_t* read, const uint32_t timeout);
+
+/**
+ * @brief Reads the characters typed on the keyboard without waiting.
+ *
+ * @details Copies up to size characters from the keyboard ring buffer, the
+ * function never blocks and can be called in interrupt handlers.
+ *
+ * @param[out] buffer The buffer that receives the characters.
+ * @param[in] size The size of the buffer.
+ *
+ * @return The number of characters read, 0 if no character is available.
+ */
+size_t keyboard_poll(char* buffer, const size_t size);
+
+/**
+ * @brief Returns the number of characters dropped because the keyboard ring
+ * buffer was full.
+ *
+ * @return The number of characters dropped since the initialization.
+ */
+uint32_t keyboard_get_dropped(void);
+
 /**
  * @brief Fills the buffer with at maximum size characters.
  * @details Fills the buffer with keyboard buffer. This function is blocking 
@@ -161,6 +265,7 @@ uint32_t keyboard_secure_read(char* buffer, const size_t size);
  * 
  * @details The function will read one character from the kaybard of the 
  * keyboard bufffer. The function is blocking if no character can be read.
+ * Callers that cannot sleep poll the keyboard controller.
  *
  * @param[out] character The buffer to write the character to.
  */
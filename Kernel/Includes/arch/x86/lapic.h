@@ -142,6 +142,11 @@
 /** @brief LAPIC Timer vector interrupt masked. */
 #define LAPIC_LVT_INT_MASKED            0x10000
 
+/** @brief LAPIC logical destination register ID shift. */
+#define LAPIC_LOGICAL_ID_SHIFT          24
+/** @brief Number of CPUs addressable in flat logical destination mode. */
+#define LAPIC_LOGICAL_CPU_COUNT         8
+
 /*******************************************************************************
  * STRUCTURES
  ******************************************************************************/
@@ -210,6 +215,19 @@ OS_RETURN_E lapic_ap_timer_init(void);
  */
 int32_t lapic_get_id(void);
 
+/**
+ * @brief Returns the flat logical destination ID of a CPU.
+ *
+ * @details Each CPU has one bit of the logical destination ID, the IO-APIC
+ * can then deliver an interrupt to a set of CPUs.
+ *
+ * @param[in] cpu_id The CPU to get the logical ID of.
+ *
+ * @returns The CPU logical destination ID. 0 is returned if the CPU cannot be
+ * addressed in flat logical destination mode.
+ */
+uint32_t lapic_get_logical_id(const int32_t cpu_id);
+
 /**
  * @brief Send an INIT IPI to the corresponding LAPIC.
  *
@@ -237,6 +237,16 @@ uint32_t rtc_get_current_daytime(void);
  */
 void rtc_update_time(void);
 
+/**
+ * @brief Acknowledges the RTC interrupt and defers the time and date update.
+ *
+ * @details Reads the CMOS register C so the RTC is able to interrupt the CPU
+ * again and queues the slow CMOS reads of rtc_update_time on the deferred work
+ * thread of the current CPU. RTC handlers can call this function instead of
+ * rtc_update_time.
+ */
+void rtc_schedule_update(void);
+
 /**
  * @brief Returns the RTC IRQ number.
  * 
@@ -24,9 +24,13 @@
 #ifndef __X86_SERIAL_H_
 #define __X86_SERIAL_H_
 
-#include <lib/stdint.h> /* Generic int types */
-#include <lib/stddef.h> /* Standard definitions */
-#include <io/graphic.h> /* Graphic definitions */
+#include <lib/stdint.h>    /* Generic int types */
+#include <lib/stddef.h>    /* Standard definitions */
+#include <io/graphic.h>    /* Graphic definitions */
+#include <sync/critical.h> /* Critical sections */
+
+/* UTK configuration file */
+#include <config.h>
 
 /*******************************************************************************
  * DEFINITIONS
@@ -99,6 +103,34 @@
 /** @brief Serial fifo depth flag: 64 bits. */
 #define SERIAL_FIFO_DEPTH_64     0x10
 
+/** @brief Number of bytes the transmit FIFO can hold. */
+#define SERIAL_TX_FIFO_SIZE 16
+
+/** @brief Serial interrupt enable flag: data received. */
+#define SERIAL_INT_ENABLE_RX 0x01
+/** @brief Serial interrupt enable flag: transmit holding register empty. */
+#define SERIAL_INT_ENABLE_TX 0x02
+
+/** @brief Serial line status flag: data ready. */
+#define SERIAL_LSR_DATA_READY  0x01
+/** @brief Serial line status flag: transmit holding register empty. */
+#define SERIAL_LSR_THR_EMPTY   0x20
+
+/** @brief Serial interrupt identification flag: no interrupt pending. */
+#define SERIAL_IIR_NONE         0x01
+/** @brief Serial interrupt identification mask. */
+#define SERIAL_IIR_ID_MASK      0x0E
+/** @brief Serial interrupt identification: modem status changed. */
+#define SERIAL_IIR_MODEM_STATUS 0x00
+/** @brief Serial interrupt identification: transmit holding register empty. */
+#define SERIAL_IIR_THR_EMPTY    0x02
+/** @brief Serial interrupt identification: data received. */
+#define SERIAL_IIR_RX_DATA      0x04
+/** @brief Serial interrupt identification: line status changed. */
+#define SERIAL_IIR_LINE_STATUS  0x06
+/** @brief Serial interrupt identification: receive FIFO timeout. */
+#define SERIAL_IIR_RX_TIMEOUT   0x0C
+
 /** 
  * @brief Computes the data port for the serial port which base port ID is 
  * given as parameter.
@@ -141,6 +173,20 @@
  * @param[in] port The base port ID of the serial port.
  */
 #define SERIAL_LINE_STATUS_PORT(port)   (port + 5)
+/** 
+ * @brief Computes the modem status port for the serial port which base port ID
+ * is given as parameter.
+ * 
+ * @param[in] port The base port ID of the serial port.
+ */
+#define SERIAL_MODEM_STATUS_PORT(port)  (port + 6)
+/** 
+ * @brief Computes the interrupt identification port for the serial port which
+ * base port ID is given as parameter.
+ * 
+ * @param[in] port The base port ID of the serial port.
+ */
+#define SERIAL_INT_ID_PORT(port)        (port + 2)
 
 /*******************************************************************************
  * STRUCTURES
@@ -190,6 +236,45 @@ enum SERIAL_BAUDRATE
  */
 typedef enum SERIAL_BAUDRATE SERIAL_BAUDRATE_E;
 
+/** @brief Serial port representation in the driver. */
+struct serial_port
+{
+    /** @brief Port base ID. */
+    uint16_t base;
+    /** @brief Shadow of the port interrupt enable register. */
+    uint8_t ier;
+
+    /** @brief Transmit ring buffer. */
+    uint8_t tx_buffer[SERIAL_TX_BUFFER_SIZE];
+    /** @brief Transmit ring buffer write index. */
+    volatile uint32_t tx_head;
+    /** @brief Transmit ring buffer read index. */
+    volatile uint32_t tx_tail;
+
+    /** @brief Receive ring buffer. */
+    uint8_t rx_buffer[SERIAL_RX_BUFFER_SIZE];
+    /** @brief Receive ring buffer write index. */
+    volatile uint32_t rx_head;
+    /** @brief Receive ring buffer read index. */
+    volatile uint32_t rx_tail;
+    /** @brief Number of bytes dropped because the receive ring was full. */
+    volatile uint32_t rx_dropped;
+    /** @brief Incremented on each reception, the blocked readers wait on it. */
+    volatile int32_t rx_event;
+    /** @brief Number of readers blocked on the port. */
+    volatile uint32_t rx_waiters;
+
+#if MAX_CPU_COUNT > 1
+    /** @brief Port lock. */
+    spinlock_t lock;
+#endif
+};
+
+/** 
+ * @brief Defines serial_port_t type as a shorcut for struct serial_port.
+ */
+typedef struct serial_port serial_port_t;
+
 /** @brief Serial driver structure. */
 extern kernel_graphic_driver_t serial_text_driver;
 
@@ -209,12 +294,40 @@ extern kernel_graphic_driver_t serial_text_driver;
  */
 OS_RETURN_E serial_init(void);
 
+/**
+ * @brief Enables the interrupt driven transmissions and receptions.
+ * 
+ * @details Registers the serial interrupt handlers. Once enabled, the written
+ * data are queued in the port transmit ring buffer and sent by bursts of
+ * SERIAL_TX_FIFO_SIZE bytes when the transmit holding register empty interrupt
+ * is raised. If the ring buffer is full, the writer drains it synchronously.
+ * The received data are moved to the port receive ring buffer by the data
+ * available interrupt, the bytes received while the ring is full are dropped.
+ * This function must be called once the interrupt manager is initialized.
+ *
+ * @return The success state or the error code. 
+ * - OS_NO_ERR is returned if no error is encountered. 
+ * - Other error codes can be returned by the interrupt manager.
+ */
+OS_RETURN_E serial_irq_init(void);
+
+/**
+ * @brief Switches the driver to synchronous transmissions.
+ * 
+ * @details Sends the data queued in the transmit ring buffers by polling the
+ * ports and disables the interrupt driven transmissions. This function does not
+ * take the ports locks and is meant to be called with interrupts disabled when
+ * the kernel panics.
+ */
+void serial_set_sync_mode(void);
+
 /**
  * @brief Writes the data given as patameter on the desired port.
  * 
  * @details The function will output the data given as parameter on the selected
- * port. This call is blocking until the data has been sent to the serial port
- * controler.
+ * port. When the interrupt driven transmissions are enabled, the data is queued
+ * in the port transmit ring buffer. Otherwise, this call is blocking until the
+ * data has been sent to the serial port controler.
  *
  * @param[in] port The desired port to write the data to.
  * @param[in] data The byte to write to the serial port.
@@ -249,7 +362,8 @@ void serial_put_char(const char character);
  * @brief Tells if the data on the serial port are ready to be read.
  * 
  * @details The function will returns 1 if a data was received by the serial
- * port referenced by the port given as parameter.
+ * port referenced by the port given as parameter. When the interrupt driven
+ * receptions are enabled, the port receive ring buffer is checked.
  *
  * @param[in] port The serial port on which the test should be executed.
  * 
@@ -263,7 +377,9 @@ uint8_t serial_received(const uint32_t port);
  * 
  * @details The function will read the input data on the selected port. This 
  * call is blocking until the data has been received by the serial port
- * controler.
+ * controler. When the interrupt driven receptions are enabled, the byte is
+ * read from the port receive ring buffer and the calling thread sleeps until
+ * data are available.
  *
  * @param port The port on whichthe data should be read.
  * 
@@ -271,6 +387,57 @@ uint8_t serial_received(const uint32_t port);
  */
 uint8_t serial_read(const uint32_t port);
 
+/** 
+ * @brief Reads the data received on a serial port.
+ * 
+ * @details Copies up to size bytes from the port receive ring buffer. If no
+ * data is available, the calling thread sleeps until data are received.
+ *
+ * @param[in] port The port on which the data should be read.
+ * @param[out] buffer The buffer that receives the data.
+ * @param[in] size The size of the buffer.
+ * @param[out] read The buffer that receives the number of bytes read.
+ * 
+ * @return The success state or the error code. 
+ * - OS_NO_ERR is returned if no error is encountered. 
+ * - OS_ERR_NULL_POINTER is returned if a pointer parameter is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the port is not supported or the size
+ *   is 0.
+ * - OS_ERR_NOT_SUPPORTED is returned if the interrupt driven receptions are
+ *   not enabled.
+ * - OS_ERR_UNAUTHORIZED_ACTION is returned if the caller cannot sleep.
+ */
+OS_RETURN_E serial_receive(const uint32_t port, uint8_t* buffer,
+                           const size_t size, size_t* read);
+
+/** 
+ * @brief Reads the data received on a serial port with a timeout.
+ * 
+ * @details Copies up to size bytes from the port receive ring buffer. If no
+ * data is available, the calling thread sleeps by periods of
+ * SERIAL_RX_WAIT_PERIOD milliseconds until data are received or the timeout
+ * expires.
+ *
+ * @param[in] port The port on which the data should be read.
+ * @param[out] buffer The buffer that receives the data.
+ * @param[in] size The size of the buffer.
+ * @param[out] read The buffer that receives the number of bytes read.
+ * @param[in] timeout The timeout in milliseconds.
+ * 
+ * @return The success state or the error code. 
+ * - OS_NO_ERR is returned if no error is encountered. 
+ * - OS_ERR_TIMEOUT is returned if no data was received before the timeout.
+ * - OS_ERR_NULL_POINTER is returned if a pointer parameter is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the port is not supported or the size
+ *   is 0.
+ * - OS_ERR_NOT_SUPPORTED is returned if the interrupt driven receptions are
+ *   not enabled.
+ * - OS_ERR_UNAUTHORIZED_ACTION is returned if the caller cannot sleep.
+ */
+OS_RETURN_E serial_receive_timeout(const uint32_t port, uint8_t* buffer,
+                                   const size_t size, size_t* read,
+                                   const uint32_t timeout);
+
 /**
  * @brief Clears the screen.
  * 
@@ -25,6 +25,9 @@
 #include <lib/stddef.h> /* Standard definitions */
 #include <io/graphic.h> /* Graphic API */
 
+/* UTK configuration file */
+#include <config.h>
+
 /*******************************************************************************
  * CONSTANTS
  ******************************************************************************/
@@ -38,6 +41,11 @@
 #define BIOS_CALL_GET_VESA_MODE 0x4F01
 /** @brief VESA BIOS set mode command id. */
 #define BIOS_CALL_SET_VESA_MODE 0x4F02
+/** @brief VESA BIOS set display start command id. */
+#define BIOS_CALL_SET_VESA_DISPLAY_START 0x4F07
+
+/** @brief VESA set display start command: wait for the vertical retrace. */
+#define VESA_DISPLAY_START_VSYNC 0x0080
 
 /** @brief VESA mode information flag: linear framebuffer. */
 #define VESA_FLAG_LINEAR_FB  0x90
@@ -50,6 +58,32 @@
 /** @brief Defines the tabulation space width. */
 #define TAB_WIDTH 4
 
+/** @brief Maximal number of dirty rectangles tracked between two flushes of
+ * the virtual buffer. When the list is full, the new area is merged in the
+ * rectangle that grows the least.
+ */
+#define VESA_DIRTY_RECT_COUNT 8
+
+/** @brief Width in pixels of the console font glyphs. */
+#define VESA_GLYPH_WIDTH  8
+/** @brief Height in pixels of the console font glyphs. */
+#define VESA_GLYPH_HEIGHT 16
+/** @brief Number of entries of the rendered glyphs cache, power of 2. */
+#define VESA_GLYPH_CACHE_SIZE 128
+
+#if (VESA_GLYPH_CACHE_SIZE & (VESA_GLYPH_CACHE_SIZE - 1)) != 0
+#error "VESA_GLYPH_CACHE_SIZE must be a power of 2"
+#endif
+
+/** @brief Maximal number of bytes copied with SSE between two interrupt
+ * windows. The XMM registers are not saved on context switch, SSE copies run
+ * with interrupts disabled.
+ */
+#define VESA_SSE_BLOCK_SIZE 4096
+
+/** @brief Minimal time in ms between two frames copied to the screen. */
+#define VESA_FRAME_PERIOD (1000 / VESA_MAX_FRAME_RATE)
+
 /*******************************************************************************
  * STRUCTURES
  ******************************************************************************/
@@ -172,6 +206,83 @@ struct vesa_mode_info
  */
 typedef struct vesa_mode_info vesa_mode_info_t;
 
+/** @brief Screen rectangle, used to track the areas of the virtual buffer
+ * modified since the last flush.
+ */
+struct vesa_rect
+{
+    /** @brief The rectangle's left column. */
+    uint32_t x;
+    /** @brief The rectangle's top line. */
+    uint32_t y;
+    /** @brief The rectangle's width in pixels. */
+    uint32_t width;
+    /** @brief The rectangle's height in pixels. */
+    uint32_t height;
+};
+
+/**
+ * @brief Defines vesa_rect_t type as a shorcut for struct vesa_rect.
+ */
+typedef struct vesa_rect vesa_rect_t;
+
+/** @brief Virtual buffer flush statistics. */
+struct vesa_flush_stats
+{
+    /** @brief Number of flushes that copied data to the hardware buffer. */
+    uint64_t frames;
+    /** @brief Number of flushes skipped because nothing changed. */
+    uint64_t skipped;
+    /** @brief Number of bytes copied to the hardware buffer. */
+    uint64_t bytes;
+    /** @brief Number of pages flipped on vertical retrace. */
+    uint64_t flips;
+    /** @brief Number of bytes copied by the last frame. */
+    uint32_t last_bytes;
+};
+
+/**
+ * @brief Defines vesa_flush_stats_t type as a shorcut for struct
+ * vesa_flush_stats.
+ */
+typedef struct vesa_flush_stats vesa_flush_stats_t;
+
+/** @brief Console glyph rendered with a color scheme, ready to be copied. */
+struct vesa_glyph_entry
+{
+    /** @brief The rendered character, 0 if the entry is free. */
+    uint32_t character;
+    /** @brief The foreground pixel value. */
+    uint32_t fgcolor;
+    /** @brief The background pixel value. */
+    uint32_t bgcolor;
+
+    /** @brief The glyph pixels, row by row. */
+    uint32_t pixels[VESA_GLYPH_WIDTH * VESA_GLYPH_HEIGHT]
+        __attribute__((aligned(16)));
+};
+
+/**
+ * @brief Defines vesa_glyph_entry_t type as a shorcut for struct
+ * vesa_glyph_entry.
+ */
+typedef struct vesa_glyph_entry vesa_glyph_entry_t;
+
+/** @brief Rendered glyphs cache statistics. */
+struct vesa_glyph_cache_stats
+{
+    /** @brief Number of characters copied from the cache. */
+    uint64_t hits;
+    /** @brief Number of characters rendered in the cache. */
+    uint64_t misses;
+};
+
+/**
+ * @brief Defines vesa_glyph_cache_stats_t type as a shorcut for struct
+ * vesa_glyph_cache_stats.
+ */
+typedef struct vesa_glyph_cache_stats vesa_glyph_cache_stats_t;
+
 /*******************************************************************************
  * FUNCTIONS
  ******************************************************************************/
@@ -332,12 +443,119 @@ OS_RETURN_E vesa_draw_rectangle(const uint16_t x, const uint16_t y,
                                 const uint8_t alpha, const uint8_t red,
                                 const uint8_t green, const uint8_t blue);
 
+/**
+ * @brief Fills a rectangle of the screen with an opaque color.
+ *
+ * @details Fills a rectangle of the screen, the alpha component of the color
+ * is ignored. The rows are filled with SSE2 stores when SSE is enabled.
+ *
+ * @param[in] x The x coordinate of the rectangle.
+ * @param[in] y The y coordinate of the rectangle.
+ * @param[in] width The width in pixels of the rectangle.
+ * @param[in] height The height in pixels of the rectangle.
+ * @param[in] color The RGB color of the rectangle.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_VESA_NOT_SUPPORTED if the graphic driver is cannot handle VESA on
+ *   the system.
+ * - OS_ERR_VESA_NOT_INIT if the VESA driver has not been initialized before
+ *   calling this function.
+ * - OS_ERR_OUT_OF_BOUND if the rectangle is out of the screen bounds.
+ */
+OS_RETURN_E vesa_fill_rectangle(const uint32_t x, const uint32_t y,
+                                const uint32_t width, const uint32_t height,
+                                const uint32_t color);
+
+/**
+ * @brief Blends a color over a rectangle of the screen.
+ *
+ * @details Blends a color over a rectangle of the screen, the alpha component
+ * of the color gives the blend factor as for vesa_draw_pixel. The pixels are
+ * blended by 4 with SSE2 when SSE is enabled.
+ *
+ * @param[in] x The x coordinate of the rectangle.
+ * @param[in] y The y coordinate of the rectangle.
+ * @param[in] width The width in pixels of the rectangle.
+ * @param[in] height The height in pixels of the rectangle.
+ * @param[in] color The ARGB color to blend.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_VESA_NOT_SUPPORTED if the graphic driver is cannot handle VESA on
+ *   the system.
+ * - OS_ERR_VESA_NOT_INIT if the VESA driver has not been initialized before
+ *   calling this function.
+ * - OS_ERR_OUT_OF_BOUND if the rectangle is out of the screen bounds.
+ */
+OS_RETURN_E vesa_blend_rectangle(const uint32_t x, const uint32_t y,
+                                 const uint32_t width, const uint32_t height,
+                                 const uint32_t color);
+
+/**
+ * @brief Copies an image to a rectangle of the screen.
+ *
+ * @details Copies an image to a rectangle of the screen. The image pixels are
+ * 32 bits values in the screen format. The rows are copied with SSE2 loads and
+ * stores when SSE is enabled.
+ *
+ * @param[in] x The x coordinate of the rectangle.
+ * @param[in] y The y coordinate of the rectangle.
+ * @param[in] width The width in pixels of the rectangle.
+ * @param[in] height The height in pixels of the rectangle.
+ * @param[in] src The image to copy.
+ * @param[in] src_pitch The number of pixels of an image row.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER if the image is NULL.
+ * - OS_ERR_VESA_NOT_SUPPORTED if the graphic driver is cannot handle VESA on
+ *   the system.
+ * - OS_ERR_VESA_NOT_INIT if the VESA driver has not been initialized before
+ *   calling this function.
+ * - OS_ERR_OUT_OF_BOUND if the rectangle is out of the screen bounds.
+ */
+OS_RETURN_E vesa_copy_rectangle(const uint32_t x, const uint32_t y,
+                                const uint32_t width, const uint32_t height,
+                                const uint32_t* src, const uint32_t src_pitch);
+
+/**
+ * @brief Draws an 8 pixels wide glyph on the screen.
+ *
+ * @details Draws a one bit per pixel glyph, the most significant bit of a row
+ * is its leftmost pixel. When both colors are opaque, the rows are expanded
+ * with SSE2 masks when SSE is enabled. Otherwise the pixels are blended as
+ * for vesa_draw_pixel, a 0 alpha component leaves the pixel unchanged.
+ *
+ * @param[in] glyph The glyph rows.
+ * @param[in] x The x coordinate of the glyph.
+ * @param[in] y The y coordinate of the glyph.
+ * @param[in] height The number of rows of the glyph.
+ * @param[in] fgcolor The ARGB foreground color.
+ * @param[in] bgcolor The ARGB background color.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER if the glyph is NULL.
+ * - OS_ERR_VESA_NOT_SUPPORTED if the graphic driver is cannot handle VESA on
+ *   the system.
+ * - OS_ERR_VESA_NOT_INIT if the VESA driver has not been initialized before
+ *   calling this function.
+ * - OS_ERR_OUT_OF_BOUND if the glyph is out of the screen bounds.
+ */
+OS_RETURN_E vesa_blit_glyph(const uint8_t* glyph,
+                            const uint32_t x, const uint32_t y,
+                            const uint32_t height,
+                            const uint32_t fgcolor, const uint32_t bgcolor);
+
 /**
  * @brief Draws a character on the screen.
  *
  * @details Draw a character on the screen at the given coordinates. The top
  * left hand corner of the screen has coordinates x = 0 and y = 0. The
- * coordinates reffer to the top left hand corner of the character.
+ * coordinates reffer to the top left hand corner of the character. Opaque
+ * characters are rendered once per color scheme in a cache and copied from
+ * it row by row.
  *
  * @param[in] character The character to write.
  * @param[in] x The x coordinate of the character.
@@ -357,6 +575,17 @@ void vesa_drawchar(const unsigned char character,
                    const uint32_t x, const uint32_t y,
                    const uint32_t fgcolor, const uint32_t bgcolor);
 
+/**
+ * @brief Returns the rendered glyphs cache statistics.
+ *
+ * @param[out] stats The buffer that receives the statistics.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the buffer is NULL.
+ */
+OS_RETURN_E vesa_get_glyph_cache_stats(vesa_glyph_cache_stats_t* stats);
+
 /**
  * @brief Returns the current resolution's width.
  *
@@ -441,7 +670,7 @@ OS_RETURN_E vesa_restore_cursor(const cursor_t buffer);
  * @brief Scrolls in the desired direction of lines_count lines.
  *
  * @details The function will scroll of lines_count line in the desired
- * direction.
+ * direction. The lines leaving the screen are kept in the scrollback history.
  *
  * @param[in] direction The direction to which the screen should be scrolled.
  * @param[in] lines_count The number of lines to scroll.
@@ -449,6 +678,24 @@ OS_RETURN_E vesa_restore_cursor(const cursor_t buffer);
 void vesa_scroll(const SCROLL_DIRECTION_E direction,
                  const uint32_t lines_count);
 
+/**
+ * @brief Displays the scrollback history.
+ *
+ * @details Displays lines_back lines of the scrollback history at the top of
+ * the screen followed by the top of the console content. The console content is
+ * drawn again from its text cells when lines_back is 0 or when characters are
+ * written.
+ *
+ * @param[in] lines_back The number of history lines to display.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NOT_SUPPORTED is returned if no VESA mode is set.
+ * - OS_ERR_OUT_OF_BOUND is returned if the history holds less lines than
+ * lines_back.
+ */
+OS_RETURN_E vesa_show_scrollback(const uint32_t lines_back);
+
 /**
  * @brief Sets the color scheme of the screen.
  *
@@ -524,11 +771,37 @@ void vesa_fill_screen(const void* pointer);
 /**
  * @brief Flushes the buffer to the graphic card.
  *
- * @details  Flushes the buffer to the graphic card. The virtual buffer
- * will be copied to the hardware buffer.
+ * @details  Flushes the buffer to the graphic card. Only the areas of the
+ * virtual buffer modified since the last flush are copied to the hardware
+ * buffer, the flush does nothing when the screen did not change. When page
+ * flipping is used, the areas are copied to the hidden page which is then
+ * displayed on the next vertical retrace.
  */
 void vesa_flush_buffer(void);
 
+/**
+ * @brief Commits the frame drawn in the virtual buffer.
+ *
+ * @details Wakes the buffer thread that copies the frame to the screen, at
+ * most VESA_MAX_FRAME_RATE times per second. The frames presented before the
+ * copy are merged. The console functions present their output, the drawing
+ * functions do not so a frame is never displayed partially drawn. The function
+ * can be called in interrupt handlers.
+ */
+void vesa_present(void);
+
+/**
+ * @brief Returns the virtual buffer flush statistics.
+ *
+ * @param[out] stats The buffer that receives the statistics.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the buffer is NULL.
+ * - OS_ERR_NOT_SUPPORTED is returned if the display is not buffered.
+ */
+OS_RETURN_E vesa_get_flush_stats(vesa_flush_stats_t* stats);
+
 /**
  * @brief Enables or disables transparent background for characters.
  *
@@ -542,8 +815,9 @@ void vesa_set_transparent_char(const uint32_t enabled);
 /**
  * @brief VESA buffered thread. 
  *
- * @details VESA buffered thread. Copies the virtual bufer into the hardware
- * buffer. 
+ * @details VESA buffered thread. Sleeps until a frame is presented then copies
+ * the virtual bufer into the hardware buffer, waiting if needed to respect
+ * VESA_MAX_FRAME_RATE.
  * 
  * @param[in] args Unused.
  * 
@@ -67,8 +67,10 @@ extern kernel_graphic_driver_t vga_text_driver;
  * @brief Returns the memory address of the screen framebuffer depending on the
  * parameters.
  *
- * @details Return the memory address of the screen framebuffer position at the
- * coordinates given as arguments.
+ * @details Return the memory address of the screen shadow buffer position at
+ * the coordinates given as arguments. The shadow buffer is copied to the
+ * hardware framebuffer by vga_flush, the driver functions that write the screen
+ * flush it before returning.
  *
  * @returns The address at which the driver has to write the bytes to display.
  *
@@ -111,6 +113,16 @@ void vga_clear_screen(void);
  */
 OS_RETURN_E vga_put_cursor_at(const uint32_t line, const uint32_t column);
 
+/**
+ * @brief Copies the modified cells of the shadow buffer to the hardware
+ * framebuffer.
+ *
+ * @details Copies the modified area of the shadow buffer to the hardware
+ * framebuffer in one copy and updates the hardware cursor if it moved since the
+ * last flush.
+ */
+void vga_flush(void);
+
 /**
  * @brief Saves the cursor attributes in the buffer given as parameter.
  *
@@ -146,13 +158,30 @@ OS_RETURN_E vga_restore_cursor(const cursor_t buffer);
  * @brief Scrolls in the desired direction of lines_count lines.
  *
  * @details The function will scroll of lines_count line in the desired
- * direction.
+ * direction. The lines leaving the screen are kept in the scrollback history.
  *
  * @param[in] direction The direction to whoch the console should be scrolled.
  * @param[in] lines_count The number of lines to scroll.
  */
 void vga_scroll(const SCROLL_DIRECTION_E direction, const uint32_t lines_count);
 
+/**
+ * @brief Displays the scrollback history.
+ *
+ * @details Displays lines_back lines of the scrollback history at the top of
+ * the screen followed by the top of the screen content. The screen content is
+ * saved and displayed again when lines_back is 0 or when characters are
+ * written.
+ *
+ * @param[in] lines_back The number of history lines to display.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_OUT_OF_BOUND is returned if the history holds less lines than
+ * lines_back.
+ */
+OS_RETURN_E vga_show_scrollback(const uint32_t lines_back);
+
 /**
  * @brief Sets the color scheme of the screen.
  *
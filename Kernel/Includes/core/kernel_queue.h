@@ -13,7 +13,9 @@
  *
  * @details Kernel's queue structures. These queues are used by the kernel as
  * priority queue or regular queues. A kernel queue can virtually store every
- * type of data and is just a wrapper.
+ * type of data and is just a wrapper. Nodes and queues can either be allocated
+ * by the queue functions or be embedded in the structure they link and
+ * initialized in place, in which case enqueuing and dequeuing never allocate.
 
  *
  * @copyright Alexy Torres Aurora Dugo
@@ -25,6 +27,7 @@
 #include <lib/stddef.h>    /* Standard definitons */
 #include <lib/stdint.h>    /* Generic int types */
 #include <sync/critical.h> /* Critical sections */
+#include <sync/rcu.h>      /* Read-copy-update */
 
 /* UTK configuration file */
 #include <config.h>
@@ -48,11 +51,17 @@ struct kernel_queue_node
     /** @brief Tell if the node is present in a queue or stands alone. */
     uint16_t enlisted;
 
+    /** @brief Queue the node is currently enlisted in. */
+    struct kernel_queue* owner;
+
     /** @brief Node's priority, used when the queue is a priority queue. */
     uint32_t priority;
 
     /** @brief Node's data pointer. Store the address of the contained data. */
     void* data;
+
+    /** @brief RCU head used to defer the node release. */
+    rcu_head_t rcu;
 };
 
 /**
@@ -72,6 +81,9 @@ struct kernel_queue
     /** @brief Current queue's size. */
     uint32_t size;
 
+    /** @brief RCU head used to defer the queue release. */
+    rcu_head_t rcu;
+
 #if MAX_CPU_COUNT > 1
     /** @brief Critical section spinlock. */
     spinlock_t lock;
@@ -105,11 +117,31 @@ typedef struct kernel_queue kernel_queue_t;
  */
 kernel_queue_node_t* kernel_queue_create_node(void* data, OS_RETURN_E *error);
 
+/**
+ * @brief Initializes a queue node in place.
+ *
+ * @details Initializes a node embedded in the structure it links. The node is
+ * ready to be inserted in a queue and must not be deleted with
+ * kernel_queue_delete_node, its memory belongs to the containing structure.
+ *
+ * @warning A node should be only used in one queue at most.
+ *
+ * @param[out] node The node to initialize.
+ * @param[in] data The pointer to the data to carry in the node.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the pointer to the node is NULL.
+ */
+OS_RETURN_E kernel_queue_init_node(kernel_queue_node_t* node, void* data);
+
 /**
  * @brief Deletes a queue node.
  *
  * @details Deletes a node from the memory. The node should not be used in any
- * queue. If it is the case, the function will return an error.
+ * queue. If it is the case, the function will return an error. The memory is
+ * released after a RCU grace period, lockless readers that still hold the node
+ * can keep using it until they leave their read side critical section.
  *
  * @param[in, out] node The node pointer of pointer to destroy.
  *
@@ -135,11 +167,28 @@ OS_RETURN_E kernel_queue_delete_node(kernel_queue_node_t** node);
  */
 kernel_queue_t* kernel_queue_create_queue(OS_RETURN_E *error);
 
+/**
+ * @brief Initializes a queue in place.
+ *
+ * @details Initializes a queue embedded in a structure. The queue is ready to
+ * be used and must not be deleted with kernel_queue_delete_queue, its memory
+ * belongs to the containing structure.
+ *
+ * @param[out] queue The queue to initialize.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the pointer to the queue is NULL.
+ */
+OS_RETURN_E kernel_queue_init_queue(kernel_queue_t* queue);
+
 /**
  * @brief Deletes a previously created queue.
  *
  * @details Delete a queue from the memory. If the queue is not empty an error
- * is returned.
+ * is returned. The memory is released after a RCU grace period, lockless
+ * readers that still hold the queue can keep using it until they leave their
+ * read side critical section.
  *
  * @param[in, out] queue The queue pointer of pointer to destroy.
  *
@@ -228,7 +277,11 @@ kernel_queue_node_t* kernel_queue_find(kernel_queue_t* queue, void* data,
  * @brief Removes a node from a queue.
  *
  * @details Removes a node from a queue given as parameter. If the node is not
- * found, nothing is done and an error is returned.
+ * enlisted in this queue, nothing is done and an error is returned. The node
+ * keeps track of the queue it is enlisted in, the removal is done in constant
+ * time. The next link of the node is kept so that RCU readers standing on the
+ * node can continue their walk, a node removed from a queue walked by RCU
+ * readers must not be pushed again before a grace period elapsed.
  *
  * @param[in, out] queue The queue containing the node.
  * @param[in] node The node to remove.
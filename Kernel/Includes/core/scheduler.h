@@ -42,6 +42,12 @@
 /** @brief Defines the main task's stack size in bytes. */
 #define SCHEDULER_MAIN_STACK_SIZE KERNEL_STACK_SIZE
 
+/** @brief Number of buckets of the per CPU run queue length histogram. Bucket 0
+ * counts the empty run queues, bucket i counts the run queues which length is
+ * in [2^(i-1), 2^i[, the last bucket counts all the longer run queues.
+ */
+#define SCHED_RUNQUEUE_HIST_SIZE 8
+
 /*******************************************************************************
  * STRUCTURES
  ******************************************************************************/
@@ -92,6 +98,19 @@ struct thread_info
     uint32_t start_time;
     /** @brief Thread's end time. */
     uint32_t end_time;
+
+    /** @brief Time spent running, in CPU timestamp counter cycles. */
+    uint64_t run_time;
+    /** @brief Time spent ready to run, in CPU timestamp counter cycles. */
+    uint64_t ready_time;
+    /** @brief Time spent waiting (sleeping, blocked or joining), in CPU
+     * timestamp counter cycles.
+     */
+    uint64_t wait_time;
+    /** @brief Number of times the thread gave the CPU away. */
+    uint32_t voluntary_switches;
+    /** @brief Number of times the thread was preempted. */
+    uint32_t involuntary_switches;
 };
 /**
  * @brief Defines thread_info_t type as a shorcut for struct thread_info.
@@ -356,6 +375,43 @@ OS_RETURN_E sched_unlock_thread(kernel_queue_node_t* node,
  */
 OS_RETURN_E sched_get_threads_info(thread_info_t* threads, size_t* size);
 
+/**
+ * @brief Gets a thread information.
+ *
+ * @details Gets the information of the thread which TID is given as parameter.
+ * The thread is looked up in the TID table, the lookup does not depend on the
+ * number of threads in the system.
+ *
+ * @param[in] tid The TID of the thread to get the information of.
+ * @param[out] info The structure to fill with the thread information.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the info parameter is NULL.
+ * - OS_ERR_NO_SUCH_ID is returned if no thread has this TID.
+ */
+OS_RETURN_E sched_get_thread_info(const int32_t tid, thread_info_t* info);
+
+/**
+ * @brief Sets the priority of a thread.
+ *
+ * @details Sets the priority of the thread which TID is given as parameter.
+ * The change is applied by the CPU of the thread on its next schedule, a ready
+ * thread is then moved to the active table of its new priority. The thread
+ * information reports the new priority as soon as this function returns.
+ *
+ * @param[in] tid The TID of the thread to modify.
+ * @param[in] priority The new priority of the thread.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_FORBIDEN_PRIORITY is returned if the priority is not valid.
+ * - OS_ERR_NO_SUCH_ID is returned if no thread has this TID.
+ * - OS_ERR_UNAUTHORIZED_ACTION is returned if the thread is an IDLE thread.
+ */
+OS_RETURN_E sched_set_thread_priority(const int32_t tid,
+                                      const uint32_t priority);
+
 /**
  * @brief Set the current thread termination cause.
  *
@@ -394,6 +450,25 @@ uint64_t sched_get_schedule_count(void);
  */
 uint64_t sched_get_idle_schedule_count(void);
 
+/**
+ * @brief Returns the run queue length histogram of a CPU.
+ *
+ * @details Returns the run queue length histogram of a CPU. The number of ready
+ * threads of the CPU is sampled each time the CPU schedules, see
+ * SCHED_RUNQUEUE_HIST_SIZE for the buckets layout.
+ *
+ * @param[in] cpu_id The id of the CPU to get the histogram of.
+ * @param[out] histogram The buffer that receives the SCHED_RUNQUEUE_HIST_SIZE
+ * buckets.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the histogram buffer is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the CPU id is not valid.
+ */
+OS_RETURN_E sched_get_runqueue_histogram(const uint32_t cpu_id,
+                                         uint64_t* histogram);
+
 /**
  * @brief Returns the address of the current thread's free page table.
  *
@@ -69,7 +69,9 @@ enum THREAD_WAIT_TYPE
     /** @brief The thread is waiting to acquire a mutex. */
     THREAD_WAIT_TYPE_MUTEX,
     /** @brief The thread is waiting to acquire a keyboard entry. */
-    THREAD_WAIT_TYPE_IO_KEYBOARD
+    THREAD_WAIT_TYPE_IO_KEYBOARD,
+    /** @brief The thread is waiting on a futex address. */
+    THREAD_WAIT_TYPE_FUTEX
 };
 
 /**
@@ -185,20 +187,52 @@ struct kernel_thread
     /** @brief Wake up time limit for the sleeping thread. */
     uint64_t wakeup_time;
 
+    /** @brief Thread's scheduling node, enlisted in the ready, sleeping and
+     * zombie tables or in a synchronization object waiting queue.
+     */
+    kernel_queue_node_t sched_node;
+    /** @brief Thread's node in its parent's children list. */
+    kernel_queue_node_t children_node;
+    /** @brief Thread's node in the global threads list. */
+    kernel_queue_node_t global_node;
+    /** @brief Thread's node in the priority requests list of its CPU. */
+    kernel_queue_node_t priority_node;
+
+    /** @brief Priority applied by the thread's CPU on its next schedule. */
+    uint32_t requested_priority;
+
     /** @brief Pointer to the joining thread's node in the threads list. */
     kernel_queue_node_t* joining_thread;
 
     /** @brief Thread's children list. */
-    kernel_queue_t* children;
+    kernel_queue_t children;
 
     /** @brief Thread's start time. */
     uint64_t start_time;
     /** @brief Thread's end time. */
     uint64_t end_time;
 
+    /** @brief Time spent running, in CPU timestamp counter cycles. */
+    uint64_t run_time;
+    /** @brief Time spent ready to run, in CPU timestamp counter cycles. */
+    uint64_t ready_time;
+    /** @brief Time spent waiting (sleeping, blocked or joining), in CPU
+     * timestamp counter cycles.
+     */
+    uint64_t wait_time;
+    /** @brief Timestamp counter value of the last time accounting update. */
+    uint64_t last_account;
+    /** @brief Number of times the thread gave the CPU away. */
+    uint32_t voluntary_switches;
+    /** @brief Number of times the thread was preempted. */
+    uint32_t involuntary_switches;
+
     /** @brief Thread's CPU affinity. */
     uint32_t cpu_affinity;
 
+    /** @brief RCU head used to defer the thread release once joined. */
+    rcu_head_t rcu;
+
 #if MAX_CPU_COUNT > 1
     /** @brief Thread's concurency lock. */
     spinlock_t lock;
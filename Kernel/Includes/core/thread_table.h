@@ -0,0 +1,102 @@
+/*******************************************************************************
+ * @file thread_table.h
+ *
+ * @see thread_table.c
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Kernel's TID indexed thread table.
+ *
+ * @details Kernel's TID indexed thread table. The table is an open addressing
+ * hash table with linear probing that maps a thread identifier to its thread
+ * structure in constant time. The table grows when its load factor reaches one
+ * half. The scheduler inserts the threads on creation and removes them once
+ * joined.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#ifndef __CORE_THREAD_TABLE_H_
+#define __CORE_THREAD_TABLE_H_
+
+#include <lib/stddef.h>  /* Standard definitions */
+#include <lib/stdint.h>  /* Generic int types */
+#include <core/thread.h> /* Kernel thread */
+
+/* UTK configuration file */
+#include <config.h>
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/** @brief Number of bits of the initial thread table size. */
+#define THREAD_TABLE_INIT_BITS 6
+
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Initializes the thread table.
+ *
+ * @details Allocates the initial thread table. This function must be called
+ * before any other thread table function.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_MALLOC is returned if the table could not be allocated.
+ */
+OS_RETURN_E thread_table_init(void);
+
+/**
+ * @brief Inserts a thread in the table.
+ *
+ * @details Inserts a thread in the table, the thread's TID is used as key. The
+ * table is grown if needed.
+ *
+ * @param[in] thread The thread to insert.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the thread is NULL.
+ * - OS_ERR_MALLOC is returned if the table could not be grown.
+ * - OS_ERR_UNAUTHORIZED_ACTION is returned if the TID is already in the table.
+ */
+OS_RETURN_E thread_table_insert(kernel_thread_t* thread);
+
+/**
+ * @brief Removes a thread from the table.
+ *
+ * @details Removes the thread which TID is given as parameter from the table.
+ *
+ * @param[in] tid The TID of the thread to remove.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NO_SUCH_ID is returned if the TID is not in the table.
+ */
+OS_RETURN_E thread_table_remove(const int32_t tid);
+
+/**
+ * @brief Looks up a thread by its TID.
+ *
+ * @details Looks up a thread by its TID. The returned thread is only
+ * guaranteed to stay valid while the caller is in a RCU read side critical
+ * section, joined threads are released after a grace period.
+ *
+ * @param[in] tid The TID of the thread to look for.
+ *
+ * @return The thread is returned if found, NULL otherwise.
+ */
+kernel_thread_t* thread_table_find(const int32_t tid);
+
+#endif /* #ifndef __CORE_THREAD_TABLE_H_ */
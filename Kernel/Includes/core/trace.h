@@ -0,0 +1,265 @@
+/*******************************************************************************
+ * @file trace.h
+ *
+ * @see trace.c
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Kernel trace events.
+ *
+ * @details Kernel trace events. The kernel code contains static tracepoints
+ * that record fixed size binary events (event id, CPU, time stamp counter and
+ * arguments) in a per CPU ring. The oldest events are overwritten when a ring
+ * is full. The event categories are enabled at runtime, the categories that are
+ * not in TRACE_CATEGORIES and all the tracepoints when TRACE_ENABLED is 0 are
+ * removed at compile time. The rings are exported over the debug serial port
+ * and decoded on the host by Tools/trace_decode.py.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#ifndef __CORE_TRACE_H_
+#define __CORE_TRACE_H_
+
+#include <lib/stdint.h> /* Generic int types */
+#include <lib/stddef.h> /* Standard definitions */
+
+/* UTK configuration file */
+#include <config.h>
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/** @brief Scheduler events category. */
+#define TRACE_CATEGORY_SCHED     0x00000001
+/** @brief Interrupts events category. */
+#define TRACE_CATEGORY_INTERRUPT 0x00000002
+/** @brief Kernel heap events category. */
+#define TRACE_CATEGORY_KHEAP     0x00000004
+/** @brief Synchronization primitives events category. */
+#define TRACE_CATEGORY_SYNC      0x00000008
+/** @brief All the events categories. */
+#define TRACE_CATEGORY_ALL       0xFFFFFFFF
+
+/** @brief Context switch: previous tid, next tid, previous state, next
+ * priority.
+ */
+#define TRACE_SCHED_SWITCH       0x0000
+/** @brief Sleeping thread woken up: tid. */
+#define TRACE_SCHED_WAKEUP       0x0001
+/** @brief Thread going to sleep: tid, sleep time in ms. */
+#define TRACE_SCHED_SLEEP        0x0002
+/** @brief Thread blocked: tid, wait type. */
+#define TRACE_SCHED_BLOCK        0x0003
+/** @brief Thread unblocked: tid, wait type. */
+#define TRACE_SCHED_UNBLOCK      0x0004
+/** @brief Thread created: tid, priority, CPU affinity. */
+#define TRACE_SCHED_CREATE       0x0005
+/** @brief Thread exited: tid. */
+#define TRACE_SCHED_EXIT         0x0006
+
+/** @brief Interrupt handler entry: interrupt line. */
+#define TRACE_INTERRUPT_ENTRY    0x0100
+/** @brief Interrupt handler exit: interrupt line. */
+#define TRACE_INTERRUPT_EXIT     0x0101
+/** @brief Spurious interrupt: interrupt line. */
+#define TRACE_INTERRUPT_SPURIOUS 0x0102
+
+/** @brief Kernel heap allocation: address, requested size, chunk size. */
+#define TRACE_KHEAP_ALLOC        0x0200
+/** @brief Kernel heap release: address, chunk size. */
+#define TRACE_KHEAP_FREE         0x0201
+
+/** @brief Mutex busy, thread going to wait: mutex, tid. */
+#define TRACE_SYNC_MUTEX_BLOCK   0x0300
+/** @brief Mutex acquired: mutex, tid. */
+#define TRACE_SYNC_MUTEX_ACQUIRE 0x0301
+/** @brief Mutex released: mutex, tid. */
+#define TRACE_SYNC_MUTEX_RELEASE 0x0302
+/** @brief Semaphore empty, thread going to wait: semaphore, tid. */
+#define TRACE_SYNC_SEM_BLOCK     0x0303
+/** @brief Semaphore acquired: semaphore, tid, level. */
+#define TRACE_SYNC_SEM_ACQUIRE   0x0304
+/** @brief Semaphore posted: semaphore, tid, level. */
+#define TRACE_SYNC_SEM_POST      0x0305
+/** @brief Futex wait: address, expected value, tid. */
+#define TRACE_SYNC_FUTEX_WAIT    0x0306
+/** @brief Futex wake: address, requested count, woken count. */
+#define TRACE_SYNC_FUTEX_WAKE    0x0307
+
+/** @brief Number of arguments of an event. */
+#define TRACE_EVENT_ARGS 4
+
+/**
+ * @brief Returns the category of an event, the category bit index is stored in
+ * the high byte of the event id.
+ */
+#define TRACE_EVENT_CATEGORY(event) (1U << ((event) >> 8))
+
+#if (TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) != 0
+#error "TRACE_BUFFER_SIZE must be a power of 2"
+#endif
+
+#if TRACE_ENABLED == 1
+
+/**
+ * @brief Records a trace event if its category is compiled in and enabled.
+ *
+ * @param[in] event The event id.
+ * @param[in] arg0 The first event argument.
+ * @param[in] arg1 The second event argument.
+ * @param[in] arg2 The third event argument.
+ * @param[in] arg3 The fourth event argument.
+ */
+#define TRACE(event, arg0, arg1, arg2, arg3) {                          \
+    if((TRACE_CATEGORIES & TRACE_EVENT_CATEGORY(event)) != 0 &&         \
+       (trace_categories & TRACE_EVENT_CATEGORY(event)) != 0)           \
+    {                                                                   \
+        trace_event((event), (uint32_t)(arg0), (uint32_t)(arg1),        \
+                    (uint32_t)(arg2), (uint32_t)(arg3));                \
+    }                                                                   \
+}
+
+#else
+
+/**
+ * @brief Tracepoints are removed when the trace events are disabled.
+ *
+ * @param[in] event The event id.
+ * @param[in] arg0 The first event argument.
+ * @param[in] arg1 The second event argument.
+ * @param[in] arg2 The third event argument.
+ * @param[in] arg3 The fourth event argument.
+ */
+#define TRACE(event, arg0, arg1, arg2, arg3)
+
+#endif
+
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/** @brief Trace event record. */
+struct trace_event
+{
+    /** @brief Time stamp counter value when the event was recorded. */
+    uint64_t timestamp;
+    /** @brief The event id. */
+    uint16_t id;
+    /** @brief The CPU that recorded the event. */
+    uint16_t cpu;
+    /** @brief The event arguments. */
+    uint32_t args[TRACE_EVENT_ARGS];
+};
+
+/**
+ * @brief Defines trace_event_t type as a shorcut for struct trace_event.
+ */
+typedef struct trace_event trace_event_t;
+
+/**
+ * @brief Per CPU ring of trace events. The CPU owning the ring is the only
+ * producer.
+ */
+struct trace_ring
+{
+    /** @brief Index of the next event to write, only increases. */
+    volatile uint32_t head;
+    /** @brief Index of the next event to read, only increases. */
+    uint32_t tail;
+
+    /** @brief The ring events. */
+    trace_event_t events[TRACE_BUFFER_SIZE];
+    /** @brief Index + 1 of the event stored in each slot, 0 while the slot is
+     * written. Lets the readers detect the events overwritten during a copy.
+     */
+    volatile uint32_t sequences[TRACE_BUFFER_SIZE];
+};
+
+/**
+ * @brief Defines trace_ring_t type as a shorcut for struct trace_ring.
+ */
+typedef struct trace_ring trace_ring_t;
+
+/** @brief Mask of the enabled categories, read by the tracepoints. */
+extern volatile uint32_t trace_categories;
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Records a trace event in the ring of the current CPU.
+ *
+ * @details Records a trace event, the function can be called with the
+ * interrupts disabled and in interrupt handlers. Use the TRACE macro instead
+ * of calling this function directly.
+ *
+ * @param[in] id The event id.
+ * @param[in] arg0 The first event argument.
+ * @param[in] arg1 The second event argument.
+ * @param[in] arg2 The third event argument.
+ * @param[in] arg3 The fourth event argument.
+ */
+void trace_event(const uint16_t id, const uint32_t arg0, const uint32_t arg1,
+                 const uint32_t arg2, const uint32_t arg3);
+
+/**
+ * @brief Enables trace events categories.
+ *
+ * @param[in] categories The mask of the categories to enable.
+ */
+void trace_enable(const uint32_t categories);
+
+/**
+ * @brief Disables trace events categories.
+ *
+ * @param[in] categories The mask of the categories to disable.
+ */
+void trace_disable(const uint32_t categories);
+
+/**
+ * @brief Drops the recorded events of all the CPUs.
+ */
+void trace_clear(void);
+
+/**
+ * @brief Reads the recorded events of a CPU.
+ *
+ * @details Copies the oldest recorded events of a CPU and removes them from
+ * the ring. An event overwritten while it is copied is dropped and counted as
+ * lost. The categories should be disabled while reading the ring of another
+ * CPU.
+ *
+ * @param[in] cpu_id The CPU id.
+ * @param[out] events The buffer that receives the events.
+ * @param[in] size The number of events the buffer can hold.
+ * @param[out] count The number of copied events.
+ * @param[out] lost The number of events overwritten since the last read,
+ * including the dropped ones, may be NULL.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the buffer or the count is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the CPU id is invalid.
+ * - OS_ERR_NOT_SUPPORTED is returned if the trace events are disabled.
+ */
+OS_RETURN_E trace_read(const uint32_t cpu_id, trace_event_t* events,
+                       const uint32_t size, uint32_t* count, uint32_t* lost);
+
+/**
+ * @brief Exports the recorded events over the debug serial port.
+ *
+ * @details Disables the categories, writes the recorded events of all the CPUs
+ * to the debug serial port then enables the categories again. Each event is a
+ * text line starting with "#TRACE" followed by the hexadecimal values of the
+ * record fields.
+ */
+void trace_dump(void);
+
+#endif /* #ifndef __CORE_TRACE_H_ */
@@ -0,0 +1,199 @@
+/*******************************************************************************
+ * @file deferred.h
+ *
+ * @see deferred.c
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Interrupt deferred work.
+ *
+ * @details Interrupt deferred work. The interrupt handlers only acknowledge
+ * their device and queue the rest of their processing, which then runs with the
+ * interrupts enabled in a high priority worker thread of the CPU that queued
+ * it. Two kinds of items are provided:
+ * - Tasklets are run first and must not sleep, they replace the processing
+ * that used to be done in the interrupt handlers.
+ * - Work items are run after the pending tasklets and may sleep.
+ * An item is queued at most once: queuing a pending item does nothing, the
+ * routine runs once for all the queue requests made before it starts. An item
+ * never runs on two CPUs at the same time.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#ifndef __INTERRUPT_DEFERRED_H_
+#define __INTERRUPT_DEFERRED_H_
+
+#include <lib/stdint.h>        /* Generic int types */
+#include <lib/stddef.h>        /* Standard definitions */
+#include <core/kernel_queue.h> /* Kernel queues */
+
+/* UTK configuration file */
+#include <config.h>
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/** @brief Priority of the deferred work threads. */
+#define DEFERRED_THREAD_PRIORITY   KERNEL_HIGHEST_PRIORITY
+/** @brief Stack size of the deferred work threads. */
+#define DEFERRED_THREAD_STACK_SIZE 0x1000
+
+/** @brief Deferred item state flag, set while the item is queued. */
+#define DEFERRED_STATE_PENDING 0x00000001
+/** @brief Deferred item state flag, set while the item routine runs. */
+#define DEFERRED_STATE_RUNNING 0x00000002
+/** @brief Deferred item state flag, set when the item was dequeued while its
+ * routine runs on an other CPU. That CPU queues the item again once the
+ * routine returns.
+ */
+#define DEFERRED_STATE_RERUN   0x00000004
+
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/** @brief Deferred work item, also used for the tasklets. */
+struct deferred_work
+{
+    /** @brief Queue node, the item is queued without allocation. */
+    kernel_queue_node_t node;
+
+    /** @brief Routine run by the worker thread. */
+    void (*routine)(void* args);
+    /** @brief Argument given to the routine. */
+    void* args;
+
+    /** @brief Item state, DEFERRED_STATE_* flags. */
+    volatile uint32_t state;
+
+    /** @brief CPU the item is queued again on when DEFERRED_STATE_RERUN is
+     * set.
+     */
+    uint32_t rerun_cpu;
+    /** @brief Set to 1 if the item is queued again as a tasklet. */
+    uint32_t rerun_tasklet;
+};
+
+/**
+ * @brief Defines deferred_work_t type as a shorcut for struct deferred_work.
+ */
+typedef struct deferred_work deferred_work_t;
+
+/** @brief Deferred work statistics of a CPU. */
+struct deferred_stats
+{
+    /** @brief Number of tasklets run. */
+    uint64_t tasklets;
+    /** @brief Number of work items run. */
+    uint64_t works;
+    /** @brief CPU cycles spent in the tasklets routines. */
+    uint64_t tasklet_cycles;
+    /** @brief Longest tasklet routine run in CPU cycles. */
+    uint64_t tasklet_max_cycles;
+    /** @brief CPU cycles spent in the work items routines. */
+    uint64_t work_cycles;
+    /** @brief Longest work item routine run in CPU cycles. */
+    uint64_t work_max_cycles;
+};
+
+/**
+ * @brief Defines deferred_stats_t type as a shorcut for struct deferred_stats.
+ */
+typedef struct deferred_stats deferred_stats_t;
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Starts the deferred work threads.
+ *
+ * @details Creates one worker thread per CPU. Before this call, the items are
+ * run immediately by the function that queues them, in the interrupt handler
+ * for the items queued by the interrupt handlers.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - Other error codes are returned by the thread creation.
+ */
+OS_RETURN_E deferred_init(void);
+
+/**
+ * @brief Initializes a deferred item.
+ *
+ * @param[out] work The item to initialize.
+ * @param[in] routine The routine run by the worker thread.
+ * @param[in] args The argument given to the routine.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the item or the routine is NULL.
+ */
+OS_RETURN_E deferred_work_init(deferred_work_t* work,
+                               void (*routine)(void*),
+                               void* args);
+
+/**
+ * @brief Schedules a tasklet on the current CPU.
+ *
+ * @details The tasklet routine runs with the interrupts enabled before the
+ * work items of the CPU and must not sleep. The function can be called in
+ * interrupt handlers.
+ *
+ * @param[in, out] tasklet The tasklet to schedule.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the tasklet is NULL.
+ */
+OS_RETURN_E deferred_tasklet_schedule(deferred_work_t* tasklet);
+
+/**
+ * @brief Queues a work item on the current CPU.
+ *
+ * @details The work item routine runs with the interrupts enabled and may
+ * sleep, the tasklets of the CPU are delayed meanwhile. The function can be
+ * called in interrupt handlers.
+ *
+ * @param[in, out] work The work item to queue.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the work item is NULL.
+ */
+OS_RETURN_E deferred_work_queue(deferred_work_t* work);
+
+/**
+ * @brief Queues a work item on a given CPU.
+ *
+ * @param[in, out] work The work item to queue.
+ * @param[in] cpu_id The CPU that runs the work item.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the work item is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the CPU is not booted.
+ */
+OS_RETURN_E deferred_work_queue_on(deferred_work_t* work,
+                                   const uint32_t cpu_id);
+
+/**
+ * @brief Returns the deferred work statistics of a CPU.
+ *
+ * @param[in] cpu_id The CPU to get the statistics of.
+ * @param[out] stats The buffer that receives the statistics.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the buffer is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the CPU does not exist.
+ */
+OS_RETURN_E deferred_get_stats(const uint32_t cpu_id, deferred_stats_t* stats);
+
+#endif /* #ifndef __INTERRUPT_DEFERRED_H_ */
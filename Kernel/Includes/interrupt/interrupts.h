@@ -25,6 +25,9 @@
 #include <lib/stddef.h>  /* Standard definitions */
 #include <cpu_structs.h> /* CPU specific structures */
 
+/* UTK configuration file */
+#include <config.h>
+
 /*******************************************************************************
  * CONSTANTS
  ******************************************************************************/
@@ -133,6 +136,46 @@ struct interrupt_driver
  */
 typedef struct interrupt_driver interrupt_driver_t;
 
+/** @brief Handler statistics of an interrupt line. */
+struct interrupt_stats
+{
+    /** @brief Number of times the handler was called. */
+    uint64_t count;
+    /** @brief CPU cycles spent in the handler. */
+    uint64_t total_cycles;
+    /** @brief Longest handler run in CPU cycles. */
+    uint64_t max_cycles;
+    /** @brief Number of times the handler was called on each CPU. */
+    uint64_t cpu_count[MAX_CPU_COUNT];
+};
+
+/**
+ * @brief Defines interrupt_stats_t type as a shorcut for struct
+ * interrupt_stats.
+ */
+typedef struct interrupt_stats interrupt_stats_t;
+
+/** @brief Longest window with the interrupts disabled. */
+struct interrupt_latency
+{
+    /** @brief Window length in CPU cycles. */
+    uint64_t  max_cycles;
+    /** @brief Return address of the kernel_interrupt_disable call. */
+    uintptr_t disable_site;
+    /** @brief Return address of the kernel_interrupt_restore call, 0 if the
+     * window was ended by a context switch.
+     */
+    uintptr_t restore_site;
+    /** @brief CPU on which the window was measured. */
+    uint32_t  cpu_id;
+};
+
+/**
+ * @brief Defines interrupt_latency_t type as a shorcut for struct
+ * interrupt_latency.
+ */
+typedef struct interrupt_latency interrupt_latency_t;
+
 /*******************************************************************************
  * FUNCTIONS
  ******************************************************************************/
@@ -196,7 +239,9 @@ OS_RETURN_E kernel_interrupt_register_irq_handler(const uint32_t irq_number,
  * 
  * @details Unregisters a custom interrupt handler to be executed. The IRQ 
  * number must be greater or equal to the minimal authorized custom IRQ number 
- * and less than the maximal one.
+ * and less than the maximal one. The handler may still be running on another
+ * CPU when the function returns, rcu_synchronize must be called before
+ * releasing the resources used by the handler.
  *
  * @param[in] irq_number The IRQ number to detach the handler from.
  * 
@@ -242,7 +287,9 @@ OS_RETURN_E kernel_interrupt_register_int_handler(const uint32_t interrupt_line,
  * 
  * @details Unregisters a custom interrupt handler to be executed. The interrupt 
  * line must be greater or equal to the minimal authorized custom interrupt line 
- * and less than the maximal one.
+ * and less than the maximal one. The handler may still be running on another
+ * CPU when the function returns, rcu_synchronize must be called before
+ * releasing the resources used by the handler.
  *
  * @param[in] interrupt_line The interrupt line to deattach the handler from.
  * 
@@ -321,5 +368,60 @@ OS_RETURN_E kernel_interrupt_set_irq_mask(const uint32_t irq_number,
  */
 OS_RETURN_E kernel_interrupt_set_irq_eoi(const uint32_t irq_number);
 
+/**
+ * @brief Returns the handler statistics of an interrupt line.
+ *
+ * @details The statistics are gathered when INTERRUPT_STATS_ENABLED is set to
+ * 1, the per CPU counters are summed.
+ *
+ * @param[in] interrupt_line The interrupt line to get the statistics of.
+ * @param[out] stats The buffer that receives the statistics.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the buffer is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the interrupt line does not exist.
+ * - OS_ERR_NOT_SUPPORTED is returned if the statistics are disabled.
+ */
+OS_RETURN_E kernel_interrupt_get_stats(const uint32_t interrupt_line,
+                                       interrupt_stats_t* stats);
+
+/**
+ * @brief Returns the longest window with the interrupts disabled.
+ *
+ * @details The windows are measured between the kernel_interrupt_disable call
+ * that disables the interrupts and the matching kernel_interrupt_restore call,
+ * which covers the critical sections. A context switch raised with the
+ * interrupts disabled ends the window. The windows are measured when
+ * INTERRUPT_LATENCY_ENABLED is set to 1.
+ *
+ * @param[out] latency The buffer that receives the longest window.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the buffer is NULL.
+ * - OS_ERR_NOT_SUPPORTED is returned if the windows are not measured.
+ */
+OS_RETURN_E kernel_interrupt_get_latency(interrupt_latency_t* latency);
+
+/**
+ * @brief Clears the interrupt handlers statistics and the longest window with
+ * the interrupts disabled.
+ *
+ * @details The counters updated by other CPUs during the call may be kept.
+ */
+void kernel_interrupt_reset_stats(void);
+
+/**
+ * @brief Writes the interrupt statistics on the serial debug port.
+ *
+ * @details Writes one "#INTSTAT <line> <count> <total cycles> <max cycles>
+ * <CPU 0 count> ..." line per interrupt line that was raised, then a
+ * "#INTSTAT IRQOFF <max cycles> <CPU> <disable site> <restore site>" line for
+ * the longest window with the interrupts disabled. The block is enclosed by
+ * "#INTSTAT BEGIN" and "#INTSTAT END" lines.
+ */
+void kernel_interrupt_dump_stats(void);
+
 
 #endif /* #ifndef __INTERRUPTS_INTERRUPTS_H_ */
\ No newline at end of file
@@ -0,0 +1,298 @@
+/*******************************************************************************
+ * @file block.h
+ *
+ * @see block.c
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Block devices abstraction and buffer cache.
+ *
+ * @details Block devices abstraction layer. A block device wraps a storage
+ * driver and exposes ranges of page sized blocks. The accesses go through a
+ * LRU buffer cache shared by all the devices and keyed by (device, block).
+ * Writes are kept in the cache until the device is flushed or the buffer is
+ * evicted. Sequential reads are detected and trigger read-ahead.
+ *
+ * @warning The block functions can block and must be called from a thread.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#ifndef __IO_BLOCK_H_
+#define __IO_BLOCK_H_
+
+#include <lib/stdint.h>        /* Generic int types */
+#include <lib/stddef.h>        /* Standard definitions */
+#include <core/kernel_queue.h> /* Kernel queues */
+
+/* UTK configuration file */
+#include <config.h>
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/** @brief Size of a block in bytes, a block fits a memory page. */
+#define BLOCK_SIZE 4096
+
+/** @brief Invalid block number. */
+#define BLOCK_NO_BLOCK 0xFFFFFFFF
+
+/** @brief Number of bits of the buffer cache hash table size. */
+#define BLOCK_CACHE_HASH_BITS 7
+
+/** @brief Initial read-ahead window once a sequential access is detected. */
+#define BLOCK_READ_AHEAD_MIN 2
+
+#if BLOCK_CACHE_SIZE < BLOCK_READ_AHEAD_MAX
+#error "The block cache must hold at least BLOCK_READ_AHEAD_MAX buffers"
+#endif
+
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/**
+ * @brief Storage driver used by a block device. The driver functions work on
+ * the device sectors.
+ */
+struct block_driver
+{
+    /**
+     * @brief Reads a range of sectors from the device.
+     *
+     * @param[in] device The driver's device.
+     * @param[in] sector The first sector to read.
+     * @param[out] buffer The buffer that receives the data.
+     * @param[in] count The number of sectors to read.
+     *
+     * @return The success state or the error code.
+     */
+    OS_RETURN_E (*read)(void* device, const uint32_t sector, void* buffer,
+                        const uint32_t count);
+
+    /**
+     * @brief Writes a range of sectors to the device.
+     *
+     * @param[in] device The driver's device.
+     * @param[in] sector The first sector to write.
+     * @param[in] buffer The buffer that contains the data.
+     * @param[in] count The number of sectors to write.
+     *
+     * @return The success state or the error code.
+     */
+    OS_RETURN_E (*write)(void* device, const uint32_t sector,
+                         const void* buffer, const uint32_t count);
+
+    /**
+     * @brief Flushes the device write cache.
+     *
+     * @param[in] device The driver's device.
+     *
+     * @return The success state or the error code.
+     */
+    OS_RETURN_E (*flush)(void* device);
+};
+
+/**
+ * @brief Defines block_driver_t type as a shorcut for struct block_driver.
+ */
+typedef struct block_driver block_driver_t;
+
+/** @brief Block device cache statistics. */
+struct block_stats
+{
+    /** @brief Number of blocks read from the cache. */
+    uint64_t hits;
+    /** @brief Number of blocks read from the device on request. */
+    uint64_t misses;
+    /** @brief Number of blocks read from the device ahead of the requests. */
+    uint64_t read_ahead;
+    /** @brief Number of dirty blocks written to the device. */
+    uint64_t writebacks;
+    /** @brief Number of read commands sent to the driver. */
+    uint64_t device_reads;
+    /** @brief Number of write commands sent to the driver. */
+    uint64_t device_writes;
+};
+
+/**
+ * @brief Defines block_stats_t type as a shorcut for struct block_stats.
+ */
+typedef struct block_stats block_stats_t;
+
+/** @brief Block device representation. */
+struct block_device
+{
+    /** @brief The driver's device. */
+    void* device;
+    /** @brief The storage driver. */
+    const block_driver_t* driver;
+
+    /** @brief Number of device sectors per block. */
+    uint32_t sectors_per_block;
+    /** @brief Number of blocks of the device. */
+    uint32_t block_count;
+
+    /** @brief Block following the last read request. */
+    uint32_t ra_next;
+    /** @brief Current read-ahead window in blocks. */
+    uint32_t ra_window;
+
+    /** @brief Cache statistics. */
+    block_stats_t stats;
+};
+
+/**
+ * @brief Defines block_device_t type as a shorcut for struct block_device.
+ */
+typedef struct block_device block_device_t;
+
+/** @brief Buffer cache entry. */
+struct block_buffer
+{
+    /** @brief Device owning the cached block, NULL if the buffer is free. */
+    block_device_t* device;
+    /** @brief Cached block. */
+    uint32_t block;
+    /** @brief Set to 1 if the buffer was modified since last written. */
+    uint32_t dirty;
+
+    /** @brief Cached data. */
+    uint8_t* data;
+
+    /** @brief Next buffer in the hash table bucket or in the free list. */
+    struct block_buffer* next;
+    /** @brief LRU list node. */
+    kernel_queue_node_t lru_node;
+};
+
+/**
+ * @brief Defines block_buffer_t type as a shorcut for struct block_buffer.
+ */
+typedef struct block_buffer block_buffer_t;
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Initializes the buffer cache.
+ *
+ * @details Allocates the BLOCK_CACHE_SIZE buffers of the cache and the read
+ * staging area. This function must be called before any other block function.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_MALLOC is returned if the cache could not be allocated.
+ */
+OS_RETURN_E block_cache_init(void);
+
+/**
+ * @brief Initializes a block device.
+ *
+ * @param[out] device The block device to initialize.
+ * @param[in] driver_device The driver's device.
+ * @param[in] driver The storage driver.
+ * @param[in] sector_size The size of a device sector in bytes.
+ * @param[in] sector_count The number of sectors of the device.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if a pointer parameter is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the sector size does not divide the
+ *   block size.
+ */
+OS_RETURN_E block_device_init(block_device_t* device, void* driver_device,
+                              const block_driver_t* driver,
+                              const uint32_t sector_size,
+                              const uint32_t sector_count);
+
+/**
+ * @brief Reads a range of blocks.
+ *
+ * @details Reads a range of blocks through the buffer cache. The missing
+ * blocks are read with as few driver commands as possible. When the request
+ * follows the previous one, the read-ahead window is grown and the following
+ * blocks are read with the last missing ones.
+ *
+ * @param[in, out] device The block device to read from.
+ * @param[in] block The first block to read.
+ * @param[out] buffer The buffer that receives the data.
+ * @param[in] count The number of blocks to read.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if a pointer parameter is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the range exceeds the device.
+ * - Other error codes can be returned by the driver.
+ */
+OS_RETURN_E block_read(block_device_t* device, const uint32_t block,
+                       void* buffer, const uint32_t count);
+
+/**
+ * @brief Writes a range of blocks.
+ *
+ * @details Writes a range of blocks in the buffer cache. The blocks are marked
+ * dirty and written to the device when flushed or evicted.
+ *
+ * @param[in, out] device The block device to write to.
+ * @param[in] block The first block to write.
+ * @param[in] buffer The buffer that contains the data.
+ * @param[in] count The number of blocks to write.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if a pointer parameter is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the range exceeds the device.
+ * - Other error codes can be returned by the driver when a dirty buffer is
+ *   evicted.
+ */
+OS_RETURN_E block_write(block_device_t* device, const uint32_t block,
+                        const void* buffer, const uint32_t count);
+
+/**
+ * @brief Flushes a block device.
+ *
+ * @details Writes the dirty blocks of the device in ascending order, adjacent
+ * blocks are written by a single driver command. The driver cache is then
+ * flushed.
+ *
+ * @param[in, out] device The block device to flush.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the device is NULL.
+ * - Other error codes can be returned by the driver.
+ */
+OS_RETURN_E block_flush(block_device_t* device);
+
+/**
+ * @brief Flushes a block device and drops its cached blocks.
+ *
+ * @param[in, out] device The block device to invalidate.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the device is NULL.
+ * - Other error codes can be returned by the driver.
+ */
+OS_RETURN_E block_invalidate(block_device_t* device);
+
+/**
+ * @brief Returns the cache statistics of a block device.
+ *
+ * @param[in] device The block device.
+ * @param[out] stats The buffer that receives the statistics.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if a pointer parameter is NULL.
+ */
+OS_RETURN_E block_get_stats(block_device_t* device, block_stats_t* stats);
+
+#endif /* #ifndef __IO_BLOCK_H_ */
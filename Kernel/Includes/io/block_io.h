@@ -0,0 +1,241 @@
+/*******************************************************************************
+ * @file block_io.h
+ *
+ * @see block_io.c
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Asynchronous block I/O request queues.
+ *
+ * @details Asynchronous block I/O request queues. Requests are submitted to the
+ * queue of a storage device and processed by the queue's worker thread. The
+ * worker serves the pending requests in ascending sector order (C-LOOK
+ * elevator) and merges the adjacent requests of the same direction into a
+ * single driver command. A request that waited more than BLOCK_IO_DEADLINE
+ * milliseconds is served first to avoid starvation. The completion is signaled
+ * by a callback and / or a semaphore.
+ *
+ * @warning The requests in flight are not ordered, a caller that needs a read
+ * to see a previous write must wait for the write completion first.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#ifndef __IO_BLOCK_IO_H_
+#define __IO_BLOCK_IO_H_
+
+#include <lib/stdint.h>        /* Generic int types */
+#include <lib/stddef.h>        /* Standard definitions */
+#include <core/thread.h>       /* Kernel threads */
+#include <core/kernel_queue.h> /* Kernel queues */
+#include <sync/mutex.h>        /* Mutex */
+#include <sync/semaphore.h>    /* Semaphores */
+#include <io/block.h>          /* Block devices */
+
+/* UTK configuration file */
+#include <config.h>
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/** @brief Priority of the queues worker threads. */
+#define BLOCK_IO_THREAD_PRIORITY   4
+/** @brief Stack size of the queues worker threads. */
+#define BLOCK_IO_THREAD_STACK_SIZE 0x1000
+
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/** @brief Asynchronous block I/O request. */
+struct block_io_request
+{
+    /** @brief Set to 1 to write the buffer, 0 to read it. */
+    uint32_t write;
+    /** @brief First sector of the request. */
+    uint32_t sector;
+    /** @brief Number of sectors of the request. */
+    uint32_t count;
+    /** @brief Request data buffer. */
+    void* buffer;
+
+    /**
+     * @brief Completion callback, called by the worker thread. May be NULL.
+     *
+     * @param[in] request The completed request.
+     * @param[in] args The callback arguments.
+     */
+    void (*callback)(struct block_io_request* request, void* args);
+    /** @brief Completion callback arguments. */
+    void* args;
+    /** @brief Semaphore posted on completion. May be NULL, it must stay valid
+     * until the completed field is set.
+     */
+    semaphore_t* done;
+
+    /** @brief Completion status, valid once the request is completed. */
+    volatile OS_RETURN_E status;
+    /**
+     * @brief Set to 1 once the request is completed, also a futex word woken
+     * on completion. The worker does not access the request after setting it.
+     */
+    volatile int32_t completed;
+
+    /** @brief Time after which the request is served first. */
+    uint64_t deadline;
+    /** @brief Node in the queue's sector ordered list. */
+    kernel_queue_node_t sort_node;
+    /** @brief Node in the queue's submission ordered list. */
+    kernel_queue_node_t fifo_node;
+    /** @brief Next request merged in the same driver command. */
+    struct block_io_request* merge_next;
+};
+
+/**
+ * @brief Defines block_io_request_t type as a shorcut for struct
+ * block_io_request.
+ */
+typedef struct block_io_request block_io_request_t;
+
+/** @brief Request queue statistics. */
+struct block_io_stats
+{
+    /** @brief Number of submitted requests. */
+    uint64_t submitted;
+    /** @brief Number of driver commands issued. */
+    uint64_t dispatched;
+    /** @brief Number of requests merged in a previous request command. */
+    uint64_t merged;
+    /** @brief Number of requests served because their deadline expired. */
+    uint64_t expired;
+};
+
+/**
+ * @brief Defines block_io_stats_t type as a shorcut for struct block_io_stats.
+ */
+typedef struct block_io_stats block_io_stats_t;
+
+/** @brief Request queue of a storage device. */
+struct block_io_queue
+{
+    /** @brief The driver's device. */
+    void* device;
+    /** @brief The storage driver. */
+    const block_driver_t* driver;
+    /** @brief The size of a device sector in bytes. */
+    uint32_t sector_size;
+
+    /** @brief Pending requests ordered by sector, lowest at the tail. */
+    kernel_queue_t sorted;
+    /** @brief Pending requests ordered by submission, oldest at the tail. */
+    kernel_queue_t fifo;
+    /** @brief Sector following the last served request. */
+    uint32_t head;
+
+    /** @brief Merged commands data buffer. */
+    uint8_t* staging;
+    /** @brief Size of the merged commands data buffer in sectors. */
+    uint32_t staging_sectors;
+
+    /** @brief Queue lock. */
+    mutex_t lock;
+    /** @brief Posted on each submission to wake the worker thread. */
+    semaphore_t pending;
+    /** @brief Worker thread. */
+    thread_t worker;
+
+    /** @brief Queue statistics. */
+    block_io_stats_t stats;
+};
+
+/**
+ * @brief Defines block_io_queue_t type as a shorcut for struct block_io_queue.
+ */
+typedef struct block_io_queue block_io_queue_t;
+
+/** @brief Block driver working on a request queue, the driver's devices are
+ * block_io_queue_t. The read and write functions wait for the completion of
+ * the request.
+ */
+extern block_driver_t block_io_driver;
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Initializes a request queue and starts its worker thread.
+ *
+ * @param[out] queue The queue to initialize.
+ * @param[in] driver_device The driver's device.
+ * @param[in] driver The storage driver.
+ * @param[in] sector_size The size of a device sector in bytes.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if a pointer parameter is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the sector size is 0 or greater than
+ *   BLOCK_IO_MERGE_SIZE.
+ * - OS_ERR_MALLOC is returned if the staging buffer could not be allocated.
+ * - Other error codes can be returned by the scheduler.
+ */
+OS_RETURN_E block_io_queue_init(block_io_queue_t* queue, void* driver_device,
+                                const block_driver_t* driver,
+                                const uint32_t sector_size);
+
+/**
+ * @brief Submits a request to a queue.
+ *
+ * @details Enqueues the request and wakes the queue's worker thread. The
+ * request must not be modified or released before its completion, the
+ * completed field of the request is set to 1 once it is completed.
+ *
+ * @param[in, out] queue The queue to submit the request to.
+ * @param[in, out] request The request to submit.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if a pointer parameter is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the request sector count is 0.
+ */
+OS_RETURN_E block_io_submit(block_io_queue_t* queue,
+                            block_io_request_t* request);
+
+/**
+ * @brief Submits a request and waits for its completion.
+ *
+ * @param[in, out] queue The queue to submit the request to.
+ * @param[in] write Set to 1 to write the buffer, 0 to read it.
+ * @param[in] sector The first sector of the request.
+ * @param[in, out] buffer The request data buffer.
+ * @param[in] count The number of sectors of the request.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if a pointer parameter is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the request sector count is 0.
+ * - Other error codes can be returned by the driver.
+ */
+OS_RETURN_E block_io_sync(block_io_queue_t* queue, const uint32_t write,
+                          const uint32_t sector, void* buffer,
+                          const uint32_t count);
+
+/**
+ * @brief Returns the statistics of a queue.
+ *
+ * @param[in] queue The queue.
+ * @param[out] stats The buffer that receives the statistics.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if a pointer parameter is NULL.
+ */
+OS_RETURN_E block_io_get_stats(block_io_queue_t* queue,
+                               block_io_stats_t* stats);
+
+#endif /* #ifndef __IO_BLOCK_IO_H_ */
@@ -15,6 +15,15 @@
  * really basic output too allow early kernel boot output and debug. These 
  * functions can be used in interrupts handlers since no lock is required to use
  * them. This also makes them non thread safe.
+ *
+ * Once the scheduler runs, the output can be deferred: the messages are then
+ * appended as records to a per CPU ring buffer with their time stamp and their
+ * packed arguments. A low priority thread formats the records in time stamp
+ * order and writes them to the output devices. The immediate mode is restored
+ * on kernel panic.
+ *
+ * @warning In deferred mode, the format string must outlive the record, string
+ * arguments are copied in the record and truncated if they do not fit.
  * 
  * @copyright Alexy Torres Aurora Dugo
  ******************************************************************************/
@@ -22,10 +31,49 @@
 #ifndef __IO_KERNEL_OUTPUT_H_
 #define __IO_KERNEL_OUTPUT_H_
 
+#include <lib/stdint.h> /* Generic int types */
+#include <lib/stddef.h> /* Standard definitions */
+#include <io/graphic.h> /* Color schemes */
+
+/* UTK configuration file */
+#include <config.h>
+
 /*******************************************************************************
  * CONSTANTS
  ******************************************************************************/
 
+/** @brief Size of the formater output buffer, flushed by runs. */
+#define KERNEL_OUTPUT_FORMAT_BUFFER_SIZE 128
+
+/** @brief Conversion flag: left justify the field. */
+#define FORMAT_FLAG_LEFT  0x01
+/** @brief Conversion flag: pad numbers with zeros. */
+#define FORMAT_FLAG_ZERO  0x02
+/** @brief Conversion flag: always print the sign of signed numbers. */
+#define FORMAT_FLAG_PLUS  0x04
+/** @brief Conversion flag: print a space before positive signed numbers. */
+#define FORMAT_FLAG_SPACE 0x08
+/** @brief Conversion flag: print the 0x prefix of hexadecimal numbers. */
+#define FORMAT_FLAG_ALT   0x10
+
+/** @brief Width or precision given by an argument. */
+#define FORMAT_STAR -2
+
+/** @brief Maximal number of digits of a 64 bits integer (octal). */
+#define FORMAT_MAX_DIGITS 22
+
+/** @brief Size in bytes of the packed arguments of a log record. */
+#define KERNEL_OUTPUT_ARGS_SIZE 100
+
+/** @brief Priority of the log flusher thread, just above the idle threads. */
+#define KERNEL_OUTPUT_THREAD_PRIORITY   62
+/** @brief Stack size of the log flusher thread. */
+#define KERNEL_OUTPUT_THREAD_STACK_SIZE 0x1000
+
+#if (KERNEL_OUTPUT_BUFFER_SIZE & (KERNEL_OUTPUT_BUFFER_SIZE - 1)) != 0
+#error "KERNEL_OUTPUT_BUFFER_SIZE must be a power of 2"
+#endif
+
 /*******************************************************************************
  * STRUCTURES
  ******************************************************************************/
@@ -44,6 +92,97 @@ struct output
  */
 typedef struct output output_t;
 
+/** @brief Kernel output levels, defines the tag printed before a message. */
+enum KERNEL_OUTPUT_LEVEL
+{
+    /** @brief Untagged screen output. */
+    KERNEL_OUTPUT_LEVEL_PRINTF,
+    /** @brief Red [ERROR] tagged screen output. */
+    KERNEL_OUTPUT_LEVEL_ERROR,
+    /** @brief Green [OK] tagged screen output. */
+    KERNEL_OUTPUT_LEVEL_SUCCESS,
+    /** @brief Cyan [INFO] tagged screen output. */
+    KERNEL_OUTPUT_LEVEL_INFO,
+    /** @brief Yellow [DEBUG] tagged screen output. */
+    KERNEL_OUTPUT_LEVEL_DEBUG,
+    /** @brief [DEBUG] tagged serial output. */
+    KERNEL_OUTPUT_LEVEL_SERIAL_DEBUG
+};
+
+/** 
+ * @brief Defines KERNEL_OUTPUT_LEVEL_E type as a shorcut for enum
+ * KERNEL_OUTPUT_LEVEL.
+ */
+typedef enum KERNEL_OUTPUT_LEVEL KERNEL_OUTPUT_LEVEL_E;
+
+/** @brief Deferred output record. */
+struct kernel_output_record
+{
+    /** @brief Time stamp counter value when the record was logged. */
+    uint64_t timestamp;
+    /** @brief The record format string. */
+    const char* fmt;
+    /** @brief The record output level, a KERNEL_OUTPUT_LEVEL_E value. */
+    uint8_t level;
+    /** @brief The CPU that logged the record. */
+    uint8_t cpu;
+    /** @brief Size in bytes of the packed arguments. */
+    uint16_t size;
+    /** @brief The screen color scheme when the record was logged. */
+    colorscheme_t scheme;
+    /** @brief The packed arguments. */
+    uint8_t args[KERNEL_OUTPUT_ARGS_SIZE];
+};
+
+/** 
+ * @brief Defines kernel_output_record_t type as a shorcut for struct
+ * kernel_output_record.
+ */
+typedef struct kernel_output_record kernel_output_record_t;
+
+/** 
+ * @brief Per CPU ring of deferred output records. The CPU owning the ring is
+ * the only producer and the flusher the only consumer.
+ */
+struct kernel_output_ring
+{
+    /** @brief Index of the next record to write, only increases. */
+    volatile uint32_t head;
+    /** @brief Index of the next record to flush, only increases. */
+    volatile uint32_t tail;
+
+    /** @brief Number of logged records. */
+    uint32_t logged;
+    /** @brief Number of records lost because the ring was full. */
+    uint32_t lost;
+
+    /** @brief The ring records. */
+    kernel_output_record_t records[KERNEL_OUTPUT_BUFFER_SIZE];
+};
+
+/** 
+ * @brief Defines kernel_output_ring_t type as a shorcut for struct
+ * kernel_output_ring.
+ */
+typedef struct kernel_output_ring kernel_output_ring_t;
+
+/** @brief Deferred output statistics. */
+struct kernel_output_stats
+{
+    /** @brief Number of logged records. */
+    uint64_t logged;
+    /** @brief Number of flushed records. */
+    uint64_t flushed;
+    /** @brief Number of records lost because a ring was full. */
+    uint64_t lost;
+};
+
+/** 
+ * @brief Defines kernel_output_stats_t type as a shorcut for struct
+ * kernel_output_stats.
+ */
+typedef struct kernel_output_stats kernel_output_stats_t;
+
 /*******************************************************************************
  * FUNCTIONS
  ******************************************************************************/
@@ -132,4 +271,63 @@ void kernel_serial_debug(const char *fmt, ...);
  */
 void kernel_doprint(const char* str, __builtin_va_list args);
 
+/**
+ * @brief Starts the deferred output.
+ *
+ * @details Creates the log flusher thread. The output is deferred if
+ * KERNEL_OUTPUT_DEFERRED is enabled, test mode keeps the immediate output. This
+ * function must be called once the scheduler is initialized.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - Other error codes can be returned by the scheduler.
+ */
+OS_RETURN_E kernel_output_init(void);
+
+/**
+ * @brief Selects the deferred or the immediate output.
+ *
+ * @details Selects the output mode. When switching to the immediate mode, the
+ * pending records are flushed first. This function can be called in interrupt
+ * handlers.
+ *
+ * @param[in] enabled Set to 1 to defer the output, 0 to output immediately.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_UNAUTHORIZED_ACTION is returned if the deferred output is selected
+ *   before the flusher thread is started.
+ */
+OS_RETURN_E kernel_output_set_deferred(const uint32_t enabled);
+
+/**
+ * @brief Flushes the pending output records.
+ *
+ * @details Formats and writes the pending records of all the CPUs in time
+ * stamp order. If another flush is in progress, the function returns
+ * immediately.
+ */
+void kernel_output_flush(void);
+
+/**
+ * @brief Flushes the pending output records on the panic path.
+ *
+ * @details Selects the immediate output and formats the pending records of all
+ * the CPUs, even if a flush was in progress when the panic occured. This
+ * function must only be called by the panic handler once the other CPUs are
+ * halted.
+ */
+void kernel_output_panic_flush(void);
+
+/**
+ * @brief Returns the deferred output statistics.
+ *
+ * @param[out] stats The buffer that receives the statistics.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the buffer is NULL.
+ */
+OS_RETURN_E kernel_output_get_stats(kernel_output_stats_t* stats);
+
 #endif /* #ifndef __IO_KERNEL_OUTPUT_H_ */
@@ -0,0 +1,109 @@
+/*******************************************************************************
+ * @file scrollback.h
+ *
+ * @see scrollback.c
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Console scrollback history.
+ *
+ * @details Console scrollback history. The console drivers push the lines that
+ * leave the top of the screen in a ring of text cells. The oldest lines are
+ * overwritten when the ring is full. The lines keep their characters and
+ * colors, the history can be displayed again without formatting the output
+ * again.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#ifndef __IO_SCROLLBACK_H_
+#define __IO_SCROLLBACK_H_
+
+#include <lib/stdint.h> /* Generic int types */
+#include <lib/stddef.h> /* Standard definitions */
+
+/* UTK configuration file */
+#include <config.h>
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/** @brief Maximal number of cells of a scrollback line. */
+#if MAX_SUPPORTED_WIDTH / 8 > 80
+#define SCROLLBACK_LINE_SIZE (MAX_SUPPORTED_WIDTH / 8)
+#else
+#define SCROLLBACK_LINE_SIZE 80
+#endif
+
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/** @brief Console text cell. */
+struct scrollback_cell
+{
+    /** @brief The cell foreground color, in the driver color format. */
+    uint32_t fgcolor;
+    /** @brief The cell background color, in the driver color format. */
+    uint32_t bgcolor;
+    /** @brief The cell character, characters under 32 are blank cells. */
+    uint8_t  character;
+};
+
+/**
+ * @brief Defines scrollback_cell_t type as a shorcut for struct
+ * scrollback_cell.
+ */
+typedef struct scrollback_cell scrollback_cell_t;
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Pushes a line in the scrollback history.
+ *
+ * @details Copies a line that left the screen in the scrollback history. The
+ * oldest line is dropped when the history is full. The cells after
+ * SCROLLBACK_LINE_SIZE are dropped.
+ *
+ * @param[in] cells The line cells.
+ * @param[in] size The number of cells of the line.
+ */
+void scrollback_push(const scrollback_cell_t* cells, const uint32_t size);
+
+/**
+ * @brief Reads a line of the scrollback history.
+ *
+ * @param[in] index The line index, 0 is the most recent line.
+ * @param[out] cells The buffer that receives the line cells, it must hold
+ * SCROLLBACK_LINE_SIZE cells.
+ * @param[out] size The number of cells of the line.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if a buffer is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if the history holds less lines than
+ * index + 1.
+ */
+OS_RETURN_E scrollback_get_line(const uint32_t index, scrollback_cell_t* cells,
+                                uint32_t* size);
+
+/**
+ * @brief Returns the number of lines of the scrollback history.
+ *
+ * @return The number of lines of the scrollback history.
+ */
+uint32_t scrollback_get_count(void);
+
+/**
+ * @brief Drops all the lines of the scrollback history.
+ */
+void scrollback_clear(void);
+
+#endif /* #ifndef __IO_SCROLLBACK_H_ */
@@ -177,6 +177,12 @@ enum OS_RETURN
     OS_ERR_KERNEL_MEM_OFFSET_UNALIGNED     = 60,
     /** @brief UTK Error value. */
     OS_ERR_HANDLER_ALREADY_EXISTS          = 61,
+    /** @brief UTK Error value. */
+    OS_FUTEX_VALUE_MISMATCH                = 62,
+    /** @brief UTK Error value. */
+    OS_ERR_BARRIER_UNINITIALIZED           = 63,
+    /** @brief UTK Error value. */
+    OS_ERR_TIMEOUT                         = 64,
 };
 
 /**
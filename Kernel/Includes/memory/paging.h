@@ -164,6 +164,23 @@ OS_RETURN_E kernel_mmap_hw(const void* virt_addr,
  */
 OS_RETURN_E kernel_munmap(const void* virt_addr, const size_t mapping_size);
 
+/**
+ * @brief Returns the physical address mapped at a kernel virtual address.
+ *
+ * @details Walks the current page tables and returns the physical address
+ * mapped at the virtual address given as parameter.
+ *
+ * @param[in] virt_addr The virtual address to translate.
+ * @param[out] phys_addr The buffer that receives the physical address.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if phys_addr is NULL.
+ * - OS_ERR_MEMORY_NOT_MAPPED is returned if the page is not mapped.
+ */
+OS_RETURN_E paging_get_phys_address(const void* virt_addr,
+                                    uintptr_t* phys_addr);
+
 /**
  * @brief Registers a page fault handler for the required address range.
  * 
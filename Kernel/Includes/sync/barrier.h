@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * @file barrier.h
+ *
+ * @see barrier.c
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Barrier synchronization primitive.
+ *
+ * @details Reusable barrier synchronization primitive. A barrier blocks the
+ * threads that reach it until a given number of threads, possibly running on
+ * different CPUs, reached it. The barrier is then released and can be used
+ * again for the next round. The waiting threads sleep on the barrier generation
+ * futex word.
+ *
+ * @warning Barriers can only be used when the current system is running and
+ * the scheduler initialized.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#ifndef __SYNC_BARRIER_H_
+#define __SYNC_BARRIER_H_
+
+#include <lib/stddef.h>    /* Standard definitions */
+#include <lib/stdint.h>    /* Generic int types */
+#include <sync/critical.h> /* Critical sections */
+
+/* UTK configuration file */
+#include <config.h>
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/** @brief Barrier structure definition. */
+struct barrier
+{
+    /** @brief Barrier generation, incremented each time the barrier is
+     * released. This is also the futex word the waiting threads wait on.
+     */
+    volatile int32_t generation;
+
+    /** @brief Number of threads that must reach the barrier. */
+    uint32_t count;
+
+    /** @brief Number of threads that reached the barrier in this generation.
+     */
+    uint32_t arrived;
+
+    /** @brief Barrier initialization state. */
+    volatile int32_t init;
+
+#if MAX_CPU_COUNT > 1
+    /** @brief Critical section spinlock. */
+    spinlock_t lock;
+#endif
+};
+
+/**
+ * @brief Defines barrier_t type as a shorcut for struct barrier.
+ */
+typedef struct barrier barrier_t;
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Initializes the barrier structure.
+ *
+ * @details Initializes the barrier structure. The barrier is released each time
+ * count threads reached it.
+ *
+ * @param[out] barrier The pointer to the barrier to initialize.
+ * @param[in] count The number of threads that must reach the barrier.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the pointer to the barrier is NULL.
+ * - OS_ERR_OUT_OF_BOUND is returned if count is 0.
+ */
+OS_RETURN_E barrier_init(barrier_t* barrier, const uint32_t count);
+
+/**
+ * @brief Destroys the barrier given as parameter.
+ *
+ * @details Destroys the barrier given as parameter. The threads waiting on the
+ * barrier are released and return OS_ERR_BARRIER_UNINITIALIZED.
+ *
+ * @param[in, out] barrier The barrier to destroy.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the pointer to the barrier is NULL.
+ * - OS_ERR_BARRIER_UNINITIALIZED is returned if the barrier is not initialized.
+ */
+OS_RETURN_E barrier_destroy(barrier_t* barrier);
+
+/**
+ * @brief Waits on the barrier given as parameter.
+ *
+ * @details Blocks the calling thread until the number of threads given at the
+ * barrier initialization reached the barrier. The last thread to reach the
+ * barrier releases the others and does not block.
+ *
+ * @param[in, out] barrier The barrier to wait on.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the pointer to the barrier is NULL.
+ * - OS_ERR_BARRIER_UNINITIALIZED is returned if the barrier is not initialized
+ *   or was destroyed while waiting.
+ * - OS_ERR_UNAUTHORIZED_ACTION is returned if the calling thread cannot block.
+ */
+OS_RETURN_E barrier_wait(barrier_t* barrier);
+
+#endif /* #ifndef __SYNC_BARRIER_H_ */
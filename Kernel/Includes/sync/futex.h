@@ -0,0 +1,152 @@
+/*******************************************************************************
+ * @file futex.h
+ *
+ * @see futex.c
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Address keyed wait / wake synchronization primitive.
+ *
+ * @details Address keyed wait / wake synchronization primitive. A thread can
+ * wait on the address of a 32 bits word as long as the word contains an
+ * expected value, and other threads can wake the threads waiting on that
+ * address. The waiting threads are stored in a global hashed table of wait
+ * queues, the synchronization objects built on top of the futex only need to
+ * store their state in a single word and do not allocate any memory.
+ *
+ * @warning Futexes can only be used when the current system is running and the
+ * scheduler initialized.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#ifndef __SYNC_FUTEX_H_
+#define __SYNC_FUTEX_H_
+
+#include <lib/stddef.h>        /* Standard definitions */
+#include <lib/stdint.h>        /* Generic int types */
+#include <core/kernel_queue.h> /* Kernel queues */
+#include <core/thread.h>       /* Thread structures */
+#include <sync/critical.h>     /* Critical sections */
+
+/* UTK configuration file */
+#include <config.h>
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/** @brief Number of bits of the futex hash, defines the wait table size. */
+#define FUTEX_HASH_TABLE_BITS 6
+/** @brief Number of buckets in the futex wait table. */
+#define FUTEX_HASH_TABLE_SIZE (1 << FUTEX_HASH_TABLE_BITS)
+
+/** @brief futex_wake count value used to wake all the waiting threads. */
+#define FUTEX_WAKE_ALL 0xFFFFFFFF
+
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/** @brief Futex wait table bucket. */
+struct futex_bucket
+{
+    /** @brief FIFO queue of the waiters which address hashes to this bucket.
+     */
+    kernel_queue_t waiters;
+
+#if MAX_CPU_COUNT > 1
+    /** @brief Critical section spinlock. */
+    spinlock_t lock;
+#endif
+};
+
+/**
+ * @brief Defines futex_bucket_t type as a shorcut for struct futex_bucket.
+ */
+typedef struct futex_bucket futex_bucket_t;
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Initializes the futex wait table.
+ *
+ * @details Initializes the futex global wait table. This function must be
+ * called before any other futex function.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ */
+OS_RETURN_E futex_init(void);
+
+/**
+ * @brief Waits on the address given as parameter.
+ *
+ * @details Blocks the calling thread on the address given as parameter if the
+ * word stored at this address is equal to the expected value. The comparison
+ * and the enqueue of the thread are atomic with regard to futex_wake. The
+ * function may return before the word is modified, the caller should always
+ * check its condition again after returning.
+ *
+ * @param[in] addr The address of the word to wait on.
+ * @param[in] value The value the word must contain for the thread to block.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if the thread blocked and was woken up.
+ * - OS_FUTEX_VALUE_MISMATCH is returned if the word did not contain the
+ *   expected value, the thread did not block.
+ * - OS_ERR_NULL_POINTER is returned if the address is NULL.
+ * - OS_ERR_UNAUTHORIZED_ACTION is returned if the calling thread cannot block.
+ */
+OS_RETURN_E futex_wait(volatile int32_t* addr, const int32_t value);
+
+/**
+ * @brief Waits on the address given as parameter with a given block type.
+ *
+ * @details Same as futex_wait but the calling thread is reported blocked with
+ * the block type given as parameter instead of THREAD_WAIT_TYPE_FUTEX. This
+ * allows the synchronization objects built on top of the futex to keep their
+ * own block type in the threads information.
+ *
+ * @param[in] addr The address of the word to wait on.
+ * @param[in] value The value the word must contain for the thread to block.
+ * @param[in] block_type The block type reported for the waiting thread.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if the thread blocked and was woken up.
+ * - OS_FUTEX_VALUE_MISMATCH is returned if the word did not contain the
+ *   expected value, the thread did not block.
+ * - OS_ERR_NULL_POINTER is returned if the address is NULL.
+ * - OS_ERR_UNAUTHORIZED_ACTION is returned if the calling thread cannot block.
+ */
+OS_RETURN_E futex_wait_type(volatile int32_t* addr, const int32_t value,
+                            const THREAD_WAIT_TYPE_E block_type);
+
+/**
+ * @brief Wakes the threads waiting on the address given as parameter.
+ *
+ * @details Wakes at most count threads waiting on the address given as
+ * parameter. The threads are woken in the order they started to wait. The
+ * function does not schedule, the caller should call the scheduler if needed.
+ * This function can be called from an interrupt handler.
+ *
+ * @param[in] addr The address of the word the threads are waiting on.
+ * @param[in] count The maximal number of threads to wake. FUTEX_WAKE_ALL wakes
+ * all the waiting threads.
+ * @param[out] woken The buffer that receives the number of threads that were
+ * woken. May be NULL.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the address is NULL.
+ */
+OS_RETURN_E futex_wake(volatile int32_t* addr, const uint32_t count,
+                       uint32_t* woken);
+
+#endif /* #ifndef __SYNC_FUTEX_H_ */
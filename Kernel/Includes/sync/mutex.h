@@ -29,7 +29,6 @@
 
 #include <lib/stddef.h>        /* Standard definitions */
 #include <lib/stdint.h>        /* Generic int types */
-#include <core/kernel_queue.h> /* Kernel queues */
 #include <sync/critical.h>     /* Critical sections */
 
 /*******************************************************************************
@@ -50,15 +49,11 @@
 /** @brief Mutex structure definition. */
 struct mutex
 {
-    /** @brief FIFO threads waiting queue. Stores the threads locked on the
-     * mutex.
-     */
-    kernel_queue_t* waiting_threads;
-
     /**
-     * @brief Mutex lock state (0 locked, 1 unlocked).
+     * @brief Mutex lock state (0 locked, 1 unlocked). This is also the futex
+     * word the threads locked on the mutex wait on.
      */
-    volatile uint32_t state;
+    volatile int32_t state;
 
     /**
      * @brief Mutex flags.
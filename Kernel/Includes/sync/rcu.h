@@ -0,0 +1,181 @@
+/*******************************************************************************
+ * @file rcu.h
+ *
+ * @see rcu.c
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Quiescent state based read-copy-update.
+ *
+ * @details Quiescent state based read-copy-update (RCU) implementation. Readers
+ * access the shared structures without taking any lock, writers unpublish the
+ * data and defer its release until a grace period elapsed. A grace period is
+ * over once every CPU that runs the scheduler went through the scheduler
+ * interrupt, which is a quiescent state since RCU readers run with interrupts
+ * disabled.
+ *
+ * @warning A reader must never block nor call the scheduler while in a read
+ * side critical section.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#ifndef __SYNC_RCU_H_
+#define __SYNC_RCU_H_
+
+#include <lib/stddef.h>           /* Standard definitions */
+#include <lib/stdint.h>           /* Generic int types */
+#include <interrupt/interrupts.h> /* Interrupt management */
+
+/* UTK configuration file */
+#include <config.h>
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+#if MAX_CPU_COUNT > 32
+#error "RCU CPU masks only support up to 32 CPUs"
+#endif
+
+/**
+ * @brief Returns the address of the object that embeds the RCU head given as
+ * parameter.
+ */
+#define RCU_CONTAINER_OF(head, type, member) \
+    ((type*)((uintptr_t)(head) - __builtin_offsetof(type, member)))
+
+/**
+ * @brief Publishes a pointer read by RCU readers. The stores initializing the
+ * pointed object are visible before the pointer itself.
+ */
+#define RCU_ASSIGN_POINTER(ptr, value) \
+    __atomic_store_n(&(ptr), (value), __ATOMIC_RELEASE)
+
+/**
+ * @brief Reads a pointer published with RCU_ASSIGN_POINTER in a read side
+ * critical section.
+ */
+#define RCU_DEREFERENCE(ptr) __atomic_load_n(&(ptr), __ATOMIC_ACQUIRE)
+
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/** @brief RCU deferred callback head, embedded in the protected object. */
+struct rcu_head
+{
+    /** @brief Next callback in the deferred callbacks list. */
+    struct rcu_head* next;
+
+    /** @brief Function called once the grace period elapsed. */
+    void (*func)(struct rcu_head*);
+
+    /** @brief Grace period number that must be completed before the call. */
+    uint32_t gp_target;
+};
+
+/**
+ * @brief Defines rcu_head_t type as a shorcut for struct rcu_head.
+ */
+typedef struct rcu_head rcu_head_t;
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Enters a RCU read side critical section.
+ *
+ * @details Enters a RCU read side critical section. The current CPU cannot be
+ * preempted until the section is exited, the returned state must be given back
+ * to rcu_read_unlock.
+ *
+ * @return The interrupt state before entering the section.
+ */
+__inline__ static uint32_t rcu_read_lock(void)
+{
+    return kernel_interrupt_disable();
+}
+
+/**
+ * @brief Exits a RCU read side critical section.
+ *
+ * @details Exits a RCU read side critical section. The pointers read during the
+ * section must not be used after this call.
+ *
+ * @param[in] state The state returned by the matching rcu_read_lock.
+ */
+__inline__ static void rcu_read_unlock(const uint32_t state)
+{
+    kernel_interrupt_restore(state);
+}
+
+/**
+ * @brief Defers a callback until the end of a grace period.
+ *
+ * @details Registers a callback that will be called once all the readers that
+ * might still access the object containing the head have left their read side
+ * critical section. The callbacks are called in thread context, by the IDLE
+ * threads or by rcu_synchronize. This function does not block and can be called
+ * from any context.
+ *
+ * @param[in] head The RCU head embedded in the object to release.
+ * @param[in] func The function to call once the grace period elapsed.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_NULL_POINTER is returned if the head or the function is NULL.
+ */
+OS_RETURN_E call_rcu(rcu_head_t* head, void (*func)(rcu_head_t*));
+
+/**
+ * @brief Waits for a full grace period.
+ *
+ * @details Blocks the calling thread until all the readers that were in a read
+ * side critical section at the time of the call left it. The deferred callbacks
+ * which grace period elapsed are then executed by the calling thread.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_UNAUTHORIZED_ACTION is returned if the calling thread cannot block.
+ */
+OS_RETURN_E rcu_synchronize(void);
+
+/**
+ * @brief Reports a quiescent state for the current CPU.
+ *
+ * @details Reports a quiescent state for the current CPU. This function is
+ * called by the scheduler on each schedule and completes the current grace
+ * period once all the CPUs reported.
+ *
+ * @warning THIS FUNCTION SHOULD NEVER BE CALLED OUTSIDE OF AN INTERRUPT.
+ *
+ * @param[in] cpu_id The id of the CPU reporting the quiescent state.
+ */
+void rcu_report_qs(const int32_t cpu_id);
+
+/**
+ * @brief Executes the deferred callbacks which grace period elapsed.
+ *
+ * @details Executes the deferred callbacks which grace period elapsed. The
+ * callbacks are executed in the caller's context with the interrupts in their
+ * current state.
+ */
+void rcu_process_callbacks(void);
+
+/**
+ * @brief Returns the number of callbacks waiting for their grace period.
+ *
+ * @details Returns the number of callbacks registered with call_rcu that were
+ * not executed yet.
+ *
+ * @return The number of pending callbacks.
+ */
+uint32_t rcu_get_pending_count(void);
+
+#endif /* #ifndef __SYNC_RCU_H_ */
@@ -26,7 +26,6 @@
 
 #include <lib/stddef.h>        /* Standard definitions */
 #include <lib/stdint.h>        /* Generic int types */
-#include <core/kernel_queue.h> /* Kernel queues */
 #include <sync/critical.h>     /* Critical sections */
 
 /*******************************************************************************
@@ -40,12 +39,9 @@
 /** @brief Semaphore structure definition. */
 struct semaphore
 {
-    /** @brief FIFO threads waiting queue. Stores the threads locked on the
-     * semaphore.
+    /** @brief Semaphore counter. This is also the futex word the threads
+     * locked on the semaphore wait on.
      */
-    kernel_queue_t* waiting_threads;
-
-    /** @brief Semaphore counter */
     volatile int32_t sem_level;
 
     /** @brief Semaphore initialization state. */
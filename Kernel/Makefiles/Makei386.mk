@@ -17,10 +17,13 @@ MODULES  = io lib memory interrupt core time user comm sync .
 
 TESTS_DIR  = Tests/Tests
 TEST_ARCH_DIR = Tests/Tests/i386
+FIXTURES_DIR  = Tests/Fixtures
+FIXTURES_ARCH_DIR = Tests/Fixtures/i386
 TESTS_INC  = Tests
 
 ifeq ($(TESTS), TRUE)
-MODULES += ../$(TESTS_DIR) ../$(TEST_ARCH_DIR)
+MODULES += ../$(TESTS_DIR) ../$(TEST_ARCH_DIR) ../$(FIXTURES_DIR) \
+           ../$(FIXTURES_ARCH_DIR)
 endif
 
 SRC_DEP = arch/cpu/$(CPU_DEP) arch/$(ARCH_DEP) $(MODULES)
@@ -122,6 +125,8 @@ clean:
 	@$(RM) -rf $(BIN_DIR) $(BUILD_DIR)
 	@$(RM) -f $(TESTS_DIR)/*.o $(TESTS_DIR)/*.d 
 	@$(RM) -f $(TEST_ARCH_DIR)/*.o $(TEST_ARCH_DIR)/*.d
+	@$(RM) -f $(FIXTURES_DIR)/*.o $(FIXTURES_DIR)/*.d
+	@$(RM) -f $(FIXTURES_ARCH_DIR)/*.o $(FIXTURES_ARCH_DIR)/*.d
 	@$(RM) -rf ./GRUB
 
 # Check header files modifications
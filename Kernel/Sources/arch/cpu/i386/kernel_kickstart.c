@@ -28,19 +28,23 @@
 #include <serial.h>               /* Serial driver */
 #include <io_apic.h>              /* IO-APIC driver */
 #include <ata_pio.h>              /* ATA PIO driver */
+#include <ata_dma.h>              /* ATA DMA driver */
 #include <keyboard.h>             /* Keyboard driver */
 #include <vga_text.h>             /* VGA display driver */
 #include <lib/stddef.h>           /* Standard definitions */
 #include <lib/string.h>           /* String manipulation */
 #include <core/panic.h>           /* Kernel panic */
 #include <core/scheduler.h>       /* Kernel scheduler */
+#include <sync/futex.h>           /* Futex wait table */
 #include <memory/kheap.h>         /* Kernel heap */
 #include <memory/paging.h>        /* Memory paging management */
 #include <memory/meminfo.h>       /* Memory information */
 #include <memory/memalloc.h>      /* Memory pools */
+#include <io/block.h>             /* Block devices */
 #include <io/kernel_output.h>     /* Kernel output methods */
 #include <interrupt/interrupts.h> /* Kernel interrupt manager */
 #include <interrupt/exceptions.h> /* Kernel exception manager */
+#include <interrupt/deferred.h>   /* Interrupt deferred work */
 
 /* UTK configuration file */
 #include <config.h>
@@ -257,21 +261,56 @@ void kernel_kickstart(void)
              "Could not initialize keyboard driver [%u]\n",
              err, 1);
 
+    err = serial_irq_init();
+    INIT_MSG("Serial interrupts initialized\n",
+             "Could not initialize serial interrupts [%u]\n",
+             err, 1);
+
     err = ata_pio_init();
     INIT_MSG("ATA-PIO initialized\n",
              "Could not initialize ATA-PIO driver [%u]\n",
              err, 1);
 
+    err = ata_dma_init();
+    INIT_MSG("ATA-DMA initialized\n",
+             "Could not initialize ATA-DMA driver [%u]\n",
+             err, 1);
+
+    err = block_cache_init();
+    INIT_MSG("Block cache initialized\n",
+             "Could not initialize block cache [%u]\n",
+             err, 1);
+
     err = cpu_smp_init();
     INIT_MSG("SMP initialized\n",
              "Could not initialize SMP [%u]\n",
              err, 1);
 
+#if IOAPIC_IRQ_BALANCE == 1
+    if (io_apic_capable())
+    {
+        err = io_apic_balance_irqs(IOAPIC_IRQ_RESERVED_CPUS);
+        INIT_MSG("IRQs balanced\n",
+                 "Could not balance IRQs [%u]\n",
+                 err, 1);
+    }
+#endif
+
+    err = futex_init();
+    INIT_MSG("",
+             "Could not initialize futex table [%u]\n",
+             err, 1);
+
     err = sched_init();
     INIT_MSG("Scheduler initialized\n",
              "Could not initialize scheduler [%u]\n",
              err, 1);
 
+    err = deferred_init();
+    INIT_MSG("Deferred work initialized\n",
+             "Could not initialize deferred work [%u]\n",
+             err, 1);
+
 # if DISPLAY_TYPE == DISPLAY_VESA_BUF
     /* Create the VESA double buffer thread */
     err = sched_create_kernel_thread(NULL, 
@@ -286,6 +325,11 @@ void kernel_kickstart(void)
              err, 1);
 #endif
 
+    err = kernel_output_init();
+    INIT_MSG("Kernel output flusher initialized\n",
+             "Could not initialize kernel output flusher [%u]\n",
+             err, 1);
+
     new_scheme.foreground = FG_CYAN;
     new_scheme.background = BG_BLACK;
     new_scheme.vga_color  = 1;
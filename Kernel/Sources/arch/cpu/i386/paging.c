@@ -740,4 +740,56 @@ OS_RETURN_E kernel_munmap(const void* virt_addr, const size_t mapping_size)
 #endif
 
     return OS_NO_ERR;
+}
+
+OS_RETURN_E paging_get_phys_address(const void* virt_addr,
+                                    uintptr_t* phys_addr)
+{
+    uint32_t    pgdir_entry;
+    uint32_t    pgtable_entry;
+    uint32_t*   pgdir_rec_addr;
+    uint32_t*   pgtable;
+    uint32_t    int_state;
+    OS_RETURN_E err;
+
+    if(phys_addr == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    /* Get entries */
+    pgdir_entry   = ((uintptr_t)virt_addr >> PG_DIR_OFFSET);
+    pgtable_entry = ((uintptr_t)virt_addr >> PG_TABLE_OFFSET) & 0x3FF;
+
+    err = OS_ERR_MEMORY_NOT_MAPPED;
+
+    pgdir_rec_addr = (uint32_t*)PAGING_RECUR_PG_DIR;
+    if((pgdir_rec_addr[pgdir_entry] & PG_DIR_FLAG_PAGE_PRESENT) != 0)
+    {
+        /* Get recursive virtual address */
+        pgtable = (uint32_t*)(PAGING_RECUR_PG_TABLE +
+                              KERNEL_PAGE_SIZE *
+                              pgdir_entry);
+
+        if((pgtable[pgtable_entry] & PAGE_FLAG_PRESENT) != 0)
+        {
+            *phys_addr = (pgtable[pgtable_entry] & PG_ENTRY_MASK) |
+                         ((uintptr_t)virt_addr & ~PAGE_ALIGN_MASK);
+            err = OS_NO_ERR;
+        }
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return err;
 }
\ No newline at end of file
@@ -113,6 +113,9 @@ void panic(cpu_state_t* cpu_state, uint32_t int_id, stack_state_t* stack_state)
 
     cpu_clear_interrupt();
 
+    /* Flush the queued serial output, the interrupts will not drain it */
+    serial_set_sync_mode();
+
     /* Kill other CPUs */
     cpu_ids        = acpi_get_cpu_ids();
     cpu_lapics     = acpi_get_cpu_lapics();
@@ -130,6 +133,9 @@ void panic(cpu_state_t* cpu_state, uint32_t int_id, stack_state_t* stack_state)
         }
     }
 
+    /* Output the pending records, the flusher will not run anymore */
+    kernel_output_panic_flush();
+
     /* VGA switch */
     if((uintptr_t)graphic_get_selected_driver()->clear_screen != 
        (uintptr_t)vga_text_driver.clear_screen 
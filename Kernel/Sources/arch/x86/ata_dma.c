@@ -0,0 +1,822 @@
+/*******************************************************************************
+ * @file ata_dma.c
+ *
+ * @see ata_dma.h
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief ATA bus master DMA driver.
+ *
+ * @details ATA bus master DMA driver. The driver uses the bus master IDE
+ * function of the PCI IDE controller to transfer ranges of sectors without
+ * moving the data with the CPU. The PRD (Physical Region Descriptor) table of
+ * the channel describes the physical pages of the caller's buffer. Each
+ * channel also owns a physically contiguous bounce buffer used when the
+ * caller's buffer cannot be reached by the engine. The completion is signaled
+ * by the channel interrupt handled by the ATA PIO driver. The driver falls back to PIO transfers when bus mastering is not
+ * available.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#include <lib/stdint.h>       /* Generic int types */
+#include <lib/stddef.h>       /* Standard definitions */
+#include <lib/string.h>       /* String manipulation */
+#include <cpu.h>              /* CPU managment */
+#include <io/kernel_output.h> /* Kernel output methods */
+#include <memory/memalloc.h>  /* Memory allocation */
+#include <memory/paging.h>    /* Memory management */
+#include <arch_paging.h>      /* Architecture specific memory settings */
+#include <sync/critical.h>    /* Critical sections */
+#include <sync/mutex.h>       /* Mutex */
+#include <sync/semaphore.h>   /* Semaphores */
+#include <ata_pio.h>          /* ATA PIO driver */
+
+/* UTK configuration file */
+#include <config.h>
+
+/* Header file */
+#include <ata_dma.h>
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************/
+
+/** @brief Primary channel DMA state. */
+static ata_dma_channel_t primary_dma;
+/** @brief Secondary channel DMA state. */
+static ata_dma_channel_t secondary_dma;
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/* Completion relies on the interrupt driven ATA channels */
+#if ATA_DMA_ENABLED == 1 && ATA_PIO_IRQ_MODE == 1
+/**
+ * @brief Reads a PCI configuration register.
+ *
+ * @param[in] bus The device bus.
+ * @param[in] device The device number on the bus.
+ * @param[in] function The device function.
+ * @param[in] offset The register offset, aligned on 4 bytes.
+ *
+ * @return The register value.
+ */
+static uint32_t ata_dma_pci_read(const uint32_t bus, const uint32_t device,
+                                 const uint32_t function, const uint32_t offset)
+{
+    cpu_outl(0x80000000 | (bus << 16) | (device << 11) | (function << 8) |
+             (offset & 0xFC), ATA_DMA_PCI_CONFIG_ADDRESS);
+    return cpu_inl(ATA_DMA_PCI_CONFIG_DATA);
+}
+
+/**
+ * @brief Writes a PCI configuration register.
+ *
+ * @param[in] bus The device bus.
+ * @param[in] device The device number on the bus.
+ * @param[in] function The device function.
+ * @param[in] offset The register offset, aligned on 4 bytes.
+ * @param[in] value The value to write.
+ */
+static void ata_dma_pci_write(const uint32_t bus, const uint32_t device,
+                              const uint32_t function, const uint32_t offset,
+                              const uint32_t value)
+{
+    cpu_outl(0x80000000 | (bus << 16) | (device << 11) | (function << 8) |
+             (offset & 0xFC), ATA_DMA_PCI_CONFIG_ADDRESS);
+    cpu_outl(value, ATA_DMA_PCI_CONFIG_DATA);
+}
+
+/**
+ * @brief Looks for a bus master capable IDE controller.
+ *
+ * @details Scans the PCI buses for an IDE controller which programming
+ * interface supports bus mastering, enables its bus master function and
+ * returns its bus master registers base port.
+ *
+ * @return The bus master registers base port, 0 if no controller was found.
+ */
+static uint16_t ata_dma_find_controller(void)
+{
+    uint32_t bus;
+    uint32_t dev;
+    uint32_t func;
+    uint32_t func_count;
+    uint32_t class;
+    uint32_t command;
+    uint32_t bar;
+
+    for(bus = 0; bus < 256; ++bus)
+    {
+        for(dev = 0; dev < 32; ++dev)
+        {
+            /* No device */
+            if((ata_dma_pci_read(bus, dev, 0, 0) & 0xFFFF) == 0xFFFF)
+            {
+                continue;
+            }
+
+            func_count = ((ata_dma_pci_read(bus, dev, 0,
+                                            ATA_DMA_PCI_HEADER_OFFSET) >> 16) &
+                          ATA_DMA_PCI_HEADER_MULTI) ? 8 : 1;
+
+            for(func = 0; func < func_count; ++func)
+            {
+                if((ata_dma_pci_read(bus, dev, func, 0) & 0xFFFF) == 0xFFFF)
+                {
+                    continue;
+                }
+
+                class = ata_dma_pci_read(bus, dev, func,
+                                         ATA_DMA_PCI_CLASS_OFFSET);
+                if(((class >> 24) & 0xFF) != ATA_DMA_PCI_CLASS_STORAGE ||
+                   ((class >> 16) & 0xFF) != ATA_DMA_PCI_SUBCLASS_IDE ||
+                   ((class >> 8) & ATA_DMA_PCI_PROGIF_BUS_MASTER) == 0)
+                {
+                    continue;
+                }
+
+                /* The bus master registers are in the IO space */
+                bar = ata_dma_pci_read(bus, dev, func, ATA_DMA_PCI_BAR4_OFFSET);
+                if((bar & 0x1) == 0 || (bar & 0xFFFC) == 0)
+                {
+                    continue;
+                }
+
+                command = ata_dma_pci_read(bus, dev, func,
+                                           ATA_DMA_PCI_COMMAND_OFFSET);
+                command = (command & 0xFFFF) | ATA_DMA_PCI_COMMAND_IO |
+                          ATA_DMA_PCI_COMMAND_BUS_MASTER;
+                ata_dma_pci_write(bus, dev, func, ATA_DMA_PCI_COMMAND_OFFSET,
+                                  command);
+
+#if ATA_DMA_KERNEL_DEBUG == 1
+                kernel_serial_debug("ATA bus master IDE at %d:%d.%d, \
+registers 0x%x\n", bus, dev, func, bar & 0xFFFC);
+#endif
+
+                return bar & 0xFFFC;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Allocates a physically contiguous memory region.
+ *
+ * @details Allocates contiguous frames and maps them in the kernel address
+ * space.
+ *
+ * @param[in] size The size of the region in bytes.
+ * @param[out] virt The region virtual address.
+ * @param[out] phys The region physical address.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E ata_dma_alloc(const size_t size, void** virt,
+                                 uintptr_t* phys)
+{
+    OS_RETURN_E err;
+    size_t      page_count;
+    void*       frames;
+    void*       pages;
+
+    page_count = (size + KERNEL_PAGE_SIZE - 1) / KERNEL_PAGE_SIZE;
+
+    frames = memalloc_alloc_kframes(page_count, &err);
+    if(frames == NULL || err != OS_NO_ERR)
+    {
+        return err;
+    }
+    pages = memalloc_alloc_kpages(page_count, &err);
+    if(pages == NULL || err != OS_NO_ERR)
+    {
+        memalloc_free_kframes(frames, page_count);
+        return err;
+    }
+    err = kernel_mmap_hw(pages, frames, page_count * KERNEL_PAGE_SIZE, 0, 0);
+    if(err != OS_NO_ERR)
+    {
+        memalloc_free_kpages(pages, page_count);
+        memalloc_free_kframes(frames, page_count);
+        return err;
+    }
+
+    *virt = pages;
+    *phys = (uintptr_t)frames;
+
+    return OS_NO_ERR;
+}
+
+/**
+ * @brief Releases a region allocated by ata_dma_alloc.
+ *
+ * @param[in] size The size of the region in bytes.
+ * @param[in] virt The region virtual address.
+ * @param[in] phys The region physical address.
+ */
+static void ata_dma_release(const size_t size, void* virt,
+                            const uintptr_t phys)
+{
+    size_t page_count;
+
+    page_count = (size + KERNEL_PAGE_SIZE - 1) / KERNEL_PAGE_SIZE;
+
+    kernel_munmap(virt, page_count * KERNEL_PAGE_SIZE);
+    memalloc_free_kpages(virt, page_count);
+    memalloc_free_kframes((void*)phys, page_count);
+}
+
+/**
+ * @brief Initializes the DMA state of a channel.
+ *
+ * @param[out] dma The channel DMA state.
+ * @param[in] bm_port The channel bus master registers base port.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E ata_dma_init_channel(ata_dma_channel_t* dma,
+                                        const uint16_t bm_port)
+{
+    OS_RETURN_E err;
+
+    err = ata_dma_alloc(sizeof(ata_dma_prd_t) * ATA_DMA_PRD_COUNT,
+                        (void**)&dma->prd_table, &dma->prd_table_phys);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+    err = ata_dma_alloc(ATA_DMA_BUFFER_SIZE, (void**)&dma->buffer,
+                        &dma->buffer_phys);
+    if(err != OS_NO_ERR)
+    {
+        ata_dma_release(sizeof(ata_dma_prd_t) * ATA_DMA_PRD_COUNT,
+                        dma->prd_table, dma->prd_table_phys);
+        dma->prd_table      = NULL;
+        dma->prd_table_phys = 0;
+        return err;
+    }
+
+    /* Stop the engine and clear the pending status */
+    cpu_outb(0, bm_port + ATA_DMA_BM_COMMAND_OFFSET);
+    cpu_outb(ATA_DMA_BM_STATUS_IRQ | ATA_DMA_BM_STATUS_ERR,
+             bm_port + ATA_DMA_BM_STATUS_OFFSET);
+
+    dma->bm_port = bm_port;
+    dma->enabled = 1;
+
+    return OS_NO_ERR;
+}
+#endif
+
+/**
+ * @brief Returns the DMA state of a device channel.
+ *
+ * @param[in] device The device to get the channel of.
+ *
+ * @return The channel DMA state, NULL if the channel cannot use bus master
+ * transfers.
+ */
+static ata_dma_channel_t* ata_dma_get_channel(const ata_pio_device_t* device)
+{
+    ata_dma_channel_t* dma;
+
+    if(device->port == PRIMARY_PORT)
+    {
+        dma = &primary_dma;
+    }
+    else if(device->port == SECONDARY_PORT)
+    {
+        dma = &secondary_dma;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    return (dma->enabled == 1) ? dma : NULL;
+}
+
+/**
+ * @brief Fills the PRD table of a channel with its bounce buffer.
+ *
+ * @details Describes the first bytes of the channel bounce buffer. The
+ * regions are split on the 64KB boundaries.
+ *
+ * @param[in, out] dma The channel DMA state.
+ * @param[in] size The size of the transfer in bytes.
+ */
+static void ata_dma_setup_prd(ata_dma_channel_t* dma, const uint32_t size)
+{
+    uintptr_t address;
+    uint32_t  left;
+    uint32_t  length;
+    uint32_t  i;
+
+    address = dma->buffer_phys;
+    left    = size;
+    i       = 0;
+
+    while(left != 0)
+    {
+        length = ATA_DMA_PRD_BOUNDARY - (address & (ATA_DMA_PRD_BOUNDARY - 1));
+        if(length > left)
+        {
+            length = left;
+        }
+
+        dma->prd_table[i].address = address;
+        dma->prd_table[i].size    = length & 0xFFFF;
+        dma->prd_table[i].flags   = 0;
+
+        address += length;
+        left    -= length;
+        ++i;
+    }
+
+    dma->prd_table[i - 1].flags = ATA_DMA_PRD_END;
+}
+
+/**
+ * @brief Fills the PRD table of a channel with the caller's buffer.
+ *
+ * @details Describes the physical pages of the buffer. The physically
+ * contiguous pages are merged in a single region, a region never crosses a
+ * 64KB boundary.
+ *
+ * @param[in, out] dma The channel DMA state.
+ * @param[in] buffer The caller's buffer.
+ * @param[in] size The size of the transfer in bytes.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if the engine can transfer the buffer directly.
+ * - OS_ERR_UNAUTHORIZED_ACTION is returned if the buffer is not aligned on 2
+ *   bytes.
+ * - OS_ERR_MEMORY_NOT_MAPPED is returned if a page of the buffer is not
+ *   mapped.
+ */
+static OS_RETURN_E ata_dma_setup_buffer_prd(ata_dma_channel_t* dma,
+                                            const uint8_t* buffer,
+                                            const uint32_t size)
+{
+    uintptr_t   virt;
+    uintptr_t   phys;
+    uintptr_t   region_phys;
+    uint32_t    region_size;
+    uint32_t    left;
+    uint32_t    length;
+    uint32_t    i;
+    OS_RETURN_E err;
+
+    /* The engine transfers words, the regions must start on even addresses */
+    if(((uintptr_t)buffer & 0x1) != 0)
+    {
+        return OS_ERR_UNAUTHORIZED_ACTION;
+    }
+
+    virt        = (uintptr_t)buffer;
+    left        = size;
+    region_phys = 0;
+    region_size = 0;
+    i           = 0;
+
+    while(left != 0)
+    {
+        err = paging_get_phys_address((void*)virt, &phys);
+        if(err != OS_NO_ERR)
+        {
+            return err;
+        }
+
+        length = KERNEL_PAGE_SIZE - (virt & (KERNEL_PAGE_SIZE - 1));
+        if(length > left)
+        {
+            length = left;
+        }
+
+        /* Grow the current region while it stays in the same 64KB window */
+        if(region_size != 0 && region_phys + region_size == phys &&
+           (phys & (ATA_DMA_PRD_BOUNDARY - 1)) != 0)
+        {
+            region_size += length;
+        }
+        else
+        {
+            if(region_size != 0)
+            {
+                dma->prd_table[i].address = region_phys;
+                dma->prd_table[i].size    = region_size & 0xFFFF;
+                dma->prd_table[i].flags   = 0;
+                ++i;
+            }
+            region_phys = phys;
+            region_size = length;
+        }
+
+        virt += length;
+        left -= length;
+    }
+
+    dma->prd_table[i].address = region_phys;
+    dma->prd_table[i].size    = region_size & 0xFFFF;
+    dma->prd_table[i].flags   = ATA_DMA_PRD_END;
+
+    return OS_NO_ERR;
+}
+
+/**
+ * @brief Transfers a range of sectors with a single DMA command.
+ *
+ * @details Issues one DMA command for up to ATA_PIO_MAX_SECTORS_PER_COMMAND
+ * sectors and sleeps until the channel interrupt signals its completion. The
+ * engine transfers the caller's buffer directly, the channel bounce buffer is
+ * only used when the buffer is not aligned on 2 bytes or not mapped.
+ *
+ * @param[in] device The device to transfer the data with.
+ * @param[in, out] channel The device interrupt driven channel.
+ * @param[in, out] dma The channel DMA state.
+ * @param[in] sector The first sector of the range.
+ * @param[in, out] buffer The data buffer.
+ * @param[in] count The number of sectors to transfer.
+ * @param[in] write Set to 1 to write the buffer, 0 to read into it.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_ATA_DEVICE_ERROR is returned if an errored device is detected.
+ * - OS_ERR_ATA_DEVICE_NOT_PRESENT is returned if the device was not detected.
+ */
+static OS_RETURN_E ata_dma_transfer(ata_pio_device_t* device,
+                                    ata_pio_channel_t* channel,
+                                    ata_dma_channel_t* dma,
+                                    const uint32_t sector,
+                                    uint8_t* buffer,
+                                    const uint32_t count,
+                                    const uint32_t write)
+{
+    uint32_t    size;
+    uint32_t    bounce;
+    uint8_t     status;
+    uint32_t    int_state;
+    OS_RETURN_E err;
+
+    size = count * ATA_PIO_SECTOR_SIZE;
+
+    err = mutex_pend(&channel->lock);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    /* Setup the bus master engine */
+    bounce = 0;
+    if(ata_dma_setup_buffer_prd(dma, buffer, size) != OS_NO_ERR)
+    {
+        bounce = 1;
+        if(write == 1)
+        {
+            memcpy(dma->buffer, buffer, size);
+        }
+        ata_dma_setup_prd(dma, size);
+    }
+    cpu_outl(dma->prd_table_phys, dma->bm_port + ATA_DMA_BM_PRDT_OFFSET);
+    cpu_outb(write == 1 ? 0 : ATA_DMA_BM_COMMAND_READ,
+             dma->bm_port + ATA_DMA_BM_COMMAND_OFFSET);
+    cpu_outb(cpu_inb(dma->bm_port + ATA_DMA_BM_STATUS_OFFSET) |
+             ATA_DMA_BM_STATUS_IRQ | ATA_DMA_BM_STATUS_ERR,
+             dma->bm_port + ATA_DMA_BM_STATUS_OFFSET);
+
+    channel->buffer   = NULL;
+    channel->left     = 0;
+    channel->block    = 0;
+    channel->write    = write;
+    channel->status   = OS_NO_ERR;
+    channel->dma_port = dma->bm_port;
+    channel->dma      = 1;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &device->lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    /* Set first sector */
+    cpu_outb((device->type == MASTER ? 0xE0 : 0xF0) |
+             ((sector & 0x0F000000) >> 24) ,
+            device->port + ATA_PIO_DEVICE_PORT_OFFSET);
+
+    /* Clear error */
+    cpu_outb(0, device->port + ATA_PIO_ERROR_PORT_OFFSET);
+
+    /* Set number of sectors, 0 stands for 256 sectors */
+    cpu_outb(count & 0xFF, device->port + ATA_PIO_SC_PORT_OFFSET);
+
+    /* Set LBA values */
+    cpu_outb(sector & 0x000000FF, device->port + ATA_PIO_LBALOW_PORT_OFFSET);
+    cpu_outb((sector & 0x0000FF00) >> 8,
+            device->port + ATA_PIO_LBAMID_PORT_OFFSET);
+    cpu_outb((sector & 0x00FF0000) >> 16,
+            device->port + ATA_PIO_LBAHIG_PORT_OFFSET);
+
+    channel->active = 1;
+    cpu_outb(write == 1 ? ATA_DMA_WRITE_COMMAND : ATA_DMA_READ_COMMAND,
+             device->port + ATA_PIO_COMMAND_PORT_OFFSET);
+
+    /* The alternate status does not acknowledge the device interrupt */
+    status = cpu_inb(device->port + ATA_PIO_CONTROL_PORT_OFFSET);
+    if(status == 0x00 || status == 0xFF)
+    {
+#if ATA_DMA_KERNEL_DEBUG == 1
+        kernel_serial_debug("ATA device not present\n");
+#endif
+        channel->active = 0;
+        err = OS_ERR_ATA_DEVICE_NOT_PRESENT;
+    }
+    else
+    {
+        /* Start the transfer */
+        cpu_outb((write == 1 ? 0 : ATA_DMA_BM_COMMAND_READ) |
+                 ATA_DMA_BM_COMMAND_START,
+                 dma->bm_port + ATA_DMA_BM_COMMAND_OFFSET);
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &device->lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    if(err == OS_NO_ERR)
+    {
+        err = sem_pend(&channel->done);
+        if(err == OS_NO_ERR)
+        {
+            err = channel->status;
+        }
+    }
+
+    channel->dma = 0;
+
+    if(err == OS_NO_ERR && write == 0 && bounce == 1)
+    {
+        memcpy(buffer, dma->buffer, size);
+    }
+
+#if ATA_DMA_KERNEL_DEBUG == 1
+    if(err != OS_NO_ERR)
+    {
+        kernel_serial_debug("ATA DMA request error 0x%p (%s) [%d]\n",
+                            device->port,
+                            ((device->type == MASTER) ? "MASTER" : "SLAVE"),
+                            err);
+    }
+#endif
+
+    mutex_post(&channel->lock);
+
+    return err;
+}
+
+OS_RETURN_E ata_dma_init(void)
+{
+#if ATA_DMA_ENABLED == 1 && ATA_PIO_IRQ_MODE == 1
+    OS_RETURN_E err;
+    uint16_t    bm_port;
+#endif
+
+    memset(&primary_dma, 0, sizeof(ata_dma_channel_t));
+    memset(&secondary_dma, 0, sizeof(ata_dma_channel_t));
+
+    /* Completion relies on the interrupt driven ATA channels */
+#if ATA_DMA_ENABLED == 0 || ATA_PIO_IRQ_MODE == 0
+    return OS_NO_ERR;
+#else
+    bm_port = ata_dma_find_controller();
+    if(bm_port == 0)
+    {
+        kernel_info("No bus master IDE controller, using ATA PIO\n");
+        return OS_NO_ERR;
+    }
+
+#if ATA_PIO_DETECT_PRIMARY_PORT == 1
+    err = ata_dma_init_channel(&primary_dma, bm_port);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+#endif
+
+#if ATA_PIO_DETECT_SECONDARY_PORT == 1
+    err = ata_dma_init_channel(&secondary_dma,
+                               bm_port + ATA_DMA_BM_SECONDARY_OFFSET);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+#endif
+    (void)err;
+
+    return OS_NO_ERR;
+#endif
+}
+
+uint32_t ata_dma_is_available(const ata_pio_device_t* device)
+{
+    if(device == NULL)
+    {
+        return 0;
+    }
+
+    return (ata_dma_get_channel(device) != NULL) ? 1 : 0;
+}
+
+OS_RETURN_E ata_dma_read_sectors(ata_pio_device_t* device,
+                                 const uint32_t sector,
+                                 void* buffer, const uint32_t count)
+{
+    ata_dma_channel_t* dma;
+    ata_pio_channel_t* channel;
+    uint32_t           done;
+    uint32_t           chunk;
+    OS_RETURN_E        err;
+
+    if(device == NULL || buffer == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+#if ATA_DMA_KERNEL_DEBUG == 1
+    kernel_serial_debug("ATA DMA read request device 0x%p %s, sector 0x%p,\
+count %d\n", device->port, ((device->type == MASTER) ? "MASTER" : "SLAVE"),
+                        sector,
+                        count);
+#endif
+
+    /* Check the range fits in 28 bits LBA */
+    if(sector > 0x0FFFFFFF || count > 0x10000000 - sector)
+    {
+        return OS_ERR_ATA_BAD_SECTOR_NUMBER;
+    }
+
+    dma     = ata_dma_get_channel(device);
+    channel = ata_pio_get_irq_channel(device);
+    if(dma == NULL || channel == NULL)
+    {
+        return ata_pio_read_sectors(device, sector, buffer, count);
+    }
+
+    err = OS_NO_ERR;
+    for(done = 0; done < count && err == OS_NO_ERR; done += chunk)
+    {
+        chunk = count - done;
+        if(chunk > ATA_PIO_MAX_SECTORS_PER_COMMAND)
+        {
+            chunk = ATA_PIO_MAX_SECTORS_PER_COMMAND;
+        }
+
+        err = ata_dma_transfer(device, channel, dma, sector + done,
+                               (uint8_t*)buffer + done * ATA_PIO_SECTOR_SIZE,
+                               chunk, 0);
+    }
+
+    return err;
+}
+
+/**
+ * @brief Writes a range of sectors without flushing the device cache.
+ *
+ * @param[in] device The device to write the data to.
+ * @param[in] sector The first sector to write.
+ * @param[in] buffer The buffer that contains the data.
+ * @param[in] count The number of sectors to write.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E ata_dma_write_range(ata_pio_device_t* device,
+                                       const uint32_t sector,
+                                       const void* buffer,
+                                       const uint32_t count)
+{
+    ata_dma_channel_t* dma;
+    ata_pio_channel_t* channel;
+    uint32_t           done;
+    uint32_t           chunk;
+    OS_RETURN_E        err;
+
+    if(device == NULL || buffer == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+#if ATA_DMA_KERNEL_DEBUG == 1
+    kernel_serial_debug("ATA DMA write request device 0x%p %s, sector 0x%p,\
+count %d\n", device->port, ((device->type == MASTER) ? "MASTER" : "SLAVE"),
+                        sector,
+                        count);
+#endif
+
+    /* Check the range fits in 28 bits LBA */
+    if(sector > 0x0FFFFFFF || count > 0x10000000 - sector)
+    {
+        return OS_ERR_ATA_BAD_SECTOR_NUMBER;
+    }
+
+    dma     = ata_dma_get_channel(device);
+    channel = ata_pio_get_irq_channel(device);
+    if(dma == NULL || channel == NULL)
+    {
+        return ata_pio_write_sectors(device, sector, buffer, count);
+    }
+
+    err = OS_NO_ERR;
+    for(done = 0; done < count && err == OS_NO_ERR; done += chunk)
+    {
+        chunk = count - done;
+        if(chunk > ATA_PIO_MAX_SECTORS_PER_COMMAND)
+        {
+            chunk = ATA_PIO_MAX_SECTORS_PER_COMMAND;
+        }
+
+        err = ata_dma_transfer(device, channel, dma, sector + done,
+                               (uint8_t*)buffer + done * ATA_PIO_SECTOR_SIZE,
+                               chunk, 1);
+    }
+
+    return err;
+}
+
+/**
+ * @brief Block driver read function.
+ *
+ * @param[in] device The ATA device.
+ * @param[in] sector The first sector to read.
+ * @param[out] buffer The buffer that receives the data.
+ * @param[in] count The number of sectors to read.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E ata_block_read(void* device, const uint32_t sector,
+                                  void* buffer, const uint32_t count)
+{
+    return ata_dma_read_sectors(device, sector, buffer, count);
+}
+
+/**
+ * @brief Block driver write function, the block layer flushes the device.
+ *
+ * @param[in] device The ATA device.
+ * @param[in] sector The first sector to write.
+ * @param[in] buffer The buffer that contains the data.
+ * @param[in] count The number of sectors to write.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E ata_block_write(void* device, const uint32_t sector,
+                                   const void* buffer, const uint32_t count)
+{
+    return ata_dma_write_range(device, sector, buffer, count);
+}
+
+/**
+ * @brief Block driver flush function.
+ *
+ * @param[in] device The ATA device.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E ata_block_flush(void* device)
+{
+    return ata_pio_flush(device);
+}
+
+/**
+ * @brief ATA block driver instance.
+ */
+block_driver_t ata_block_driver = {
+    .read  = ata_block_read,
+    .write = ata_block_write,
+    .flush = ata_block_flush
+};
+
+OS_RETURN_E ata_dma_write_sectors(ata_pio_device_t* device,
+                                  const uint32_t sector,
+                                  const void* buffer, const uint32_t count)
+{
+    OS_RETURN_E err;
+
+    err = ata_dma_write_range(device, sector, buffer, count);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    /* Flush write */
+    return ata_pio_flush(device);
+}
@@ -13,16 +13,26 @@
  *
  * @details ATA (Advanced Technology Attachment) driver. Supports hard drive IO
  * through the CPU PIO. The driver can read and write data. No utility function
- * are provided.
+ * are provided. Ranges of sectors are transfered with multi-sector commands
+ * and string IO instructions. Once the scheduler runs, the transfers on the
+ * primary and secondary ports are interrupt driven: the requesting thread
+ * sleeps on the channel semaphore and the IRQ handler moves each block.
  *
  * @copyright Alexy Torres Aurora Dugo
  ******************************************************************************/
 
-#include <lib/stdint.h>       /* Generic int types */
-#include <lib/stddef.h>       /* Standard definitions */
-#include <cpu.h>              /* CPU managment */
-#include <io/kernel_output.h> /* Kernel output methods */
-#include <sync/critical.h>    /* Critical sections */
+#include <lib/stdint.h>           /* Generic int types */
+#include <lib/stddef.h>           /* Standard definitions */
+#include <lib/string.h>           /* String manipulation */
+#include <cpu.h>                  /* CPU managment */
+#include <io/kernel_output.h>     /* Kernel output methods */
+#include <interrupt/interrupts.h> /* Interrupt management */
+#include <interrupt_settings.h>   /* Interrupt settings */
+#include <core/scheduler.h>       /* Kernel scheduler */
+#include <core/panic.h>           /* Kernel panic */
+#include <sync/critical.h>        /* Critical sections */
+#include <sync/mutex.h>           /* Mutex */
+#include <sync/semaphore.h>       /* Semaphores */
 
 /* UTK configuration file */
 #include <config.h>
@@ -34,15 +44,559 @@
 
 /* Header file */
 #include <ata_pio.h>
+#include <ata_dma.h>
 
 /*******************************************************************************
  * GLOBAL VARIABLES
  ******************************************************************************/
 
+#if ATA_PIO_IRQ_MODE == 1
+/** @brief Primary channel interrupt driven transfer state. */
+static ata_pio_channel_t primary_channel;
+/** @brief Secondary channel interrupt driven transfer state. */
+static ata_pio_channel_t secondary_channel;
+#endif
+
 /*******************************************************************************
  * FUNCTIONS
  ******************************************************************************/
 
+#if ATA_PIO_IRQ_MODE == 1
+/**
+ * @brief Releases the thread waiting for the active request of a channel.
+ *
+ * @param[in, out] channel The channel which request completed.
+ */
+static void ata_pio_channel_complete(ata_pio_channel_t* channel)
+{
+    OS_RETURN_E err;
+
+    err = sem_post(&channel->done);
+    if(err != OS_NO_ERR)
+    {
+        kernel_error("Could not release ATA request [%d]\n", err);
+        kernel_panic(err);
+    }
+}
+
+/**
+ * @brief Moves the data block requested by an ATA channel interrupt.
+ *
+ * @details Deferred work routine of the channel interrupt. Each data request of
+ * the active request moves one block of sectors. The requesting thread is woken
+ * once the last read block is moved, once the interrupt following the last
+ * written block is received or once the device reports an error. The device
+ * does not raise the next interrupt before the block is moved, the routine
+ * never runs twice for the same interrupt.
+ *
+ * @param[in, out] args The channel that raised the interrupt.
+ */
+static void ata_pio_channel_transfer(void* args)
+{
+    ata_pio_channel_t* channel;
+    uint8_t            status;
+    uint32_t           block;
+    uint32_t           words;
+    uint32_t           finished;
+
+    channel  = args;
+    status   = channel->irq_status;
+    finished = 0;
+
+    if((status & ATA_PIO_FLAG_ERR) == ATA_PIO_FLAG_ERR)
+    {
+        channel->status = OS_ERR_ATA_DEVICE_ERROR;
+        finished        = 1;
+    }
+    else if(channel->left != 0)
+    {
+        if((status & ATA_PIO_FLAG_DRQ) == ATA_PIO_FLAG_DRQ)
+        {
+            /* The last block can be shorter than the multiple block size */
+            block = channel->block;
+            if(block > channel->left)
+            {
+                block = channel->left;
+            }
+            words = block * ATA_PIO_SECTOR_SIZE / sizeof(uint16_t);
+
+            if(channel->write == 1)
+            {
+                cpu_outsw(channel->port + ATA_PIO_DATA_PORT_OFFSET,
+                          channel->buffer, words);
+            }
+            else
+            {
+                cpu_insw(channel->port + ATA_PIO_DATA_PORT_OFFSET,
+                         channel->buffer, words);
+            }
+
+            channel->buffer += block * ATA_PIO_SECTOR_SIZE;
+            channel->left   -= block;
+
+            if(channel->write == 0 && channel->left == 0)
+            {
+                finished = 1;
+            }
+        }
+    }
+    else
+    {
+        /* Last written block processed or non data command completed */
+        finished = 1;
+    }
+
+    if(finished == 1)
+    {
+        channel->active = 0;
+        ata_pio_channel_complete(channel);
+    }
+}
+
+/**
+ * @brief Handles the interrupt of an ATA channel.
+ *
+ * @details Handles the interrupt of an ATA channel. The bus master DMA
+ * transfers are completed here, the PIO data blocks are moved by the channel
+ * deferred work.
+ *
+ * @param[in, out] channel The channel that raised the interrupt.
+ * @param[in] irq The channel IRQ line.
+ */
+static void ata_pio_channel_irq(ata_pio_channel_t* channel, const uint32_t irq)
+{
+    uint8_t  status;
+    uint8_t  bm_status;
+    uint32_t finished;
+    uint32_t deferred;
+
+    /* Reading the status acknowledges the device interrupt */
+    status   = cpu_inb(channel->port + ATA_PIO_COMMAND_PORT_OFFSET);
+    finished = 0;
+    deferred = 0;
+
+    if(channel->active == 1 && channel->dma == 1)
+    {
+        /* The bus master raises its interrupt flag once the PRD table is
+         * consumed or the device ends the transfer.
+         */
+        bm_status = cpu_inb(channel->dma_port + ATA_DMA_BM_STATUS_OFFSET);
+        if((bm_status & ATA_DMA_BM_STATUS_IRQ) == ATA_DMA_BM_STATUS_IRQ ||
+           (status & ATA_PIO_FLAG_ERR) == ATA_PIO_FLAG_ERR)
+        {
+            cpu_outb(0, channel->dma_port + ATA_DMA_BM_COMMAND_OFFSET);
+            cpu_outb(bm_status | ATA_DMA_BM_STATUS_IRQ | ATA_DMA_BM_STATUS_ERR,
+                     channel->dma_port + ATA_DMA_BM_STATUS_OFFSET);
+
+            if((status & ATA_PIO_FLAG_ERR) == ATA_PIO_FLAG_ERR ||
+               (bm_status & ATA_DMA_BM_STATUS_ERR) == ATA_DMA_BM_STATUS_ERR)
+            {
+                channel->status = OS_ERR_ATA_DEVICE_ERROR;
+            }
+            channel->active = 0;
+            finished        = 1;
+        }
+    }
+    else if(channel->active == 1)
+    {
+        channel->irq_status = status;
+        deferred            = 1;
+    }
+
+    kernel_interrupt_set_irq_eoi(irq);
+
+    /* The requesting thread is released once the interrupt is acknowledged */
+    if(finished == 1)
+    {
+        ata_pio_channel_complete(channel);
+    }
+    else if(deferred == 1)
+    {
+        deferred_work_queue(&channel->transfer);
+    }
+}
+
+#if ATA_PIO_DETECT_PRIMARY_PORT == 1
+/**
+ * @brief Primary ATA channel interrupt handler.
+ *
+ * @param[in, out] cpu_state The cpu registers before the interrupt.
+ * @param[in] int_id The interrupt line that called the handler.
+ * @param[in, out] stack_state The stack state before the interrupt.
+ */
+static void ata_pio_primary_handler(cpu_state_t* cpu_state, uintptr_t int_id,
+                                    stack_state_t* stack_state)
+{
+    (void)cpu_state;
+    (void)int_id;
+    (void)stack_state;
+
+    ata_pio_channel_irq(&primary_channel, ATA_PRIMARY_IRQ_LINE);
+}
+#endif
+
+#if ATA_PIO_DETECT_SECONDARY_PORT == 1
+/**
+ * @brief Secondary ATA channel interrupt handler.
+ *
+ * @param[in, out] cpu_state The cpu registers before the interrupt.
+ * @param[in] int_id The interrupt line that called the handler.
+ * @param[in, out] stack_state The stack state before the interrupt.
+ */
+static void ata_pio_secondary_handler(cpu_state_t* cpu_state, uintptr_t int_id,
+                                      stack_state_t* stack_state)
+{
+    (void)cpu_state;
+    (void)int_id;
+    (void)stack_state;
+
+    ata_pio_channel_irq(&secondary_channel, ATA_SECONDARY_IRQ_LINE);
+}
+#endif
+
+/**
+ * @brief Initializes the interrupt driven transfers of an ATA channel.
+ *
+ * @details Initializes the channel request state, enables the devices
+ * interrupts and registers the channel IRQ handler.
+ *
+ * @param[out] channel The channel to initialize.
+ * @param[in] port The channel port.
+ * @param[in] irq The channel IRQ line.
+ * @param[in] handler The channel IRQ handler.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E ata_pio_init_channel(ata_pio_channel_t* channel,
+                                        const ATA_PIO_PORT_E port,
+                                        const uint32_t irq,
+                                        void(*handler)(
+                                             cpu_state_t*,
+                                             uintptr_t,
+                                             stack_state_t*
+                                             ))
+{
+    OS_RETURN_E err;
+
+    channel->port        = port;
+    channel->irq_enabled = 0;
+    channel->active      = 0;
+    channel->buffer      = NULL;
+    channel->left        = 0;
+    channel->block       = 0;
+    channel->write       = 0;
+    channel->status      = OS_NO_ERR;
+    channel->dma         = 0;
+    channel->dma_port    = 0;
+    channel->irq_status  = 0;
+
+    err = deferred_work_init(&channel->transfer, ata_pio_channel_transfer,
+                             channel);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    err = mutex_init(&channel->lock, MUTEX_FLAG_NONE,
+                     MUTEX_PRIORITY_ELEVATION_NONE);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+    err = sem_init(&channel->done, 0);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    /* Clear nIEN, the devices of the channel raise their interrupt */
+    cpu_outb(0x00, port + ATA_PIO_CONTROL_PORT_OFFSET);
+
+    err = kernel_interrupt_register_irq_handler(irq, handler);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+    err = kernel_interrupt_set_irq_mask(irq, 1);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    channel->irq_enabled = 1;
+
+    return OS_NO_ERR;
+}
+
+/**
+ * @brief Returns the channel of a device.
+ *
+ * @param[in] device The device to get the channel of.
+ *
+ * @return The channel of the device, NULL if the channel IRQ handler is not
+ * registered.
+ */
+static ata_pio_channel_t* ata_pio_get_channel(const ata_pio_device_t* device)
+{
+    ata_pio_channel_t* channel;
+
+    if(device->port == PRIMARY_PORT)
+    {
+        channel = &primary_channel;
+    }
+    else if(device->port == SECONDARY_PORT)
+    {
+        channel = &secondary_channel;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    if(channel->irq_enabled != 1)
+    {
+        return NULL;
+    }
+
+    return channel;
+}
+#endif
+
+/**
+ * @brief Acquires the channel of a device for a polled request.
+ *
+ * @details The polled requests are issued by callers that cannot sleep, the
+ * channel lock is only taken if it is free. Before the channel IRQ handler is
+ * registered, the requests are only issued by the boot sequence and no lock is
+ * taken.
+ *
+ * @param[in] device The device to send the request to.
+ * @param[out] channel The buffer that receives the acquired channel, NULL if no
+ * lock was taken.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_MUTEX_LOCKED is returned if the channel executes another request.
+ */
+static OS_RETURN_E ata_pio_polled_lock(const ata_pio_device_t* device,
+                                       ata_pio_channel_t** channel)
+{
+#if ATA_PIO_IRQ_MODE == 1
+    int32_t value;
+
+    *channel = ata_pio_get_channel(device);
+    if(*channel == NULL)
+    {
+        return OS_NO_ERR;
+    }
+
+    return mutex_try_pend(&(*channel)->lock, &value);
+#else
+    (void)device;
+
+    *channel = NULL;
+
+    return OS_NO_ERR;
+#endif
+}
+
+/**
+ * @brief Releases the channel acquired for a polled request.
+ *
+ * @param[in, out] channel The acquired channel, NULL if no lock was taken.
+ */
+static void ata_pio_polled_unlock(ata_pio_channel_t* channel)
+{
+    if(channel != NULL)
+    {
+        mutex_post(&channel->lock);
+    }
+}
+
+ata_pio_channel_t* ata_pio_get_irq_channel(const ata_pio_device_t* device)
+{
+#if ATA_PIO_IRQ_MODE == 1
+    ata_pio_channel_t* channel;
+
+    channel = ata_pio_get_channel(device);
+    if(channel == NULL ||
+       sched_get_system_state() != SYSTEM_STATE_RUNNING ||
+       kernel_interrupt_get_state() == 0 ||
+       sched_get_self() == NULL)
+    {
+        return NULL;
+    }
+
+    return channel;
+#else
+    (void)device;
+
+    return NULL;
+#endif
+}
+
+#if ATA_PIO_IRQ_MODE == 1
+/**
+ * @brief Executes an interrupt driven command.
+ *
+ * @details Issues the command and sleeps until the channel IRQ handler
+ * completes it. Only the first block of a write is moved by the calling thread,
+ * the device does not raise an interrupt for it. A command with no sector is a
+ * non data command.
+ *
+ * @param[in] device The device to send the command to.
+ * @param[in, out] channel The channel of the device.
+ * @param[in] sector The first sector of the range.
+ * @param[in, out] buffer The data buffer.
+ * @param[in] count The number of sectors to transfer.
+ * @param[in] command The command to issue.
+ * @param[in] block The number of sectors per data request.
+ * @param[in] write Set to 1 to write the buffer, 0 to read into it.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_ATA_DEVICE_ERROR is returned if an errored device is detected.
+ * - OS_ERR_ATA_DEVICE_NOT_PRESENT is returned if the device was not detected.
+ */
+static OS_RETURN_E ata_pio_irq_request(ata_pio_device_t* device,
+                                       ata_pio_channel_t* channel,
+                                       const uint32_t sector,
+                                       uint8_t* buffer,
+                                       const uint32_t count,
+                                       const uint8_t command,
+                                       uint32_t block,
+                                       const uint32_t write)
+{
+    uint8_t     status;
+    uint32_t    words;
+    uint32_t    int_state;
+    OS_RETURN_E err;
+
+    err = mutex_pend(&channel->lock);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    channel->buffer = buffer;
+    channel->left   = count;
+    channel->block  = block;
+    channel->write  = write;
+    channel->status = OS_NO_ERR;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &device->lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    if(count != 0)
+    {
+        /* Set first sector */
+        cpu_outb((device->type == MASTER ? 0xE0 : 0xF0) |
+                 ((sector & 0x0F000000) >> 24) ,
+                device->port + ATA_PIO_DEVICE_PORT_OFFSET);
+
+        /* Clear error */
+        cpu_outb(0, device->port + ATA_PIO_ERROR_PORT_OFFSET);
+
+        /* Set number of sectors, 0 stands for 256 sectors */
+        cpu_outb(count & 0xFF, device->port + ATA_PIO_SC_PORT_OFFSET);
+
+        /* Set LBA values */
+        cpu_outb(sector & 0x000000FF,
+                 device->port + ATA_PIO_LBALOW_PORT_OFFSET);
+        cpu_outb((sector & 0x0000FF00) >> 8,
+                device->port + ATA_PIO_LBAMID_PORT_OFFSET);
+        cpu_outb((sector & 0x00FF0000) >> 16,
+                device->port + ATA_PIO_LBAHIG_PORT_OFFSET);
+    }
+    else
+    {
+        cpu_outb((device->type == MASTER ? 0xE0 : 0xF0),
+                 device->port + ATA_PIO_DEVICE_PORT_OFFSET);
+    }
+
+    /* The first written block is not announced by an interrupt */
+    channel->active = (write == 1) ? 0 : 1;
+    cpu_outb(command, device->port + ATA_PIO_COMMAND_PORT_OFFSET);
+
+    /* The alternate status does not acknowledge the device interrupt */
+    status = cpu_inb(device->port + ATA_PIO_CONTROL_PORT_OFFSET);
+    if(status == 0x00 || status == 0xFF)
+    {
+#if ATA_PIO_KERNEL_DEBUG == 1
+        kernel_serial_debug("ATA device not present\n");
+#endif
+        channel->active = 0;
+        err = OS_ERR_ATA_DEVICE_NOT_PRESENT;
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &device->lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    /* The channel lock serializes the requests, the first written block is
+     * polled with the interrupts enabled.
+     */
+    if(err == OS_NO_ERR && write == 1)
+    {
+        while(((status & ATA_PIO_FLAG_BUSY) == ATA_PIO_FLAG_BUSY ||
+               (status & ATA_PIO_FLAG_DRQ) != ATA_PIO_FLAG_DRQ) &&
+              (status & ATA_PIO_FLAG_ERR) != ATA_PIO_FLAG_ERR)
+        {
+            status = cpu_inb(device->port + ATA_PIO_CONTROL_PORT_OFFSET);
+        }
+        if((status & ATA_PIO_FLAG_ERR) == ATA_PIO_FLAG_ERR)
+        {
+            err = OS_ERR_ATA_DEVICE_ERROR;
+        }
+        else
+        {
+            if(block > count)
+            {
+                block = count;
+            }
+            words = block * ATA_PIO_SECTOR_SIZE / sizeof(uint16_t);
+
+            /* The request state is updated before the data is sent since the
+             * following interrupt can be handled by another CPU.
+             */
+            channel->buffer = buffer + block * ATA_PIO_SECTOR_SIZE;
+            channel->left   = count - block;
+            channel->active = 1;
+
+            cpu_outsw(device->port + ATA_PIO_DATA_PORT_OFFSET, buffer, words);
+        }
+    }
+
+    if(err == OS_NO_ERR)
+    {
+        err = sem_pend(&channel->done);
+        if(err == OS_NO_ERR)
+        {
+            err = channel->status;
+        }
+    }
+
+#if ATA_PIO_KERNEL_DEBUG == 1
+    if(err != OS_NO_ERR)
+    {
+        kernel_serial_debug("ATA device request error 0x%p (%s) [%d]\n",
+                            device->port,
+                            ((device->type == MASTER) ? "MASTER" : "SLAVE"),
+                            err);
+    }
+#endif
+
+    mutex_post(&channel->lock);
+
+    return err;
+}
+#endif
+
 #define DETECT_DEVICE(device, err) {                                           \
     err = ata_pio_identify_device(device);                                     \
     if(err == OS_NO_ERR)                                                       \
@@ -126,6 +680,251 @@ OS_RETURN_E ata_pio_init(void)
     ata_pio_test();
 #endif
 
+    /* Detection and boot time transfers are polled, interrupts are used once
+     * the scheduler runs.
+     */
+#if ATA_PIO_IRQ_MODE == 1
+#if ATA_PIO_DETECT_PRIMARY_PORT == 1
+    if(err == OS_NO_ERR)
+    {
+        err = ata_pio_init_channel(&primary_channel, PRIMARY_PORT,
+                                   ATA_PRIMARY_IRQ_LINE,
+                                   ata_pio_primary_handler);
+    }
+#endif
+#if ATA_PIO_DETECT_SECONDARY_PORT == 1
+    if(err == OS_NO_ERR)
+    {
+        err = ata_pio_init_channel(&secondary_channel, SECONDARY_PORT,
+                                   ATA_SECONDARY_IRQ_LINE,
+                                   ata_pio_secondary_handler);
+    }
+#endif
+#endif
+
+    return err;
+}
+
+/**
+ * @brief Enables the multiple mode of a device.
+ *
+ * @details Sends the SET MULTIPLE MODE command to the device. On success, the
+ * device transfers the given number of sectors per data request for the READ
+ * and WRITE MULTIPLE commands.
+ *
+ * @param[in, out] device The device to configure.
+ * @param[in] sectors The number of sectors per data request.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_ATA_DEVICE_ERROR is returned if the device rejected the command.
+ */
+static OS_RETURN_E ata_pio_set_multiple(ata_pio_device_t* device,
+                                        const uint16_t sectors)
+{
+    uint8_t status;
+
+    cpu_outb(device->type == MASTER ? 0xE0 : 0xF0,
+             device->port + ATA_PIO_DEVICE_PORT_OFFSET);
+    cpu_outb(sectors & 0xFF, device->port + ATA_PIO_SC_PORT_OFFSET);
+    cpu_outb(ATA_PIO_SET_MULTIPLE_COMMAND,
+             device->port + ATA_PIO_COMMAND_PORT_OFFSET);
+
+    status = cpu_inb(device->port + ATA_PIO_COMMAND_PORT_OFFSET);
+    while((status & ATA_PIO_FLAG_BUSY) == ATA_PIO_FLAG_BUSY)
+    {
+        status = cpu_inb(device->port + ATA_PIO_COMMAND_PORT_OFFSET);
+    }
+
+    if((status & ATA_PIO_FLAG_ERR) == ATA_PIO_FLAG_ERR)
+    {
+        device->multiple_sectors = 0;
+        return OS_ERR_ATA_DEVICE_ERROR;
+    }
+
+    device->multiple_sectors = sectors;
+
+    return OS_NO_ERR;
+}
+
+/**
+ * @brief Transfers a range of sectors with a single command.
+ *
+ * @details Issues one read or write command for up to
+ * ATA_PIO_MAX_SECTORS_PER_COMMAND sectors and moves the data of each data
+ * request with a single string IO instruction. The transfer is interrupt driven
+ * when the calling thread can sleep, polled otherwise.
+ *
+ * @param[in] device The device to transfer the data with.
+ * @param[in] sector The first sector of the range.
+ * @param[in, out] buffer The data buffer.
+ * @param[in] count The number of sectors to transfer.
+ * @param[in] write Set to 1 to write the buffer, 0 to read into it.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_ATA_DEVICE_ERROR is returned if an errored device is detected.
+ * - OS_ERR_ATA_DEVICE_NOT_PRESENT is returned if the device was not detected.
+ */
+static OS_RETURN_E ata_pio_transfer(ata_pio_device_t* device,
+                                    const uint32_t sector,
+                                    uint8_t* buffer,
+                                    const uint32_t count,
+                                    const uint32_t write)
+{
+    uint32_t    block;
+    uint32_t    left;
+    uint32_t    words;
+    uint8_t     command;
+    uint8_t     status;
+    uint32_t    int_state;
+    OS_RETURN_E err;
+    ata_pio_channel_t* channel;
+
+    /* Multiple mode transfers a block of sectors per data request */
+    if(device->multiple_sectors != 0 &&
+       device->multiple_sectors <= ATA_PIO_MAX_SECTORS_PER_COMMAND)
+    {
+        block   = device->multiple_sectors;
+        command = write ? ATA_PIO_WRITE_MULTIPLE_COMMAND :
+                          ATA_PIO_READ_MULTIPLE_COMMAND;
+    }
+    else
+    {
+        block   = 1;
+        command = write ? ATA_PIO_WRITE_SECTOR_COMMAND :
+                          ATA_PIO_READ_SECTOR_COMMAND;
+    }
+
+#if ATA_PIO_IRQ_MODE == 1
+    channel = ata_pio_get_irq_channel(device);
+    if(channel != NULL)
+    {
+        return ata_pio_irq_request(device, channel, sector, buffer, count,
+                                   command, block, write);
+    }
+#endif
+
+    err = ata_pio_polled_lock(device, &channel);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &device->lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    /* Set first sector */
+    cpu_outb((device->type == MASTER ? 0xE0 : 0xF0) |
+             ((sector & 0x0F000000) >> 24) ,
+            device->port + ATA_PIO_DEVICE_PORT_OFFSET);
+
+    /* Clear error */
+    cpu_outb(0, device->port + ATA_PIO_ERROR_PORT_OFFSET);
+
+    /* Set number of sectors, 0 stands for 256 sectors */
+    cpu_outb(count & 0xFF, device->port + ATA_PIO_SC_PORT_OFFSET);
+
+    /* Set LBA values */
+    cpu_outb(sector & 0x000000FF, device->port + ATA_PIO_LBALOW_PORT_OFFSET);
+    cpu_outb((sector & 0x0000FF00) >> 8,
+            device->port + ATA_PIO_LBAMID_PORT_OFFSET);
+    cpu_outb((sector & 0x00FF0000) >> 16,
+            device->port + ATA_PIO_LBAHIG_PORT_OFFSET);
+
+    cpu_outb(command, device->port + ATA_PIO_COMMAND_PORT_OFFSET);
+
+    /* Once the channel lock serializes the requests, the data requests are
+     * polled with the caller interrupt state.
+     */
+    if(channel != NULL)
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &device->lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+    }
+
+    left = count;
+    while(left != 0)
+    {
+        /* Wait for the data request */
+        status = cpu_inb(device->port + ATA_PIO_COMMAND_PORT_OFFSET);
+        if(status == 0x00)
+        {
+#if ATA_PIO_KERNEL_DEBUG == 1
+            kernel_serial_debug("ATA device not present\n");
+#endif
+            err = OS_ERR_ATA_DEVICE_NOT_PRESENT;
+            break;
+        }
+        while(((status & ATA_PIO_FLAG_BUSY) == ATA_PIO_FLAG_BUSY ||
+               (status & ATA_PIO_FLAG_DRQ) != ATA_PIO_FLAG_DRQ) &&
+              (status & ATA_PIO_FLAG_ERR) != ATA_PIO_FLAG_ERR)
+        {
+            status = cpu_inb(device->port + ATA_PIO_COMMAND_PORT_OFFSET);
+        }
+        if((status & ATA_PIO_FLAG_ERR) == ATA_PIO_FLAG_ERR)
+        {
+#if ATA_PIO_KERNEL_DEBUG == 1
+            kernel_serial_debug("ATA device transfer error 0x%p (%s)\n",
+                                device->port,
+                                ((device->type == MASTER) ?
+                                "MASTER" : "SLAVE"));
+#endif
+            err = OS_ERR_ATA_DEVICE_ERROR;
+            break;
+        }
+
+        /* The last block can be shorter than the multiple block size */
+        if(block > left)
+        {
+            block = left;
+        }
+        words = block * ATA_PIO_SECTOR_SIZE / sizeof(uint16_t);
+
+        if(write)
+        {
+            cpu_outsw(device->port + ATA_PIO_DATA_PORT_OFFSET, buffer, words);
+        }
+        else
+        {
+            cpu_insw(device->port + ATA_PIO_DATA_PORT_OFFSET, buffer, words);
+        }
+
+        buffer += block * ATA_PIO_SECTOR_SIZE;
+        left   -= block;
+    }
+
+    /* Wait for the last written block to be processed */
+    if(err == OS_NO_ERR && write)
+    {
+        status = cpu_inb(device->port + ATA_PIO_COMMAND_PORT_OFFSET);
+        while((status & ATA_PIO_FLAG_BUSY) == ATA_PIO_FLAG_BUSY)
+        {
+            status = cpu_inb(device->port + ATA_PIO_COMMAND_PORT_OFFSET);
+        }
+        if((status & ATA_PIO_FLAG_ERR) == ATA_PIO_FLAG_ERR)
+        {
+            err = OS_ERR_ATA_DEVICE_ERROR;
+        }
+    }
+
+    if(channel == NULL)
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &device->lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+    }
+
+    ata_pio_polled_unlock(channel);
+
     return err;
 }
 
@@ -135,6 +934,7 @@ OS_RETURN_E ata_pio_identify_device(ata_pio_device_t* device)
     uint16_t i;
     char     ata_pio_str[513] = {0};
     uint16_t ata_pio_index;
+    uint16_t multiple;
 
 #if ATA_PIO_KERNEL_DEBUG == 1
     kernel_serial_debug("IDENTIFY ATA 0x%p %s\n",
@@ -201,6 +1001,7 @@ OS_RETURN_E ata_pio_identify_device(ata_pio_device_t* device)
 
     /* The device data information is now ready to be read */
     ata_pio_index = 0;
+    multiple      = 0;
     for(i = 0; i < 256; ++i)
     {
         uint16_t data;
@@ -208,6 +1009,11 @@ OS_RETURN_E ata_pio_identify_device(ata_pio_device_t* device)
         data = cpu_inw(device->port + ATA_PIO_DATA_PORT_OFFSET);
         ata_pio_str[ata_pio_index++] = (data >> 8) & 0xFF;
         ata_pio_str[ata_pio_index++] = data & 0xFF;
+
+        if(i == ATA_PIO_IDENTIFY_MULTIPLE_WORD)
+        {
+            multiple = data & 0xFF;
+        }
     }
     (void)ata_pio_str;
 
@@ -215,6 +1021,22 @@ OS_RETURN_E ata_pio_identify_device(ata_pio_device_t* device)
     kernel_serial_debug("ATA STR: %s\n", ata_pio_str);
 #endif
 
+    /* Enable multiple mode with the largest supported block */
+    device->multiple_sectors = 0;
+    if(multiple != 0 && ata_pio_set_multiple(device, multiple) != OS_NO_ERR)
+    {
+#if ATA_PIO_KERNEL_DEBUG == 1
+        kernel_serial_debug("ATA multiple mode rejected 0x%p (%s)\n",
+                            device->port,
+                            ((device->type == MASTER) ? "MASTER" : "SLAVE"));
+#endif
+    }
+
+#if ATA_PIO_KERNEL_DEBUG == 1
+    kernel_serial_debug("ATA multiple mode: %d sectors\n",
+                        device->multiple_sectors);
+#endif
+
     return OS_NO_ERR;
 }
 
@@ -225,6 +1047,10 @@ OS_RETURN_E ata_pio_read_sector(ata_pio_device_t* device, const uint32_t sector,
     uint8_t     status;
     OS_RETURN_E err;
     uint32_t    int_state;
+    ata_pio_channel_t* channel;
+#if ATA_PIO_IRQ_MODE == 1
+    uint8_t     sector_buffer[ATA_PIO_SECTOR_SIZE];
+#endif
 
 #if ATA_PIO_KERNEL_DEBUG == 1
     kernel_serial_debug("ATA read request device 0x%p %s, sector 0x%p,\
@@ -247,6 +1073,29 @@ size %d\n", device->port, ((device->type == MASTER) ? "MASTER" : "SLAVE"),
         return OS_ERR_ATA_SIZE_TO_HUGE;
     }
 
+#if ATA_PIO_IRQ_MODE == 1
+    if(ata_pio_get_irq_channel(device) != NULL)
+    {
+        if(size == ATA_PIO_SECTOR_SIZE)
+        {
+            return ata_pio_transfer(device, sector, buffer, 1, 0);
+        }
+
+        err = ata_pio_transfer(device, sector, sector_buffer, 1, 0);
+        if(err == OS_NO_ERR)
+        {
+            memcpy(buffer, sector_buffer, size);
+        }
+        return err;
+    }
+#endif
+
+    err = ata_pio_polled_lock(device, &channel);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
 #if MAX_CPU_COUNT > 1
     ENTER_CRITICAL(int_state, &device->lock);
 #else
@@ -289,6 +1138,8 @@ size %d\n", device->port, ((device->type == MASTER) ? "MASTER" : "SLAVE"),
         EXIT_CRITICAL(int_state);
 #endif
 
+        ata_pio_polled_unlock(channel);
+
         return OS_ERR_ATA_DEVICE_NOT_PRESENT;
     }
     while(((status & ATA_PIO_FLAG_BUSY) == ATA_PIO_FLAG_BUSY)
@@ -312,6 +1163,8 @@ size %d\n", device->port, ((device->type == MASTER) ? "MASTER" : "SLAVE"),
         EXIT_CRITICAL(int_state);
 #endif
 
+        ata_pio_polled_unlock(channel);
+
         return OS_ERR_ATA_DEVICE_ERROR;
     }
 
@@ -349,6 +1202,8 @@ size %d\n", device->port, ((device->type == MASTER) ? "MASTER" : "SLAVE"),
     EXIT_CRITICAL(int_state);
 #endif
 
+    ata_pio_polled_unlock(channel);
+
     return err;
 }
 
@@ -356,8 +1211,13 @@ OS_RETURN_E ata_pio_write_sector(ata_pio_device_t* device,
                                  const uint32_t sector,
                                  const void* buffer, const uint32_t size)
 {
-    uint32_t i;
-    uint32_t int_state;
+    uint32_t    i;
+    uint32_t    int_state;
+    OS_RETURN_E err;
+    ata_pio_channel_t* channel;
+#if ATA_PIO_IRQ_MODE == 1
+    uint8_t     sector_buffer[ATA_PIO_SECTOR_SIZE];
+#endif
 
 #if ATA_PIO_KERNEL_DEBUG == 1
     kernel_serial_debug("ATA write request device 0x%p %s, sector 0x%p,\
@@ -378,6 +1238,30 @@ size %d\n", device->port, ((device->type == MASTER) ? "MASTER" : "SLAVE"),
         return OS_ERR_ATA_SIZE_TO_HUGE;
     }
 
+#if ATA_PIO_IRQ_MODE == 1
+    if(ata_pio_get_irq_channel(device) != NULL)
+    {
+        /* Add padding to the sector */
+        memcpy(sector_buffer, buffer, size);
+        memset(sector_buffer + size, 0, ATA_PIO_SECTOR_SIZE - size);
+
+        err = ata_pio_transfer(device, sector, sector_buffer, 1, 1);
+        if(err != OS_NO_ERR)
+        {
+            return err;
+        }
+
+        /* Flush write */
+        return ata_pio_flush(device);
+    }
+#endif
+
+    err = ata_pio_polled_lock(device, &channel);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
 #if MAX_CPU_COUNT > 1
     ENTER_CRITICAL(int_state, &device->lock);
 #else
@@ -439,6 +1323,100 @@ size %d\n", device->port, ((device->type == MASTER) ? "MASTER" : "SLAVE"),
     EXIT_CRITICAL(int_state);
 #endif
 
+    ata_pio_polled_unlock(channel);
+
+    /* Flush write */
+    return ata_pio_flush(device);
+}
+
+OS_RETURN_E ata_pio_read_sectors(ata_pio_device_t* device,
+                                 const uint32_t sector,
+                                 void* buffer, const uint32_t count)
+{
+    uint32_t    done;
+    uint32_t    chunk;
+    OS_RETURN_E err;
+
+    if(device == NULL || buffer == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+#if ATA_PIO_KERNEL_DEBUG == 1
+    kernel_serial_debug("ATA read range request device 0x%p %s, sector 0x%p,\
+count %d\n", device->port, ((device->type == MASTER) ? "MASTER" : "SLAVE"),
+                        sector,
+                        count);
+#endif
+
+    /* Check the range fits in 28 bits LBA */
+    if(sector > 0x0FFFFFFF || count > 0x10000000 - sector)
+    {
+        return OS_ERR_ATA_BAD_SECTOR_NUMBER;
+    }
+
+    err = OS_NO_ERR;
+    for(done = 0; done < count && err == OS_NO_ERR; done += chunk)
+    {
+        chunk = count - done;
+        if(chunk > ATA_PIO_MAX_SECTORS_PER_COMMAND)
+        {
+            chunk = ATA_PIO_MAX_SECTORS_PER_COMMAND;
+        }
+
+        err = ata_pio_transfer(device, sector + done,
+                               (uint8_t*)buffer + done * ATA_PIO_SECTOR_SIZE,
+                               chunk, 0);
+    }
+
+    return err;
+}
+
+OS_RETURN_E ata_pio_write_sectors(ata_pio_device_t* device,
+                                  const uint32_t sector,
+                                  const void* buffer, const uint32_t count)
+{
+    uint32_t    done;
+    uint32_t    chunk;
+    OS_RETURN_E err;
+
+    if(device == NULL || buffer == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+#if ATA_PIO_KERNEL_DEBUG == 1
+    kernel_serial_debug("ATA write range request device 0x%p %s, sector 0x%p,\
+count %d\n", device->port, ((device->type == MASTER) ? "MASTER" : "SLAVE"),
+                        sector,
+                        count);
+#endif
+
+    /* Check the range fits in 28 bits LBA */
+    if(sector > 0x0FFFFFFF || count > 0x10000000 - sector)
+    {
+        return OS_ERR_ATA_BAD_SECTOR_NUMBER;
+    }
+
+    err = OS_NO_ERR;
+    for(done = 0; done < count && err == OS_NO_ERR; done += chunk)
+    {
+        chunk = count - done;
+        if(chunk > ATA_PIO_MAX_SECTORS_PER_COMMAND)
+        {
+            chunk = ATA_PIO_MAX_SECTORS_PER_COMMAND;
+        }
+
+        err = ata_pio_transfer(device, sector + done,
+                               (uint8_t*)buffer + done * ATA_PIO_SECTOR_SIZE,
+                               chunk, 1);
+    }
+
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
     /* Flush write */
     return ata_pio_flush(device);
 }
@@ -448,6 +1426,7 @@ OS_RETURN_E ata_pio_flush(ata_pio_device_t* device)
     uint8_t     status;
     uint32_t    int_state;
     OS_RETURN_E err;
+    ata_pio_channel_t* channel;
 
     err = OS_NO_ERR;
 
@@ -457,6 +1436,21 @@ OS_RETURN_E ata_pio_flush(ata_pio_device_t* device)
                         ((device->type == MASTER) ? "MASTER" : "SLAVE"));
 #endif
 
+#if ATA_PIO_IRQ_MODE == 1
+    channel = ata_pio_get_irq_channel(device);
+    if(channel != NULL)
+    {
+        return ata_pio_irq_request(device, channel, 0, NULL, 0,
+                                   ATA_PIO_FLUSH_SECTOR_COMMAND, 0, 0);
+    }
+#endif
+
+    err = ata_pio_polled_lock(device, &channel);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
 #if MAX_CPU_COUNT > 1
     ENTER_CRITICAL(int_state, &device->lock);
 #else
@@ -486,6 +1480,8 @@ OS_RETURN_E ata_pio_flush(ata_pio_device_t* device)
      EXIT_CRITICAL(int_state);
 #endif
 
+        ata_pio_polled_unlock(channel);
+
         return OS_ERR_ATA_DEVICE_NOT_PRESENT;
     }
 
@@ -504,6 +1500,8 @@ OS_RETURN_E ata_pio_flush(ata_pio_device_t* device)
         EXIT_CRITICAL(int_state);
 #endif
 
+        ata_pio_polled_unlock(channel);
+
         return OS_ERR_ATA_DEVICE_ERROR;
     }
 
@@ -528,6 +1526,8 @@ OS_RETURN_E ata_pio_flush(ata_pio_device_t* device)
         EXIT_CRITICAL(int_state);
 #endif
 
+        ata_pio_polled_unlock(channel);
+
         return OS_ERR_ATA_DEVICE_ERROR;
     }
 
@@ -537,5 +1537,7 @@ OS_RETURN_E ata_pio_flush(ata_pio_device_t* device)
     EXIT_CRITICAL(int_state);
 #endif
 
+    ata_pio_polled_unlock(channel);
+
     return err;
 }
\ No newline at end of file
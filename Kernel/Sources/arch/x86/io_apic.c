@@ -13,7 +13,8 @@
  *
  * @details IO-APIC (IO advanced programmable interrupt controler) driver.
  * Allows to remmap the IO-APIC IRQ, set the IRQs mask and manage EoI for the
- * X86 IO-APIC.
+ * X86 IO-APIC. The driver keeps the mask and the destination of each IRQ, the
+ * redirection entries are always written from this state.
  *
  * @warning This driver also use the LAPIC driver to function correctly.
  *
@@ -26,6 +27,7 @@
 #include <lib/stddef.h>           /* Standard definitions */
 #include <io/kernel_output.h>     /* Kernel output methods */
 #include <acpi.h>                 /* ACPI driver */
+#include <cpu.h>                  /* cpu_get_booted_cpu_count */
 #include <lapic.h>                /* LAPIC driver */
 #include <pic.h>                  /* PIC driver */
 #include <memory/paging.h>        /* Memory management */
@@ -43,6 +45,26 @@
 /* Header file */
 #include <io_apic.h>
 
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/** @brief IO-APIC IRQ routing state. */
+struct io_apic_irq
+{
+    /** @brief Set to 1 when the IRQ is not masked. */
+    uint32_t unmasked;
+    /** @brief CPUs that receive the IRQ, bit N is set for CPU N. */
+    uint32_t cpu_mask;
+    /** @brief Set to 1 when the affinity was set, the IRQ is not balanced. */
+    uint32_t pinned;
+};
+
+/**
+ * @brief Defines io_apic_irq_t type as a shorcut for struct io_apic_irq.
+ */
+typedef struct io_apic_irq io_apic_irq_t;
+
 /*******************************************************************************
  * GLOBAL VARIABLES
  ******************************************************************************/
@@ -56,6 +78,9 @@ static const uint8_t* io_apic_base_addr;
 /** @brief IO-APIC IRQ redirection count. */
 static uint32_t max_redirect_count;
 
+/** @brief IO-APIC IRQs routing states. */
+static io_apic_irq_t irqs[IO_APIC_MAX_IRQ_LINE + 1];
+
 /** @brief IO_PIC driver instance. */
 interrupt_driver_t io_apic_driver = {
     .driver_set_irq_mask     = io_apic_set_irq_mask,
@@ -102,6 +127,76 @@ __inline__ static uint32_t io_apic_read(const uint32_t reg)
     return mapped_io_read_32((uint32_t*)(io_apic_base_addr + IOWIN));
 }
 
+/**
+ * @brief Writes the redirection entry of an IRQ from its routing state. Must be
+ * called in the IO-APIC critical section.
+ *
+ * @param[in] irq_number The IRQ number to write the entry of.
+ */
+static void io_apic_write_entry(const uint32_t irq_number)
+{
+    const local_apic_t** lapics;
+    const io_apic_irq_t* irq;
+    uint32_t             entry_lo;
+    uint32_t             entry_hi;
+    uint32_t             actual_irq;
+
+    irq = &irqs[irq_number];
+
+    /* Set the interrupt line */
+    entry_lo = irq_number + INT_IOAPIC_IRQ_OFFSET;
+
+    /* Set the destination */
+    if((irq->cpu_mask & (irq->cpu_mask - 1)) == 0)
+    {
+        lapics   = acpi_get_cpu_lapics();
+        entry_hi = lapics[__builtin_ctz(irq->cpu_mask)]->apic_id <<
+                   IO_APIC_DEST_SHIFT;
+    }
+    else
+    {
+        entry_lo |= IO_APIC_DELIVERY_LOWEST | IO_APIC_DEST_LOGICAL;
+        entry_hi  = irq->cpu_mask << IO_APIC_DEST_SHIFT;
+    }
+
+    /* Set enable mask */
+    if(irq->unmasked == 0)
+    {
+        entry_lo |= IO_APIC_IRQ_MASKED;
+    }
+
+    /* Get the remapped value */
+    actual_irq = acpi_get_remmaped_irq(irq_number);
+
+    /* The destination is written first, the entry is complete when the low
+     * word unmasks it.
+     */
+    io_apic_write(IOREDTBL + actual_irq * 2 + 1, entry_hi);
+    io_apic_write(IOREDTBL + actual_irq * 2, entry_lo);
+}
+
+/**
+ * @brief Returns the mask of the booted CPUs.
+ *
+ * @return The mask of the booted CPUs, bit N is set for CPU N.
+ */
+static uint32_t io_apic_get_booted_mask(void)
+{
+    uint32_t count;
+
+    count = cpu_get_booted_cpu_count();
+    if(count == 0)
+    {
+        count = 1;
+    }
+    if(count > MAX_CPU_COUNT)
+    {
+        count = MAX_CPU_COUNT;
+    }
+
+    return count >= 32 ? 0xFFFFFFFF : (1U << count) - 1;
+}
+
 OS_RETURN_E io_apic_init(void)
 {
 #if IOAPIC_KERNEL_DEBUG == 1
@@ -137,10 +232,18 @@ OS_RETURN_E io_apic_init(void)
     read_count = io_apic_read(IOAPICVER);
 
     max_redirect_count = ((read_count >> 16) & 0xff) + 1;
+    if(max_redirect_count > IO_APIC_MAX_IRQ_LINE + 1)
+    {
+        max_redirect_count = IO_APIC_MAX_IRQ_LINE + 1;
+    }
 
-    /* Redirect and disable all interrupts */
+    /* Redirect and disable all interrupts, the boot CPU receives the IRQs */
     for (i = 0; i < max_redirect_count; ++i)
     {
+        irqs[i].unmasked = 0;
+        irqs[i].cpu_mask = 1;
+        irqs[i].pinned   = 0;
+
         err = io_apic_set_irq_mask(i, 0);
         if(err != OS_NO_ERR)
         {
@@ -161,9 +264,6 @@ OS_RETURN_E io_apic_init(void)
 OS_RETURN_E io_apic_set_irq_mask(const uint32_t irq_number,
                                  const uint32_t enabled)
 {
-    uint32_t entry_lo   = 0;
-    uint32_t entry_hi   = 0;
-    uint32_t actual_irq = 0;
     uint32_t int_state;
 
     if(irq_number >= max_redirect_count)
@@ -171,23 +271,14 @@ OS_RETURN_E io_apic_set_irq_mask(const uint32_t irq_number,
         return OS_ERR_NO_SUCH_IRQ_LINE;
     }
 
-    /* Set the interrupt line */
-    entry_lo |= irq_number + INT_IOAPIC_IRQ_OFFSET;
-
-    /* Set enable mask */
-    entry_lo |= (~enabled & 0x1) << 16;
-
 #if MAX_CPU_COUNT > 1
     ENTER_CRITICAL(int_state, &lock);
 #else
     ENTER_CRITICAL(int_state);
 #endif
 
-    /* Get the remapped value */
-    actual_irq = acpi_get_remmaped_irq(irq_number);
-
-    io_apic_write(IOREDTBL + actual_irq * 2, entry_lo);
-    io_apic_write(IOREDTBL + actual_irq * 2 + 1, entry_hi);
+    irqs[irq_number].unmasked = enabled & 0x1;
+    io_apic_write_entry(irq_number);
 
 #if MAX_CPU_COUNT > 1
     EXIT_CRITICAL(int_state, &lock);
@@ -197,7 +288,8 @@ OS_RETURN_E io_apic_set_irq_mask(const uint32_t irq_number,
 
 #if IOAPIC_KERNEL_DEBUG == 1
     kernel_serial_debug("IOAPIC mask IRQ %d (%d): %d\n",
-                        irq_number, actual_irq, enabled);
+                        irq_number, acpi_get_remmaped_irq(irq_number),
+                        enabled);
 #endif
 
     return OS_NO_ERR;
@@ -261,6 +353,145 @@ int32_t io_apic_get_irq_int_line(const uint32_t irq_number)
     return irq_number + INT_IOAPIC_IRQ_OFFSET;
 }
 
+OS_RETURN_E io_apic_set_irq_affinity(const uint32_t irq_number,
+                                     const uint32_t cpu_id)
+{
+    if(cpu_id >= MAX_CPU_COUNT)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    return io_apic_set_irq_affinity_mask(irq_number, 1U << cpu_id);
+}
+
+OS_RETURN_E io_apic_set_irq_affinity_mask(const uint32_t irq_number,
+                                          const uint32_t cpu_mask)
+{
+    uint32_t int_state;
+
+    if(enabled == 0)
+    {
+        return OS_ERR_NOT_SUPPORTED;
+    }
+    if(irq_number >= max_redirect_count)
+    {
+        return OS_ERR_NO_SUCH_IRQ_LINE;
+    }
+    if(cpu_mask == 0 || (cpu_mask & ~io_apic_get_booted_mask()) != 0)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    /* The logical destinations only address the first CPUs */
+    if((cpu_mask & (cpu_mask - 1)) != 0 &&
+       (cpu_mask >> LAPIC_LOGICAL_CPU_COUNT) != 0)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    irqs[irq_number].cpu_mask = cpu_mask;
+    irqs[irq_number].pinned   = 1;
+    io_apic_write_entry(irq_number);
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+#if IOAPIC_KERNEL_DEBUG == 1
+    kernel_serial_debug("IOAPIC IRQ %d affinity 0x%x\n",
+                        irq_number, cpu_mask);
+#endif
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E io_apic_get_irq_affinity(const uint32_t irq_number,
+                                     uint32_t* cpu_mask)
+{
+    if(cpu_mask == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    if(irq_number >= max_redirect_count)
+    {
+        return OS_ERR_NO_SUCH_IRQ_LINE;
+    }
+
+    *cpu_mask = irqs[irq_number].cpu_mask;
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E io_apic_balance_irqs(const uint32_t reserved_cpus)
+{
+    uint32_t cpu_mask;
+    uint32_t cpu_id;
+    uint32_t unmasked;
+    uint32_t int_state;
+    uint32_t i;
+
+    if(enabled == 0)
+    {
+        return OS_ERR_NOT_SUPPORTED;
+    }
+
+    cpu_mask = io_apic_get_booted_mask();
+    if((cpu_mask & ~reserved_cpus) != 0)
+    {
+        cpu_mask &= ~reserved_cpus;
+    }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    /* Deal the enabled IRQs first so they are spread evenly */
+    cpu_id = 0;
+    for(unmasked = 2; unmasked > 0; --unmasked)
+    {
+        for(i = 0; i < max_redirect_count; ++i)
+        {
+            if(irqs[i].pinned == 1 || irqs[i].unmasked != unmasked - 1)
+            {
+                continue;
+            }
+
+            while((cpu_mask & (1U << cpu_id)) == 0)
+            {
+                cpu_id = (cpu_id + 1) % MAX_CPU_COUNT;
+            }
+
+            irqs[i].cpu_mask = 1U << cpu_id;
+            io_apic_write_entry(i);
+
+#if IOAPIC_KERNEL_DEBUG == 1
+            kernel_serial_debug("IOAPIC IRQ %d balanced to CPU %d\n",
+                                i, cpu_id);
+#endif
+
+            cpu_id = (cpu_id + 1) % MAX_CPU_COUNT;
+        }
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return OS_NO_ERR;
+}
+
 uint8_t io_apic_capable(void)
 {
     /* Check IO-APIC support */
@@ -18,12 +18,18 @@
  ******************************************************************************/
 
 #include <io/graphic.h>           /* Graphic API */
+#include <io/kernel_output.h>     /* Kernel output methods */
 #include <cpu.h>                  /* CPU management */
 #include <interrupt/interrupts.h> /* Interrupt management */
 #include <interrupt_settings.h>   /* Interrupt settings */
 #include <lib/stdint.h>           /* Generic int types */
 #include <lib/stddef.h>           /* Standard definitions */
 #include <lib/string.h>           /* String manipulation */
+#include <sync/critical.h>        /* Critical sections */
+#include <core/kernel_queue.h>    /* Kernel queues */
+#include <core/scheduler.h>       /* Kernel scheduler */
+#include <core/panic.h>           /* Kernel panic */
+#include <time/time_management.h> /* Uptime */
 
 /* UTK configuration file */
 #include <config.h>
@@ -227,6 +233,188 @@ static const key_mapper_t qwerty_map =
  * FUNCTIONS
  ******************************************************************************/
 
+/**
+ * @brief Stores a character in the keyboard ring buffer.
+ *
+ * @details The characters typed while the ring buffer is full are dropped.
+ *
+ * @param[in] character The character to store.
+ */
+static void keyboard_push_char(const char character)
+{
+    uint32_t int_state;
+    uint32_t next;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &kbd_buf.lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    next = (kbd_buf.head + 1) & (KEYBOARD_BUFFER_SIZE - 1);
+    if(next == kbd_buf.tail)
+    {
+        ++kbd_buf.dropped;
+    }
+    else
+    {
+        kbd_buf.char_buf[kbd_buf.head] = character;
+        kbd_buf.head = next;
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &kbd_buf.lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+}
+
+/**
+ * @brief Wakes up all the threads waiting for keyboard inputs.
+ */
+static void keyboard_wake_readers(void)
+{
+    kernel_queue_node_t* waiter_node;
+    uint32_t             int_state;
+    OS_RETURN_E          err;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &kbd_buf.lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    while(kbd_buf.waiters.size != 0)
+    {
+        waiter_node = kernel_queue_pop(&kbd_buf.waiters, &err);
+        if(err == OS_NO_ERR)
+        {
+            err = sched_unlock_thread(waiter_node->data,
+                                      THREAD_WAIT_TYPE_IO_KEYBOARD, 0);
+        }
+        if(err != OS_NO_ERR)
+        {
+#if MAX_CPU_COUNT > 1
+            EXIT_CRITICAL(int_state, &kbd_buf.lock);
+#else
+            EXIT_CRITICAL(int_state);
+#endif
+            kernel_error("Could not unlock keyboard reader[%d]\n", err);
+            kernel_panic(err);
+        }
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &kbd_buf.lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+}
+
+/**
+ * @brief Copies the characters of the keyboard ring buffer.
+ *
+ * @param[out] buffer The buffer that receives the characters.
+ * @param[in] size The size of the buffer.
+ *
+ * @return The number of characters copied.
+ */
+static size_t keyboard_pop(char* buffer, const size_t size)
+{
+    uint32_t int_state;
+    size_t   read;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &kbd_buf.lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    read = 0;
+    while(read < size && kbd_buf.tail != kbd_buf.head)
+    {
+        buffer[read++] = kbd_buf.char_buf[kbd_buf.tail];
+        kbd_buf.tail = (kbd_buf.tail + 1) & (KEYBOARD_BUFFER_SIZE - 1);
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &kbd_buf.lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return read;
+}
+
+/**
+ * @brief Blocks the calling thread until the keyboard ring buffer is not
+ * empty.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if characters are available.
+ * - OS_ERR_UNAUTHORIZED_ACTION is returned if the caller cannot sleep.
+ */
+static OS_RETURN_E keyboard_wait_input(void)
+{
+    kernel_queue_node_t  waiter_node;
+    kernel_queue_node_t* thread_node;
+    uint32_t             int_state;
+    OS_RETURN_E          err;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &kbd_buf.lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    /* The interrupt handler cannot store a character before we are queued */
+    if(kbd_buf.tail != kbd_buf.head)
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &kbd_buf.lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+        return OS_NO_ERR;
+    }
+
+    thread_node = sched_lock_thread(THREAD_WAIT_TYPE_IO_KEYBOARD);
+    if(thread_node == NULL)
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &kbd_buf.lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+        return OS_ERR_UNAUTHORIZED_ACTION;
+    }
+
+    /* The waiter node stays valid on our stack until we are woken up */
+    kernel_queue_init_node(&waiter_node, thread_node);
+
+    err = kernel_queue_push(&waiter_node, &kbd_buf.waiters);
+    if(err != OS_NO_ERR)
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &kbd_buf.lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+        kernel_error("Could not enqueue keyboard reader[%d]\n", err);
+        kernel_panic(err);
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &kbd_buf.lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    sched_schedule();
+
+    return OS_NO_ERR;
+}
+
 /**
  * @brief Parses a keyboard keycode.
  * 
@@ -238,7 +426,6 @@ static const key_mapper_t qwerty_map =
 static void manage_keycode(const int32_t keycode)
 {
     char    character;
-    //OS_RETURN_E err;
 
     /* Manage push of release */
     if(keycode > 0)
@@ -273,62 +460,8 @@ static void manage_keycode(const int32_t keycode)
                          qwerty_map.shifted[keycode] :
                          qwerty_map.regular[keycode];
 
-            /* Manage user buffer */
-            if(kbd_buf.type != 0)
-            {
-                if(kbd_buf.type == 1)
-                {
-                    /* read */
-                    if(character == KEY_RETURN)
-                    {
-                        if(kbd_buf.read < kbd_buf.read_size)
-                        {
-                            kbd_buf.char_buf[kbd_buf.read++] = character;
-                        }
-
-                        kbd_buf.type = 0;
-#if 0
-                        err = sem_post(&kbd_buf.sem);
-                        if(err != OS_NO_ERR)
-                        {
-                            kernel_error("Keyboard driver failure");
-                            kernel_panic(err);
-                        }
-#endif
-                    }
-                    else if(character == KEY_BACKSPACE)
-                    {
-                        if(kbd_buf.read > 0)
-                        {
-                            --kbd_buf.read;
-                        }
-
-                        kbd_buf.char_buf[kbd_buf.read] = 0;
-                    }
-                    else if(kbd_buf.read < kbd_buf.read_size)
-                    {
-                        kbd_buf.char_buf[kbd_buf.read++] = character;
-                    }
-                }
-                else if(kbd_buf.type  == 2)
-                {
-                    /* getch */
-                    if(kbd_buf.read < kbd_buf.read_size)
-                    {
-                        kbd_buf.char_buf[kbd_buf.read++] = character;
-                    }
-
-                    kbd_buf.type = 0;
-#if 0
-                    err = sem_post(&kbd_buf.sem);
-                    if(err != OS_NO_ERR)
-                    {
-                        kernel_error("Keyboard driver failure");
-                        kernel_panic(err);
-                    }
-#endif
-                }
-            }
+            /* Store the character for the readers */
+            keyboard_push_char(character);
 
             /* Display character */
             if(display_keyboard)
@@ -366,11 +499,115 @@ static void manage_keycode(const int32_t keycode)
     }
 }
 
+/**
+ * @brief Keyboard scancodes decoding tasklet.
+ *
+ * @details Decodes the scancodes stored by the interrupt handler, echoes the
+ * characters and manage thread blocked on IO.
+ *
+ * @param[in] args Unused.
+ */
+static void keyboard_decode(void* args)
+{
+    uint32_t int_state;
+    uint32_t pending;
+    int8_t   keycode;
+
+    (void)args;
+
+    while(1)
+    {
+#if MAX_CPU_COUNT > 1
+        ENTER_CRITICAL(int_state, &kbd_buf.lock);
+#else
+        ENTER_CRITICAL(int_state);
+#endif
+
+        pending = kbd_buf.scan_tail != kbd_buf.scan_head;
+        if(pending == 1)
+        {
+            keycode = kbd_buf.scancodes[kbd_buf.scan_tail];
+            kbd_buf.scan_tail = (kbd_buf.scan_tail + 1) &
+                                (KEYBOARD_SCANCODE_BUFFER_SIZE - 1);
+        }
+
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &kbd_buf.lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+
+        if(pending == 0)
+        {
+            break;
+        }
+
+        /* Manage keycode */
+        manage_keycode(keycode);
+    }
+
+    if(kbd_buf.tail != kbd_buf.head)
+    {
+        keyboard_wake_readers();
+    }
+}
+
+/**
+ * @brief Reads a scancode from the keyboard controller.
+ *
+ * @details Stores the scancode in the scancodes ring if the controller holds
+ * keyboard data. The scancode is dropped when the ring is full.
+ *
+ * @return 1 if a scancode was stored, 0 otherwise.
+ */
+static uint32_t keyboard_read_scancode(void)
+{
+    uint32_t int_state;
+    uint32_t next;
+    uint32_t queued;
+    uint8_t  keycode;
+
+    queued = 0;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &kbd_buf.lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    /* Read if not empty and not from auxiliary port */
+    if((cpu_inb(KEYBOARD_COMM_PORT) & 0x100001) == 1)
+    {
+        /* Retrieve key code and store it */
+        keycode = cpu_inb(KEYBOARD_DATA_PORT);
+
+        next = (kbd_buf.scan_head + 1) & (KEYBOARD_SCANCODE_BUFFER_SIZE - 1);
+        if(next == kbd_buf.scan_tail)
+        {
+            ++kbd_buf.dropped;
+        }
+        else
+        {
+            kbd_buf.scancodes[kbd_buf.scan_head] = keycode;
+            kbd_buf.scan_head = next;
+            queued = 1;
+        }
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &kbd_buf.lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return queued;
+}
+
 /**
  * @brief Keyboard IRQ handler.
  * 
- * @details Keyboard IRQ handler, reads the key value and manage thread blocked 
- * on IO.
+ * @details Keyboard IRQ handler, reads the key value and schedules its
+ * decoding, or decodes it when KEYBOARD_DEFERRED_DECODE is set to 0.
  *
  * @param[in] cpu_state The cpu registers before the interrupt.
  * @param[in] int_id The interrupt line that called the handler.
@@ -379,23 +616,24 @@ static void manage_keycode(const int32_t keycode)
 static void keyboard_interrupt_handler(cpu_state_t* cpu_state, uintptr_t int_id,
                                        stack_state_t* stack_state)
 {
+    uint32_t queued;
+
     (void)cpu_state;
     (void)int_id;
     (void)stack_state;
 
-    /* Read if not empty and not from auxiliary port */
-    if((cpu_inb(KEYBOARD_COMM_PORT) & 0x100001) == 1)
-    {
-        int8_t keycode;
-      
-        /* Retrieve key code and test it */
-        keycode = cpu_inb(KEYBOARD_DATA_PORT);
-
-        /* Manage keycode */
-        manage_keycode(keycode);
-    }
+    queued = keyboard_read_scancode();
 
     kernel_interrupt_set_irq_eoi(KBD_IRQ_LINE);
+
+    if(queued == 1)
+    {
+#if KEYBOARD_DEFERRED_DECODE == 1
+        deferred_tasklet_schedule(&kbd_buf.decoder);
+#else
+        keyboard_decode(NULL);
+#endif
+    }
 }
 
 OS_RETURN_E keyboard_init(void)
@@ -414,6 +652,19 @@ OS_RETURN_E keyboard_init(void)
     }
 #endif
     memset(&kbd_buf, 0, sizeof(kbd_buffer_t));
+#if MAX_CPU_COUNT > 1
+    INIT_SPINLOCK(&kbd_buf.lock);
+#endif
+    err = kernel_queue_init_queue(&kbd_buf.waiters);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+    err = deferred_work_init(&kbd_buf.decoder, keyboard_decode, NULL);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
     /* Init interuption settings */
     err = kernel_interrupt_register_irq_handler(KBD_IRQ_LINE,
                                                 keyboard_interrupt_handler);
@@ -426,31 +677,130 @@ OS_RETURN_E keyboard_init(void)
     return err;
 }
 
-uint32_t keyboard_read(char* buffer, const uint32_t size)
+OS_RETURN_E keyboard_receive(char* buffer, const size_t size, size_t* read)
 {
-    uint32_t    read = 0;
+    OS_RETURN_E err;
 
-    if(buffer == NULL || size == 0)
+    if(buffer == NULL || read == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    *read = 0;
+    if(size == 0)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    while(1)
+    {
+        *read = keyboard_pop(buffer, size);
+        if(*read != 0)
+        {
+            return OS_NO_ERR;
+        }
+
+        err = keyboard_wait_input();
+        if(err != OS_NO_ERR)
+        {
+            return err;
+        }
+    }
+}
+
+OS_RETURN_E keyboard_receive_timeout(char* buffer, const size_t size,
+                                     size_t* read, const uint32_t timeout)
+{
+    uint64_t    deadline;
+    uint64_t    now;
+    OS_RETURN_E err;
+
+    if(buffer == NULL || read == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    *read = 0;
+    if(size == 0)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    /* The scheduler has no timed block, sleep by periods until the deadline */
+    deadline = time_get_current_uptime() + timeout;
+    while(1)
+    {
+        *read = keyboard_pop(buffer, size);
+        if(*read != 0)
+        {
+            return OS_NO_ERR;
+        }
+
+        now = time_get_current_uptime();
+        if(now >= deadline)
+        {
+            return OS_ERR_TIMEOUT;
+        }
+        err = sched_sleep((deadline - now < KEYBOARD_WAIT_PERIOD) ?
+                          (uint32_t)(deadline - now) :
+                          KEYBOARD_WAIT_PERIOD);
+        if(err != OS_NO_ERR)
+        {
+            return err;
+        }
+    }
+}
+
+size_t keyboard_poll(char* buffer, const size_t size)
+{
+    if(buffer == NULL)
     {
         return 0;
     }
 
-    kbd_buf.char_buf  = buffer;
-    kbd_buf.read_size = size;
-    kbd_buf.read      = 0;
-    kbd_buf.type      = 1;
+    return keyboard_pop(buffer, size);
+}
+
+uint32_t keyboard_get_dropped(void)
+{
+    return kbd_buf.dropped;
+}
 
-    read = kbd_buf.read;
+uint32_t keyboard_read(char* buffer, const size_t size)
+{
+    uint32_t read;
+    char     character;
 
-    kbd_buf.char_buf  = NULL;
-    kbd_buf.read_size = 0;
-    kbd_buf.read      = 0;
-    kbd_buf.type      = 0;
+    if(buffer == NULL || size == 0)
+    {
+        return 0;
+    }
+
+    read = 0;
+    while(read < size)
+    {
+        keyboard_getch(&character);
+
+        if(character == KEY_BACKSPACE)
+        {
+            if(read > 0)
+            {
+                --read;
+            }
+            buffer[read] = 0;
+        }
+        else
+        {
+            buffer[read++] = character;
+            if(character == KEY_RETURN)
+            {
+                break;
+            }
+        }
+    }
 
     return read;
 }
 
-uint32_t keyboard_secure_read(char* buffer, const uint32_t size)
+uint32_t keyboard_secure_read(char* buffer, const size_t size)
 {
     /* Read string */
     uint32_t new_size = keyboard_read(buffer, size);
@@ -470,61 +820,27 @@ uint32_t keyboard_secure_read(char* buffer, const uint32_t size)
 
 void keyboard_getch(char* character)
 {
-    //OS_RETURN_E err;
+    size_t read;
 
     if(character == NULL)
     {
         return;
     }
-#if 0
-    err = mutex_pend(&kbd_mutex);
-    if(err != OS_NO_ERR)
-    {
-        kernel_error("Keyboard cannot release its mutex[%d]\n", err);
-        kernel_panic(err);
-    }
 
-    /* Set current buffer */
-    err = sem_init(&kbd_buf.sem, 0);
-    if(err != OS_NO_ERR)
+    if(keyboard_receive(character, 1, &read) == OS_NO_ERR)
     {
-        kernel_error("Keyboard cannot create buffer semaphore[%d]\n", err);
-        kernel_panic(err);
-    }
-#endif
-    kbd_buf.char_buf  = character;
-    kbd_buf.read_size = 1;
-    kbd_buf.read      = 0;
-    kbd_buf.type      = 2;
-#if 0
-    /* Wait for completion */
-    err = sem_pend(&kbd_buf.sem);
-    if(err != OS_NO_ERR)
-    {
-        kernel_error("Keyboard cannot pend buffer semaphore[%d]\n", err);
-        kernel_panic(err);
+        return;
     }
 
-    /* Release resources */
-    err = sem_destroy(&kbd_buf.sem);
-    if(err != OS_NO_ERR)
-    {
-        kernel_error("Keyboard cannot delete buffer semaphore[%d]\n", err);
-        kernel_panic(err);
-    }
-#endif
-    kbd_buf.char_buf  = NULL;
-    kbd_buf.read_size = 0;
-    kbd_buf.read      = 0;
-    kbd_buf.type      = 0;
-#if 0
-    err = mutex_post(&kbd_mutex);
-    if(err != OS_NO_ERR)
+    /* The caller cannot sleep. It may run with the interrupts disabled or in
+     * the worker thread that runs the decoding tasklet: poll the controller and
+     * decode the scancodes here.
+     */
+    while(keyboard_pop(character, 1) == 0)
     {
-        kernel_error("Keyboard cannot release its mutex[%d]\n", err);
-        kernel_panic(err);
+        keyboard_read_scancode();
+        keyboard_decode(NULL);
     }
-#endif
 }
 
 void keyboard_enable_secure(void)
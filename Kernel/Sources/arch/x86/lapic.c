@@ -185,9 +185,10 @@ OS_RETURN_E lapic_init(void)
     /* Enable all interrupts */
     lapic_write(LAPIC_TPR, 0);
 
-    /* Set logical destination mode */
+    /* Set flat logical destination mode, one bit per CPU */
     lapic_write(LAPIC_DFR, 0xffffffff);
-    lapic_write(LAPIC_LDR, 0x01000000);
+    lapic_write(LAPIC_LDR, lapic_get_logical_id(cpu_get_id()) <<
+                           LAPIC_LOGICAL_ID_SHIFT);
 
     /* Spurious Interrupt Vector Register */
     lapic_write(LAPIC_SVR, 0x100 | LAPIC_SPURIOUS_INT_LINE);
@@ -210,6 +211,16 @@ int32_t lapic_get_id(void)
     return (lapic_read(LAPIC_ID) >> 24);
 }
 
+uint32_t lapic_get_logical_id(const int32_t cpu_id)
+{
+    if(cpu_id < 0 || cpu_id >= LAPIC_LOGICAL_CPU_COUNT)
+    {
+        return 0;
+    }
+
+    return 1 << cpu_id;
+}
+
 OS_RETURN_E lapic_send_ipi_init(const uint32_t lapic_id)
 {
     OS_RETURN_E err;
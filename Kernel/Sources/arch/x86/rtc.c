@@ -25,6 +25,7 @@
 #include <lib/stddef.h>           /* Standard definition */
 #include <time/time_management.h> /* Timer factory */
 #include <sync/critical.h>        /* Critical sections */
+#include <interrupt/deferred.h>   /* Interrupt deferred work */
 
 /* UTK configuration file */
 #include <config.h>
@@ -53,6 +54,9 @@ static uint32_t disabled_nesting;
 /** @brief Keeps track of the current frequency. */
 static uint32_t rtc_frequency;
 
+/** @brief Time and date update deferred work. */
+static deferred_work_t rtc_update_work;
+
 /** @brief RTC driver instance. */
 kernel_timer_t rtc_driver = {
     .get_frequency  = rtc_get_frequency,
@@ -74,6 +78,18 @@ static spinlock_t lock = SPINLOCK_INIT_VALUE;
  * FUNCTIONS
  ******************************************************************************/
 
+/**
+ * @brief Time and date update deferred work routine.
+ *
+ * @param[in] args Unused.
+ */
+static void rtc_update_routine(void* args)
+{
+    (void)args;
+
+    rtc_update_time();
+}
+
 /**
  * @brief Initial RTC interrupt handler.
  *
@@ -91,7 +107,7 @@ static void dummy_handler(cpu_state_t* cpu_state, uintptr_t int_id,
     (void)int_id;
     (void)stack_state;
 
-    rtc_update_time();
+    rtc_schedule_update();
 
     /* EOI */
     kernel_interrupt_set_irq_eoi(RTC_IRQ_LINE);
@@ -124,6 +140,12 @@ OS_RETURN_E rtc_init(void)
     cpu_outb((prev_rate & 0xF0) | RTC_INIT_RATE, CMOS_DATA_PORT);
     rtc_frequency = (RTC_QUARTZ_FREQ >> (RTC_INIT_RATE - 1));
 
+    err = deferred_work_init(&rtc_update_work, rtc_update_routine, NULL);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
     /* Set rtc clock interrupt handler */
     err = kernel_interrupt_register_irq_handler(RTC_IRQ_LINE, dummy_handler);
     if(err != OS_NO_ERR)
@@ -533,6 +555,15 @@ void rtc_update_time(void)
 #endif
 }
 
+void rtc_schedule_update(void)
+{
+    /* Clear C Register */
+    cpu_outb(CMOS_REG_C, CMOS_COMM_PORT);
+    cpu_inb(CMOS_DATA_PORT);
+
+    deferred_work_queue(&rtc_update_work);
+}
+
 uint32_t rtc_get_irq(void)
 {
     return RTC_IRQ_LINE;
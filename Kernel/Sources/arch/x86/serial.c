@@ -21,12 +21,18 @@
  * @warning Only COM1 and COM2 are initialized for input.
  ******************************************************************************/
 
-#include <lib/stddef.h>       /* Standard definitions */
-#include <lib/stdint.h>       /* Generic int types */
-#include <lib/string.h>       /* String manipulation */
-#include <cpu.h>              /* CPU manipulation */
-#include <io/graphic.h>       /* Graphic definitions */
-#include <io/kernel_output.h> /* Kernel output methods */
+#include <lib/stddef.h>           /* Standard definitions */
+#include <lib/stdint.h>           /* Generic int types */
+#include <lib/string.h>           /* String manipulation */
+#include <cpu.h>                  /* CPU manipulation */
+#include <io/graphic.h>           /* Graphic definitions */
+#include <io/kernel_output.h>     /* Kernel output methods */
+#include <sync/critical.h>        /* Critical sections */
+#include <sync/futex.h>           /* Futex */
+#include <core/scheduler.h>       /* Kernel scheduler */
+#include <time/time_management.h> /* Uptime */
+#include <interrupt/interrupts.h> /* Interrupts management */
+#include <interrupt_settings.h>   /* Interrupts settings */
 
 /* UTK configuration file */
 #include <config.h>
@@ -46,6 +52,27 @@
 /** @brief Stores the serial initialization state. */
 static uint8_t serial_init_done = 0;
 
+/** @brief Set to 1 when the transmissions are interrupt driven. */
+static volatile uint8_t serial_irq_enabled = 0;
+
+#if MAX_CPU_COUNT > 1
+/** @brief Serial ports, COM1 to COM4. */
+static serial_port_t serial_ports[4] = {
+    {.base = SERIAL_COM1_BASE, .lock = SPINLOCK_INIT_VALUE},
+    {.base = SERIAL_COM2_BASE, .lock = SPINLOCK_INIT_VALUE},
+    {.base = SERIAL_COM3_BASE, .lock = SPINLOCK_INIT_VALUE},
+    {.base = SERIAL_COM4_BASE, .lock = SPINLOCK_INIT_VALUE}
+};
+#else
+/** @brief Serial ports, COM1 to COM4. */
+static serial_port_t serial_ports[4] = {
+    {.base = SERIAL_COM1_BASE},
+    {.base = SERIAL_COM2_BASE},
+    {.base = SERIAL_COM3_BASE},
+    {.base = SERIAL_COM4_BASE}
+};
+#endif
+
 /**
  * @brief Serial text driver instance.
  */
@@ -169,15 +196,13 @@ OS_RETURN_E serial_init(void)
 
         attr = SERIAL_DATA_LENGTH_8 | SERIAL_STOP_BIT_1;
 
-        /* Enable interrupt on recv for COM1 and COM2 */
-        if(com == SERIAL_COM1_BASE || com == SERIAL_COM2_BASE)
-        {
-            cpu_outb(0x01, SERIAL_DATA_PORT_2(com));
-        }
-        else
-        {
-            cpu_outb(0x00, SERIAL_DATA_PORT_2(com));
-        }
+        /* Interrupts are enabled on demand once the handlers are set */
+        cpu_outb(0x00, SERIAL_DATA_PORT_2(com));
+        serial_ports[i].ier     = 0;
+        serial_ports[i].tx_head = 0;
+        serial_ports[i].tx_tail = 0;
+        serial_ports[i].rx_head = 0;
+        serial_ports[i].rx_tail = 0;
 
         /* Init baud rate */
         err = set_baudrate(BAUDRATE_9600, com);
@@ -218,35 +243,431 @@ OS_RETURN_E serial_init(void)
     return err;
 }
 
-void serial_write(const uint32_t port, const uint8_t data)
+/**
+ * @brief Returns the driver representation of a serial port.
+ *
+ * @param[in] port The base port ID of the serial port.
+ *
+ * @return The serial port, NULL if the port is not supported.
+ */
+static serial_port_t* serial_get_port(const uint32_t port)
 {
-    if(serial_init_done == 0)
+    switch(port)
     {
-        return;
+        case COM1:
+            return &serial_ports[0];
+        case COM2:
+            return &serial_ports[1];
+        case COM3:
+            return &serial_ports[2];
+        case COM4:
+            return &serial_ports[3];
+        default:
+            return NULL;
     }
-    if(port != COM1 && port != COM2 && port != COM3 && port != COM4)
+}
+
+/**
+ * @brief Writes a byte on a port and waits for the transmitter to be ready.
+ *
+ * @param[in] port The base port ID of the serial port.
+ * @param[in] data The byte to write.
+ */
+static void serial_write_sync(const uint32_t port, const uint8_t data)
+{
+    if(data == '\n')
     {
-        return;
+        serial_write_sync(port, '\r');
     }
 
     /* Wait for empty transmit */
-    while((cpu_inb(SERIAL_LINE_STATUS_PORT(port)) & 0x20) == 0)
+    while((cpu_inb(SERIAL_LINE_STATUS_PORT(port)) & SERIAL_LSR_THR_EMPTY) == 0)
     {}
 
-    if(data == '\n')
+    cpu_outb(data, SERIAL_DATA_PORT(port));
+}
+
+/**
+ * @brief Moves the queued data to the port transmit FIFO.
+ *
+ * @details If the transmit FIFO is empty, fills it with up to
+ * SERIAL_TX_FIFO_SIZE bytes of the transmit ring buffer. The port must be
+ * locked.
+ *
+ * @param[in, out] port The serial port.
+ */
+static void serial_tx_fill(serial_port_t* port)
+{
+    uint32_t i;
+
+    if((cpu_inb(SERIAL_LINE_STATUS_PORT(port->base)) &
+        SERIAL_LSR_THR_EMPTY) == 0)
+    {
+        return;
+    }
+
+    for(i = 0; i < SERIAL_TX_FIFO_SIZE && port->tx_tail != port->tx_head; ++i)
+    {
+        cpu_outb(port->tx_buffer[port->tx_tail], SERIAL_DATA_PORT(port->base));
+        port->tx_tail = (port->tx_tail + 1) & (SERIAL_TX_BUFFER_SIZE - 1);
+    }
+}
+
+/**
+ * @brief Enables the transmit interrupt while data are queued.
+ *
+ * @details The port must be locked.
+ *
+ * @param[in, out] port The serial port.
+ */
+static void serial_tx_update_irq(serial_port_t* port)
+{
+    uint8_t ier;
+
+    if(port->tx_tail != port->tx_head)
     {
-        serial_write(port, '\r');
-        cpu_outb('\n', port);
+        ier = port->ier | SERIAL_INT_ENABLE_TX;
     }
     else
     {
-        cpu_outb(data, port);
+        ier = port->ier & ~SERIAL_INT_ENABLE_TX;
     }
 
-    while((cpu_inb(SERIAL_LINE_STATUS_PORT(port)) & 0x20) == 0)
-    {}
+    if(ier != port->ier)
+    {
+        port->ier = ier;
+        cpu_outb(ier, SERIAL_DATA_PORT_2(port->base));
+    }
+}
+
+/**
+ * @brief Queues a byte in the port transmit ring buffer.
+ *
+ * @details If the ring buffer is full, the queued data are sent synchronously
+ * until a slot is available. The port must be locked.
+ *
+ * @param[in, out] port The serial port.
+ * @param[in] data The byte to queue.
+ */
+static void serial_tx_push(serial_port_t* port, const uint8_t data)
+{
+    uint32_t next;
+
+    next = (port->tx_head + 1) & (SERIAL_TX_BUFFER_SIZE - 1);
+    while(next == port->tx_tail)
+    {
+        serial_tx_fill(port);
+    }
+
+    port->tx_buffer[port->tx_head] = data;
+    port->tx_head = next;
+}
+
+/**
+ * @brief Writes a buffer on a port.
+ *
+ * @details Queues the buffer in the port transmit ring buffer when the
+ * transmissions are interrupt driven, writes it synchronously otherwise.
+ *
+ * @param[in] port The base port ID of the serial port.
+ * @param[in] data The buffer to write.
+ * @param[in] len The size of the buffer.
+ */
+static void serial_write_buffer(const uint32_t port, const uint8_t* data,
+                                const size_t len)
+{
+    serial_port_t* sport;
+    uint32_t       int_state;
+    size_t         i;
+
+    if(serial_init_done == 0)
+    {
+        return;
+    }
+    sport = serial_get_port(port);
+    if(sport == NULL)
+    {
+        return;
+    }
+
+    if(serial_irq_enabled == 0)
+    {
+        for(i = 0; i < len; ++i)
+        {
+            serial_write_sync(port, data[i]);
+        }
+        return;
+    }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &sport->lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    for(i = 0; i < len; ++i)
+    {
+        if(data[i] == '\n')
+        {
+            serial_tx_push(sport, '\r');
+        }
+        serial_tx_push(sport, data[i]);
+    }
+    serial_tx_fill(sport);
+    serial_tx_update_irq(sport);
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &sport->lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+}
+
+/**
+ * @brief Copies the data of the port receive ring buffer.
+ *
+ * @param[in, out] port The serial port.
+ * @param[out] buffer The buffer that receives the data.
+ * @param[in] size The size of the buffer.
+ * @param[out] event The buffer that receives the port reception counter.
+ *
+ * @return The number of bytes copied.
+ */
+static size_t serial_rx_pop(serial_port_t* port, uint8_t* buffer,
+                            const size_t size, int32_t* event)
+{
+    uint32_t int_state;
+    size_t   read;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &port->lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    read = 0;
+    while(read < size && port->rx_tail != port->rx_head)
+    {
+        buffer[read++] = port->rx_buffer[port->rx_tail];
+        port->rx_tail = (port->rx_tail + 1) & (SERIAL_RX_BUFFER_SIZE - 1);
+    }
+    *event = port->rx_event;
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &port->lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return read;
+}
+
+#if SERIAL_IRQ_MODE == 1
+/**
+ * @brief Moves the received data to the port receive ring buffer.
+ *
+ * @details The bytes received while the ring buffer is full are dropped. The
+ * port must be locked.
+ *
+ * @param[in, out] port The serial port.
+ */
+static void serial_rx_drain(serial_port_t* port)
+{
+    uint32_t next;
+    uint8_t  data;
+
+    while((cpu_inb(SERIAL_LINE_STATUS_PORT(port->base)) &
+           SERIAL_LSR_DATA_READY) != 0)
+    {
+        data = cpu_inb(SERIAL_DATA_PORT(port->base));
+        next = (port->rx_head + 1) & (SERIAL_RX_BUFFER_SIZE - 1);
+        if(next == port->rx_tail)
+        {
+            ++port->rx_dropped;
+            continue;
+        }
+
+        port->rx_buffer[port->rx_head] = data;
+        port->rx_head = next;
+    }
+
+    ++port->rx_event;
+}
+
+/**
+ * @brief Handles the interrupts of a serial port.
+ *
+ * @param[in, out] port The serial port.
+ */
+static void serial_port_irq(serial_port_t* port)
+{
+    uint32_t int_state;
+    uint32_t received;
+    uint8_t  iir;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &port->lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    received = 0;
+
+    /* A missing port reads as 0xFF, with no interrupt pending */
+    iir = cpu_inb(SERIAL_INT_ID_PORT(port->base));
+    while((iir & SERIAL_IIR_NONE) == 0)
+    {
+        switch(iir & SERIAL_IIR_ID_MASK)
+        {
+            case SERIAL_IIR_THR_EMPTY:
+                serial_tx_fill(port);
+                break;
+            case SERIAL_IIR_LINE_STATUS:
+                cpu_inb(SERIAL_LINE_STATUS_PORT(port->base));
+                break;
+            case SERIAL_IIR_MODEM_STATUS:
+                cpu_inb(SERIAL_MODEM_STATUS_PORT(port->base));
+                break;
+            case SERIAL_IIR_RX_DATA:
+            case SERIAL_IIR_RX_TIMEOUT:
+                serial_rx_drain(port);
+                received = 1;
+                break;
+            default:
+                iir = SERIAL_IIR_NONE;
+                continue;
+        }
+
+        iir = cpu_inb(SERIAL_INT_ID_PORT(port->base));
+    }
+
+    serial_tx_update_irq(port);
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &port->lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    /* Wake the blocked readers, they run at the next schedule */
+    if(received == 1 && port->rx_waiters != 0)
+    {
+        futex_wake(&port->rx_event, FUTEX_WAKE_ALL, NULL);
+    }
+}
+
+/**
+ * @brief COM1 and COM3 interrupt handler.
+ *
+ * @param[in, out] cpu_state The cpu registers before the interrupt.
+ * @param[in] int_id The interrupt line that called the handler.
+ * @param[in, out] stack_state The stack state before the interrupt.
+ */
+static void serial_1_3_handler(cpu_state_t* cpu_state, uintptr_t int_id,
+                               stack_state_t* stack_state)
+{
+    (void)cpu_state;
+    (void)int_id;
+    (void)stack_state;
+
+    serial_port_irq(&serial_ports[0]);
+    serial_port_irq(&serial_ports[2]);
+
+    kernel_interrupt_set_irq_eoi(SERIAL_1_3_IRQ_LINE);
+}
+
+/**
+ * @brief COM2 and COM4 interrupt handler.
+ *
+ * @param[in, out] cpu_state The cpu registers before the interrupt.
+ * @param[in] int_id The interrupt line that called the handler.
+ * @param[in, out] stack_state The stack state before the interrupt.
+ */
+static void serial_2_4_handler(cpu_state_t* cpu_state, uintptr_t int_id,
+                               stack_state_t* stack_state)
+{
+    (void)cpu_state;
+    (void)int_id;
+    (void)stack_state;
+
+    serial_port_irq(&serial_ports[1]);
+    serial_port_irq(&serial_ports[3]);
+
+    kernel_interrupt_set_irq_eoi(SERIAL_2_4_IRQ_LINE);
+}
+#endif
+
+OS_RETURN_E serial_irq_init(void)
+{
+#if SERIAL_IRQ_MODE == 0
+    return OS_NO_ERR;
+#else
+    OS_RETURN_E err;
+    uint32_t    i;
+
+    err = kernel_interrupt_register_irq_handler(SERIAL_1_3_IRQ_LINE,
+                                                serial_1_3_handler);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+    err = kernel_interrupt_register_irq_handler(SERIAL_2_4_IRQ_LINE,
+                                                serial_2_4_handler);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    err = kernel_interrupt_set_irq_mask(SERIAL_1_3_IRQ_LINE, 1);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+    err = kernel_interrupt_set_irq_mask(SERIAL_2_4_IRQ_LINE, 1);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    serial_irq_enabled = 1;
+
+    /* Enable the data available interrupt */
+    for(i = 0; i < 4; ++i)
+    {
+        serial_ports[i].ier |= SERIAL_INT_ENABLE_RX;
+        cpu_outb(serial_ports[i].ier, SERIAL_DATA_PORT_2(serial_ports[i].base));
+    }
+
+#if SERIAL_KERNEL_DEBUG == 1
+    kernel_serial_debug("[SERIAL] Interrupt driven transfers enabled\n");
+#endif
+
+    return OS_NO_ERR;
+#endif
+}
+
+void serial_set_sync_mode(void)
+{
+    serial_port_t* port;
+    uint32_t       i;
+
+    serial_irq_enabled = 0;
+
+    for(i = 0; i < 4; ++i)
+    {
+        port = &serial_ports[i];
+        while(port->tx_tail != port->tx_head)
+        {
+            serial_tx_fill(port);
+        }
+        serial_tx_update_irq(port);
+    }
 }
 
+void serial_write(const uint32_t port, const uint8_t data)
+{
+    serial_write_buffer(port, &data, 1);
+}
 
 void serial_clear_screen(void)
 {
@@ -308,31 +729,188 @@ OS_RETURN_E serial_save_color_scheme(colorscheme_t* buffer)
 
 void serial_console_write_keyboard(const char* str, const size_t len)
 {
-    size_t i;
-    for(i = 0; i < len; ++i)
+    serial_write_buffer(SERIAL_DEBUG_PORT, (const uint8_t*)str, len);
+}
+
+/**
+ * @brief Reads the data received on a serial port.
+ *
+ * @param[in] port The port on which the data should be read.
+ * @param[out] buffer The buffer that receives the data.
+ * @param[in] size The size of the buffer.
+ * @param[out] read The buffer that receives the number of bytes read.
+ * @param[in] timeout The timeout in milliseconds, ignored if use_timeout is 0.
+ * @param[in] use_timeout Set to 1 to wait at most timeout milliseconds.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E serial_receive_wait(const uint32_t port, uint8_t* buffer,
+                                       const size_t size, size_t* read,
+                                       const uint32_t timeout,
+                                       const uint32_t use_timeout)
+{
+    serial_port_t* sport;
+    uint64_t       deadline;
+    uint64_t       now;
+    uint32_t       int_state;
+    int32_t        event;
+    OS_RETURN_E    err;
+
+    if(buffer == NULL || read == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    *read = 0;
+
+    sport = serial_get_port(port);
+    if(sport == NULL || size == 0)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+    if(serial_irq_enabled == 0)
     {
-        serial_write(SERIAL_DEBUG_PORT, str[i]);
+        return OS_ERR_NOT_SUPPORTED;
     }
+
+    deadline = time_get_current_uptime() + timeout;
+    while(1)
+    {
+        *read = serial_rx_pop(sport, buffer, size, &event);
+        if(*read != 0)
+        {
+            return OS_NO_ERR;
+        }
+
+        if(use_timeout == 1)
+        {
+            now = time_get_current_uptime();
+            if(now >= deadline)
+            {
+                return OS_ERR_TIMEOUT;
+            }
+            err = sched_sleep((deadline - now < SERIAL_RX_WAIT_PERIOD) ?
+                              (uint32_t)(deadline - now) :
+                              SERIAL_RX_WAIT_PERIOD);
+        }
+        else
+        {
+            /* Sleep until the next reception */
+#if MAX_CPU_COUNT > 1
+            ENTER_CRITICAL(int_state, &sport->lock);
+#else
+            ENTER_CRITICAL(int_state);
+#endif
+            ++sport->rx_waiters;
+#if MAX_CPU_COUNT > 1
+            EXIT_CRITICAL(int_state, &sport->lock);
+#else
+            EXIT_CRITICAL(int_state);
+#endif
+
+            err = futex_wait(&sport->rx_event, event);
+
+#if MAX_CPU_COUNT > 1
+            ENTER_CRITICAL(int_state, &sport->lock);
+#else
+            ENTER_CRITICAL(int_state);
+#endif
+            --sport->rx_waiters;
+#if MAX_CPU_COUNT > 1
+            EXIT_CRITICAL(int_state, &sport->lock);
+#else
+            EXIT_CRITICAL(int_state);
+#endif
+
+            if(err == OS_FUTEX_VALUE_MISMATCH)
+            {
+                err = OS_NO_ERR;
+            }
+        }
+
+        if(err != OS_NO_ERR)
+        {
+            return err;
+        }
+    }
+}
+
+OS_RETURN_E serial_receive(const uint32_t port, uint8_t* buffer,
+                           const size_t size, size_t* read)
+{
+    return serial_receive_wait(port, buffer, size, read, 0, 0);
+}
+
+OS_RETURN_E serial_receive_timeout(const uint32_t port, uint8_t* buffer,
+                                   const size_t size, size_t* read,
+                                   const uint32_t timeout)
+{
+    return serial_receive_wait(port, buffer, size, read, timeout, 1);
 }
 
 uint8_t serial_read(const uint32_t port)
 {
+    serial_port_t* sport;
+    size_t         read;
+    uint32_t       int_state;
+    uint32_t       received;
+    int32_t        event;
+    uint8_t        val;
+
+    sport = serial_get_port(port);
+    if(serial_irq_enabled == 1 && sport != NULL)
+    {
+        if(serial_receive(port, &val, 1, &read) == OS_NO_ERR)
+        {
+            return val;
+        }
+
+        /* The caller cannot sleep and the interrupt may never be raised if
+         * the interrupts are disabled: drain the ring then poll the port.
+         */
+        while(serial_rx_pop(sport, &val, 1, &event) == 0)
+        {
+#if MAX_CPU_COUNT > 1
+            ENTER_CRITICAL(int_state, &sport->lock);
+#else
+            ENTER_CRITICAL(int_state);
+#endif
+
+            received = 0;
+            if((cpu_inb(SERIAL_LINE_STATUS_PORT(port)) &
+                SERIAL_LSR_DATA_READY) != 0)
+            {
+                val      = cpu_inb(SERIAL_DATA_PORT(port));
+                received = 1;
+            }
+
+#if MAX_CPU_COUNT > 1
+            EXIT_CRITICAL(int_state, &sport->lock);
+#else
+            EXIT_CRITICAL(int_state);
+#endif
+
+            if(received == 1)
+            {
+                return val;
+            }
+        }
+
+        return val;
+    }
+
     /* Wait for data to be received */
     while (serial_received(port) == 0);
 
     /* Read available data on port */
-    uint8_t val = cpu_inb(SERIAL_DATA_PORT(port));
+    val = cpu_inb(SERIAL_DATA_PORT(port));
 
     return val;
 }
 
 void serial_put_string(const char* string)
 {
-    size_t i;
-    for(i = 0; i < strlen(string); ++i)
-    {
-        serial_write(SERIAL_DEBUG_PORT, string[i]);
-    }
+    serial_write_buffer(SERIAL_DEBUG_PORT, (const uint8_t*)string,
+                        strlen(string));
 }
 
 void serial_put_char(const char character)
@@ -342,6 +920,14 @@ void serial_put_char(const char character)
 
 uint8_t serial_received(const uint32_t port)
 {
+    serial_port_t* sport;
+
+    sport = serial_get_port(port);
+    if(serial_irq_enabled == 1 && sport != NULL)
+    {
+        return (sport->rx_head != sport->rx_tail) ? 1 : 0;
+    }
+
     /* Read on LINE status port */
-    return cpu_inb(SERIAL_LINE_STATUS_PORT(port)) & 0x01;
+    return cpu_inb(SERIAL_LINE_STATUS_PORT(port)) & SERIAL_LSR_DATA_READY;
 }
@@ -33,6 +33,10 @@
 #include <memory/kheap.h>     /* Kernel heap */
 #include <arch_paging.h>      /* Architecture specific memory settings */
 #include <core/scheduler.h>   /* Kernel scheduler */
+#include <sync/critical.h>    /* Critical sections */
+#include <sync/futex.h>       /* Futex */
+#include <time/time_management.h> /* Uptime */
+#include <io/scrollback.h>    /* Scrollback history */
 
 /* UTK configuration file */
 #include <config.h>
@@ -69,6 +73,27 @@ static cursor_t      last_printed_cursor;
 static colorscheme_t screen_scheme;
 /** @brief Stores the last printed character's column for each screen line. */
 static uint32_t*     last_columns;
+/** @brief Text cells of the console, used to render the screen content again.
+ */
+static scrollback_cell_t* console_cells   = NULL;
+/** @brief Number of text columns of the console. */
+static uint32_t           console_columns = 0;
+/** @brief Number of text lines of the console. */
+static uint32_t           console_lines   = 0;
+/**
+ * @brief Number of history lines displayed above the screen content, 0 when
+ * the screen content is displayed.
+ */
+static uint32_t           scrollback_view = 0;
+
+/** @brief Bits of the 4 leftmost pixels of a glyph row. */
+static const uint32_t glyph_bits_high[4] __attribute__((aligned(16))) = {
+    0x80, 0x40, 0x20, 0x10
+};
+/** @brief Bits of the 4 rightmost pixels of a glyph row. */
+static const uint32_t glyph_bits_low[4] __attribute__((aligned(16))) = {
+    0x08, 0x04, 0x02, 0x01
+};
 
 /** @brief VGA color to RGB translation table. */
 static const uint32_t vga_color_table[16] = {
@@ -119,6 +144,52 @@ static uint8_t save_buff[256] = {0};
 /** @brief Virtual framebuffer used for double-buffering */
 static uint8_t* virt_buffer = NULL;
 
+/** @brief Rendered glyphs cache, indexed by a hash of the character and the
+ * colors.
+ */
+static vesa_glyph_entry_t       glyph_cache[VESA_GLYPH_CACHE_SIZE];
+/** @brief Rendered glyphs cache statistics. */
+static vesa_glyph_cache_stats_t glyph_stats;
+
+#if MAX_CPU_COUNT > 1
+/** @brief Rendered glyphs cache lock. */
+static spinlock_t glyph_lock = SPINLOCK_INIT_VALUE;
+#endif
+
+#if DISPLAY_TYPE == DISPLAY_VESA_BUF
+/** @brief Areas of the virtual buffer modified since the last flush. */
+static vesa_rect_t dirty_rects[VESA_DIRTY_RECT_COUNT];
+/** @brief Number of valid dirty rectangles. */
+static uint32_t    dirty_count = 0;
+/** @brief Last updated dirty rectangle, checked first by the next update. */
+static uint32_t    dirty_last  = 0;
+/** @brief Virtual buffer flush statistics. */
+static vesa_flush_stats_t flush_stats;
+
+/** @brief Incremented by each present, the buffer thread waits on it. */
+static volatile int32_t  present_event   = 0;
+/** @brief Set when the buffer thread waits for a present. */
+static volatile uint32_t present_waiting = 0;
+
+/** @brief Size of the video memory in bytes. */
+static uint32_t    video_memory_size = 0;
+/** @brief Set when the current mode uses page flipping. */
+static uint32_t    page_flipping     = 0;
+/** @brief Index of the displayed page when page flipping is used. */
+static uint32_t    front_page        = 0;
+/** @brief Areas copied to the other page by the previous flush, the hidden
+ * page misses them.
+ */
+static vesa_rect_t flip_rects[VESA_DIRTY_RECT_COUNT];
+/** @brief Number of valid previous flush areas. */
+static uint32_t    flip_count        = 0;
+
+#if MAX_CPU_COUNT > 1
+/** @brief Dirty rectangles and flush statistics lock. */
+static spinlock_t dirty_lock = SPINLOCK_INIT_VALUE;
+#endif
+#endif
+
 /*******************************************************************************
  * FUNCTIONS
  ******************************************************************************/
@@ -145,29 +216,228 @@ static void fast_memset(void* dst, const uint8_t value, uint32_t size)
 #endif
 }
 
+/**
+ * @brief Copies 16 bytes chunks with SSE2 non temporal stores.
+ *
+ * @details The XMM registers are not saved on context switch, the copy runs
+ * with interrupts disabled. The helper is compiled for SSE2 and never inlined
+ * so the compiler does not use the XMM registers outside of this window.
+ *
+ * @param[out] dst The destination, aligned on 16 bytes.
+ * @param[in] src The source.
+ * @param[in] chunks The number of 16 bytes chunks to copy, not 0.
+ */
+__attribute__((target("sse2"), noinline))
+static void vesa_sse_stream(void* dst, const void* src, uint32_t chunks)
+{
+    uint32_t int_state;
+
+    int_state = kernel_interrupt_disable();
+    __asm__ __volatile__(
+        "1:\n\t"
+        "movups  (%[src]), %%xmm0\n\t"
+        "movntdq %%xmm0, (%[dst])\n\t"
+        "add     $16, %[src]\n\t"
+        "add     $16, %[dst]\n\t"
+        "dec     %[chunks]\n\t"
+        "jnz     1b\n\t"
+    : [dst]"+r"(dst), [src]"+r"(src), [chunks]"+r"(chunks)
+    :
+    : "memory", "xmm0");
+    kernel_interrupt_restore(int_state);
+}
+
+/**
+ * @brief Fills 4 pixels chunks with SSE2 aligned stores.
+ *
+ * @details Runs with interrupts disabled, see vesa_sse_stream.
+ *
+ * @param[out] dst The first pixel, aligned on 16 bytes.
+ * @param[in] color The pixel value.
+ * @param[in] chunks The number of 4 pixels chunks to fill, not 0.
+ */
+__attribute__((target("sse2"), noinline))
+static void vesa_sse_fill(uint32_t* dst, const uint32_t color,
+                          uint32_t chunks)
+{
+    uint32_t int_state;
+
+    int_state = kernel_interrupt_disable();
+    __asm__ __volatile__(
+        "movd    %[color], %%xmm0\n\t"
+        "pshufd  $0, %%xmm0, %%xmm0\n\t"
+        "1:\n\t"
+        "movdqa  %%xmm0, (%[dst])\n\t"
+        "add     $16, %[dst]\n\t"
+        "dec     %[chunks]\n\t"
+        "jnz     1b\n\t"
+    : [dst]"+r"(dst), [chunks]"+r"(chunks)
+    : [color]"r"(color)
+    : "memory", "xmm0");
+    kernel_interrupt_restore(int_state);
+}
+
+/**
+ * @brief Copies 4 pixels chunks with SSE2 loads and stores.
+ *
+ * @details Runs with interrupts disabled, see vesa_sse_stream.
+ *
+ * @param[out] dst The first destination pixel.
+ * @param[in] src The first source pixel.
+ * @param[in] chunks The number of 4 pixels chunks to copy, not 0.
+ */
+__attribute__((target("sse2"), noinline))
+static void vesa_sse_copy(uint32_t* dst, const uint32_t* src,
+                          uint32_t chunks)
+{
+    uint32_t int_state;
+
+    int_state = kernel_interrupt_disable();
+    __asm__ __volatile__(
+        "1:\n\t"
+        "movdqu  (%[src]), %%xmm0\n\t"
+        "movdqu  %%xmm0, (%[dst])\n\t"
+        "add     $16, %[src]\n\t"
+        "add     $16, %[dst]\n\t"
+        "dec     %[chunks]\n\t"
+        "jnz     1b\n\t"
+    : [dst]"+r"(dst), [src]"+r"(src), [chunks]"+r"(chunks)
+    :
+    : "memory", "xmm0");
+    kernel_interrupt_restore(int_state);
+}
+
+/**
+ * @brief Blends a color over 4 pixels chunks with SSE2 16 bits multiplies.
+ *
+ * @details Runs with interrupts disabled, see vesa_sse_stream.
+ *
+ * @param[in, out] dst The first pixel.
+ * @param[in] color_words Two pixels of premultiplied color words.
+ * @param[in] alpha_words Two pixels of inverse alpha words.
+ * @param[in] pixel_mask The mask clearing the alpha component of 4 pixels.
+ * @param[in] chunks The number of 4 pixels chunks to blend, not 0.
+ */
+__attribute__((target("sse2"), noinline))
+static void vesa_sse_blend(uint32_t* dst, const uint16_t* color_words,
+                           const uint16_t* alpha_words,
+                           const uint32_t* pixel_mask, uint32_t chunks)
+{
+    uint32_t int_state;
+
+    int_state = kernel_interrupt_disable();
+    __asm__ __volatile__(
+        "pxor      %%xmm7, %%xmm7\n\t"
+        "movdqa    (%[cw]), %%xmm6\n\t"
+        "movdqa    (%[aw]), %%xmm5\n\t"
+        "movdqa    (%[mask]), %%xmm4\n\t"
+        "1:\n\t"
+        "movdqu    (%[dst]), %%xmm0\n\t"
+        "movdqa    %%xmm0, %%xmm1\n\t"
+        "punpcklbw %%xmm7, %%xmm0\n\t"
+        "punpckhbw %%xmm7, %%xmm1\n\t"
+        "pmullw    %%xmm5, %%xmm0\n\t"
+        "pmullw    %%xmm5, %%xmm1\n\t"
+        "paddw     %%xmm6, %%xmm0\n\t"
+        "paddw     %%xmm6, %%xmm1\n\t"
+        "psrlw     $8, %%xmm0\n\t"
+        "psrlw     $8, %%xmm1\n\t"
+        "packuswb  %%xmm1, %%xmm0\n\t"
+        "pand      %%xmm4, %%xmm0\n\t"
+        "movdqu    %%xmm0, (%[dst])\n\t"
+        "add       $16, %[dst]\n\t"
+        "dec       %[chunks]\n\t"
+        "jnz       1b\n\t"
+    : [dst]"+r"(dst), [chunks]"+r"(chunks)
+    : [cw]"r"(color_words), [aw]"r"(alpha_words), [mask]"r"(pixel_mask)
+    : "memory", "xmm0", "xmm1", "xmm4", "xmm5", "xmm6", "xmm7");
+    kernel_interrupt_restore(int_state);
+}
+
+/**
+ * @brief Draws the rows of an 8 pixels wide glyph with SSE2 masks.
+ *
+ * @details Runs with interrupts disabled, see vesa_sse_stream.
+ *
+ * @param[out] dst The top left pixel of the glyph.
+ * @param[in] pitch The number of pixels of a screen line.
+ * @param[in] glyph The glyph rows.
+ * @param[in] height The number of rows of the glyph, not 0.
+ * @param[in] fgcolor The foreground pixel value.
+ * @param[in] bgcolor The background pixel value.
+ */
+__attribute__((target("sse2"), noinline))
+static void vesa_sse_glyph(uint32_t* dst, const uint32_t pitch,
+                           const uint8_t* glyph, uint32_t height,
+                           const uint32_t fgcolor, const uint32_t bgcolor)
+{
+    uint32_t row;
+    uint32_t int_state;
+
+    int_state = kernel_interrupt_disable();
+    __asm__ __volatile__(
+        "movdqa  %[high], %%xmm2\n\t"
+        "movdqa  %[low], %%xmm3\n\t"
+        "movd    %[fg], %%xmm4\n\t"
+        "pshufd  $0, %%xmm4, %%xmm4\n\t"
+        "movd    %[bg], %%xmm5\n\t"
+        "pshufd  $0, %%xmm5, %%xmm5\n\t"
+        "1:\n\t"
+        "movzbl  (%[glyph]), %[row]\n\t"
+        "movd    %[row], %%xmm0\n\t"
+        "pshufd  $0, %%xmm0, %%xmm0\n\t"
+        "movdqa  %%xmm0, %%xmm1\n\t"
+        "pand    %%xmm2, %%xmm0\n\t"
+        "pcmpeqd %%xmm2, %%xmm0\n\t"
+        "pand    %%xmm3, %%xmm1\n\t"
+        "pcmpeqd %%xmm3, %%xmm1\n\t"
+        "movdqa  %%xmm0, %%xmm6\n\t"
+        "pand    %%xmm4, %%xmm6\n\t"
+        "pandn   %%xmm5, %%xmm0\n\t"
+        "por     %%xmm6, %%xmm0\n\t"
+        "movdqa  %%xmm1, %%xmm6\n\t"
+        "pand    %%xmm4, %%xmm6\n\t"
+        "pandn   %%xmm5, %%xmm1\n\t"
+        "por     %%xmm6, %%xmm1\n\t"
+        "movdqu  %%xmm0, (%[dst])\n\t"
+        "movdqu  %%xmm1, 16(%[dst])\n\t"
+        "lea     (%[dst], %[pitch], 4), %[dst]\n\t"
+        "inc     %[glyph]\n\t"
+        "dec     %[height]\n\t"
+        "jnz     1b\n\t"
+    : [dst]"+r"(dst), [glyph]"+r"(glyph), [height]"+r"(height),
+      [row]"=&r"(row)
+    : [pitch]"r"((uintptr_t)pitch), [fg]"m"(fgcolor), [bg]"m"(bgcolor),
+      [high]"m"(glyph_bits_high), [low]"m"(glyph_bits_low)
+    : "memory", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6");
+    kernel_interrupt_restore(int_state);
+}
+
 static void fast_memcpy(void* dst, const void* src, const uint32_t size)
 {
-    uint32_t i;
+    uint32_t chunks;
     uint32_t n;
 
-    /* Check SSE support */
-    if(cpu_is_sse_enabled())
+    /* Check SSE support, non temporal stores need an aligned destination */
+    if(cpu_is_sse_enabled() && ((uintptr_t)dst & 0xF) == 0)
     {
-        for(i = 0; i < size / 16; ++i)
+        /* Copy by 16bytes chunks, in blocks to bound the interrupts latency */
+        chunks = size / 16;
+        while(chunks > 0)
         {
-            /* Copy by 16bytes chunks */
-            __asm__ __volatile__(
-                "movups  (%0), %%xmm0\n\t"
-                "movntdq %%xmm0, (%1)\n\t"
-            ::"r"(src), "r"(dst) : "memory");
-            src = (void*)((uintptr_t)src + 16);
-            dst = (void*)((uintptr_t)dst + 16);
+            n = chunks < VESA_SSE_BLOCK_SIZE / 16 ?
+                chunks : VESA_SSE_BLOCK_SIZE / 16;
+            vesa_sse_stream(dst, src, n);
+            src = (void*)((uintptr_t)src + n * 16);
+            dst = (void*)((uintptr_t)dst + n * 16);
+            chunks -= n;
         }
+        __asm__ __volatile__("sfence" ::: "memory");
 
         /* If some rests */
-        if(size % 0x7)
+        if(size % 16)
         {
-            n = size;
+            n = size % 16;
 #if defined(__i386__)
             size_t nl = n >> 2;
             __asm__ __volatile__ ("cld ; rep ; movsl ; movl %3,%0 ; rep ; movsb":"+c" (nl),
@@ -206,6 +476,684 @@ static void fast_memcpy(void* dst, const void* src, const uint32_t size)
     }
 }
 
+/**
+ * @brief Fills a span of pixels with a color.
+ *
+ * @details Uses aligned SSE2 stores once the destination is aligned on 16
+ * bytes, the scalar loop is used when SSE is not enabled.
+ *
+ * @param[out] dst The first pixel of the span.
+ * @param[in] color The pixel value.
+ * @param[in] count The number of pixels of the span.
+ */
+static void vesa_fill_span(uint32_t* dst, const uint32_t color,
+                           uint32_t count)
+{
+    uint32_t chunks;
+
+    if(cpu_is_sse_enabled())
+    {
+        while(count > 0 && ((uintptr_t)dst & 0xF) != 0)
+        {
+            *dst++ = color;
+            --count;
+        }
+
+        chunks = count / 4;
+        if(chunks > 0)
+        {
+            vesa_sse_fill(dst, color, chunks);
+            dst   += chunks * 4;
+            count %= 4;
+        }
+    }
+
+    while(count > 0)
+    {
+        *dst++ = color;
+        --count;
+    }
+}
+
+/**
+ * @brief Copies a span of pixels.
+ *
+ * @details Copies 4 pixels per SSE2 load and store, the scalar loop is used
+ * when SSE is not enabled.
+ *
+ * @param[out] dst The first destination pixel.
+ * @param[in] src The first source pixel.
+ * @param[in] count The number of pixels of the span.
+ */
+static void vesa_copy_span(uint32_t* dst, const uint32_t* src,
+                           uint32_t count)
+{
+    uint32_t chunks;
+
+    chunks = count / 4;
+    if(cpu_is_sse_enabled() && chunks > 0)
+    {
+        vesa_sse_copy(dst, src, chunks);
+        dst   += chunks * 4;
+        src   += chunks * 4;
+        count %= 4;
+    }
+
+    while(count > 0)
+    {
+        *dst++ = *src++;
+        --count;
+    }
+}
+
+/**
+ * @brief Blends a color over a span of pixels.
+ *
+ * @details Each component becomes (color * alpha + pixel * (255 - alpha)) / 256
+ * as vesa_draw_pixel computes it. The SSE2 loop blends 4 pixels with 16 bits
+ * multiplies, the scalar loop is used when SSE is not enabled.
+ *
+ * @param[in, out] dst The first pixel of the span.
+ * @param[in] color The ARGB color, the alpha component is the blend factor.
+ * @param[in] count The number of pixels of the span.
+ */
+static void vesa_blend_span(uint32_t* dst, const uint32_t color,
+                            uint32_t count)
+{
+    uint32_t alpha;
+    uint32_t chunks;
+    uint32_t i;
+    uint8_t* back;
+    uint8_t  pixel[4];
+    uint16_t color_words[8] __attribute__((aligned(16)));
+    uint16_t alpha_words[8] __attribute__((aligned(16)));
+    uint32_t pixel_mask[4]  __attribute__((aligned(16)));
+
+    alpha  = color >> 24;
+    chunks = count / 4;
+    if(cpu_is_sse_enabled() && chunks > 0)
+    {
+        /* Two pixels of premultiplied color and inverse alpha words */
+        for(i = 0; i < 8; i += 4)
+        {
+            color_words[i]     = (color & 0xFF) * alpha;
+            color_words[i + 1] = ((color >> 8) & 0xFF) * alpha;
+            color_words[i + 2] = ((color >> 16) & 0xFF) * alpha;
+            color_words[i + 3] = 0;
+            alpha_words[i]     = 255 - alpha;
+            alpha_words[i + 1] = 255 - alpha;
+            alpha_words[i + 2] = 255 - alpha;
+            alpha_words[i + 3] = 255 - alpha;
+        }
+        for(i = 0; i < 4; ++i)
+        {
+            pixel_mask[i] = 0x00FFFFFF;
+        }
+
+        vesa_sse_blend(dst, color_words, alpha_words, pixel_mask, chunks);
+        dst   += chunks * 4;
+        count %= 4;
+    }
+
+    while(count > 0)
+    {
+        back = (uint8_t*)dst;
+        pixel[0] = ((color & 0xFF) * alpha + back[0] * (255 - alpha)) >> 8;
+        pixel[1] = (((color >> 8) & 0xFF) * alpha +
+                    back[1] * (255 - alpha)) >> 8;
+        pixel[2] = (((color >> 16) & 0xFF) * alpha +
+                    back[2] * (255 - alpha)) >> 8;
+        pixel[3] = 0;
+        *dst++ = *((uint32_t*)pixel);
+        --count;
+    }
+}
+
+/**
+ * @brief Draws the rows of an 8 pixels wide glyph with opaque colors.
+ *
+ * @details The most significant bit of a glyph row is its leftmost pixel. The
+ * SSE2 loop expands each row in two masks of 4 pixels to select the foreground
+ * or the background color, the scalar loop is used when SSE is not enabled.
+ *
+ * @param[out] dst The top left pixel of the glyph.
+ * @param[in] pitch The number of pixels of a screen line.
+ * @param[in] glyph The glyph rows.
+ * @param[in] height The number of rows of the glyph.
+ * @param[in] fgcolor The foreground pixel value.
+ * @param[in] bgcolor The background pixel value.
+ */
+static void vesa_glyph_span(uint32_t* dst, const uint32_t pitch,
+                            const uint8_t* glyph, uint32_t height,
+                            const uint32_t fgcolor, const uint32_t bgcolor)
+{
+    uint32_t i;
+    uint32_t row;
+
+    if(cpu_is_sse_enabled() && height > 0)
+    {
+        vesa_sse_glyph(dst, pitch, glyph, height, fgcolor, bgcolor);
+        return;
+    }
+
+    while(height > 0)
+    {
+        row = *glyph++;
+        for(i = 0; i < 8; ++i)
+        {
+            dst[i] = (row & (0x80 >> i)) != 0 ? fgcolor : bgcolor;
+        }
+        dst += pitch;
+        --height;
+    }
+}
+
+#if DISPLAY_TYPE == DISPLAY_VESA_BUF
+/**
+ * @brief Merges a rectangle in a dirty rectangle.
+ *
+ * @param[in, out] rect The dirty rectangle to grow.
+ * @param[in] x The x coordinate of the rectangle to merge.
+ * @param[in] y The y coordinate of the rectangle to merge.
+ * @param[in] width The width of the rectangle to merge.
+ * @param[in] height The height of the rectangle to merge.
+ */
+static void vesa_rect_merge(vesa_rect_t* rect,
+                            const uint32_t x, const uint32_t y,
+                            const uint32_t width, const uint32_t height)
+{
+    uint32_t right;
+    uint32_t bottom;
+
+    right  = rect->x + rect->width;
+    bottom = rect->y + rect->height;
+    if(x + width > right)
+    {
+        right = x + width;
+    }
+    if(y + height > bottom)
+    {
+        bottom = y + height;
+    }
+    if(x < rect->x)
+    {
+        rect->x = x;
+    }
+    if(y < rect->y)
+    {
+        rect->y = y;
+    }
+    rect->width  = right - rect->x;
+    rect->height = bottom - rect->y;
+}
+
+/**
+ * @brief Tells if a rectangle contains another one.
+ *
+ * @param[in] rect The containing rectangle.
+ * @param[in] x The x coordinate of the contained rectangle.
+ * @param[in] y The y coordinate of the contained rectangle.
+ * @param[in] width The width of the contained rectangle.
+ * @param[in] height The height of the contained rectangle.
+ *
+ * @return 1 if the rectangle is contained, 0 otherwise.
+ */
+static __inline__ uint32_t vesa_rect_contains(const vesa_rect_t* rect,
+                                              const uint32_t x,
+                                              const uint32_t y,
+                                              const uint32_t width,
+                                              const uint32_t height)
+{
+    return x >= rect->x && x + width <= rect->x + rect->width &&
+           y >= rect->y && y + height <= rect->y + rect->height;
+}
+#endif
+
+/**
+ * @brief Marks an area of the virtual buffer as modified.
+ *
+ * @details Adds the area to the dirty rectangles copied by the next flush. The
+ * area is merged in a rectangle it touches, otherwise it uses a new rectangle.
+ * When all the rectangles are used, the area is merged in the rectangle that
+ * grows the least. The area must be marked once drawn so a concurrent flush
+ * cannot clear it before copying the new pixels.
+ *
+ * @param[in] x The x coordinate of the area.
+ * @param[in] y The y coordinate of the area.
+ * @param[in] width The width of the area.
+ * @param[in] height The height of the area.
+ */
+static void vesa_mark_dirty(const uint32_t x, const uint32_t y,
+                            uint32_t width, uint32_t height)
+{
+#if DISPLAY_TYPE == DISPLAY_VESA_BUF
+    vesa_rect_t* rect;
+    uint32_t     int_state;
+    uint32_t     best;
+    uint32_t     best_growth;
+    uint32_t     growth;
+    uint32_t     i;
+    vesa_rect_t  merged;
+
+    if(current_mode == NULL ||
+       x >= current_mode->width || y >= current_mode->height)
+    {
+        return;
+    }
+    if(x + width > current_mode->width)
+    {
+        width = current_mode->width - x;
+    }
+    if(y + height > current_mode->height)
+    {
+        height = current_mode->height - y;
+    }
+    if(width == 0 || height == 0)
+    {
+        return;
+    }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &dirty_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    /* Consecutive draws are usually next to each other */
+    if(dirty_last < dirty_count &&
+       vesa_rect_contains(&dirty_rects[dirty_last], x, y, width, height))
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &dirty_lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+        return;
+    }
+
+    best        = VESA_DIRTY_RECT_COUNT;
+    best_growth = 0xFFFFFFFF;
+    for(i = 0; i < dirty_count; ++i)
+    {
+        rect = &dirty_rects[i];
+
+        /* Touching rectangles are always merged */
+        if(x <= rect->x + rect->width && rect->x <= x + width &&
+           y <= rect->y + rect->height && rect->y <= y + height)
+        {
+            best = i;
+            break;
+        }
+
+        merged = *rect;
+        vesa_rect_merge(&merged, x, y, width, height);
+        growth = merged.width * merged.height - rect->width * rect->height;
+        if(growth < best_growth)
+        {
+            best_growth = growth;
+            best        = i;
+        }
+    }
+
+    if(i == dirty_count && dirty_count < VESA_DIRTY_RECT_COUNT)
+    {
+        rect = &dirty_rects[dirty_count];
+        rect->x      = x;
+        rect->y      = y;
+        rect->width  = width;
+        rect->height = height;
+        dirty_last   = dirty_count++;
+    }
+    else
+    {
+        vesa_rect_merge(&dirty_rects[best], x, y, width, height);
+        dirty_last = best;
+
+        /* Drop the rectangles covered by the grown rectangle */
+        rect = &dirty_rects[best];
+        for(i = 0; i < dirty_count; ++i)
+        {
+            if(i != dirty_last &&
+               vesa_rect_contains(rect, dirty_rects[i].x, dirty_rects[i].y,
+                                  dirty_rects[i].width, dirty_rects[i].height))
+            {
+                dirty_rects[i] = dirty_rects[--dirty_count];
+                if(dirty_last == dirty_count)
+                {
+                    dirty_last = i;
+                    rect = &dirty_rects[i];
+                }
+                --i;
+            }
+        }
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &dirty_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+#else
+    (void)x;
+    (void)y;
+    (void)width;
+    (void)height;
+#endif
+}
+
+#if DISPLAY_TYPE == DISPLAY_VESA_BUF
+/**
+ * @brief Copies an area of the virtual buffer to a hardware page.
+ *
+ * @details Copies whole 16 bytes chunks so the copy keeps using aligned non
+ * temporal stores. The rows spanning the whole screen are copied at once.
+ *
+ * @param[out] hw_buffer The hardware page to copy to.
+ * @param[in] rect The area to copy.
+ *
+ * @return The number of copied bytes.
+ */
+static uint32_t vesa_copy_rect(uint8_t* hw_buffer, const vesa_rect_t* rect)
+{
+    uint32_t pitch;
+    uint32_t start;
+    uint32_t end;
+    uint32_t i;
+
+    pitch = current_mode->width * (current_mode->bpp / 8);
+    start = (rect->x * (current_mode->bpp / 8)) & ~0xF;
+    end   = ((rect->x + rect->width) * (current_mode->bpp / 8) + 0xF) & ~0xF;
+    if(end > pitch)
+    {
+        end = pitch;
+    }
+
+    if(start == 0 && end == pitch)
+    {
+        fast_memcpy(hw_buffer + rect->y * pitch,
+                    virt_buffer + rect->y * pitch,
+                    pitch * rect->height);
+    }
+    else
+    {
+        for(i = rect->y; i < rect->y + rect->height; ++i)
+        {
+            fast_memcpy(hw_buffer + i * pitch + start,
+                        virt_buffer + i * pitch + start,
+                        end - start);
+        }
+    }
+
+    return (end - start) * rect->height;
+}
+#endif
+
+/**
+ * @brief Writes a pixel in the virtual buffer without marking it dirty.
+ *
+ * @details Writes a pixel in the virtual buffer, blending it with the current
+ * pixel when the alpha component is not 0xFF. Pixels outside of the screen are
+ * ignored.
+ *
+ * @param[in] x The x coordinate of the pixel.
+ * @param[in] y The y coordinate of the pixel.
+ * @param[in] alpha The alpha component of the pixel.
+ * @param[in] red The red component of the pixel.
+ * @param[in] green The green component of the pixel.
+ * @param[in] blue The blue component of the pixel.
+ */
+static __inline__ void vesa_put_pixel(const uint32_t x, const uint32_t y,
+                                      const uint8_t alpha, const uint8_t red,
+                                      const uint8_t green, const uint8_t blue)
+{
+    uint32_t* addr;
+    uint8_t   pixel[4] = {0};
+    uint8_t*  back;
+
+    if(x >= current_mode->width || y >= current_mode->height)
+    {
+        return;
+    }
+
+    /* Get framebuffer address */
+    addr = ((uint32_t*)virt_buffer) +
+                        (current_mode->width * y) + x;
+
+    back = (uint8_t*)addr;
+
+    if(alpha == 0xFF)
+    {
+        pixel[0] = blue;
+        pixel[1] = green;
+        pixel[2] = red;
+        pixel[3] = 0;
+    }
+    else if(alpha != 0x00)
+    {
+        pixel[0] = (blue * alpha + back[0] * (255 - alpha)) >> 8;
+        pixel[1] = (green * alpha + back[1] * (255 - alpha)) >> 8;
+        pixel[2] = (red * alpha + back[2] * (255 - alpha)) >> 8;
+        pixel[3] = 0;
+    }
+    else
+    {
+        return;
+    }
+
+    *addr = *((uint32_t*)pixel);
+}
+
+/**
+ * @brief Fills or blends an area of the screen with a color.
+ *
+ * @details The color is written when its alpha component is 0xFF, blended
+ * when it is not 0 and ignored otherwise. The area must be on the screen.
+ *
+ * @param[in] x The x coordinate of the area.
+ * @param[in] y The y coordinate of the area.
+ * @param[in] width The width of the area.
+ * @param[in] height The height of the area.
+ * @param[in] color The ARGB color of the area.
+ */
+static void vesa_color_area(const uint32_t x, const uint32_t y,
+                            const uint32_t width, const uint32_t height,
+                            const uint32_t color)
+{
+    uint32_t* dst;
+    uint32_t  i;
+
+    if((color >> 24) == 0)
+    {
+        return;
+    }
+
+    dst = ((uint32_t*)virt_buffer) + current_mode->width * y + x;
+    for(i = 0; i < height; ++i)
+    {
+        if((color >> 24) == 0xFF)
+        {
+            vesa_fill_span(dst, color & 0x00FFFFFF, width);
+        }
+        else
+        {
+            vesa_blend_span(dst, color, width);
+        }
+        dst += current_mode->width;
+    }
+    vesa_mark_dirty(x, y, width, height);
+}
+
+/**
+ * @brief Draws an 8 pixels wide glyph.
+ *
+ * @details Opaque glyphs that fit on the screen are drawn by rows, the others
+ * are drawn pixel per pixel to blend and clip them.
+ *
+ * @param[in] glyph The glyph rows, the most significant bit is the leftmost
+ * pixel.
+ * @param[in] x The x coordinate of the glyph.
+ * @param[in] y The y coordinate of the glyph.
+ * @param[in] height The number of rows of the glyph.
+ * @param[in] fgcolor The ARGB foreground color.
+ * @param[in] bgcolor The ARGB background color.
+ */
+static void vesa_glyph(const uint8_t* glyph, const uint32_t x, const uint32_t y,
+                       const uint32_t height,
+                       const uint32_t fgcolor, const uint32_t bgcolor)
+{
+    uint32_t color;
+    uint32_t i;
+    uint32_t j;
+
+    if(x + 8 <= current_mode->width && y + height <= current_mode->height &&
+       (fgcolor >> 24) == 0xFF && (bgcolor >> 24) == 0xFF)
+    {
+        vesa_glyph_span(((uint32_t*)virt_buffer) + current_mode->width * y + x,
+                        current_mode->width, glyph, height,
+                        fgcolor & 0x00FFFFFF, bgcolor & 0x00FFFFFF);
+    }
+    else
+    {
+        for(j = 0; j < height; ++j)
+        {
+            for(i = 0; i < 8; ++i)
+            {
+                color = (glyph[j] & (0x80 >> i)) != 0 ? fgcolor : bgcolor;
+                vesa_put_pixel(x + i, y + j,
+                               (color >> 24) & 0xFF, (color >> 16) & 0xFF,
+                               (color >> 8) & 0xFF, color & 0xFF);
+            }
+        }
+    }
+    vesa_mark_dirty(x, y, 8, height);
+}
+
+/**
+ * @brief Sets consecutive text cells of a console line with the current color
+ * scheme.
+ *
+ * @param[in] line The console line of the cells.
+ * @param[in] column The console column of the first cell.
+ * @param[in] count The number of cells to set.
+ * @param[in] character The character of the cells.
+ */
+static void vesa_set_cells(const uint32_t line, const uint32_t column,
+                           uint32_t count, const char character)
+{
+    scrollback_cell_t* cell;
+
+    if(console_cells == NULL ||
+       line >= console_lines || column >= console_columns)
+    {
+        return;
+    }
+    if(column + count > console_columns)
+    {
+        count = console_columns - column;
+    }
+
+    cell = console_cells + line * console_columns + column;
+    while(count-- > 0)
+    {
+        cell->character = character;
+        cell->fgcolor   = screen_scheme.foreground;
+        cell->bgcolor   = transparent_char ? 0 : screen_scheme.background;
+        ++cell;
+    }
+}
+
+/**
+ * @brief Draws a console character with the current color scheme and keeps it
+ * in the console text cells.
+ *
+ * @param[in] character The character to draw.
+ * @param[in] x The x coordinate of the character.
+ * @param[in] y The y coordinate of the character.
+ */
+static void vesa_console_char(const char character,
+                              const uint32_t x, const uint32_t y)
+{
+    vesa_drawchar(character, x, y, screen_scheme.foreground,
+                  transparent_char ? 0 : screen_scheme.background);
+    vesa_set_cells(y / font_height, x / font_width, 1, character);
+}
+
+/**
+ * @brief Draws a line of text cells on a console line. The line is cleared
+ * first, the columns after the cells are left blank.
+ *
+ * @param[in] line The console line to draw.
+ * @param[in] cells The text cells.
+ * @param[in] size The number of text cells.
+ */
+static void vesa_render_cells(const uint32_t line,
+                              const scrollback_cell_t* cells,
+                              uint32_t size)
+{
+    uint32_t i;
+
+    if(size > console_columns)
+    {
+        size = console_columns;
+    }
+
+    vesa_color_area(0, line * font_height, current_mode->width, font_height,
+                    screen_scheme.background | 0xFF000000);
+    for(i = 0; i < size; ++i)
+    {
+        if(cells[i].character > 32 && cells[i].character < 127)
+        {
+            vesa_drawchar(cells[i].character, i * font_width,
+                          line * font_height,
+                          cells[i].fgcolor, cells[i].bgcolor);
+        }
+        else if((cells[i].bgcolor >> 24) != 0 &&
+                cells[i].bgcolor != (screen_scheme.background | 0xFF000000))
+        {
+            vesa_color_area(i * font_width, line * font_height,
+                            font_width, font_height, cells[i].bgcolor);
+        }
+    }
+}
+
+/**
+ * @brief Fills an area of the screen with the console background color.
+ *
+ * @param[in] x The x coordinate of the area.
+ * @param[in] y The y coordinate of the area.
+ * @param[in] width The width of the area.
+ * @param[in] height The height of the area.
+ */
+static void vesa_erase_area(const uint32_t x, const uint32_t y,
+                            uint32_t width, uint32_t height)
+{
+    uint32_t line;
+
+    if(x >= current_mode->width || y >= current_mode->height)
+    {
+        return;
+    }
+    if(x + width > current_mode->width)
+    {
+        width = current_mode->width - x;
+    }
+    if(y + height > current_mode->height)
+    {
+        height = current_mode->height - y;
+    }
+
+    vesa_color_area(x, y, width, height, screen_scheme.background);
+
+    /* The area cells are blank */
+    for(line = y / font_height;
+        line < (y + height + font_height - 1) / font_height;
+        ++line)
+    {
+        vesa_set_cells(line, x / font_width,
+                       (width + font_width - 1) / font_width, ' ');
+    }
+}
+
 /**
  * @brief Processes the character in parameters.
  *
@@ -217,14 +1165,17 @@ static void fast_memcpy(void* dst, const void* src, const uint32_t size)
  */
 static void vesa_process_char(const char character)
 {
-    uint32_t i;
-    uint32_t j;
-
 #if (KERNEL_DEBUG == 1) | (TEST_MODE_ENABLED == 1)
     /* Write on serial */
     serial_write(COM1, character);
 #endif
 
+    /* Output goes back to the screen content */
+    if(scrollback_view != 0)
+    {
+        vesa_show_scrollback(0);
+    }
+
     /* If character is a normal ASCII character */
     if(character > 31 && character < 127)
     {
@@ -232,17 +1183,9 @@ static void vesa_process_char(const char character)
         if(screen_cursor.x + font_width >= current_mode->width)
         {
             /* remove cursor */
-            for(i = screen_cursor.x; i < current_mode->width; ++i)
-            {
-                for(j = screen_cursor.y; j < screen_cursor.y + font_height; ++j)
-                {
-                    vesa_draw_pixel(i, j,
-                               (screen_scheme.background & 0xFF000000) >> 24,
-                               (screen_scheme.background & 0x00FF0000) >> 16,
-                               (screen_scheme.background & 0x0000FF00) >> 8,
-                               (screen_scheme.background & 0x000000FF));
-                }
-            }
+            vesa_erase_area(screen_cursor.x, screen_cursor.y,
+                            current_mode->width - screen_cursor.x,
+                            font_height);
             vesa_put_cursor_at(screen_cursor.y + font_height, 0);
             last_columns[(screen_cursor.y / font_height)] = screen_cursor.x;
         }
@@ -257,25 +1200,16 @@ static void vesa_process_char(const char character)
         vesa_put_cursor_at(screen_cursor.y, screen_cursor.x + font_width);
 
         /* Display character */
-        vesa_drawchar(character, screen_cursor.x - font_width, screen_cursor.y,
-                      screen_scheme.foreground,
-                      transparent_char ? 0 : screen_scheme.background);
+        vesa_console_char(character, screen_cursor.x - font_width,
+                          screen_cursor.y);
 
         /* Manage end of line cursor position */
         if(screen_cursor.x + font_width >= current_mode->width)
         {
             /* remove cursor */
-            for(i = screen_cursor.x; i < current_mode->width; ++i)
-            {
-                for(j = screen_cursor.y; j < screen_cursor.y + font_height; ++j)
-                {
-                    vesa_draw_pixel(i, j,
-                                (screen_scheme.background & 0xFF000000) >> 24,
-                                (screen_scheme.background & 0x00FF0000) >> 16,
-                                (screen_scheme.background & 0x0000FF00) >> 8,
-                                (screen_scheme.background & 0x000000FF));
-                }
-            }
+            vesa_erase_area(screen_cursor.x, screen_cursor.y,
+                            current_mode->width - screen_cursor.x,
+                            font_height);
             vesa_put_cursor_at(screen_cursor.y + font_height, 0);
         }
         last_columns[(screen_cursor.y / font_height)] = screen_cursor.x;
@@ -293,13 +1227,9 @@ static void vesa_process_char(const char character)
                 {
                     if(screen_cursor.x > last_printed_cursor.x)
                     {
-                        vesa_drawchar(' ', screen_cursor.x, screen_cursor.y,
-                                      screen_scheme.foreground,
-                                      transparent_char ? 0 : screen_scheme.background);
-                        vesa_drawchar(' ',
-                                screen_cursor.x - font_width, screen_cursor.y,
-                                screen_scheme.foreground,
-                                transparent_char ? 0 : screen_scheme.background);
+                        vesa_console_char(' ', screen_cursor.x, screen_cursor.y);
+                        vesa_console_char(' ',
+                                screen_cursor.x - font_width, screen_cursor.y);
                         vesa_put_cursor_at(screen_cursor.y,
                                            screen_cursor.x - font_width);
                         last_columns[(screen_cursor.y / font_height)] =
@@ -310,13 +1240,9 @@ static void vesa_process_char(const char character)
                 {
                     if(screen_cursor.x > 0)
                     {
-                        vesa_drawchar(' ', screen_cursor.x, screen_cursor.y,
-                                      screen_scheme.foreground,
-                                      transparent_char ? 0 : screen_scheme.background);
-                        vesa_drawchar(' ',
-                                screen_cursor.x - font_width, screen_cursor.y,
-                                screen_scheme.foreground,
-                                transparent_char ? 0 : screen_scheme.background);
+                        vesa_console_char(' ', screen_cursor.x, screen_cursor.y);
+                        vesa_console_char(' ',
+                                screen_cursor.x - font_width, screen_cursor.y);
                         vesa_put_cursor_at(screen_cursor.y,
                                            screen_cursor.x - font_width);
                         last_columns[(screen_cursor.y / font_height)] =
@@ -325,14 +1251,10 @@ static void vesa_process_char(const char character)
                     }
                     else
                     {
-                        vesa_drawchar(' ', screen_cursor.x, screen_cursor.y,
-                                      screen_scheme.foreground,
-                                      transparent_char ? 0 : screen_scheme.background);
-                        vesa_drawchar(' ',
+                        vesa_console_char(' ', screen_cursor.x, screen_cursor.y);
+                        vesa_console_char(' ',
                             last_columns[(screen_cursor.y / font_height) - 1],
-                            screen_cursor.y - font_height,
-                            screen_scheme.foreground,
-                            transparent_char ? 0 : screen_scheme.background);
+                            screen_cursor.y - font_height);
                         vesa_put_cursor_at(screen_cursor.y - font_height,
                             last_columns[(screen_cursor.y / font_height) - 1]);
                     }
@@ -361,40 +1283,16 @@ static void vesa_process_char(const char character)
             case '\n':
 
                 /* remove cursor */
-                for(i = screen_cursor.x; i < current_mode->width; ++i)
-                {
-                    for(j = screen_cursor.y;
-                        j < screen_cursor.y + font_height;
-                        ++j)
-                    {
-                        vesa_draw_pixel(i, j,
-                                (screen_scheme.background & 0xFF000000) >> 24,
-                                (screen_scheme.background & 0x00FF0000) >> 16,
-                                (screen_scheme.background & 0x0000FF00) >> 8,
-                                (screen_scheme.background & 0x000000FF));
-                    }
-                }
+                vesa_erase_area(screen_cursor.x, screen_cursor.y,
+                                current_mode->width - screen_cursor.x,
+                                font_height);
                 last_columns[(screen_cursor.y / font_height)] = screen_cursor.x;
                 if(screen_cursor.y + font_height <=
                    current_mode->height - font_height)
                 {
                     /* remove cursor */
-                    for(i = screen_cursor.x;
-                        i < current_mode->width &&
-                        i < screen_cursor.x + font_width;
-                         ++i)
-                    {
-                        for(j = screen_cursor.y;
-                            j < screen_cursor.y + font_height;
-                            ++j)
-                        {
-                            vesa_draw_pixel(i, j,
-                                (screen_scheme.background & 0xFF000000) >> 24,
-                                (screen_scheme.background & 0x00FF0000) >> 16,
-                                (screen_scheme.background & 0x0000FF00) >> 8,
-                                (screen_scheme.background & 0x000000FF));
-                        }
-                    }
+                    vesa_erase_area(screen_cursor.x, screen_cursor.y,
+                                    font_width, font_height);
                     vesa_put_cursor_at(screen_cursor.y + font_height, 0);
                     last_columns[(screen_cursor.y / font_height)] =
                                                                 screen_cursor.x;
@@ -476,6 +1374,11 @@ OS_RETURN_E vesa_init(void)
         return OS_ERR_VESA_NOT_SUPPORTED;
     }
 
+#if DISPLAY_TYPE == DISPLAY_VESA_BUF
+    /* The video memory size is given in 64KB blocks */
+    video_memory_size = (uint32_t)vbe_info_base.video_memory * 0x10000;
+#endif
+
     /* Get modes */
     modes = (uint16_t*)(uintptr_t)vbe_info_base.video_modes;
     for (i = 0 ; mode_count < MAX_VESA_MODE_COUNT && modes[i] != 0xFFFF ; ++i)
@@ -616,6 +1519,8 @@ OS_RETURN_E vesa_text_vga_to_vesa(void)
 
     vesa_clear_screen();
 
+    /* The history cells use the VGA colors */
+    scrollback_clear();
 
     vga_fb = temp_buffer;
 
@@ -655,6 +1560,7 @@ OS_RETURN_E vesa_text_vga_to_vesa(void)
 
     /* Restore previous screen scheme */
     screen_scheme = old_colorscheme;
+    vesa_present();
 
 #if VESA_KERNEL_DEBUG == 1
     kernel_serial_debug("VESA VGA Text to VESA\n");
@@ -702,16 +1608,16 @@ OS_RETURN_E vesa_set_vesa_mode(const vesa_mode_info_t mode)
 {
     bios_int_regs_t regs;
     uint32_t        last_columns_size;
+    uint32_t        cells_size;
     vesa_mode_t*    cursor;
     OS_RETURN_E     err;
     uint32_t        page_count;
     uint32_t        buffer_size;
     size_t          current_buffer_size;
     size_t          current_buffer_page_count;
-
-#if DISPLAY_TYPE == DISPLAY_VESA_BUF  
-    void*           virt_buffer_frames;
-#endif
+    uint32_t        hw_page_count;
+    uint32_t        hw_size;
+    uint32_t        flip;
 
     if(vesa_supported == 0)
     {
@@ -719,6 +1625,7 @@ OS_RETURN_E vesa_set_vesa_mode(const vesa_mode_info_t mode)
     }
 
     err = OS_NO_ERR;
+    current_buffer_page_count = 0;
 
     /* Search for the mode in the saved modes */
     cursor = saved_modes;
@@ -754,6 +1661,21 @@ OS_RETURN_E vesa_set_vesa_mode(const vesa_mode_info_t mode)
         ++page_count;
     }
 
+    /* Map a second page for page flipping if the video memory can hold it */
+    flip = 0;
+#if DISPLAY_TYPE == DISPLAY_VESA_BUF && VESA_PAGE_FLIPPING == 1
+    if(video_memory_size / 2 >= buffer_size)
+    {
+        flip = 1;
+    }
+#endif
+    hw_size       = buffer_size * (flip + 1);
+    hw_page_count = hw_size / KERNEL_PAGE_SIZE;
+    if(hw_size % KERNEL_PAGE_SIZE != 0)
+    {
+        ++hw_page_count;
+    }
+
     if(current_mode != NULL)
     {
         current_buffer_size = current_mode->width *
@@ -771,7 +1693,7 @@ OS_RETURN_E vesa_set_vesa_mode(const vesa_mode_info_t mode)
     {
         memalloc_free_kpages(cursor->framebuffer, page_count);
     }
-    cursor->framebuffer = memalloc_alloc_kpages(page_count, &err);
+    cursor->framebuffer = memalloc_alloc_kpages(hw_page_count, &err);
     if(cursor->framebuffer == 0 || err != OS_NO_ERR)
     {
         return err;
@@ -789,7 +1711,7 @@ OS_RETURN_E vesa_set_vesa_mode(const vesa_mode_info_t mode)
     virt_buffer = memalloc_alloc_kpages(page_count, &err);
     if(err != OS_NO_ERR)
     {
-        memalloc_free_kpages(cursor->framebuffer, page_count);
+        memalloc_free_kpages(cursor->framebuffer, hw_page_count);
         cursor->framebuffer = NULL;
         return err;
     }
@@ -797,7 +1719,7 @@ OS_RETURN_E vesa_set_vesa_mode(const vesa_mode_info_t mode)
                       0, 0);
     if(err != OS_NO_ERR)
     {
-        memalloc_free_kpages(cursor->framebuffer, page_count);
+        memalloc_free_kpages(cursor->framebuffer, hw_page_count);
         memalloc_free_kpages(virt_buffer, page_count);
         cursor->framebuffer = NULL;
         virt_buffer = NULL;
@@ -813,11 +1735,10 @@ OS_RETURN_E vesa_set_vesa_mode(const vesa_mode_info_t mode)
         cursor->bpp = 32;
     }
     err = kernel_mmap_hw((void*)cursor->framebuffer, (void*)cursor->framebuffer_phy,
-                         cursor->width * cursor->height * (cursor->bpp / 8),
-                         0, 0);
+                         hw_size, 0, 0);
     if(err != OS_NO_ERR)
     {
-        memalloc_free_kpages(cursor->framebuffer, page_count);
+        memalloc_free_kpages(cursor->framebuffer, hw_page_count);
         cursor->framebuffer = NULL;
 #if DISPLAY_TYPE == DISPLAY_VESA_BUF
         memalloc_free_kpages(virt_buffer, page_count);
@@ -835,7 +1756,7 @@ OS_RETURN_E vesa_set_vesa_mode(const vesa_mode_info_t mode)
     last_columns = kmalloc(last_columns_size);
     if(last_columns == NULL)
     {
-        memalloc_free_kpages(cursor->framebuffer, page_count);
+        memalloc_free_kpages(cursor->framebuffer, hw_page_count);
         cursor->framebuffer = NULL;
 #if DISPLAY_TYPE == DISPLAY_VESA_BUF
         memalloc_free_kpages(virt_buffer, page_count);
@@ -845,6 +1766,31 @@ OS_RETURN_E vesa_set_vesa_mode(const vesa_mode_info_t mode)
     }
     fast_memset(last_columns, 0, last_columns_size);
 
+    /* Set the console text cells */
+    cells_size = sizeof(scrollback_cell_t) *
+                 (cursor->width / font_width) * (cursor->height / font_height);
+    if(console_cells != NULL)
+    {
+        kfree(console_cells);
+    }
+    console_cells = kmalloc(cells_size);
+    if(console_cells == NULL)
+    {
+        memalloc_free_kpages(cursor->framebuffer, hw_page_count);
+        cursor->framebuffer = NULL;
+        kfree(last_columns);
+        last_columns = NULL;
+#if DISPLAY_TYPE == DISPLAY_VESA_BUF
+        memalloc_free_kpages(virt_buffer, page_count);
+        virt_buffer = NULL;
+#endif
+        return OS_ERR_MALLOC;
+    }
+    fast_memset(console_cells, 0, cells_size);
+    console_columns = cursor->width / font_width;
+    console_lines   = cursor->height / font_height;
+    scrollback_view = 0;
+
     /* Set the VESA mode */
     regs.ax = BIOS_CALL_SET_VESA_MODE;
     regs.bx = cursor->mode_id | VESA_FLAG_LFB_ENABLE;
@@ -853,10 +1799,12 @@ OS_RETURN_E vesa_set_vesa_mode(const vesa_mode_info_t mode)
     /* Check call result */
     if(regs.ax != 0x004F)
     {
-        memalloc_free_kpages(cursor->framebuffer, page_count);
+        memalloc_free_kpages(cursor->framebuffer, hw_page_count);
         cursor->framebuffer = NULL;
         kfree(last_columns);
         last_columns = NULL;
+        kfree(console_cells);
+        console_cells = NULL;
 #if DISPLAY_TYPE == DISPLAY_VESA_BUF
         memalloc_free_kpages(virt_buffer, page_count);
         virt_buffer = NULL;
@@ -868,12 +1816,28 @@ OS_RETURN_E vesa_set_vesa_mode(const vesa_mode_info_t mode)
 
     current_mode = cursor;
 
+#if DISPLAY_TYPE == DISPLAY_VESA_BUF
+    /* The mode is set with the first page displayed */
+    page_flipping = flip;
+    front_page    = 0;
+    flip_count    = 0;
+
+    /* The new virtual buffer is copied by the next flush */
+    dirty_count = 0;
+    vesa_mark_dirty(0, 0, current_mode->width, current_mode->height);
+    vesa_present();
+#else
+    (void)flip;
+#endif
+
     if(err != OS_NO_ERR)
     {
-        memalloc_free_kpages(cursor->framebuffer, page_count);
+        memalloc_free_kpages(cursor->framebuffer, hw_page_count);
         cursor->framebuffer = NULL;
         kfree(last_columns);
         last_columns = NULL;
+        kfree(console_cells);
+        console_cells = NULL;
 #if DISPLAY_TYPE == DISPLAY_VESA_BUF
         memalloc_free_kpages(virt_buffer, page_count);
         virt_buffer = NULL;
@@ -929,10 +1893,6 @@ __inline__ OS_RETURN_E vesa_draw_pixel(const uint16_t x, const uint16_t y,
                                        const uint8_t alpha, const uint8_t red,
                                        const uint8_t green, const uint8_t blue)
 {
-    uint32_t* addr;
-    uint8_t   pixel[4] = {0};
-    uint8_t*  back;
-
     if(vesa_supported == 0)
     {
         return OS_ERR_VESA_NOT_SUPPORTED;
@@ -943,38 +1903,52 @@ __inline__ OS_RETURN_E vesa_draw_pixel(const uint16_t x, const uint16_t y,
         return OS_ERR_VESA_NOT_INIT;
     }
 
-    if(x > current_mode->width || y > current_mode->height)
+    if(x >= current_mode->width || y >= current_mode->height)
     {
         return OS_ERR_OUT_OF_BOUND;
     }
 
-    /* Get framebuffer address */
-    addr = ((uint32_t*)virt_buffer) +
-                        (current_mode->width * y) + x;
+    vesa_put_pixel(x, y, alpha, red, green, blue);
+    vesa_mark_dirty(x, y, 1, 1);
 
-    back = (uint8_t*)addr;
+    return OS_NO_ERR;
+}
 
-    if(alpha == 0xFF)
+/**
+ * @brief Checks that an area can be drawn.
+ *
+ * @param[in] x The x coordinate of the area.
+ * @param[in] y The y coordinate of the area.
+ * @param[in] width The width of the area.
+ * @param[in] height The height of the area.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_VESA_NOT_SUPPORTED if the graphic driver is cannot handle VESA on
+ *   the system.
+ * - OS_ERR_VESA_NOT_INIT if the VESA driver has not been initialized before
+ *   calling this function.
+ * - OS_ERR_OUT_OF_BOUND if the area is out of the screen bounds.
+ */
+static OS_RETURN_E vesa_check_area(const uint32_t x, const uint32_t y,
+                                   const uint32_t width, const uint32_t height)
+{
+    if(vesa_supported == 0)
     {
-        pixel[0] = blue;
-        pixel[1] = green;
-        pixel[2] = red;
-        pixel[3] = 0;
+        return OS_ERR_VESA_NOT_SUPPORTED;
     }
-    else if(alpha != 0x00)
+
+    if(current_mode == NULL)
     {
-        pixel[0] = (blue * alpha + back[0] * (255 - alpha)) >> 8;
-        pixel[1] = (green * alpha + back[1] * (255 - alpha)) >> 8;
-        pixel[2] = (red * alpha + back[2] * (255 - alpha)) >> 8;
-        pixel[3] = 0;
+        return OS_ERR_VESA_NOT_INIT;
     }
-    else
+
+    if(x > current_mode->width || width > current_mode->width - x ||
+       y > current_mode->height || height > current_mode->height - y)
     {
-        return OS_NO_ERR;
+        return OS_ERR_OUT_OF_BOUND;
     }
 
-    *addr = *((uint32_t*)pixel);
-
     return OS_NO_ERR;
 }
 
@@ -986,32 +1960,106 @@ __inline__ OS_RETURN_E vesa_draw_rectangle(const uint16_t x, const uint16_t y,
                                            const uint8_t green,
                                            const uint8_t blue)
 {
-    uint16_t i;
-    uint16_t j;
+    OS_RETURN_E err;
 
-    if(vesa_supported == 0)
+    err = vesa_check_area(x, y, width, height);
+    if(err != OS_NO_ERR)
     {
-        return OS_ERR_VESA_NOT_SUPPORTED;
+        return err;
     }
 
-    if(current_mode == NULL)
+    vesa_color_area(x, y, width, height,
+                    ((uint32_t)alpha << 24) | ((uint32_t)red << 16) |
+                    ((uint32_t)green << 8) | blue);
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E vesa_fill_rectangle(const uint32_t x, const uint32_t y,
+                                const uint32_t width, const uint32_t height,
+                                const uint32_t color)
+{
+    OS_RETURN_E err;
+
+    err = vesa_check_area(x, y, width, height);
+    if(err != OS_NO_ERR)
     {
-        return OS_ERR_VESA_NOT_INIT;
+        return err;
+    }
+
+    vesa_color_area(x, y, width, height, color | 0xFF000000);
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E vesa_blend_rectangle(const uint32_t x, const uint32_t y,
+                                 const uint32_t width, const uint32_t height,
+                                 const uint32_t color)
+{
+    OS_RETURN_E err;
+
+    err = vesa_check_area(x, y, width, height);
+    if(err != OS_NO_ERR)
+    {
+        return err;
     }
 
-    if(x + width > current_mode->width || y + height > current_mode->height)
+    vesa_color_area(x, y, width, height, color);
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E vesa_copy_rectangle(const uint32_t x, const uint32_t y,
+                                const uint32_t width, const uint32_t height,
+                                const uint32_t* src, const uint32_t src_pitch)
+{
+    OS_RETURN_E err;
+    uint32_t*   dst;
+    uint32_t    i;
+
+    if(src == NULL)
     {
-        return OS_ERR_OUT_OF_BOUND;
+        return OS_ERR_NULL_POINTER;
     }
 
-    for(i = y; i < y + height; ++i)
+    err = vesa_check_area(x, y, width, height);
+    if(err != OS_NO_ERR)
     {
-        for(j = x; j < x + width; ++j)
-        {
-            vesa_draw_pixel(j, i, alpha, red, green, blue);
-        }
+        return err;
+    }
+
+    dst = ((uint32_t*)virt_buffer) + current_mode->width * y + x;
+    for(i = 0; i < height; ++i)
+    {
+        vesa_copy_span(dst, src, width);
+        dst += current_mode->width;
+        src += src_pitch;
+    }
+    vesa_mark_dirty(x, y, width, height);
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E vesa_blit_glyph(const uint8_t* glyph,
+                            const uint32_t x, const uint32_t y,
+                            const uint32_t height,
+                            const uint32_t fgcolor, const uint32_t bgcolor)
+{
+    OS_RETURN_E err;
+
+    if(glyph == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    err = vesa_check_area(x, y, 8, height);
+    if(err != OS_NO_ERR)
+    {
+        return err;
     }
 
+    vesa_glyph(glyph, x, y, height, fgcolor, bgcolor);
+
     return OS_NO_ERR;
 }
 
@@ -1019,25 +2067,96 @@ void vesa_drawchar(const unsigned char charracter,
                    const uint32_t x, const uint32_t y,
                    const uint32_t fgcolor, const uint32_t bgcolor)
 {
-    uint32_t cx;
-    uint32_t cy;
+    vesa_glyph_entry_t* entry;
+    uint32_t*           dst;
+    uint32_t            int_state;
+    uint32_t            index;
+    uint32_t            i;
+
+    if(current_mode == NULL)
+    {
+        return;
+    }
 
-    uint32_t mask[8] = {1, 2, 4, 8, 16, 32, 64, 128};
+    /* Transparent and clipped characters are not cached */
+    if(charracter == 0 ||
+       (fgcolor >> 24) != 0xFF || (bgcolor >> 24) != 0xFF ||
+       x + VESA_GLYPH_WIDTH > current_mode->width ||
+       y + VESA_GLYPH_HEIGHT > current_mode->height)
+    {
+        vesa_glyph(font_bitmap + (charracter - 31) * VESA_GLYPH_HEIGHT, x, y,
+                   VESA_GLYPH_HEIGHT, fgcolor, bgcolor);
+        return;
+    }
 
-    unsigned char *glyph = font_bitmap + (charracter - 31) * 16;
+    /* A color scheme maps the characters to consecutive entries */
+    index = (charracter +
+             (((fgcolor ^ (bgcolor << 7)) * 0x9E3779B1) >> 25)) &
+            (VESA_GLYPH_CACHE_SIZE - 1);
+    entry = &glyph_cache[index];
 
-    uint8_t pixel[4] = {0};
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &glyph_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
 
-    for(cy = 0; cy < 16; ++cy)
+    if(entry->character != charracter ||
+       entry->fgcolor != (fgcolor & 0x00FFFFFF) ||
+       entry->bgcolor != (bgcolor & 0x00FFFFFF))
     {
-        for(cx = 0; cx < 8; ++cx)
-        {
-            *((uint32_t*)pixel) = glyph[cy] & mask[cx] ? fgcolor : bgcolor;
+        entry->character = charracter;
+        entry->fgcolor   = fgcolor & 0x00FFFFFF;
+        entry->bgcolor   = bgcolor & 0x00FFFFFF;
+        vesa_glyph_span(entry->pixels, VESA_GLYPH_WIDTH,
+                        font_bitmap + (charracter - 31) * VESA_GLYPH_HEIGHT,
+                        VESA_GLYPH_HEIGHT, entry->fgcolor, entry->bgcolor);
+        ++glyph_stats.misses;
+    }
+    else
+    {
+        ++glyph_stats.hits;
+    }
 
-            vesa_draw_pixel(x + (7 - cx ), y + cy,
-                            pixel[3], pixel[2], pixel[1], pixel[0]);
-        }
+    dst = ((uint32_t*)virt_buffer) + current_mode->width * y + x;
+    for(i = 0; i < VESA_GLYPH_HEIGHT; ++i)
+    {
+        vesa_copy_span(dst, entry->pixels + i * VESA_GLYPH_WIDTH,
+                       VESA_GLYPH_WIDTH);
+        dst += current_mode->width;
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &glyph_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    vesa_mark_dirty(x, y, VESA_GLYPH_WIDTH, VESA_GLYPH_HEIGHT);
+}
+
+OS_RETURN_E vesa_get_glyph_cache_stats(vesa_glyph_cache_stats_t* stats)
+{
+    uint32_t int_state;
+
+    if(stats == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
     }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &glyph_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+    *stats = glyph_stats;
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &glyph_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return OS_NO_ERR;
 }
 
 uint32_t vesa_get_screen_width(void)
@@ -1084,6 +2203,14 @@ void vesa_clear_screen(void)
     fast_memset(buffer, 0, current_mode->width *
            current_mode->height *
            (current_mode->bpp / 8));
+    if(console_cells != NULL)
+    {
+        fast_memset(console_cells, 0, sizeof(scrollback_cell_t) *
+                                      console_columns * console_lines);
+    }
+    scrollback_view = 0;
+    vesa_mark_dirty(0, 0, current_mode->width, current_mode->height);
+    vesa_present();
 }
 
 OS_RETURN_E vesa_put_cursor_at(const uint32_t line, const uint32_t column)
@@ -1124,6 +2251,7 @@ OS_RETURN_E vesa_put_cursor_at(const uint32_t line, const uint32_t column)
             vesa_draw_pixel(column + 1, line + i, 0xFF, 0xFF, 0xFF, 0xFF);
         }
     }
+    vesa_present();
 
     return OS_NO_ERR;
 }
@@ -1155,65 +2283,70 @@ OS_RETURN_E vesa_restore_cursor(const cursor_t buffer)
     return OS_NO_ERR;
 }
 
-/* Scroll in the desired direction of lines_count lines.
- *
- * @param direction The direction to whoch the console should be scrolled.
- * @param lines_count The number of lines to scroll.
- */
 void vesa_scroll(const SCROLL_DIRECTION_E direction,
                  const uint32_t lines_count)
 {
-    uint8_t to_scroll;
-
-    int32_t q;
-    int32_t m;
-    uint32_t* buffer_addr;
-    uint32_t line_size;
-    uint32_t bpp_size;
+    uint32_t to_scroll;
+    uint32_t kept;
     uint32_t line_mem_size;
+    uint32_t i;
 
-    to_scroll = lines_count;
+    if(current_mode == NULL || console_lines == 0)
+    {
+        return;
+    }
 
-    q = current_mode->height / font_height;
-    m = current_mode->height % (q * font_height);
+    if(scrollback_view != 0)
+    {
+        vesa_show_scrollback(0);
+    }
 
-    buffer_addr = (uint32_t*)virt_buffer;
+    if(console_lines < lines_count)
+    {
+        to_scroll = console_lines;
+    }
+    else
+    {
+        to_scroll = lines_count;
+    }
+    kept = console_lines - to_scroll;
 
-    line_size = font_height * current_mode->width;
-    bpp_size = ((current_mode->bpp | 7) >> 3);
-    line_mem_size = bpp_size * line_size;
+    line_mem_size = font_height * current_mode->width *
+                    ((current_mode->bpp | 7) >> 3);
 
     /* Select scroll direction */
     if(direction == SCROLL_DOWN)
     {
-        uint8_t i;
-        uint8_t j;
-        uint32_t* src;
-        uint32_t* dst;
-
-        i = 0;
-        dst = buffer_addr + i * line_size;
-        src = dst + line_size;
-        /* For each line scroll we want */
-        for(j = 0; j < to_scroll; ++j)
+        /* Keep the lines leaving the screen in the history */
+        for(i = 0; i < to_scroll; ++i)
         {
-            /* Copy all the lines to the above one */
-            for(i = 0; i < q - 1; ++i)
-            {
-                dst = buffer_addr + i * line_size;
-                src = dst + line_size;
-                memmove(dst, src ,line_mem_size);
-                last_columns[i] = last_columns[i + 1];
-            }
+            scrollback_push(console_cells + i * console_columns,
+                            console_columns);
         }
-        fast_memset(src, 0, line_mem_size);
+
+        /* Move the retained lines at once */
+        memmove(virt_buffer, virt_buffer + to_scroll * line_mem_size,
+                kept * line_mem_size);
+        memmove(console_cells, console_cells + to_scroll * console_columns,
+                sizeof(scrollback_cell_t) * kept * console_columns);
+        memmove(last_columns, last_columns + to_scroll,
+                sizeof(uint32_t) * kept);
+
+        /* Clear the exposed lines */
+        vesa_color_area(0, kept * font_height,
+                        current_mode->width, to_scroll * font_height,
+                        screen_scheme.background | 0xFF000000);
+        fast_memset(console_cells + kept * console_columns, 0,
+                    sizeof(scrollback_cell_t) * to_scroll * console_columns);
+        fast_memset(last_columns + kept, 0, sizeof(uint32_t) * to_scroll);
+
+        vesa_mark_dirty(0, 0, current_mode->width, current_mode->height);
     }
 
     /* Replace cursor */
-    vesa_put_cursor_at(current_mode->height - m - font_height, 0);
-    last_columns[(screen_cursor.y / font_height)] = 0;
+    vesa_put_cursor_at(kept * font_height, 0);
 
-    if(to_scroll <= last_printed_cursor.y)
+    if(to_scroll * font_height <= last_printed_cursor.y)
     {
         last_printed_cursor.y -= to_scroll * font_height;
     }
@@ -1222,6 +2355,49 @@ void vesa_scroll(const SCROLL_DIRECTION_E direction,
         last_printed_cursor.x = 0;
         last_printed_cursor.y = 0;
     }
+    vesa_present();
+}
+
+OS_RETURN_E vesa_show_scrollback(const uint32_t lines_back)
+{
+    scrollback_cell_t cells[SCROLLBACK_LINE_SIZE];
+    uint32_t          size;
+    uint32_t          line;
+
+    if(current_mode == NULL || console_cells == NULL)
+    {
+        return OS_ERR_NOT_SUPPORTED;
+    }
+    if(lines_back > scrollback_get_count())
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+    if(lines_back == 0 && scrollback_view == 0)
+    {
+        return OS_NO_ERR;
+    }
+    scrollback_view = lines_back;
+
+    /* The history lines are followed by the top of the screen content */
+    for(line = 0; line < console_lines; ++line)
+    {
+        if(line >= lines_back)
+        {
+            vesa_render_cells(line,
+                              console_cells +
+                              (line - lines_back) * console_columns,
+                              console_columns);
+        }
+        else
+        {
+            size = 0;
+            scrollback_get_line(lines_back - 1 - line, cells, &size);
+            vesa_render_cells(line, cells, size);
+        }
+    }
+    vesa_present();
+
+    return OS_NO_ERR;
 }
 
 void vesa_set_color_scheme(const colorscheme_t color_scheme)
@@ -1266,12 +2442,14 @@ void vesa_put_string(const char* string)
         vesa_process_char(string[i]);
         last_printed_cursor = screen_cursor;
     }
+    vesa_present();
 }
 
 void vesa_put_char(const char charactrer)
 {
     vesa_process_char(charactrer);
     last_printed_cursor = screen_cursor;
+    vesa_present();
 }
 
 void vesa_console_write_keyboard(const char* string, const uint32_t size)
@@ -1282,6 +2460,7 @@ void vesa_console_write_keyboard(const char* string, const uint32_t size)
     {
         vesa_process_char(string[i]);
     }
+    vesa_present();
 }
 
 void vesa_fill_screen(const void* pointer)
@@ -1293,21 +2472,145 @@ void vesa_fill_screen(const void* pointer)
            current_mode->width *
            current_mode->height *
            (current_mode->bpp / 8));
+    vesa_mark_dirty(0, 0, current_mode->width, current_mode->height);
 }
 
 void vesa_flush_buffer(void)
 {
 #if DISPLAY_TYPE == DISPLAY_VESA_BUF
-    uint32_t* buffer;
-    uint32_t* hw_buffer;
+    vesa_rect_t     rects[VESA_DIRTY_RECT_COUNT];
+    bios_int_regs_t regs;
+    uint8_t*        hw_buffer;
+    uint32_t        int_state;
+    uint32_t        count;
+    uint32_t        bytes;
+    uint32_t        i;
 
-    buffer = (uint32_t*)virt_buffer_;
-    hw_buffer = (uint32_t*)current_mode->framebuffer;
+    if(current_mode == NULL || virt_buffer == NULL)
+    {
+        return;
+    }
 
-    fast_memcpy(hw_buffer, buffer,
-           current_mode->width *
-           current_mode->height *
-           (current_mode->bpp / 8));
+    /* Take the dirty rectangles, the areas drawn from now on are copied by the
+     * next flush.
+     */
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &dirty_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+    count = dirty_count;
+    memcpy(rects, dirty_rects, sizeof(vesa_rect_t) * count);
+    dirty_count = 0;
+    dirty_last  = 0;
+    if(count == 0)
+    {
+        ++flush_stats.skipped;
+    }
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &dirty_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    if(count == 0)
+    {
+        return;
+    }
+
+    hw_buffer = (uint8_t*)current_mode->framebuffer;
+    bytes     = 0;
+
+    if(page_flipping == 1)
+    {
+        /* The hidden page also misses the areas of the previous frame */
+        hw_buffer += (front_page ^ 1) * current_mode->width *
+                     current_mode->height * (current_mode->bpp / 8);
+        for(i = 0; i < flip_count; ++i)
+        {
+            bytes += vesa_copy_rect(hw_buffer, &flip_rects[i]);
+        }
+    }
+
+    for(i = 0; i < count; ++i)
+    {
+        bytes += vesa_copy_rect(hw_buffer, &rects[i]);
+    }
+
+    if(page_flipping == 1)
+    {
+        /* Display the hidden page on the next vertical retrace */
+        front_page ^= 1;
+        regs.ax = BIOS_CALL_SET_VESA_DISPLAY_START;
+        regs.bx = VESA_DISPLAY_START_VSYNC;
+        regs.cx = 0;
+        regs.dx = front_page * current_mode->height;
+        bios_call(BIOS_INTERRUPT_VESA, &regs);
+
+        memcpy(flip_rects, rects, sizeof(vesa_rect_t) * count);
+        flip_count = count;
+    }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &dirty_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+    ++flush_stats.frames;
+    flush_stats.bytes     += bytes;
+    flush_stats.last_bytes = bytes;
+    flush_stats.flips     += page_flipping;
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &dirty_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+#endif
+}
+
+void vesa_present(void)
+{
+#if DISPLAY_TYPE == DISPLAY_VESA_BUF
+    __atomic_fetch_add(&present_event, 1, __ATOMIC_SEQ_CST);
+
+    /* Only the first present wakes the buffer thread */
+    if(__atomic_exchange_n(&present_waiting, 0, __ATOMIC_SEQ_CST) != 0)
+    {
+        futex_wake(&present_event, 1, NULL);
+    }
+#endif
+}
+
+OS_RETURN_E vesa_get_flush_stats(vesa_flush_stats_t* stats)
+{
+#if DISPLAY_TYPE == DISPLAY_VESA_BUF
+    uint32_t int_state;
+
+    if(stats == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &dirty_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+    *stats = flush_stats;
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &dirty_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return OS_NO_ERR;
+#else
+    if(stats == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    return OS_ERR_NOT_SUPPORTED;
 #endif
 }
 
@@ -1318,13 +2621,43 @@ void vesa_set_transparent_char(const uint32_t enabled)
 
 void* vesa_double_buffer_thread(void* args)
 {
+#if DISPLAY_TYPE == DISPLAY_VESA_BUF
+    int32_t  presented;
+    uint64_t next_frame;
+    uint64_t now;
+
     (void)args;
 
+    presented  = 0;
+    next_frame = 0;
     while(1)
     {
+        /* Sleep until a frame is presented */
+        while(1)
+        {
+            __atomic_store_n(&present_waiting, 1, __ATOMIC_SEQ_CST);
+            if(__atomic_load_n(&present_event, __ATOMIC_SEQ_CST) != presented)
+            {
+                break;
+            }
+            futex_wait(&present_event, presented);
+        }
+        __atomic_store_n(&present_waiting, 0, __ATOMIC_SEQ_CST);
+
+        /* Cap the frame rate, the frames presented meanwhile are merged */
+        now = time_get_current_uptime();
+        if(now < next_frame)
+        {
+            sched_sleep((uint32_t)(next_frame - now));
+        }
+
+        presented = __atomic_load_n(&present_event, __ATOMIC_SEQ_CST);
         vesa_flush_buffer();
-        sched_sleep(30);
+        next_frame = time_get_current_uptime() + VESA_FRAME_PERIOD;
     }
+#else
+    (void)args;
+#endif
 
     return NULL;
-}
\ No newline at end of file
+}
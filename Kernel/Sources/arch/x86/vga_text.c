@@ -26,6 +26,7 @@
 #include <memory/memalloc.h> /* Memory allocation */
 #include <memory/paging.h>   /* Paging management */
 #include <arch_paging.h>     /* Memory paging settings */
+#include <io/scrollback.h>   /* Scrollback history */
 
 /* UTK configuration file */
 #include <config.h>
@@ -67,6 +68,29 @@ static uint8_t last_columns[VGA_TEXT_SCREEN_LINE_SIZE] = {0};
 /** @brief VGA frame buffer address. */
 static uint16_t* vga_framebuffer = (uint16_t*)VGA_TEXT_FRAMEBUFFER;
 
+/**
+ * @brief Cacheable copy of the screen, the driver writes and reads it and
+ * copies the modified cells to the frame buffer when flushing.
+ */
+static uint16_t vga_shadow[VGA_TEXT_SCREEN_LINE_SIZE *
+                           VGA_TEXT_SCREEN_COL_SIZE];
+/** @brief First modified cell of the shadow buffer. */
+static uint32_t dirty_start = VGA_TEXT_SCREEN_LINE_SIZE *
+                              VGA_TEXT_SCREEN_COL_SIZE;
+/** @brief Cell following the last modified cell of the shadow buffer. */
+static uint32_t dirty_end   = 0;
+/** @brief Set to 1 when the cursor moved since the last flush. */
+static uint32_t cursor_dirty = 0;
+
+/**
+ * @brief Number of history lines displayed above the screen content, 0 when
+ * the screen content is displayed.
+ */
+static uint32_t scrollback_view = 0;
+/** @brief Screen content saved while the history is displayed. */
+static uint16_t live_screen[VGA_TEXT_SCREEN_LINE_SIZE *
+                            VGA_TEXT_SCREEN_COL_SIZE];
+
 /**
  * @brief VGA text driver instance.
  */
@@ -87,6 +111,51 @@ kernel_graphic_driver_t vga_text_driver = {
  * FUNCTIONS
  ******************************************************************************/
 
+/**
+ * @brief Adds cells to the modified area of the shadow buffer.
+ *
+ * @param[in] start The first modified cell.
+ * @param[in] end The cell following the last modified cell.
+ */
+inline static void vga_mark_dirty(const uint32_t start, const uint32_t end)
+{
+    if(start < dirty_start)
+    {
+        dirty_start = start;
+    }
+    if(end > dirty_end)
+    {
+        dirty_end = end;
+    }
+}
+
+/**
+ * @brief Places the cursor, the hardware cursor is updated by the next flush.
+ *
+ * @param[in] line The line index where to place the cursor.
+ * @param[in] column The column index where to place the cursor.
+ *
+ * @return The success state or the error code. OS_NO_ERR if no error is
+ * encountered. OS_ERR_OUT_OF_BOUND is returned if the parameters are
+ * out of bound.
+ */
+static OS_RETURN_E vga_move_cursor(const uint32_t line, const uint32_t column)
+{
+    /* Checks the values of line and column */
+    if(column > VGA_TEXT_SCREEN_COL_SIZE ||
+       line > VGA_TEXT_SCREEN_LINE_SIZE)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    /* Set new cursor position */
+    screen_cursor.x = column;
+    screen_cursor.y = line;
+    cursor_dirty    = 1;
+
+    return OS_NO_ERR;
+}
+
 /**
  * @brief Prints a character to the selected coordinates.
  *
@@ -114,6 +183,7 @@ static OS_RETURN_E vga_print_char(const uint32_t line, const uint32_t column,
 
     /* Get address to inject */
     screen_mem = vga_get_framebuffer(line, column);
+    vga_mark_dirty(screen_mem - vga_shadow, screen_mem - vga_shadow + 1);
 
     /* Inject the character with the current colorscheme */
     *screen_mem = character |
@@ -123,6 +193,99 @@ static OS_RETURN_E vga_print_char(const uint32_t line, const uint32_t column,
     return OS_NO_ERR;
 }
 
+/**
+ * @brief Pushes a screen line in the scrollback history.
+ *
+ * @param[in] line The screen line to push.
+ */
+static void vga_push_scrollback(const uint16_t* line)
+{
+    scrollback_cell_t cells[VGA_TEXT_SCREEN_COL_SIZE];
+    uint32_t          i;
+
+    for(i = 0; i < VGA_TEXT_SCREEN_COL_SIZE; ++i)
+    {
+        cells[i].character = line[i] & 0xFF;
+        cells[i].fgcolor   = (line[i] >> 8) & 0x0F;
+        cells[i].bgcolor   = (line[i] >> 8) & 0xF0;
+    }
+
+    scrollback_push(cells, VGA_TEXT_SCREEN_COL_SIZE);
+}
+
+/**
+ * @brief Scrolls the shadow buffer in the desired direction of lines_count
+ * lines.
+ *
+ * @param[in] direction The direction to whoch the console should be scrolled.
+ * @param[in] lines_count The number of lines to scroll.
+ */
+static void vga_scroll_shadow(const SCROLL_DIRECTION_E direction,
+                              const uint32_t lines_count)
+{
+    uint32_t to_scroll;
+
+    if(scrollback_view != 0)
+    {
+        vga_show_scrollback(0);
+    }
+
+    if(VGA_TEXT_SCREEN_LINE_SIZE < lines_count)
+    {
+        to_scroll = VGA_TEXT_SCREEN_LINE_SIZE;
+    }
+    else
+    {
+        to_scroll = lines_count;
+    }
+
+    /* Select scroll direction */
+    if(direction == SCROLL_DOWN)
+    {
+        uint32_t i;
+        uint32_t kept;
+        uint16_t blank = ' ' |
+                         ((screen_scheme.background << 8) & 0xF000) |
+                         ((screen_scheme.foreground << 8) & 0x0F00);
+
+        /* Keep the lines leaving the screen in the history */
+        for(i = 0; i < to_scroll; ++i)
+        {
+            vga_push_scrollback(vga_get_framebuffer(i, 0));
+        }
+
+        /* Move the retained lines at once */
+        kept = VGA_TEXT_SCREEN_LINE_SIZE - to_scroll;
+        memmove(vga_shadow,
+                vga_shadow + to_scroll * VGA_TEXT_SCREEN_COL_SIZE,
+                sizeof(uint16_t) * kept * VGA_TEXT_SCREEN_COL_SIZE);
+        memmove(last_columns, last_columns + to_scroll, kept);
+        memset(last_columns + kept, 0, to_scroll);
+
+        /* Clear the exposed lines */
+        for(i = kept * VGA_TEXT_SCREEN_COL_SIZE;
+            i < VGA_TEXT_SCREEN_LINE_SIZE * VGA_TEXT_SCREEN_COL_SIZE;
+            ++i)
+        {
+            vga_shadow[i] = blank;
+        }
+        vga_mark_dirty(0, VGA_TEXT_SCREEN_LINE_SIZE * VGA_TEXT_SCREEN_COL_SIZE);
+    }
+
+    /* Replace cursor */
+    vga_move_cursor(VGA_TEXT_SCREEN_LINE_SIZE - to_scroll, 0);
+
+    if(to_scroll <= last_printed_cursor.y)
+    {
+        last_printed_cursor.y -= to_scroll;
+    }
+    else
+    {
+        last_printed_cursor.x = 0;
+        last_printed_cursor.y = 0;
+    }
+}
+
 /**
  * @brief Processes the character in parameters.
  *
@@ -139,6 +302,12 @@ static void vga_process_char(const char character)
     serial_write(COM1, character);
 #endif
 
+    /* Output goes back to the screen content */
+    if(scrollback_view != 0)
+    {
+        vga_show_scrollback(0);
+    }
+
     /* If character is a normal ASCII character */
     if(character > 31 && character < 127)
     {
@@ -149,20 +318,20 @@ static void vga_process_char(const char character)
         /* Manage end of line cursor position */
         if(screen_cursor.x > VGA_TEXT_SCREEN_COL_SIZE - 1)
         {
-            vga_put_cursor_at(screen_cursor.y + 1, 0);
+            vga_move_cursor(screen_cursor.y + 1, 0);
             last_columns[screen_cursor.y] = screen_cursor.x;
         }
 
         /* Manage end of screen cursor position */
         if(screen_cursor.y >= VGA_TEXT_SCREEN_LINE_SIZE)
         {
-            vga_scroll(SCROLL_DOWN, 1);
+            vga_scroll_shadow(SCROLL_DOWN, 1);
 
         }
         else
         {
             /* Move cursor */
-            vga_put_cursor_at(screen_cursor.y, screen_cursor.x);
+            vga_move_cursor(screen_cursor.y, screen_cursor.x);
             last_columns[screen_cursor.y] = screen_cursor.x;
         }
     }
@@ -177,7 +346,7 @@ static void vga_process_char(const char character)
                 {
                     if(screen_cursor.x > last_printed_cursor.x)
                     {
-                        vga_put_cursor_at(screen_cursor.y, screen_cursor.x - 1);
+                        vga_move_cursor(screen_cursor.y, screen_cursor.x - 1);
                         last_columns[screen_cursor.y] = screen_cursor.x;
                         vga_print_char(screen_cursor.y, screen_cursor.x, ' ');
                     }
@@ -186,7 +355,7 @@ static void vga_process_char(const char character)
                 {
                     if(screen_cursor.x > 0)
                     {
-                        vga_put_cursor_at(screen_cursor.y, screen_cursor.x - 1);
+                        vga_move_cursor(screen_cursor.y, screen_cursor.x - 1);
                         last_columns[screen_cursor.y] = screen_cursor.x;
                         vga_print_char(screen_cursor.y, screen_cursor.x, ' ');
                     }
@@ -199,7 +368,7 @@ static void vga_process_char(const char character)
                                VGA_TEXT_SCREEN_COL_SIZE - 1;
                         }
 
-                        vga_put_cursor_at(screen_cursor.y - 1,
+                        vga_move_cursor(screen_cursor.y - 1,
                                       last_columns[screen_cursor.y - 1]);
                         vga_print_char(screen_cursor.y, screen_cursor.x, ' ');
                     }
@@ -209,13 +378,13 @@ static void vga_process_char(const char character)
             case '\t':
                 if(screen_cursor.x + 8 < VGA_TEXT_SCREEN_COL_SIZE - 1)
                 {
-                    vga_put_cursor_at(screen_cursor.y,
+                    vga_move_cursor(screen_cursor.y,
                             screen_cursor.x  +
                             (8 - screen_cursor.x % 8));
                 }
                 else
                 {
-                    vga_put_cursor_at(screen_cursor.y,
+                    vga_move_cursor(screen_cursor.y,
                            VGA_TEXT_SCREEN_COL_SIZE - 1);
                 }
                 last_columns[screen_cursor.y] = screen_cursor.x;
@@ -224,12 +393,12 @@ static void vga_process_char(const char character)
             case '\n':
                 if(screen_cursor.y < VGA_TEXT_SCREEN_LINE_SIZE - 1)
                 {
-                    vga_put_cursor_at(screen_cursor.y + 1, 0);
+                    vga_move_cursor(screen_cursor.y + 1, 0);
                     last_columns[screen_cursor.y] = screen_cursor.x;
                 }
                 else
                 {
-                    vga_scroll(SCROLL_DOWN, 1);
+                    vga_scroll_shadow(SCROLL_DOWN, 1);
                 }
                 break;
             /* Clear screen */
@@ -238,7 +407,7 @@ static void vga_process_char(const char character)
                 break;
             /* Line return */
             case '\r':
-                vga_put_cursor_at(screen_cursor.y, 0);
+                vga_move_cursor(screen_cursor.y, 0);
                 last_columns[screen_cursor.y] = screen_cursor.x;
                 break;
             /* Undefined */
@@ -254,12 +423,11 @@ uint16_t* vga_get_framebuffer(const uint32_t line, const uint32_t column)
     if(line > VGA_TEXT_SCREEN_LINE_SIZE - 1 ||
        column > VGA_TEXT_SCREEN_COL_SIZE -1)
     {
-        return vga_framebuffer;
+        return vga_shadow;
     }
 
     /* Returns the mem adress of the coordinates */
-    return (uint16_t*)vga_framebuffer +
-           (column + line * VGA_TEXT_SCREEN_COL_SIZE);
+    return vga_shadow + (column + line * VGA_TEXT_SCREEN_COL_SIZE);
 }
 
 OS_RETURN_E vga_init(void)
@@ -270,8 +438,9 @@ OS_RETURN_E vga_init(void)
     kernel_serial_debug("Initializing VGA text driver\n");
 #endif 
 
-    /* Init framebuffer */
+    /* Init framebuffer, the shadow buffer starts with the screen content */
     vga_framebuffer = (uint16_t*)VGA_TEXT_FRAMEBUFFER;
+    memcpy(vga_shadow, vga_framebuffer, sizeof(vga_shadow));
 
     err = OS_NO_ERR;
 
@@ -290,6 +459,8 @@ void vga_clear_screen(void)
                      ((screen_scheme.background << 8) & 0xF000) |
                      ((screen_scheme.foreground << 8) & 0x0F00);
 
+    scrollback_view = 0;
+
     /* Clear all screen cases */
     for(i = 0; i < VGA_TEXT_SCREEN_LINE_SIZE; ++i)
     {
@@ -299,25 +470,45 @@ void vga_clear_screen(void)
         }
         last_columns[i] = 0;
     }
+    vga_mark_dirty(0, VGA_TEXT_SCREEN_LINE_SIZE * VGA_TEXT_SCREEN_COL_SIZE);
+    vga_flush();
 }
 
 OS_RETURN_E vga_put_cursor_at(const uint32_t line, const uint32_t column)
 {
-    int16_t  cursor_position;
+    OS_RETURN_E err;
 
-    /* Checks the values of line and column */
-    if(column > VGA_TEXT_SCREEN_COL_SIZE ||
-       line > VGA_TEXT_SCREEN_LINE_SIZE)
+    err = vga_move_cursor(line, column);
+    if(err == OS_NO_ERR)
     {
-        return OS_ERR_OUT_OF_BOUND;
+        vga_flush();
     }
 
-    /* Set new cursor position */
-    screen_cursor.x = column;
-    screen_cursor.y = line;
+    return err;
+}
+
+void vga_flush(void)
+{
+    int16_t cursor_position;
+
+    /* Copy the modified cells at once */
+    if(dirty_start < dirty_end)
+    {
+        memcpy(vga_framebuffer + dirty_start, vga_shadow + dirty_start,
+               sizeof(uint16_t) * (dirty_end - dirty_start));
+        dirty_start = VGA_TEXT_SCREEN_LINE_SIZE * VGA_TEXT_SCREEN_COL_SIZE;
+        dirty_end   = 0;
+    }
+
+    if(cursor_dirty == 0)
+    {
+        return;
+    }
+    cursor_dirty = 0;
 
     /* Display new position on screen */
-    cursor_position = column + line * VGA_TEXT_SCREEN_COL_SIZE;
+    cursor_position = screen_cursor.x +
+                      screen_cursor.y * VGA_TEXT_SCREEN_COL_SIZE;
 
     /* Send low part to the screen */
     cpu_outb(VGA_TEXT_CURSOR_COMM_LOW, VGA_TEXT_SCREEN_COMM_PORT);
@@ -327,8 +518,6 @@ OS_RETURN_E vga_put_cursor_at(const uint32_t line, const uint32_t column)
     cpu_outb(VGA_TEXT_CURSOR_COMM_HIGH, VGA_TEXT_SCREEN_COMM_PORT);
     cpu_outb((int8_t)((cursor_position & 0xFF00) >> 8),
              VGA_TEXT_SCREEN_DATA_PORT);
-
-    return OS_NO_ERR;
 }
 
 OS_RETURN_E vga_save_cursor(cursor_t* buffer)
@@ -360,57 +549,68 @@ OS_RETURN_E vga_restore_cursor(const cursor_t buffer)
 
 void vga_scroll(const SCROLL_DIRECTION_E direction, const uint32_t lines_count)
 {
-    uint32_t to_scroll;
+    vga_scroll_shadow(direction, lines_count);
+    vga_flush();
+}
 
-    if(VGA_TEXT_SCREEN_LINE_SIZE < lines_count)
+OS_RETURN_E vga_show_scrollback(const uint32_t lines_back)
+{
+    scrollback_cell_t cells[SCROLLBACK_LINE_SIZE];
+    uint32_t          size;
+    uint32_t          line;
+    uint32_t          i;
+    uint16_t*         screen_line;
+
+    if(lines_back > scrollback_get_count())
     {
-        to_scroll = VGA_TEXT_SCREEN_LINE_SIZE;
+        return OS_ERR_OUT_OF_BOUND;
     }
-    else
+    if(lines_back == 0 && scrollback_view == 0)
     {
-        to_scroll = lines_count;
+        return OS_NO_ERR;
     }
 
-    /* Select scroll direction */
-    if(direction == SCROLL_DOWN)
+    /* Save the screen content when leaving it */
+    if(scrollback_view == 0 && lines_back != 0)
     {
-        uint32_t i;
-        uint32_t j;
-
+        memcpy(live_screen, vga_shadow, sizeof(live_screen));
+    }
+    scrollback_view = lines_back;
 
-        /* For each line scroll we want */
-        for(j = 0; j < to_scroll; ++j)
+    /* The history lines are followed by the top of the screen content */
+    for(line = 0; line < VGA_TEXT_SCREEN_LINE_SIZE; ++line)
+    {
+        screen_line = vga_get_framebuffer(line, 0);
+        if(line >= lines_back)
         {
-            /* Copy all the lines to the above one */
-            for(i = 0; i < VGA_TEXT_SCREEN_LINE_SIZE - 1; ++i)
-            {
-                memmove(vga_get_framebuffer(i, 0),
-                        vga_get_framebuffer(i + 1, 0),
-                        sizeof(uint16_t) * VGA_TEXT_SCREEN_COL_SIZE);
-                last_columns[i] = last_columns[i+1];
-            }
-            last_columns[VGA_TEXT_SCREEN_LINE_SIZE - 1] = 0;
+            memcpy(screen_line,
+                   live_screen + (line - lines_back) * VGA_TEXT_SCREEN_COL_SIZE,
+                   sizeof(uint16_t) * VGA_TEXT_SCREEN_COL_SIZE);
+            continue;
         }
-        /* Clear last line */
+
+        size = 0;
+        scrollback_get_line(lines_back - 1 - line, cells, &size);
         for(i = 0; i < VGA_TEXT_SCREEN_COL_SIZE; ++i)
         {
-            vga_print_char(VGA_TEXT_SCREEN_LINE_SIZE - 1, i, ' ');
+            if(i < size && cells[i].character > 31)
+            {
+                screen_line[i] = cells[i].character |
+                                 ((cells[i].bgcolor << 8) & 0xF000) |
+                                 ((cells[i].fgcolor << 8) & 0x0F00);
+            }
+            else
+            {
+                screen_line[i] = ' ' |
+                                 ((screen_scheme.background << 8) & 0xF000) |
+                                 ((screen_scheme.foreground << 8) & 0x0F00);
+            }
         }
-
     }
+    vga_mark_dirty(0, VGA_TEXT_SCREEN_LINE_SIZE * VGA_TEXT_SCREEN_COL_SIZE);
+    vga_flush();
 
-    /* Replace cursor */
-    vga_put_cursor_at(VGA_TEXT_SCREEN_LINE_SIZE - to_scroll, 0);
-
-    if(to_scroll <= last_printed_cursor.y)
-    {
-        last_printed_cursor.y -= to_scroll;
-    }
-    else
-    {
-        last_printed_cursor.x = 0;
-        last_printed_cursor.y = 0;
-    }
+    return OS_NO_ERR;
 }
 
 void vga_set_color_scheme(const colorscheme_t color_scheme)
@@ -437,17 +637,20 @@ void vga_put_string(const char* string)
 {
     size_t i;
 
-    /* Output each character of the string */
-    for(i = 0; i < strlen(string); ++i)
+    /* Output each character of the string, the screen is updated once */
+    for(i = 0; string[i] != 0; ++i)
     {
-        vga_put_char(string[i]);
+        vga_process_char(string[i]);
+        last_printed_cursor = screen_cursor;
     }
+    vga_flush();
 }
 
 void vga_put_char(const char character)
 {
     vga_process_char(character);
     last_printed_cursor = screen_cursor;
+    vga_flush();
 }
 
 void vga_console_write_keyboard(const char* string, const size_t size)
@@ -459,6 +662,7 @@ void vga_console_write_keyboard(const char* string, const size_t size)
     {
         vga_process_char(string[i]);
     }
+    vga_flush();
 }
 
 OS_RETURN_E vga_map_memory(void)
@@ -13,7 +13,9 @@
  *
  * @details Kernel's queue structures. These queues are used by the kernel as
  * priority queue or regular queues. A kernel queue can virtually store every
- * type of data and is just a wrapper.
+ * type of data and is just a wrapper. Nodes and queues can either be allocated
+ * by the queue functions or be embedded in the structure they link and
+ * initialized in place, in which case enqueuing and dequeuing never allocate.
  *
  * @copyright Alexy Torres Aurora Dugo
  ******************************************************************************/
@@ -25,6 +27,7 @@
 #include <core/panic.h>       /* Kernel panic */
 #include <sync/critical.h>    /* Critical sections */
 #include <io/kernel_output.h> /* Kernel output methods */
+#include <sync/rcu.h>         /* Read-copy-update */
 
 /* UTK configuration file */
 #include <config.h>
@@ -40,6 +43,26 @@
  * FUNCTIONS
  ******************************************************************************/
 
+/**
+ * @brief Releases a node once its RCU grace period elapsed.
+ *
+ * @param[in] head The RCU head embedded in the node.
+ */
+static void kernel_queue_free_node(rcu_head_t* head)
+{
+    kfree(RCU_CONTAINER_OF(head, kernel_queue_node_t, rcu));
+}
+
+/**
+ * @brief Releases a queue once its RCU grace period elapsed.
+ *
+ * @param[in] head The RCU head embedded in the queue.
+ */
+static void kernel_queue_free_queue(rcu_head_t* head)
+{
+    kfree(RCU_CONTAINER_OF(head, kernel_queue_t, rcu));
+}
+
 kernel_queue_node_t* kernel_queue_create_node(void* data, OS_RETURN_E *error)
 {
     kernel_queue_node_t* new_node;
@@ -55,9 +78,8 @@ kernel_queue_node_t* kernel_queue_create_node(void* data, OS_RETURN_E *error)
         }
         return NULL;
     }
-     /* Init the structure */
-    memset(new_node, 0, sizeof(kernel_queue_node_t));
-    new_node->data = data;
+    /* Init the structure */
+    kernel_queue_init_node(new_node, data);
     if(error != NULL)
     {
         *error = OS_NO_ERR;
@@ -65,6 +87,19 @@ kernel_queue_node_t* kernel_queue_create_node(void* data, OS_RETURN_E *error)
     return new_node;
 }
 
+OS_RETURN_E kernel_queue_init_node(kernel_queue_node_t* node, void* data)
+{
+    if(node == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    memset(node, 0, sizeof(kernel_queue_node_t));
+    node->data = data;
+
+    return OS_NO_ERR;
+}
+
 OS_RETURN_E kernel_queue_delete_node(kernel_queue_node_t** node)
 {
     if(node == NULL || *node == NULL)
@@ -78,7 +113,8 @@ OS_RETURN_E kernel_queue_delete_node(kernel_queue_node_t** node)
         return OS_ERR_UNAUTHORIZED_ACTION;
     }
 
-    kfree(*node);
+    /* Lockless readers may still walk through the node */
+    call_rcu(&(*node)->rcu, kernel_queue_free_node);
 
     *node = NULL;
 
@@ -101,11 +137,7 @@ kernel_queue_t* kernel_queue_create_queue(OS_RETURN_E *error)
     }
 
     /* Init the structure */
-    memset(newqueue, 0, sizeof(kernel_queue_t));
-
-#if MAX_CPU_COUNT > 1
-    INIT_SPINLOCK(&newqueue->lock);
-#endif
+    kernel_queue_init_queue(newqueue);
 
     if(error != NULL)
     {
@@ -115,6 +147,22 @@ kernel_queue_t* kernel_queue_create_queue(OS_RETURN_E *error)
     return newqueue;
 }
 
+OS_RETURN_E kernel_queue_init_queue(kernel_queue_t* queue)
+{
+    if(queue == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    memset(queue, 0, sizeof(kernel_queue_t));
+
+#if MAX_CPU_COUNT > 1
+    INIT_SPINLOCK(&queue->lock);
+#endif
+
+    return OS_NO_ERR;
+}
+
 OS_RETURN_E kernel_queue_delete_queue(kernel_queue_t** queue)
 {
     if(queue == NULL || *queue == NULL)
@@ -128,7 +176,8 @@ OS_RETURN_E kernel_queue_delete_queue(kernel_queue_t** queue)
         return OS_ERR_UNAUTHORIZED_ACTION;
     }
 
-    kfree(*queue);
+    /* Lockless readers may still hold the queue */
+    call_rcu(&(*queue)->rcu, kernel_queue_free_queue);
 
     *queue = NULL;
 
@@ -157,14 +206,14 @@ OS_RETURN_E kernel_queue_push(kernel_queue_node_t* node,
     ENTER_CRITICAL(word);
 #endif
 
-    /* If this queue is empty */
+    /* The links are published last, RCU readers walk the queue unlocked */
     if(queue->head == NULL)
     {
         /* Set the first item */
-        queue->head = node;
-        queue->tail = node;
         node->next = NULL;
         node->prev = NULL;
+        queue->tail = node;
+        RCU_ASSIGN_POINTER(queue->head, node);
     }
     else
     {
@@ -172,11 +221,12 @@ OS_RETURN_E kernel_queue_push(kernel_queue_node_t* node,
         node->next = queue->head;
         node->prev = NULL;
         queue->head->prev = node;
-        queue->head = node;
+        RCU_ASSIGN_POINTER(queue->head, node);
     }
 
     ++queue->size;
     node->enlisted = 1;
+    node->owner    = queue;
 
 #if QUEUE_KERNEL_DEBUG == 1
 kernel_serial_debug("Enqueue kernel element 0x%p in queue 0x%p\n",
@@ -238,14 +288,14 @@ OS_RETURN_E kernel_queue_push_prio(kernel_queue_node_t* node,
 
     node->priority = priority;
 
-    /* If this queue is empty */
+    /* The links are published last, RCU readers walk the queue unlocked */
     if(queue->head == NULL)
     {
         /* Set the first item */
-        queue->head = node;
-        queue->tail = node;
         node->next = NULL;
         node->prev = NULL;
+        queue->tail = node;
+        RCU_ASSIGN_POINTER(queue->head, node);
     }
     else
     {
@@ -262,11 +312,11 @@ OS_RETURN_E kernel_queue_push_prio(kernel_queue_node_t* node,
             cursor->prev = node;
             if(node->prev != NULL)
             {
-                node->prev->next = node;
+                RCU_ASSIGN_POINTER(node->prev->next, node);
             }
             else
             {
-                queue->head = node;
+                RCU_ASSIGN_POINTER(queue->head, node);
             }
         }
         else
@@ -274,12 +324,13 @@ OS_RETURN_E kernel_queue_push_prio(kernel_queue_node_t* node,
             /* Just put on the tail */
             node->prev = queue->tail;
             node->next = NULL;
-            queue->tail->next = node;
+            RCU_ASSIGN_POINTER(queue->tail->next, node);
             queue->tail = node;
         }
     }
     ++queue->size;
     node->enlisted = 1;
+    node->owner    = queue;
 
 #if QUEUE_KERNEL_DEBUG == 1
 kernel_serial_debug("Enqueue kernel element 0x%p in queue 0x%p\n",
@@ -383,6 +434,7 @@ kernel_serial_debug("Element 0x%p 0x%p 0x%p 0x%p 0x%p\n",
     node->next = NULL;
     node->prev = NULL;
     node->enlisted = 0;
+    node->owner    = NULL;
 
     if(error != NULL)
     {
@@ -480,14 +532,9 @@ OS_RETURN_E kernel_queue_remove(kernel_queue_t* queue,
     ENTER_CRITICAL(word);
 #endif
 
-    /* Search for node in the queue*/
-    cursor = queue->head;
-    while(cursor != NULL && cursor != node)
-    {
-        cursor = cursor->next;
-    }
-
-    if(cursor == NULL)
+    /* The node knows the queue it belongs to, no need to search for it */
+    cursor = node;
+    if(cursor->enlisted == 0 || cursor->owner != queue)
     {
 #if MAX_CPU_COUNT > 1
         EXIT_CRITICAL(word, &queue->lock);
@@ -519,10 +566,15 @@ OS_RETURN_E kernel_queue_remove(kernel_queue_t* queue,
         queue->tail = NULL;
     }
 
-    node->next = NULL;
+    --queue->size;
+
+    /* The next link is kept, a RCU reader standing on the node continues its
+     * walk in the queue.
+     */
     node->prev = NULL;
 
     node->enlisted = 0;
+    node->owner    = NULL;
 
 #if MAX_CPU_COUNT > 1
     EXIT_CRITICAL(word, &queue->lock);
@@ -32,7 +32,10 @@
 #include <io/kernel_output.h>     /* Kernel output methods */
 #include <io/graphic.h>           /* Graphic API */
 #include <core/kernel_queue.h>    /* Kernel queues */
+#include <core/thread_table.h>    /* TID indexed thread table */
 #include <sync/critical.h>        /* Critical sections */
+#include <sync/rcu.h>             /* Read-copy-update */
+#include <core/trace.h>           /* Trace events */
 #include <time/time_management.h> /* Timers factory */
 
 /* UTK configuration file */
@@ -52,8 +55,8 @@
 /** @brief Main CPU ID. */
 extern int32_t main_core_id;
 
-/** @brief The last TID given by the kernel. */
-static volatile uint32_t last_given_tid;
+/** @brief The next TID to be given by the kernel. */
+static volatile uint32_t next_tid;
 /** @brief The number of thread in the system (dead threads are not accounted).
  */
 static volatile uint32_t thread_count;
@@ -98,6 +101,9 @@ static volatile uint64_t schedule_count[MAX_CPU_COUNT];
 /** @brien Count of the number of times the idle thread was scheduled. */
 static volatile uint64_t idle_sched_count[MAX_CPU_COUNT];
 
+/** @brief Per CPU run queue length histogram, sampled on each schedule. */
+static volatile uint64_t runqueue_hist[MAX_CPU_COUNT][SCHED_RUNQUEUE_HIST_SIZE];
+
 /*******************************************************
  * THREAD TABLES
  * Sorted by priority:
@@ -109,19 +115,24 @@ static volatile uint64_t idle_sched_count[MAX_CPU_COUNT];
  *
  *******************************************************/
 /** @brief Active threads tables. The array is sorted by priority. */
-static kernel_queue_t* active_threads_table[MAX_CPU_COUNT]
-                                           [KERNEL_LOWEST_PRIORITY + 1];
+static kernel_queue_t active_threads_table[MAX_CPU_COUNT]
+                                          [KERNEL_LOWEST_PRIORITY + 1];
 
 /** @brief Sleeping threads table. The threads are sorted by their wakeup time
  * value.
  */
-static kernel_queue_t* sleeping_threads_table[MAX_CPU_COUNT];
+static kernel_queue_t sleeping_threads_table[MAX_CPU_COUNT];
 
 /** @brief Zombie threads table. */
-static kernel_queue_t* zombie_threads_table;
+static kernel_queue_t zombie_threads_table;
 
 /** @brief Global thread table. */
-static kernel_queue_t* global_threads_table;
+static kernel_queue_t global_threads_table;
+
+/** @brief Per CPU priority change requests, applied by the CPU owning the
+ * active tables when it selects its next thread.
+ */
+static kernel_queue_t priority_requests_table[MAX_CPU_COUNT];
 
 /** @brief Extern user program entry point. */
 extern int main(int, char**);
@@ -130,6 +141,66 @@ extern int main(int, char**);
  * FUNCTIONS
  ******************************************************************************/
 
+/**
+ * @brief Adds the time spent in a state to the matching time counter.
+ *
+ * @param[in] state The state the thread was in since the last update.
+ * @param[in] last The timestamp counter value of the last update.
+ * @param[in] now The current timestamp counter value.
+ * @param[in, out] run_time The running time counter.
+ * @param[in, out] ready_time The ready time counter.
+ * @param[in, out] wait_time The waiting time counter.
+ */
+__inline__ static void sched_add_state_time(const THREAD_STATE_E state,
+                                            const uint64_t last,
+                                            const uint64_t now,
+                                            uint64_t* run_time,
+                                            uint64_t* ready_time,
+                                            uint64_t* wait_time)
+{
+    uint64_t elapsed;
+
+    /* The timestamp counters of the CPUs might not be perfectly synchronized */
+    elapsed = (now > last) ? now - last : 0;
+
+    switch(state)
+    {
+        case THREAD_STATE_RUNNING:
+            *run_time += elapsed;
+            break;
+        case THREAD_STATE_READY:
+            *ready_time += elapsed;
+            break;
+        case THREAD_STATE_ZOMBIE:
+        case THREAD_STATE_DEAD:
+            break;
+        default:
+            *wait_time += elapsed;
+    }
+}
+
+/**
+ * @brief Updates a thread time accounting.
+ *
+ * @details Adds the time elapsed since the last update to the thread counter
+ * matching the state the thread was in. Must be called when the thread changes
+ * state. A thread that blocks sets its new state before being switched out, the
+ * scheduler hence gives the running state explicitly.
+ *
+ * @param[in, out] thread The thread to update.
+ * @param[in] state The state the thread was in since the last update.
+ * @param[in] now The current timestamp counter value.
+ */
+__inline__ static void sched_account(kernel_thread_t* thread,
+                                     const THREAD_STATE_E state,
+                                     const uint64_t now)
+{
+    sched_add_state_time(state, thread->last_account, now, &thread->run_time,
+                         &thread->ready_time, &thread->wait_time);
+
+    thread->last_account = now;
+}
+
 /**
  * @brief Thread's exit point.
  *
@@ -157,9 +228,7 @@ static void thread_exit(void)
         cpu_id = 0;
     }
 
-#if SCHED_KERNEL_DEBUG == 1
-    kernel_serial_debug("Exit thread %d\n", active_thread[cpu_id]->tid);
-#endif
+    TRACE(TRACE_SCHED_EXIT, active_thread[cpu_id]->tid, 0, 0, 0);
 
     /* Cannot exit idle thread */
     if(active_thread[cpu_id] == idle_thread[cpu_id])
@@ -187,7 +256,7 @@ static void thread_exit(void)
 #endif
 
     /* Enqueue thread in zombie list. */
-    err = kernel_queue_push(active_thread_node[cpu_id], zombie_threads_table);
+    err = kernel_queue_push(active_thread_node[cpu_id], &zombie_threads_table);
     if(err != OS_NO_ERR)
     {
 #if MAX_CPU_COUNT > 1
@@ -201,19 +270,20 @@ static void thread_exit(void)
     }
 
     /* All the children of the thread are inherited by init */
-    node = kernel_queue_pop(active_thread[cpu_id]->children, &err);
+    node = kernel_queue_pop(&active_thread[cpu_id]->children, &err);
     while(node != NULL && err == OS_NO_ERR)
     {
         kernel_thread_t* thread = (kernel_thread_t*)node->data;
 
         thread->ptid = init_thread->tid;
 
-        if(thread->joining_thread->data == active_thread[cpu_id])
+        if(thread->joining_thread != NULL &&
+           thread->joining_thread->data == active_thread[cpu_id])
         {
             thread->joining_thread->data = NULL;
         }
 
-        err = kernel_queue_push(node, init_thread->children);
+        err = kernel_queue_push(node, &init_thread->children);
         if(err != OS_NO_ERR)
         {
 #if MAX_CPU_COUNT > 1
@@ -226,7 +296,7 @@ static void thread_exit(void)
             kernel_panic(err);
         }
 
-        node = kernel_queue_pop(active_thread[cpu_id]->children, &err);
+        node = kernel_queue_pop(&active_thread[cpu_id]->children, &err);
     }
     if(err != OS_NO_ERR)
     {
@@ -239,19 +309,6 @@ static void thread_exit(void)
         kernel_panic(err);
     }
 
-    /* Delete list */
-    err = kernel_queue_delete_queue(&active_thread[cpu_id]->children);
-    if(err != OS_NO_ERR)
-    {
-#if MAX_CPU_COUNT > 1
-        EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
-#else
-        EXIT_CRITICAL(int_state);
-#endif
-        kernel_error("Could not delete list of children[%d]\n", err);
-        kernel_panic(err);
-    }
-
     /* Search for joining thread */
     if(active_thread[cpu_id]->joining_thread != NULL)
     {
@@ -273,10 +330,11 @@ static void thread_exit(void)
                 joining_thread->tid);
 #endif
 
+            sched_account(joining_thread, joining_thread->state, cpu_rdtsc());
             joining_thread->state = THREAD_STATE_READY;
 
             err = kernel_queue_push(active_thread[cpu_id]->joining_thread,
-                        active_threads_table[joining_thread->cpu_affinity]
+                        &active_threads_table[joining_thread->cpu_affinity]
                                             [joining_thread->priority]);
             if(err != OS_NO_ERR)
             {
@@ -309,17 +367,32 @@ static void thread_exit(void)
     sched_schedule();
 }
 
+/**
+ * @brief Releases a joined thread memory once its RCU grace period elapsed.
+ *
+ * @param[in] head The RCU head embedded in the thread.
+ */
+static void sched_free_thread(rcu_head_t* head)
+{
+    kernel_thread_t* thread;
+
+    thread = RCU_CONTAINER_OF(head, kernel_thread_t, rcu);
+
+    kfree(thread->stack);
+    kfree(thread);
+}
+
 /**
  * @brief Cleans a joined thread footprint in the system.
  *
  * @details Cleans a thread that is currently being joined by the curent active
- * thread. Removes the thread from all lists and cleans the lists nodes.
+ * thread. Removes the thread from all lists, the lists nodes are embedded in
+ * the thread and released with it.
  *
  * @param[in] thread The thread to clean.
  */
 static void sched_clean_joined_thread(kernel_thread_t* thread)
 {
-    kernel_queue_node_t* node;
     OS_RETURN_E          err;
     uint32_t             int_state;    
     int32_t              cpu_id;
@@ -340,25 +413,14 @@ static void sched_clean_joined_thread(kernel_thread_t* thread)
     ENTER_CRITICAL(int_state);
 #endif
 
-    /* Remove node from children table */
-    node = kernel_queue_find(active_thread[cpu_id]->children, thread, &err);
-    if(err != OS_NO_ERR && err != OS_ERR_NO_SUCH_ID)
-    {
-#if MAX_CPU_COUNT > 1
-        EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
-#else
-        EXIT_CRITICAL(int_state);
-#endif
-
-        kernel_error("Could not find joined thread in children table[%d]\n",
-                     err);
-        kernel_panic(err);
-    }
-
-    if(node != NULL && err == OS_NO_ERR)
+    /* Remove node from children table, the node knows its table since the
+     * thread might have been inherited by INIT.
+     */
+    if(thread->children_node.enlisted != 0)
     {
-        err = kernel_queue_remove(active_thread[cpu_id]->children, node);
-        if(err != OS_NO_ERR)
+        err = kernel_queue_remove(thread->children_node.owner,
+                                  &thread->children_node);
+        if(err != OS_NO_ERR && err != OS_ERR_NO_SUCH_ID)
         {
 #if MAX_CPU_COUNT > 1
             EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
@@ -370,24 +432,10 @@ static void sched_clean_joined_thread(kernel_thread_t* thread)
                          err);
             kernel_panic(err);
         }
-
-        err = kernel_queue_delete_node(&node);
-        if(err != OS_NO_ERR)
-        {
-#if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
-#else
-            EXIT_CRITICAL(int_state);
-#endif
-
-            kernel_error("Could delete thread node[%d]\n", err);
-            kernel_panic(err);
-        }
     }
 
     /* Remove node from zombie table */
-
-    node = kernel_queue_find(zombie_threads_table, thread, &err);
+    err = kernel_queue_remove(&zombie_threads_table, &thread->sched_node);
     if(err != OS_NO_ERR && err != OS_ERR_NO_SUCH_ID)
     {
 #if MAX_CPU_COUNT > 1
@@ -396,43 +444,13 @@ static void sched_clean_joined_thread(kernel_thread_t* thread)
         EXIT_CRITICAL(int_state);
 #endif
 
-        kernel_error("Could not find joined thread in zombie table[%d]\n",
+        kernel_error("Could delete thread node in zombie table[%d]\n",
                      err);
         kernel_panic(err);
     }
 
-    if(node != NULL && err == OS_NO_ERR)
-    {
-        err = kernel_queue_remove(zombie_threads_table, node);
-        if(err != OS_NO_ERR)
-        {
-#if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
-#else
-            EXIT_CRITICAL(int_state);
-#endif
-
-            kernel_error("Could delete thread node in zombie table[%d]\n",
-                         err);
-            kernel_panic(err);
-        }
-
-        err = kernel_queue_delete_node(&node);
-        if(err != OS_NO_ERR)
-        {
-#if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
-#else
-            EXIT_CRITICAL(int_state);
-#endif
-
-            kernel_error("Could delete thread node[%d]\n", err);
-            kernel_panic(err);
-        }
-    }
-
     /* Remove node from general table */
-    node = kernel_queue_find(global_threads_table, thread, &err);
+    err = kernel_queue_remove(&global_threads_table, &thread->global_node);
     if(err != OS_NO_ERR && err != OS_ERR_NO_SUCH_ID)
     {
 #if MAX_CPU_COUNT > 1
@@ -441,38 +459,38 @@ static void sched_clean_joined_thread(kernel_thread_t* thread)
         EXIT_CRITICAL(int_state);
 #endif
 
-        kernel_error("Could not find joined thread in general table[%d]\n",
+        kernel_error("Could delete thread node in general table[%d]\n",
                      err);
         kernel_panic(err);
     }
-    if(node != NULL && err == OS_NO_ERR)
+
+    /* Drop a pending priority request */
+    err = kernel_queue_remove(&priority_requests_table[thread->cpu_affinity],
+                              &thread->priority_node);
+    if(err != OS_NO_ERR && err != OS_ERR_NO_SUCH_ID)
     {
-        err = kernel_queue_remove(global_threads_table, node);
-        if(err != OS_NO_ERR)
-        {
 #if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
+        EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
 #else
-            EXIT_CRITICAL(int_state);
+        EXIT_CRITICAL(int_state);
 #endif
 
-            kernel_error("Could delete thread node in general table[%d]\n",
-                         err);
-            kernel_panic(err);
-        }
+        kernel_error("Could delete thread priority request[%d]\n", err);
+        kernel_panic(err);
+    }
 
-        err = kernel_queue_delete_node(&node);
-        if(err != OS_NO_ERR)
-        {
+    /* Remove the thread from the TID table */
+    err = thread_table_remove(thread->tid);
+    if(err != OS_NO_ERR && err != OS_ERR_NO_SUCH_ID)
+    {
 #if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
+        EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
 #else
-            EXIT_CRITICAL(int_state);
+        EXIT_CRITICAL(int_state);
 #endif
 
-            kernel_error("Could delete thread node[%d]\n", err);
-            kernel_panic(err);
-        }
+        kernel_error("Could delete thread in TID table[%d]\n", err);
+        kernel_panic(err);
     }
 
 #if SCHED_KERNEL_DEBUG == 1
@@ -481,9 +499,8 @@ static void sched_clean_joined_thread(kernel_thread_t* thread)
                          thread->tid);
 #endif
 
-    /* Free the thread stack */
-    kfree(thread->stack);
-    kfree(thread);
+    /* Other CPUs may still be reading the thread, defer its release */
+    call_rcu(&thread->rcu, sched_free_thread);
 
 #if MAX_CPU_COUNT > 1
     ENTER_CRITICAL(secint_state, &sched_lock);
@@ -600,6 +617,9 @@ static void* idle_sys(void* args)
 
         kernel_interrupt_restore(1);
 
+        /* Release the memory which grace period elapsed */
+        rcu_process_callbacks();
+
         if(cpu_id == main_core_id && system_state == SYSTEM_STATE_HALTED)
         {
             if(cpu_id == MAX_CPU_COUNT - 1)
@@ -655,6 +675,7 @@ static void* init_func(void* args)
     scheduler_preemt_test();
     scheduler_sleep_test();
     scheduler_sleep_mc_test();
+    scheduler_stats_test();
     critical_test();
     div_by_zero_test();
     mutex_test();
@@ -664,7 +685,25 @@ static void* init_func(void* args)
     mailbox_test();
     userqueue_test();
     spinlock_test();
+    futex_test();
+    rcu_test();
+    barrier_test();
     sse_test();
+    ata_pio_irq_test();
+    ata_dma_test();
+    block_test();
+    block_io_test();
+    serial_rx_test();
+    serial_tx_test();
+    output_deferred_test();
+    trace_test();
+    vesa_flush_test();
+    vesa_blit_test();
+    vga_scroll_test();
+    keyboard_test();
+    deferred_test();
+    interrupt_stats_test();
+    irq_affinity_test();
     while(1)
     {
         sched_sleep(10000000);
@@ -705,7 +744,7 @@ static void* init_func(void* args)
     while(thread_count > sys_thread)
     {
 
-        thread_node = kernel_queue_pop(active_thread[cpu_id]->children, &err);
+        thread_node = kernel_queue_pop(&active_thread[cpu_id]->children, &err);
 
         while(thread_node != NULL && err == OS_NO_ERR)
         {
@@ -737,20 +776,7 @@ static void* init_func(void* args)
             ENTER_CRITICAL(int_state);
 #endif
 
-            err = kernel_queue_delete_node(&thread_node);
-            if(err != OS_NO_ERR)
-            {
-#if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
-#else
-            EXIT_CRITICAL(int_state);
-#endif
-
-                kernel_error("Error while deleting thread node in INIT [%d]\n",
-                             err);
-                kernel_panic(err);
-            }
-            thread_node = kernel_queue_pop(active_thread[cpu_id]->children, &err);
+            thread_node = kernel_queue_pop(&active_thread[cpu_id]->children, &err);
         }
     }
 
@@ -774,14 +800,85 @@ static void* init_func(void* args)
  * System's specific functions END.
  ******************************************************************************/
 
+/**
+ * @brief Allocates a new TID.
+ *
+ * @details Allocates a new TID, the TIDs are given in increasing order and are
+ * never reused. The allocation is protected since threads can be created
+ * concurrently on different CPUs.
+ *
+ * @return The allocated TID.
+ */
+static int32_t sched_alloc_tid(void)
+{
+    int32_t tid;
+
+#if MAX_CPU_COUNT > 1
+    uint32_t int_state;
+
+    ENTER_CRITICAL(int_state, &sched_lock);
+#endif
+    tid = next_tid++;
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &sched_lock);
+#endif
+
+    return tid;
+}
+
+/**
+ * @brief Fills a thread information structure.
+ *
+ * @details Fills a thread information structure from a thread. The caller must
+ * ensure the thread cannot be released during the call.
+ *
+ * @param[in] thread The thread to get the information of.
+ * @param[out] info The structure to fill.
+ */
+static void sched_fill_thread_info(const kernel_thread_t* thread,
+                                   thread_info_t* info)
+{
+    info->tid          = thread->tid;
+    info->ptid         = thread->ptid;
+    strncpy(info->name, thread->name, THREAD_MAX_NAME_LENGTH);
+    info->init_prio    = thread->init_prio;
+    info->priority     = thread->requested_priority;
+    info->assigned_cpu = thread->cpu_affinity;
+    info->state        = thread->state;
+    info->wakeup_time  = thread->wakeup_time;
+    info->start_time   = thread->start_time;
+
+    info->run_time             = thread->run_time;
+    info->ready_time           = thread->ready_time;
+    info->wait_time            = thread->wait_time;
+    info->voluntary_switches   = thread->voluntary_switches;
+    info->involuntary_switches = thread->involuntary_switches;
+
+    /* Add the time spent in the current state since the last update */
+    sched_add_state_time(info->state, thread->last_account, cpu_rdtsc(),
+                         &info->run_time, &info->ready_time, &info->wait_time);
+
+    if(info->state != THREAD_STATE_ZOMBIE)
+    {
+        info->end_time = time_get_current_uptime();
+    }
+    else
+    {
+        info->end_time = thread->end_time;
+    }
+}
+
 static OS_RETURN_E create_idle(const uint32_t idle_stack_size)
 {
     OS_RETURN_E          err;
-    kernel_queue_node_t* second_idle_thread_node;
     char                 idle_name[5] = "Idle\0";
     uint32_t             stack_index;
     int32_t              cpu_id;
 
+#if MAX_CPU_COUNT > 1
+    uint32_t             int_state;
+#endif
+
     /* Get CPU ID */
     cpu_id = cpu_get_id();
     if(cpu_id == -1)
@@ -790,30 +887,30 @@ static OS_RETURN_E create_idle(const uint32_t idle_stack_size)
     }
 
     idle_thread[cpu_id] = kmalloc(sizeof(kernel_thread_t));
-    idle_thread_node[cpu_id] =
-        kernel_queue_create_node(idle_thread[cpu_id], &err);
-
-    if(err != OS_NO_ERR ||
-       idle_thread[cpu_id] == NULL ||
-       idle_thread_node[cpu_id] == NULL)
+    if(idle_thread[cpu_id] == NULL)
     {
-        if(idle_thread[cpu_id] != NULL)
-        {
-            kfree(idle_thread[cpu_id]);
-        }
-        else
-        {
-            err = OS_ERR_MALLOC;
-        }
-        return err;
+        return OS_ERR_MALLOC;
     }
 
     memset(idle_thread[cpu_id], 0, sizeof(kernel_thread_t));
 
+    /* The queues nodes are embedded in the thread */
+    kernel_queue_init_node(&idle_thread[cpu_id]->sched_node,
+                           idle_thread[cpu_id]);
+    kernel_queue_init_node(&idle_thread[cpu_id]->children_node,
+                           idle_thread[cpu_id]);
+    kernel_queue_init_node(&idle_thread[cpu_id]->global_node,
+                           idle_thread[cpu_id]);
+    kernel_queue_init_node(&idle_thread[cpu_id]->priority_node,
+                           idle_thread[cpu_id]);
+    kernel_queue_init_queue(&idle_thread[cpu_id]->children);
+    idle_thread_node[cpu_id] = &idle_thread[cpu_id]->sched_node;
+
     /* Init thread settings */
-    idle_thread[cpu_id]->tid            = last_given_tid;
-    idle_thread[cpu_id]->ptid           = last_given_tid;
+    idle_thread[cpu_id]->tid            = sched_alloc_tid();
+    idle_thread[cpu_id]->ptid           = idle_thread[cpu_id]->tid;
     idle_thread[cpu_id]->priority       = IDLE_THREAD_PRIORITY;
+    idle_thread[cpu_id]->requested_priority = IDLE_THREAD_PRIORITY;
     idle_thread[cpu_id]->init_prio      = IDLE_THREAD_PRIORITY;
     idle_thread[cpu_id]->args           = 0;
     idle_thread[cpu_id]->function       = idle_sys;
@@ -821,18 +918,12 @@ static OS_RETURN_E create_idle(const uint32_t idle_stack_size)
     idle_thread[cpu_id]->state          = THREAD_STATE_RUNNING;
     idle_thread[cpu_id]->stack_size     = idle_stack_size;
     idle_thread[cpu_id]->cpu_affinity   = cpu_id;
+    idle_thread[cpu_id]->last_account   = cpu_rdtsc();
 
 #if MAX_CPU_COUNT > 1
     INIT_SPINLOCK(&idle_thread[cpu_id]->lock);
 #endif
 
-    idle_thread[cpu_id]->children = kernel_queue_create_queue(&err);
-    if(err != OS_NO_ERR)
-    {
-        kfree(idle_thread[cpu_id]);
-        return err;
-    }
-
     /* Init thread stack */
     stack_index = (idle_stack_size + ALIGN - 1) & (~(ALIGN - 1));
     stack_index /= sizeof(uintptr_t);
@@ -853,25 +944,31 @@ static OS_RETURN_E create_idle(const uint32_t idle_stack_size)
     kernel_serial_debug("IDLE thread created\n");
 #endif
 
-    second_idle_thread_node =
-        kernel_queue_create_node(idle_thread[cpu_id], &err);
-    if(err != OS_NO_ERR || second_idle_thread_node == NULL)
+    err = thread_table_insert(idle_thread[cpu_id]);
+    if(err != OS_NO_ERR)
     {
         kfree(idle_thread[cpu_id]->stack);
         kfree(idle_thread[cpu_id]);
         return err;
     }
 
-    err = kernel_queue_push(second_idle_thread_node, global_threads_table);
+    err = kernel_queue_push(&idle_thread[cpu_id]->global_node,
+                            &global_threads_table);
     if(err != OS_NO_ERR)
     {
+        thread_table_remove(idle_thread[cpu_id]->tid);
         kfree(idle_thread[cpu_id]->stack);
         kfree(idle_thread[cpu_id]);
         return err;
     }
 
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &sched_lock);
+#endif
     ++thread_count;
-    ++last_given_tid;
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &sched_lock);
+#endif
 
     /* Initializes the scheduler active thread */
     active_thread[cpu_id] = idle_thread[cpu_id];
@@ -882,6 +979,57 @@ static OS_RETURN_E create_idle(const uint32_t idle_stack_size)
     return OS_NO_ERR;
 }
 
+/**
+ * @brief Applies the priority changes requested for the threads of a CPU.
+ *
+ * @details Applies the priority changes requested with
+ * sched_set_thread_priority. The ready threads are moved to the active table
+ * of their new priority. Only the CPU owning the active tables pops them, the
+ * move cannot race with the selection of the next thread.
+ *
+ * @warning THIS FUNCTION SHOULD NEVER BE CALLED OUTSIDE OF AN INTERRUPT.
+ *
+ * @param[in] cpu_id The id of the current CPU.
+ */
+static void sched_apply_priorities(const int32_t cpu_id)
+{
+    OS_RETURN_E          err;
+    kernel_queue_node_t* node;
+    kernel_thread_t*     thread;
+
+    node = kernel_queue_pop(&priority_requests_table[cpu_id], &err);
+    while(node != NULL && err == OS_NO_ERR)
+    {
+        thread = (kernel_thread_t*)node->data;
+
+        /* A thread that is not in its active table uses the new priority once
+         * it is put back.
+         */
+        err = kernel_queue_remove(&active_threads_table[cpu_id]
+                                                       [thread->priority],
+                                  &thread->sched_node);
+        thread->priority = thread->requested_priority;
+        if(err == OS_NO_ERR)
+        {
+            err = kernel_queue_push(&thread->sched_node,
+                                    &active_threads_table[cpu_id]
+                                                         [thread->priority]);
+            if(err != OS_NO_ERR)
+            {
+                kernel_error("Could not enqueue thread[%d]\n", err);
+                kernel_panic(err);
+            }
+        }
+
+        node = kernel_queue_pop(&priority_requests_table[cpu_id], &err);
+    }
+    if(err != OS_NO_ERR)
+    {
+        kernel_error("Could not dequeue priority request[%d]\n", err);
+        kernel_panic(err);
+    }
+}
+
 /**
  * @brief Selects the next thread to be scheduled.
  *
@@ -895,7 +1043,9 @@ static void select_thread(void)
     OS_RETURN_E          err;
     kernel_queue_node_t* sleeping_node;
     uint32_t             i;
+    uint32_t             ready_count;
     uint64_t             current_time = time_get_current_uptime();
+    uint64_t             now          = cpu_rdtsc();
     int32_t              cpu_id;
 
     cpu_id = cpu_get_id();
@@ -907,12 +1057,16 @@ static void select_thread(void)
     prev_thread[cpu_id] = active_thread[cpu_id];
     prev_thread_node[cpu_id] = active_thread_node[cpu_id];
 
+    sched_account(prev_thread[cpu_id], THREAD_STATE_RUNNING, now);
+
+    sched_apply_priorities(cpu_id);
+
     /* If the thread was not locked */
     if(prev_thread[cpu_id]->state == THREAD_STATE_RUNNING)
     {
         prev_thread[cpu_id]->state = THREAD_STATE_READY;
         err = kernel_queue_push(prev_thread_node[cpu_id],
-                active_threads_table[cpu_id][prev_thread[cpu_id]->priority]);
+                &active_threads_table[cpu_id][prev_thread[cpu_id]->priority]);
         if(err != OS_NO_ERR)
         {
             kernel_error("Could not enqueue old thread[%d]\n", err);
@@ -922,7 +1076,7 @@ static void select_thread(void)
     else if(prev_thread[cpu_id]->state == THREAD_STATE_SLEEPING)
     {
         err = kernel_queue_push_prio(prev_thread_node[cpu_id],
-                                     sleeping_threads_table[cpu_id],
+                                     &sleeping_threads_table[cpu_id],
                                      prev_thread[cpu_id]->wakeup_time);
         if(err != OS_NO_ERR)
         {
@@ -936,15 +1090,12 @@ static void select_thread(void)
     {
         kernel_thread_t* sleeping;
 
-        sleeping_node = kernel_queue_pop(sleeping_threads_table[cpu_id], &err);
+        sleeping_node = kernel_queue_pop(&sleeping_threads_table[cpu_id], &err);
         if(err != OS_NO_ERR)
         {
             kernel_error("Could not dequeue sleeping thread[%d]\n", err);
             kernel_panic(err);
         }
-#if SCHED_KERNEL_DEBUG == 1
-    kernel_serial_debug("Checking threads to wakeup\n");
-#endif
 
         /* If nothing to wakeup */
         if(sleeping_node == NULL)
@@ -957,14 +1108,13 @@ static void select_thread(void)
         /* If we should wakeup the thread */
         if(sleeping != NULL && sleeping->wakeup_time < current_time)
         {
-#if SCHED_KERNEL_DEBUG == 1
-    kernel_serial_debug("Waking up %d\n", sleeping->tid);
-#endif
+            TRACE(TRACE_SCHED_WAKEUP, sleeping->tid, 0, 0, 0);
 
+            sched_account(sleeping, sleeping->state, now);
             sleeping->state = THREAD_STATE_READY;
 
             err = kernel_queue_push(sleeping_node,
-                            active_threads_table[cpu_id][sleeping->priority]);
+                            &active_threads_table[cpu_id][sleeping->priority]);
             if(err != OS_NO_ERR)
             {
                 kernel_error("Could not enqueue sleeping thread[%d]\n", err);
@@ -973,11 +1123,8 @@ static void select_thread(void)
         }
         else if(sleeping != NULL)
         {
-#if SCHED_KERNEL_DEBUG == 1
-    kernel_serial_debug("Keeping sleep %d\n", sleeping->tid);
-#endif
             err = kernel_queue_push_prio(sleeping_node,
-                                         sleeping_threads_table[cpu_id],
+                                         &sleeping_threads_table[cpu_id],
                                          sleeping->wakeup_time);
             if(err != OS_NO_ERR)
             {
@@ -988,20 +1135,28 @@ static void select_thread(void)
         }
     } while(sleeping_node != NULL);
 
+    /* Sample the run queue length */
+    ready_count = 0;
+    for(i = 0; i < KERNEL_LOWEST_PRIORITY + 1; ++i)
+    {
+        ready_count += active_threads_table[cpu_id][i].size;
+    }
+    for(i = 0; i < SCHED_RUNQUEUE_HIST_SIZE - 1 && ready_count != 0; ++i)
+    {
+        ready_count >>= 1;
+    }
+    ++runqueue_hist[cpu_id][i];
+
     /* Get the new thread */
     for(i = 0; i < KERNEL_LOWEST_PRIORITY + 1; ++i)
     {
         active_thread_node[cpu_id] =
-            kernel_queue_pop(active_threads_table[cpu_id][i], &err);
+            kernel_queue_pop(&active_threads_table[cpu_id][i], &err);
         if(err != OS_NO_ERR)
         {
             kernel_error("Could not dequeue next thread[%d]\n", err);
             kernel_panic(err);
         }
-#if SCHED_KERNEL_DEBUG == 1
-    kernel_serial_debug("Poped One");
-    kernel_serial_debug(" 0x%p\n", active_thread_node[cpu_id]);
-#endif
         if(active_thread_node[cpu_id] != NULL)
         {
             break;
@@ -1017,16 +1172,13 @@ static void select_thread(void)
 
     active_thread[cpu_id] = (kernel_thread_t*)active_thread_node[cpu_id]->data;
 
-#if SCHED_KERNEL_DEBUG == 1
-    kernel_serial_debug("Elected thread %d\n", active_thread[cpu_id]->tid);
-#endif
-
 
     if(active_thread[cpu_id] == NULL)
     {
         kernel_error("Next thread to schedule should not be NULL\n");
         kernel_panic(err);
     }
+    sched_account(active_thread[cpu_id], active_thread[cpu_id]->state, now);
     active_thread[cpu_id]->state = THREAD_STATE_RUNNING;
 }
 
@@ -1055,19 +1207,35 @@ static void schedule_int(cpu_state_t* cpu_state, uintptr_t int_id,
         cpu_id = 0;
     }
 
-    (void) int_id;
-
     cpu_save_context(first_sched[cpu_id], cpu_state, stack_state, active_thread[cpu_id]);
 
+    /* The CPU left the previous thread, it cannot be in a RCU read section */
+    rcu_report_qs(cpu_id);
+
     /* Search for next thread */
     select_thread();
 
     ++schedule_count[cpu_id];
 
-#if SCHED_KERNEL_DEBUG == 1
-    kernel_serial_debug("CPU Sched %d -> %d\n",
-                        prev_thread[cpu_id]->tid, active_thread[cpu_id]->tid);
-#endif
+    /* A thread still ready when leaving the CPU because of the timer was
+     * preempted, otherwise it blocked or yielded.
+     */
+    if(prev_thread[cpu_id] != active_thread[cpu_id])
+    {
+        if(prev_thread[cpu_id]->state == THREAD_STATE_READY &&
+           int_id != SCHEDULER_SW_INT_LINE)
+        {
+            ++prev_thread[cpu_id]->involuntary_switches;
+        }
+        else
+        {
+            ++prev_thread[cpu_id]->voluntary_switches;
+        }
+
+        TRACE(TRACE_SCHED_SWITCH, prev_thread[cpu_id]->tid,
+              active_thread[cpu_id]->tid, prev_thread[cpu_id]->state,
+              active_thread[cpu_id]->priority);
+    }
 
      /* Restore thread context */
     cpu_update_pgdir(active_thread[cpu_id]->cpu_context.cr3);
@@ -1076,7 +1244,7 @@ static void schedule_int(cpu_state_t* cpu_state, uintptr_t int_id,
     first_sched[cpu_id] = 1;
 }
 
-SYSTEM_STATE_E get_system_state(void)
+SYSTEM_STATE_E sched_get_system_state(void)
 {
     return system_state;
 }
@@ -1095,11 +1263,12 @@ OS_RETURN_E sched_init(void)
     }
 
     /* Init scheduler settings */
-    last_given_tid   = 0;
+    next_tid         = 0;
     thread_count     = 0;
 
     memset((void*)schedule_count, 0, sizeof(uint64_t));
     memset((void*)idle_sched_count, 0, sizeof(uint64_t));
+    memset((void*)runqueue_hist, 0, sizeof(runqueue_hist));
 
     init_thread      = NULL;
     init_thread_node = NULL;
@@ -1111,12 +1280,8 @@ OS_RETURN_E sched_init(void)
 #endif
 
     /* Init thread tables */
-    global_threads_table = kernel_queue_create_queue(&err);
-    if(err != OS_NO_ERR)
-    {
-        kernel_error("Could not create global_threads_table[%d]\n", err);
-        kernel_panic(err);
-    }
+    kernel_queue_init_queue(&global_threads_table);
+    kernel_queue_init_queue(&zombie_threads_table);
 
     for(i = 0; i < MAX_CPU_COUNT; ++i)
     {
@@ -1126,34 +1291,20 @@ OS_RETURN_E sched_init(void)
 
         for(j = 0; j < KERNEL_LOWEST_PRIORITY + 1; ++j)
         {
-            active_threads_table[i][j] = kernel_queue_create_queue(&err);
-            if(err != OS_NO_ERR)
-            {
-                kernel_error("Could not create active_threads_table %d [%d]\n",
-                            j, err);
-                kernel_panic(err);
-            }
+            kernel_queue_init_queue(&active_threads_table[i][j]);
         }
+
+        kernel_queue_init_queue(&sleeping_threads_table[i]);
+        kernel_queue_init_queue(&priority_requests_table[i]);
     }
 
-    zombie_threads_table = kernel_queue_create_queue(&err);
+    err = thread_table_init();
     if(err != OS_NO_ERR)
     {
-        kernel_error("Could not create zombie_threads_table[%d]\n", err);
+        kernel_error("Could not initialize the thread table[%d]\n", err);
         kernel_panic(err);
     }
 
-    for(i = 0; i < MAX_CPU_COUNT; ++i)
-    {
-        sleeping_threads_table[i] = kernel_queue_create_queue(&err);
-        if(err != OS_NO_ERR)
-        {
-            kernel_error("Could not create sleeping_threads_table %d [%d]\n",
-            i, err);
-            kernel_panic(err);
-        }
-    }
-
     /* Create idle thread */
     err = create_idle(SCHEDULER_IDLE_STACK_SIZE);
     if(err != OS_NO_ERR)
@@ -1239,13 +1390,7 @@ OS_RETURN_E sched_sleep(const unsigned int time_ms)
         time_get_current_uptime() + time_ms - 1000 / KERNEL_MAIN_TIMER_FREQ;
     active_thread[cpu_id]->state       = THREAD_STATE_SLEEPING;
 
-#if SCHED_KERNEL_DEBUG == 1
-    kernel_serial_debug("[%d] Thread %d asleep until %d (%dms)\n",
-                        (uint32_t)time_get_current_uptime(),
-                        active_thread[cpu_id]->tid,
-                        (uint32_t)active_thread[cpu_id]->wakeup_time,
-                        time_ms);
-#endif
+    TRACE(TRACE_SCHED_SLEEP, active_thread[cpu_id]->tid, time_ms, 0, 0);
 
     sched_schedule();
 
@@ -1333,16 +1478,18 @@ OS_RETURN_E sched_set_priority(const uint32_t priority)
         return OS_ERR_FORBIDEN_PRIORITY;
     }
 
-    active_thread[cpu_id]->priority = priority;
+    active_thread[cpu_id]->priority           = priority;
+    active_thread[cpu_id]->requested_priority = priority;
 
     return OS_NO_ERR;
 }
 
-OS_RETURN_E get_threads_info(thread_info_t* threads, int32_t* size)
+OS_RETURN_E sched_get_threads_info(thread_info_t* threads, size_t* size)
 {
-    int32_t               i;
+    size_t                i;
     kernel_queue_node_t*  cursor;
     kernel_thread_t*      cursor_thread;
+    uint32_t              rcu_state;
 
     if(threads == NULL)
     {
@@ -1353,36 +1500,131 @@ OS_RETURN_E get_threads_info(thread_info_t* threads, int32_t* size)
         return OS_ERR_NULL_POINTER;
     }
 
-    if(*size > (int)thread_count)
+    if(*size > thread_count)
     {
         *size = thread_count;
     }
 
+    /* Joined threads and their nodes are released after a grace period, the
+     * list can be walked without locking it.
+     */
+    rcu_state = rcu_read_lock();
+
     /* Walk the thread list and fill the structures */
-    cursor = global_threads_table->head;
-    cursor_thread = (kernel_thread_t*)cursor->data;
+    cursor = RCU_DEREFERENCE(global_threads_table.head);
     for(i = 0; cursor != NULL && i < *size; ++i)
     {
-        thread_info_t *current = &threads[i];
-        current->tid = cursor_thread->tid;
-        current->ptid = cursor_thread->ptid;
-        strncpy(current->name, cursor_thread->name, THREAD_MAX_NAME_LENGTH);
-        current->priority = cursor_thread->priority;
-        current->state = cursor_thread->state;
-        current->start_time = cursor_thread->start_time;
-        if(current->state != THREAD_STATE_ZOMBIE)
-        {
-            current->end_time = time_get_current_uptime();
-        }
-        else
-        {
-            current->end_time = cursor_thread->end_time;
-        }
-
-        cursor = cursor->next;
         cursor_thread = (kernel_thread_t*)cursor->data;
+        sched_fill_thread_info(cursor_thread, &threads[i]);
+
+        cursor = RCU_DEREFERENCE(cursor->next);
+    }
+
+    rcu_read_unlock(rcu_state);
+
+    *size = i;
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E sched_get_thread_info(const int32_t tid, thread_info_t* info)
+{
+    kernel_thread_t* thread;
+    uint32_t         rcu_state;
+
+    if(info == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
     }
 
+    /* Joined threads are released after a grace period, the thread stays valid
+     * until the read side section is exited.
+     */
+    rcu_state = rcu_read_lock();
+
+    thread = thread_table_find(tid);
+    if(thread == NULL)
+    {
+        rcu_read_unlock(rcu_state);
+        return OS_ERR_NO_SUCH_ID;
+    }
+
+    sched_fill_thread_info(thread, info);
+
+    rcu_read_unlock(rcu_state);
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E sched_set_thread_priority(const int32_t tid,
+                                      const uint32_t priority)
+{
+    OS_RETURN_E      err;
+    kernel_thread_t* thread;
+    uint32_t         rcu_state;
+    uint32_t         int_state;
+
+    /* Check if priority is free */
+    if(priority > KERNEL_LOWEST_PRIORITY)
+    {
+        return OS_ERR_FORBIDEN_PRIORITY;
+    }
+
+    rcu_state = rcu_read_lock();
+
+    thread = thread_table_find(tid);
+    if(thread == NULL)
+    {
+        rcu_read_unlock(rcu_state);
+        return OS_ERR_NO_SUCH_ID;
+    }
+
+    /* The IDLE threads must stay at the lowest priority */
+    if(thread == idle_thread[thread->cpu_affinity])
+    {
+        rcu_read_unlock(rcu_state);
+        return OS_ERR_UNAUTHORIZED_ACTION;
+    }
+
+    /* Only the thread's CPU pops its active tables, the move is done there on
+     * the next schedule. The CPU lock serializes the requests.
+     */
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &cpu_locks[thread->cpu_affinity]);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    thread->requested_priority = priority;
+
+    /* Requeue the request, the CPU reads the priority after popping it */
+    err = kernel_queue_remove(&priority_requests_table[thread->cpu_affinity],
+                              &thread->priority_node);
+    if(err == OS_NO_ERR || err == OS_ERR_NO_SUCH_ID)
+    {
+        err = kernel_queue_push(&thread->priority_node,
+                                &priority_requests_table[thread->cpu_affinity]);
+    }
+    if(err != OS_NO_ERR)
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &cpu_locks[thread->cpu_affinity]);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+
+        kernel_error("Could not enqueue priority request[%d]\n", err);
+        kernel_panic(err);
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &cpu_locks[thread->cpu_affinity]);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    rcu_read_unlock(rcu_state);
+
     return OS_NO_ERR;
 }
 
@@ -1427,9 +1669,6 @@ OS_RETURN_E sched_create_kernel_thread(thread_t* thread,
 {
     OS_RETURN_E          err;
     kernel_thread_t*     new_thread;
-    kernel_queue_node_t* new_thread_node;
-    kernel_queue_node_t* seconde_new_thread_node;
-    kernel_queue_node_t* children_new_thread_node;
     uint32_t             stack_index;
     uint32_t             int_state;
     int32_t              cpu_id;
@@ -1467,34 +1706,32 @@ OS_RETURN_E sched_create_kernel_thread(thread_t* thread,
 #endif
 
     new_thread = kmalloc(sizeof(kernel_thread_t));
-    new_thread_node = kernel_queue_create_node(new_thread, &err);
-    if(err != OS_NO_ERR ||
-       new_thread == NULL ||
-       new_thread_node == NULL)
+    if(new_thread == NULL)
     {
-        if(new_thread != NULL)
-        {
-            kfree(new_thread);
-        }
-        else
-        {
-            err = OS_ERR_MALLOC;
-        }
-
 #if MAX_CPU_COUNT > 1
         EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
 #else
         EXIT_CRITICAL(int_state);
 #endif
 
-        return err;
+        return OS_ERR_MALLOC;
     }
     memset(new_thread, 0, sizeof(kernel_thread_t));
 
+    /* The queues nodes are embedded in the thread, enqueuing the thread in the
+     * scheduler tables never allocates.
+     */
+    kernel_queue_init_node(&new_thread->sched_node, new_thread);
+    kernel_queue_init_node(&new_thread->children_node, new_thread);
+    kernel_queue_init_node(&new_thread->global_node, new_thread);
+    kernel_queue_init_node(&new_thread->priority_node, new_thread);
+    kernel_queue_init_queue(&new_thread->children);
+
     /* Init thread settings */
-    new_thread->tid            = ++last_given_tid;
+    new_thread->tid            = sched_alloc_tid();
     new_thread->ptid           = active_thread[cpu_id]->tid;
     new_thread->priority       = priority;
+    new_thread->requested_priority = priority;
     new_thread->init_prio      = priority;
     new_thread->args           = args;
     new_thread->function       = function;
@@ -1502,34 +1739,18 @@ OS_RETURN_E sched_create_kernel_thread(thread_t* thread,
     new_thread->state          = THREAD_STATE_READY;
     new_thread->stack_size     = stack_size;
     new_thread->cpu_affinity   = cpu_affinity;
+    new_thread->last_account   = cpu_rdtsc();
 
 #if MAX_CPU_COUNT > 1
     INIT_SPINLOCK(&new_thread->lock);
 #endif
 
-    new_thread->children = kernel_queue_create_queue(&err);
-    if(err != OS_NO_ERR)
-    {
-        kernel_queue_delete_node(&new_thread_node);
-        kfree(new_thread);
-
-#if MAX_CPU_COUNT > 1
-        EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
-#else
-        EXIT_CRITICAL(int_state);
-#endif
-
-        return err;
-    }
-
     /* Init thread stack and align stack size */
     stack_index = (stack_size + ALIGN - 1) & (~(ALIGN - 1));
     stack_index /= sizeof(uintptr_t);
     new_thread->stack = kmalloc(stack_index * sizeof(uintptr_t));
     if(new_thread->stack == NULL)
     {
-        kernel_queue_delete_node(&new_thread_node);
-        kernel_queue_delete_queue(&new_thread->children);
         kfree(new_thread);
 
 #if MAX_CPU_COUNT > 1
@@ -1549,12 +1770,10 @@ OS_RETURN_E sched_create_kernel_thread(thread_t* thread,
 
     strncpy(new_thread->name, name, THREAD_MAX_NAME_LENGTH);
 
-    /* Add thread to the system's queues. */
-    seconde_new_thread_node = kernel_queue_create_node(new_thread, &err);
+    /* Add thread to the system's tables. */
+    err = thread_table_insert(new_thread);
     if(err != OS_NO_ERR)
     {
-        kernel_queue_delete_queue(&new_thread->children);
-        kernel_queue_delete_node(&new_thread_node);
         kfree(new_thread->stack);
         kfree(new_thread);
 
@@ -1567,12 +1786,10 @@ OS_RETURN_E sched_create_kernel_thread(thread_t* thread,
         return err;
     }
 
-    children_new_thread_node = kernel_queue_create_node(new_thread, &err);
+    err = kernel_queue_push(&new_thread->global_node, &global_threads_table);
     if(err != OS_NO_ERR)
     {
-        kernel_queue_delete_queue(&new_thread->children);
-        kernel_queue_delete_node(&new_thread_node);
-        kernel_queue_delete_node(&seconde_new_thread_node);
+        thread_table_remove(new_thread->tid);
         kfree(new_thread->stack);
         kfree(new_thread);
 
@@ -1585,13 +1802,12 @@ OS_RETURN_E sched_create_kernel_thread(thread_t* thread,
         return err;
     }
 
-    err = kernel_queue_push(seconde_new_thread_node, global_threads_table);
+    err = kernel_queue_push(&new_thread->children_node,
+                            &active_thread[cpu_id]->children);
     if(err != OS_NO_ERR)
     {
-        kernel_queue_delete_queue(&new_thread->children);
-        kernel_queue_delete_node(&children_new_thread_node);
-        kernel_queue_delete_node(&new_thread_node);
-        kernel_queue_delete_node(&seconde_new_thread_node);
+        thread_table_remove(new_thread->tid);
+        kernel_queue_remove(&global_threads_table, &new_thread->global_node);
         kfree(new_thread->stack);
         kfree(new_thread);
 
@@ -1604,39 +1820,14 @@ OS_RETURN_E sched_create_kernel_thread(thread_t* thread,
         return err;
     }
 
-
-    err = kernel_queue_push(children_new_thread_node,
-                            active_thread[cpu_id]->children);
+    err = kernel_queue_push(&new_thread->sched_node,
+                            &active_threads_table[cpu_affinity][priority]);
     if(err != OS_NO_ERR)
     {
-        kernel_queue_delete_queue(&new_thread->children);
-        kernel_queue_delete_node(&children_new_thread_node);
-        kernel_queue_delete_node(&new_thread_node);
-        kernel_queue_delete_node(&seconde_new_thread_node);
-        kernel_queue_remove(global_threads_table, seconde_new_thread_node);
-        kfree(new_thread->stack);
-        kfree(new_thread);
-
-#if MAX_CPU_COUNT > 1
-        EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
-#else
-        EXIT_CRITICAL(int_state);
-#endif
-
-        return err;
-    }
-
-    err = kernel_queue_push(new_thread_node,
-                            active_threads_table[cpu_affinity][priority]);
-    if(err != OS_NO_ERR)
-    {
-        kernel_queue_delete_queue(&new_thread->children);
-        kernel_queue_delete_node(&children_new_thread_node);
-        kernel_queue_delete_node(&new_thread_node);
-        kernel_queue_delete_node(&seconde_new_thread_node);
-        kernel_queue_remove(global_threads_table, seconde_new_thread_node);
-        kernel_queue_remove(active_thread[cpu_id]->children,
-                            children_new_thread_node);
+        thread_table_remove(new_thread->tid);
+        kernel_queue_remove(&global_threads_table, &new_thread->global_node);
+        kernel_queue_remove(&active_thread[cpu_id]->children,
+                            &new_thread->children_node);
         kfree(new_thread->stack);
         kfree(new_thread);
 
@@ -1663,9 +1854,8 @@ OS_RETURN_E sched_create_kernel_thread(thread_t* thread,
     EXIT_CRITICAL(int_state);
 #endif
 
-#if SCHED_KERNEL_DEBUG == 1
-    kernel_serial_debug("Created thread %d\n", new_thread->tid);
-#endif
+    TRACE(TRACE_SCHED_CREATE, new_thread->tid, new_thread->priority,
+          new_thread->cpu_affinity, 0);
 
     if(thread != NULL)
     {
@@ -1758,11 +1948,7 @@ kernel_queue_node_t* sched_lock_thread(const THREAD_WAIT_TYPE_E block_type)
     active_thread[cpu_id]->state      = THREAD_STATE_WAITING;
     active_thread[cpu_id]->block_type = block_type;
 
-#if SCHED_KERNEL_DEBUG == 1
-    kernel_serial_debug("Thread %d locked, reason: %d\n",
-                        active_thread[cpu_id]->tid,
-                        block_type);
-#endif
+    TRACE(TRACE_SCHED_BLOCK, active_thread[cpu_id]->tid, block_type, 0, 0);
 
     return current_thread_node;
 }
@@ -1812,9 +1998,10 @@ OS_RETURN_E sched_unlock_thread(kernel_queue_node_t* node,
 #endif
 
     /* Unlock thread state */
+    sched_account(thread, thread->state, cpu_rdtsc());
     thread->state = THREAD_STATE_READY;
     err = kernel_queue_push(node,
-                            active_threads_table[thread->cpu_affinity]
+                            &active_threads_table[thread->cpu_affinity]
                                                 [thread->priority]);
     if(err != OS_NO_ERR)
     {
@@ -1828,11 +2015,7 @@ OS_RETURN_E sched_unlock_thread(kernel_queue_node_t* node,
         kernel_panic(err);
     }
 
-#if SCHED_KERNEL_DEBUG == 1
-    kernel_serial_debug("Thread %d unlocked, reason: %d\n",
-                         thread->tid,
-                         block_type);
-#endif
+    TRACE(TRACE_SCHED_UNBLOCK, thread->tid, block_type, 0, 0);
 
 #if MAX_CPU_COUNT > 1
     EXIT_CRITICAL(int_state, &cpu_locks[cpu_id]);
@@ -1872,6 +2055,28 @@ uint64_t sched_get_idle_schedule_count(void)
     return idle_sched_count[cpu_id];
 }
 
+OS_RETURN_E sched_get_runqueue_histogram(const uint32_t cpu_id,
+                                         uint64_t* histogram)
+{
+    uint32_t i;
+
+    if(histogram == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    if(cpu_id >= MAX_CPU_COUNT)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    for(i = 0; i < SCHED_RUNQUEUE_HIST_SIZE; ++i)
+    {
+        histogram[i] = runqueue_hist[cpu_id][i];
+    }
+
+    return OS_NO_ERR;
+}
+
 uintptr_t sched_get_thread_free_page_table(void)
 {
     int32_t cpu_id;
@@ -0,0 +1,312 @@
+/*******************************************************************************
+ * @file thread_table.c
+ *
+ * @see thread_table.h
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Kernel's TID indexed thread table.
+ *
+ * @details Kernel's TID indexed thread table. The table is an open addressing
+ * hash table with linear probing that maps a thread identifier to its thread
+ * structure in constant time. The table grows when its load factor reaches one
+ * half. The scheduler inserts the threads on creation and removes them once
+ * joined.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#include <lib/stddef.h>       /* Standard definitions */
+#include <lib/stdint.h>       /* Generic int types */
+#include <lib/string.h>       /* String manipulation */
+#include <memory/kheap.h>     /* Kernel heap */
+#include <sync/critical.h>    /* Critical sections */
+
+/* UTK configuration file */
+#include <config.h>
+
+/* Header file */
+#include <core/thread_table.h>
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************/
+
+/** @brief Thread table slots, NULL slots are free. */
+static kernel_thread_t** thread_table = NULL;
+/** @brief Number of bits of the thread table size. */
+static uint32_t thread_table_bits = 0;
+/** @brief Number of threads stored in the table. */
+static uint32_t thread_table_count = 0;
+
+#if MAX_CPU_COUNT > 1
+/** @brief Critical section spinlock. */
+static spinlock_t thread_table_lock = SPINLOCK_INIT_VALUE;
+#endif
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Returns the home slot of a TID.
+ *
+ * @param[in] tid The TID to hash.
+ * @param[in] bits The number of bits of the table size.
+ *
+ * @return The index of the first slot to probe for the TID.
+ */
+__inline__ static uint32_t thread_table_hash(const int32_t tid,
+                                             const uint32_t bits)
+{
+    return ((uint32_t)tid * 0x9E3779B1) >> (32 - bits);
+}
+
+/**
+ * @brief Returns the slot that contains a TID.
+ *
+ * @details Returns the slot that contains a TID. The table lock must be held by
+ * the caller.
+ *
+ * @param[in] tid The TID to look for.
+ *
+ * @return The index of the slot containing the TID, -1 if the TID is not in
+ * the table.
+ */
+static int32_t thread_table_find_slot(const int32_t tid)
+{
+    uint32_t mask;
+    uint32_t i;
+
+    mask = (1 << thread_table_bits) - 1;
+    i    = thread_table_hash(tid, thread_table_bits);
+
+    while(thread_table[i] != NULL)
+    {
+        if(thread_table[i]->tid == tid)
+        {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Doubles the thread table size.
+ *
+ * @details Allocates a table twice as big and moves the threads into it. The
+ * table lock must be held by the caller.
+ *
+ * @return The success state or the error code.
+ * - OS_NO_ERR is returned if no error is encountered.
+ * - OS_ERR_MALLOC is returned if the new table could not be allocated.
+ */
+static OS_RETURN_E thread_table_grow(void)
+{
+    kernel_thread_t** new_table;
+    uint32_t          new_bits;
+    uint32_t          new_mask;
+    uint32_t          i;
+    uint32_t          j;
+
+    new_bits  = thread_table_bits + 1;
+    new_mask  = (1 << new_bits) - 1;
+    new_table = kmalloc(sizeof(kernel_thread_t*) << new_bits);
+    if(new_table == NULL)
+    {
+        return OS_ERR_MALLOC;
+    }
+    memset(new_table, 0, sizeof(kernel_thread_t*) << new_bits);
+
+    for(i = 0; i < (1U << thread_table_bits); ++i)
+    {
+        if(thread_table[i] != NULL)
+        {
+            j = thread_table_hash(thread_table[i]->tid, new_bits);
+            while(new_table[j] != NULL)
+            {
+                j = (j + 1) & new_mask;
+            }
+            new_table[j] = thread_table[i];
+        }
+    }
+
+    kfree(thread_table);
+    thread_table      = new_table;
+    thread_table_bits = new_bits;
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E thread_table_init(void)
+{
+    thread_table = kmalloc(sizeof(kernel_thread_t*) << THREAD_TABLE_INIT_BITS);
+    if(thread_table == NULL)
+    {
+        return OS_ERR_MALLOC;
+    }
+    memset(thread_table, 0, sizeof(kernel_thread_t*) << THREAD_TABLE_INIT_BITS);
+
+    thread_table_bits  = THREAD_TABLE_INIT_BITS;
+    thread_table_count = 0;
+
+#if MAX_CPU_COUNT > 1
+    INIT_SPINLOCK(&thread_table_lock);
+#endif
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E thread_table_insert(kernel_thread_t* thread)
+{
+    OS_RETURN_E err;
+    uint32_t    mask;
+    uint32_t    i;
+    uint32_t    int_state;
+
+    if(thread == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &thread_table_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    if(thread_table_find_slot(thread->tid) != -1)
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &thread_table_lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+        return OS_ERR_UNAUTHORIZED_ACTION;
+    }
+
+    /* Keep the load factor under one half so the probe chains stay short */
+    if((thread_table_count + 1) * 2 > (1U << thread_table_bits))
+    {
+        err = thread_table_grow();
+        if(err != OS_NO_ERR)
+        {
+#if MAX_CPU_COUNT > 1
+            EXIT_CRITICAL(int_state, &thread_table_lock);
+#else
+            EXIT_CRITICAL(int_state);
+#endif
+            return err;
+        }
+    }
+
+    mask = (1 << thread_table_bits) - 1;
+    i    = thread_table_hash(thread->tid, thread_table_bits);
+    while(thread_table[i] != NULL)
+    {
+        i = (i + 1) & mask;
+    }
+    thread_table[i] = thread;
+    ++thread_table_count;
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &thread_table_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E thread_table_remove(const int32_t tid)
+{
+    int32_t  slot;
+    uint32_t mask;
+    uint32_t i;
+    uint32_t j;
+    uint32_t home;
+    uint32_t int_state;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &thread_table_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    slot = thread_table_find_slot(tid);
+    if(slot == -1)
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &thread_table_lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+        return OS_ERR_NO_SUCH_ID;
+    }
+
+    mask = (1 << thread_table_bits) - 1;
+    i    = slot;
+    thread_table[i] = NULL;
+    --thread_table_count;
+
+    /* Shift back the following entries of the probe chain instead of leaving a
+     * tombstone, an entry moves if the freed slot is between its home slot and
+     * its current slot.
+     */
+    j = i;
+    while(1)
+    {
+        j = (j + 1) & mask;
+        if(thread_table[j] == NULL)
+        {
+            break;
+        }
+
+        home = thread_table_hash(thread_table[j]->tid, thread_table_bits);
+        if((j > i && (home <= i || home > j)) ||
+           (j < i && (home <= i && home > j)))
+        {
+            thread_table[i] = thread_table[j];
+            thread_table[j] = NULL;
+            i = j;
+        }
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &thread_table_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return OS_NO_ERR;
+}
+
+kernel_thread_t* thread_table_find(const int32_t tid)
+{
+    kernel_thread_t* thread;
+    int32_t          slot;
+    uint32_t         int_state;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &thread_table_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    slot   = thread_table_find_slot(tid);
+    thread = (slot != -1) ? thread_table[slot] : NULL;
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &thread_table_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return thread;
+}
@@ -0,0 +1,304 @@
+/*******************************************************************************
+ * @file trace.c
+ *
+ * @see trace.h
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Kernel trace events.
+ *
+ * @details Kernel trace events. A ring is only written by its CPU with the
+ * interrupts disabled, recording an event needs no lock. The export formats the
+ * events as text lines so they can be mixed with the kernel serial output.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#include <lib/stdint.h>           /* Generic int types */
+#include <lib/stddef.h>           /* Standard definitions */
+#include <lib/string.h>           /* memcpy */
+#include <cpu.h>                  /* cpu_get_id, cpu_rdtsc */
+#include <serial.h>               /* Serial driver */
+#include <interrupt/interrupts.h> /* Interrupt state */
+
+/* UTK configuration file */
+#include <config.h>
+
+/* Header file */
+#include <core/trace.h>
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************/
+
+#if TRACE_ENABLED == 1
+
+volatile uint32_t trace_categories = TRACE_BOOT_CATEGORIES;
+
+/** @brief Per CPU trace rings. */
+static trace_ring_t trace_rings[MAX_CPU_COUNT];
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Writes the hexadecimal representation of a value.
+ *
+ * @param[out] buffer The buffer that receives the digits.
+ * @param[in] value The value to write.
+ * @param[in] digits The number of digits to write.
+ *
+ * @return The buffer position following the digits.
+ */
+static char* trace_put_hex(char* buffer, uint32_t value, const uint32_t digits)
+{
+    uint32_t i;
+
+    for(i = digits; i > 0; --i)
+    {
+        buffer[i - 1] = "0123456789abcdef"[value & 0xF];
+        value >>= 4;
+    }
+
+    return buffer + digits;
+}
+
+void trace_event(const uint16_t id, const uint32_t arg0, const uint32_t arg1,
+                 const uint32_t arg2, const uint32_t arg3)
+{
+    trace_ring_t*  ring;
+    trace_event_t* event;
+    uint32_t       int_state;
+    uint32_t       head;
+    uint32_t       slot;
+    int32_t        cpu_id;
+
+    /* The ring is only written by its CPU, disabling the interrupts is enough
+     * to own it.
+     */
+    int_state = kernel_interrupt_disable();
+
+    cpu_id = cpu_get_id();
+    if(cpu_id < 0 || cpu_id >= MAX_CPU_COUNT)
+    {
+        cpu_id = 0;
+    }
+    ring = &trace_rings[cpu_id];
+
+    head  = ring->head;
+    slot  = head & (TRACE_BUFFER_SIZE - 1);
+    event = &ring->events[slot];
+
+    /* Readers copying the slot meanwhile see the sequence change */
+    __atomic_store_n(&ring->sequences[slot], 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    event->timestamp = cpu_rdtsc();
+    event->id        = id;
+    event->cpu       = cpu_id;
+    event->args[0]   = arg0;
+    event->args[1]   = arg1;
+    event->args[2]   = arg2;
+    event->args[3]   = arg3;
+
+    __atomic_store_n(&ring->sequences[slot], head + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    kernel_interrupt_restore(int_state);
+}
+
+void trace_enable(const uint32_t categories)
+{
+    __atomic_fetch_or(&trace_categories, categories, __ATOMIC_RELAXED);
+}
+
+void trace_disable(const uint32_t categories)
+{
+    __atomic_fetch_and(&trace_categories, ~categories, __ATOMIC_RELAXED);
+}
+
+void trace_clear(void)
+{
+    uint32_t i;
+
+    for(i = 0; i < MAX_CPU_COUNT; ++i)
+    {
+        trace_rings[i].tail = __atomic_load_n(&trace_rings[i].head,
+                                              __ATOMIC_ACQUIRE);
+    }
+}
+
+OS_RETURN_E trace_read(const uint32_t cpu_id, trace_event_t* events,
+                       const uint32_t size, uint32_t* count, uint32_t* lost)
+{
+    trace_ring_t* ring;
+    uint32_t      head;
+    uint32_t      tail;
+    uint32_t      slot;
+    uint32_t      sequence;
+    uint32_t      dropped;
+    uint32_t      i;
+
+    if(events == NULL || count == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    if(cpu_id >= MAX_CPU_COUNT)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    ring = &trace_rings[cpu_id];
+    head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    tail = ring->tail;
+
+    /* The oldest events were overwritten */
+    dropped = 0;
+    if(head - tail > TRACE_BUFFER_SIZE)
+    {
+        dropped = head - tail - TRACE_BUFFER_SIZE;
+        tail    = head - TRACE_BUFFER_SIZE;
+    }
+
+    i = 0;
+    while(i < size && tail != head)
+    {
+        slot     = tail & (TRACE_BUFFER_SIZE - 1);
+        sequence = __atomic_load_n(&ring->sequences[slot], __ATOMIC_ACQUIRE);
+
+        memcpy(&events[i], &ring->events[slot], sizeof(trace_event_t));
+
+        /* Keep the event only if the slot was not written during the copy */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(sequence == tail + 1 &&
+           __atomic_load_n(&ring->sequences[slot], __ATOMIC_RELAXED) ==
+           sequence)
+        {
+            ++i;
+        }
+        else
+        {
+            ++dropped;
+        }
+        ++tail;
+    }
+
+    ring->tail = tail;
+    *count     = i;
+    if(lost != NULL)
+    {
+        *lost = dropped;
+    }
+
+    return OS_NO_ERR;
+}
+
+void trace_dump(void)
+{
+    trace_event_t event;
+    uint32_t      categories;
+    uint32_t      cpu_id;
+    uint32_t      count;
+    uint32_t      lost;
+    uint32_t      i;
+    char          line[96];
+    char*         pos;
+
+    categories = __atomic_exchange_n(&trace_categories, 0, __ATOMIC_ACQUIRE);
+
+    serial_put_string("#TRACE BEGIN\n");
+
+    for(cpu_id = 0; cpu_id < MAX_CPU_COUNT; ++cpu_id)
+    {
+        while(trace_read(cpu_id, &event, 1, &count, &lost) == OS_NO_ERR &&
+              (count != 0 || lost != 0))
+        {
+            if(lost != 0)
+            {
+                pos = line;
+                memcpy(pos, "#TRACE LOST ", 12);
+                pos = trace_put_hex(pos + 12, cpu_id, 2);
+                *pos++ = ' ';
+                pos = trace_put_hex(pos, lost, 8);
+                *pos++ = '\n';
+                *pos   = 0;
+                serial_put_string(line);
+            }
+            if(count == 0)
+            {
+                continue;
+            }
+
+            /* #TRACE <cpu> <tsc> <id> <arg0> <arg1> <arg2> <arg3> */
+            pos = line;
+            memcpy(pos, "#TRACE ", 7);
+            pos = trace_put_hex(pos + 7, event.cpu, 2);
+            *pos++ = ' ';
+            pos = trace_put_hex(pos, (uint32_t)(event.timestamp >> 32), 8);
+            pos = trace_put_hex(pos, (uint32_t)event.timestamp, 8);
+            *pos++ = ' ';
+            pos = trace_put_hex(pos, event.id, 4);
+            for(i = 0; i < TRACE_EVENT_ARGS; ++i)
+            {
+                *pos++ = ' ';
+                pos = trace_put_hex(pos, event.args[i], 8);
+            }
+            *pos++ = '\n';
+            *pos   = 0;
+            serial_put_string(line);
+        }
+    }
+
+    serial_put_string("#TRACE END\n");
+
+    __atomic_fetch_or(&trace_categories, categories, __ATOMIC_RELEASE);
+}
+
+#else /* TRACE_ENABLED == 1 */
+
+void trace_event(const uint16_t id, const uint32_t arg0, const uint32_t arg1,
+                 const uint32_t arg2, const uint32_t arg3)
+{
+    (void)id;
+    (void)arg0;
+    (void)arg1;
+    (void)arg2;
+    (void)arg3;
+}
+
+void trace_enable(const uint32_t categories)
+{
+    (void)categories;
+}
+
+void trace_disable(const uint32_t categories)
+{
+    (void)categories;
+}
+
+void trace_clear(void)
+{
+}
+
+OS_RETURN_E trace_read(const uint32_t cpu_id, trace_event_t* events,
+                       const uint32_t size, uint32_t* count, uint32_t* lost)
+{
+    (void)cpu_id;
+    (void)events;
+    (void)size;
+    (void)count;
+    (void)lost;
+
+    return OS_ERR_NOT_SUPPORTED;
+}
+
+void trace_dump(void)
+{
+}
+
+#endif /* TRACE_ENABLED == 1 */
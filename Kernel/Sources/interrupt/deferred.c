@@ -0,0 +1,459 @@
+/*******************************************************************************
+ * @file deferred.c
+ *
+ * @see deferred.h
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Interrupt deferred work.
+ *
+ * @details Interrupt deferred work. Each CPU has a tasklet queue, a work item
+ * queue and a worker thread that sleeps on a futex while both queues are
+ * empty. Queuing an item only sets its pending flag, enqueues its embedded node
+ * and wakes the worker, it is short enough to be done in interrupt handlers.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#include <lib/stdint.h>        /* Generic int types */
+#include <lib/stddef.h>        /* Standard definitions */
+#include <lib/string.h>        /* memset */
+#include <cpu.h>               /* cpu_get_id, cpu_rdtsc */
+#include <core/kernel_queue.h> /* Kernel queues */
+#include <core/scheduler.h>    /* Kernel scheduler */
+#include <core/panic.h>        /* Kernel panic */
+#include <io/kernel_output.h>  /* Kernel output methods */
+#include <sync/critical.h>     /* Critical sections */
+#include <sync/futex.h>        /* Futex */
+
+/* UTK configuration file */
+#include <config.h>
+
+/* Header file */
+#include <interrupt/deferred.h>
+
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/** @brief Deferred work context of a CPU. */
+struct deferred_cpu
+{
+    /** @brief Pending tasklets. */
+    kernel_queue_t tasklets;
+    /** @brief Pending work items. */
+    kernel_queue_t works;
+
+    /** @brief Incremented by each queue request, the worker waits on it. */
+    volatile int32_t  event;
+    /** @brief Set when the worker waits for items. */
+    volatile uint32_t waiting;
+
+    /** @brief Worker statistics. */
+    deferred_stats_t stats;
+
+#if MAX_CPU_COUNT > 1
+    /** @brief Statistics lock. */
+    spinlock_t lock;
+#endif
+};
+
+/**
+ * @brief Defines deferred_cpu_t type as a shorcut for struct deferred_cpu.
+ */
+typedef struct deferred_cpu deferred_cpu_t;
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************/
+
+/** @brief Per CPU deferred work contexts. */
+static deferred_cpu_t deferred_cpus[MAX_CPU_COUNT];
+
+/** @brief Set to 1 once the worker threads are started. */
+static volatile uint32_t deferred_started = 0;
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Returns the ID of the current CPU, 0 if it is not known.
+ *
+ * @return The ID of the current CPU.
+ */
+static uint32_t deferred_get_cpu(void)
+{
+    int32_t cpu_id;
+
+    cpu_id = cpu_get_id();
+    if(cpu_id < 0 || cpu_id >= MAX_CPU_COUNT)
+    {
+        cpu_id = 0;
+    }
+
+    return (uint32_t)cpu_id;
+}
+
+static void deferred_queue(deferred_work_t* work, const uint32_t cpu_id,
+                           const uint32_t tasklet);
+
+/**
+ * @brief Runs an item routine unless it already runs on an other CPU.
+ *
+ * @details When the routine already runs on an other CPU, the item is marked
+ * for a new run instead. The CPU running the routine queues the item again
+ * on the given CPU once the routine returns.
+ *
+ * @param[in, out] work The item to run.
+ * @param[in] cpu_id The CPU the item is queued again on if it cannot run now.
+ * @param[in] tasklet Set to 1 if the item is a tasklet.
+ *
+ * @return The CPU cycles spent in the routine, 0 if it did not run.
+ */
+static uint64_t deferred_run(deferred_work_t* work, const uint32_t cpu_id,
+                             const uint32_t tasklet)
+{
+    uint64_t start;
+    uint64_t cycles;
+    uint32_t state;
+
+    state = __atomic_load_n(&work->state, __ATOMIC_ACQUIRE);
+    while(1)
+    {
+        if((state & DEFERRED_STATE_RUNNING) == 0)
+        {
+            if(__atomic_compare_exchange_n(&work->state, &state,
+                                           state | DEFERRED_STATE_RUNNING, 0,
+                                           __ATOMIC_ACQUIRE,
+                                           __ATOMIC_ACQUIRE) != 0)
+            {
+                break;
+            }
+        }
+        else
+        {
+            /* Published by the release of the state update */
+            work->rerun_cpu     = cpu_id;
+            work->rerun_tasklet = tasklet;
+            if(__atomic_compare_exchange_n(&work->state, &state,
+                                           state | DEFERRED_STATE_RERUN, 0,
+                                           __ATOMIC_RELEASE,
+                                           __ATOMIC_ACQUIRE) != 0)
+            {
+                return 0;
+            }
+        }
+    }
+
+    start = cpu_rdtsc();
+    work->routine(work->args);
+    cycles = cpu_rdtsc() - start;
+
+    state = __atomic_fetch_and(&work->state,
+                               ~(DEFERRED_STATE_RUNNING | DEFERRED_STATE_RERUN),
+                               __ATOMIC_ACQ_REL);
+
+    /* The item was dequeued by an other CPU while the routine ran */
+    if((state & DEFERRED_STATE_RERUN) != 0)
+    {
+        deferred_queue(work, work->rerun_cpu, work->rerun_tasklet);
+    }
+
+    /* Do not report an empty run */
+    return cycles == 0 ? 1 : cycles;
+}
+
+/**
+ * @brief Queues an item on a CPU and wakes its worker.
+ *
+ * @param[in, out] work The item to queue.
+ * @param[in] cpu_id The CPU that runs the item.
+ * @param[in] tasklet Set to 1 to queue the item as a tasklet.
+ */
+static void deferred_queue(deferred_work_t* work, const uint32_t cpu_id,
+                           const uint32_t tasklet)
+{
+    deferred_cpu_t* cpu;
+    OS_RETURN_E     err;
+
+    /* The item is already pending, its routine has not started yet */
+    if((__atomic_fetch_or(&work->state, DEFERRED_STATE_PENDING,
+                          __ATOMIC_ACQ_REL) & DEFERRED_STATE_PENDING) != 0)
+    {
+        return;
+    }
+
+    /* No worker yet, run the item now */
+    if(deferred_started == 0)
+    {
+        __atomic_fetch_and(&work->state, ~DEFERRED_STATE_PENDING,
+                           __ATOMIC_RELEASE);
+        deferred_run(work, cpu_id, tasklet);
+        return;
+    }
+
+    cpu = &deferred_cpus[cpu_id];
+
+    err = kernel_queue_push(&work->node,
+                            tasklet == 1 ? &cpu->tasklets : &cpu->works);
+    if(err != OS_NO_ERR)
+    {
+        kernel_error("Could not queue deferred work[%d]\n", err);
+        kernel_panic(err);
+    }
+
+    __atomic_fetch_add(&cpu->event, 1, __ATOMIC_SEQ_CST);
+
+    /* Only the first request wakes the worker */
+    if(__atomic_exchange_n(&cpu->waiting, 0, __ATOMIC_SEQ_CST) != 0)
+    {
+        futex_wake(&cpu->event, 1, NULL);
+    }
+}
+
+/**
+ * @brief Runs the next pending item of a CPU.
+ *
+ * @param[in, out] cpu The CPU deferred work context.
+ *
+ * @return 1 if an item was dequeued, 0 if the queues are empty.
+ */
+static uint32_t deferred_process_one(deferred_cpu_t* cpu)
+{
+    kernel_queue_node_t* node;
+    deferred_work_t*     work;
+    uint64_t             cycles;
+    uint32_t             int_state;
+    uint32_t             tasklet;
+    OS_RETURN_E          err;
+
+    /* The tasklets are run first */
+    tasklet = 1;
+    node    = kernel_queue_pop(&cpu->tasklets, &err);
+    if(node == NULL && err == OS_NO_ERR)
+    {
+        tasklet = 0;
+        node    = kernel_queue_pop(&cpu->works, &err);
+    }
+    if(err != OS_NO_ERR)
+    {
+        kernel_error("Could not dequeue deferred work[%d]\n", err);
+        kernel_panic(err);
+    }
+    if(node == NULL)
+    {
+        return 0;
+    }
+
+    /* Queue requests made from now on run the routine again */
+    work = node->data;
+    __atomic_fetch_and(&work->state, ~DEFERRED_STATE_PENDING,
+                       __ATOMIC_ACQ_REL);
+
+    cycles = deferred_run(work, (uint32_t)(cpu - deferred_cpus), tasklet);
+    if(cycles == 0)
+    {
+        /* The item runs on an other CPU, that CPU queues it again */
+        return 1;
+    }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &cpu->lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    if(tasklet == 1)
+    {
+        ++cpu->stats.tasklets;
+        cpu->stats.tasklet_cycles += cycles;
+        if(cycles > cpu->stats.tasklet_max_cycles)
+        {
+            cpu->stats.tasklet_max_cycles = cycles;
+        }
+    }
+    else
+    {
+        ++cpu->stats.works;
+        cpu->stats.work_cycles += cycles;
+        if(cycles > cpu->stats.work_max_cycles)
+        {
+            cpu->stats.work_max_cycles = cycles;
+        }
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &cpu->lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return 1;
+}
+
+/**
+ * @brief Deferred work thread routine.
+ *
+ * @param[in] args The CPU ID of the worker.
+ *
+ * @return NULL always, the thread never returns.
+ */
+static void* deferred_worker(void* args)
+{
+    deferred_cpu_t* cpu;
+    int32_t         event;
+
+    cpu = &deferred_cpus[(uint32_t)args];
+
+    while(1)
+    {
+        event = __atomic_load_n(&cpu->event, __ATOMIC_SEQ_CST);
+
+        while(deferred_process_one(cpu) == 1);
+
+        /* Sleep until the next queue request */
+        __atomic_store_n(&cpu->waiting, 1, __ATOMIC_SEQ_CST);
+        if(__atomic_load_n(&cpu->event, __ATOMIC_SEQ_CST) == event)
+        {
+            futex_wait(&cpu->event, event);
+        }
+        __atomic_store_n(&cpu->waiting, 0, __ATOMIC_SEQ_CST);
+    }
+
+    return NULL;
+}
+
+OS_RETURN_E deferred_init(void)
+{
+    OS_RETURN_E err;
+    uint32_t    i;
+
+    for(i = 0; i < MAX_CPU_COUNT; ++i)
+    {
+        memset(&deferred_cpus[i], 0, sizeof(deferred_cpu_t));
+#if MAX_CPU_COUNT > 1
+        INIT_SPINLOCK(&deferred_cpus[i].lock);
+#endif
+        err = kernel_queue_init_queue(&deferred_cpus[i].tasklets);
+        if(err != OS_NO_ERR)
+        {
+            return err;
+        }
+        err = kernel_queue_init_queue(&deferred_cpus[i].works);
+        if(err != OS_NO_ERR)
+        {
+            return err;
+        }
+    }
+
+    for(i = 0; i < MAX_CPU_COUNT; ++i)
+    {
+        err = sched_create_kernel_thread(NULL, DEFERRED_THREAD_PRIORITY,
+                                         "deferred",
+                                         DEFERRED_THREAD_STACK_SIZE,
+                                         i, deferred_worker, (void*)i);
+        if(err != OS_NO_ERR)
+        {
+            return err;
+        }
+    }
+
+    deferred_started = 1;
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E deferred_work_init(deferred_work_t* work,
+                               void (*routine)(void*),
+                               void* args)
+{
+    if(work == NULL || routine == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    memset(work, 0, sizeof(deferred_work_t));
+    work->routine = routine;
+    work->args    = args;
+
+    return kernel_queue_init_node(&work->node, work);
+}
+
+OS_RETURN_E deferred_tasklet_schedule(deferred_work_t* tasklet)
+{
+    if(tasklet == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    deferred_queue(tasklet, deferred_get_cpu(), 1);
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E deferred_work_queue(deferred_work_t* work)
+{
+    if(work == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    deferred_queue(work, deferred_get_cpu(), 0);
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E deferred_work_queue_on(deferred_work_t* work,
+                                   const uint32_t cpu_id)
+{
+    if(work == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    if(cpu_id >= MAX_CPU_COUNT || cpu_id >= cpu_get_booted_cpu_count())
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    deferred_queue(work, cpu_id, 0);
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E deferred_get_stats(const uint32_t cpu_id, deferred_stats_t* stats)
+{
+    deferred_cpu_t* cpu;
+    uint32_t        int_state;
+
+    if(stats == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    if(cpu_id >= MAX_CPU_COUNT)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    cpu = &deferred_cpus[cpu_id];
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &cpu->lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    *stats = cpu->stats;
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &cpu->lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return OS_NO_ERR;
+}
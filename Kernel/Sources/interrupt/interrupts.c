@@ -21,6 +21,7 @@
 #include <lib/stdint.h>         /* Generic int types */
 #include <lib/stddef.h>         /* Standard definitions */
 #include <lib/string.h>         /* String manipulation */
+#include <lib/stdlib.h>         /* uitoa */
 #include <cpu_settings.h>       /* CPU settings */
 #include <cpu_structs.h>        /* CPU structures */
 #include <cpu.h>                /* CPU management */
@@ -28,6 +29,8 @@
 #include <core/panic.h>         /* Kernel panic */
 #include <io/kernel_output.h>   /* Kernel output methods */
 #include <sync/critical.h>      /* Critical sections */
+#include <core/trace.h>         /* Trace events */
+#include <serial.h>             /* Serial driver */
 
 /* UTK configuration file */
 #include <config.h>
@@ -40,6 +43,50 @@
 /* Header file */
 #include <interrupt/interrupts.h>
 
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+#if INTERRUPT_STATS_ENABLED == 1
+/** @brief Handler statistics of an interrupt line on a CPU. */
+struct interrupt_line_stats
+{
+    /** @brief Number of times the handler was called. */
+    uint64_t count;
+    /** @brief CPU cycles spent in the handler. */
+    uint64_t total_cycles;
+    /** @brief Longest handler run in CPU cycles. */
+    uint64_t max_cycles;
+};
+
+/**
+ * @brief Defines interrupt_line_stats_t type as a shorcut for struct
+ * interrupt_line_stats.
+ */
+typedef struct interrupt_line_stats interrupt_line_stats_t;
+#endif
+
+#if INTERRUPT_LATENCY_ENABLED == 1
+/** @brief Interrupts disabled window of a CPU. */
+struct interrupt_window
+{
+    /** @brief Time stamp of the kernel_interrupt_disable call. */
+    uint64_t  start;
+    /** @brief Return address of the kernel_interrupt_disable call. */
+    uintptr_t site;
+    /** @brief Set while the interrupts are disabled by the window. */
+    uint32_t  open;
+    /** @brief Longest window measured on the CPU. */
+    interrupt_latency_t worst;
+};
+
+/**
+ * @brief Defines interrupt_window_t type as a shorcut for struct
+ * interrupt_window.
+ */
+typedef struct interrupt_window interrupt_window_t;
+#endif
+
 /*******************************************************************************
  * GLOBAL VARIABLES
  ******************************************************************************/
@@ -60,6 +107,20 @@ static uint32_t spurious_interrupt;
 static spinlock_t lock  = SPINLOCK_INIT_VALUE;
 #endif
 
+#if INTERRUPT_STATS_ENABLED == 1
+/** @brief Per CPU handlers statistics, only written by their CPU with the
+ * interrupts disabled.
+ */
+static interrupt_line_stats_t interrupt_stats[MAX_CPU_COUNT][INT_ENTRY_COUNT];
+#endif
+
+#if INTERRUPT_LATENCY_ENABLED == 1
+/** @brief Per CPU interrupts disabled windows, only written by their CPU with
+ * the interrupts disabled.
+ */
+static interrupt_window_t interrupt_windows[MAX_CPU_COUNT];
+#endif
+
 
 /*******************************************************************************
  * FUNCTIONS
@@ -90,6 +151,57 @@ static int32_t init_driver_get_irq_int_line(const uint32_t irq_number)
     return 0;
 }
 
+/**
+ * @brief Returns the ID of the current CPU, 0 if it is not known.
+ *
+ * @return The ID of the current CPU.
+ */
+static inline uint32_t interrupt_get_cpu(void)
+{
+    int32_t cpu_id;
+
+    cpu_id = cpu_get_id();
+    if(cpu_id < 0 || cpu_id >= MAX_CPU_COUNT)
+    {
+        cpu_id = 0;
+    }
+
+    return (uint32_t)cpu_id;
+}
+
+#if INTERRUPT_LATENCY_ENABLED == 1
+/**
+ * @brief Closes the interrupts disabled window of the current CPU. Must be
+ * called with the interrupts disabled.
+ *
+ * @param[in] site The return address of the kernel_interrupt_restore call, 0
+ * when the window is closed by an interrupt.
+ */
+static void interrupt_close_window(const uintptr_t site)
+{
+    interrupt_window_t* window;
+    uint64_t            cycles;
+    uint32_t            cpu_id;
+
+    cpu_id = interrupt_get_cpu();
+    window = &interrupt_windows[cpu_id];
+    if(window->open == 0)
+    {
+        return;
+    }
+
+    window->open = 0;
+    cycles = cpu_rdtsc() - window->start;
+    if(cycles > window->worst.max_cycles)
+    {
+        window->worst.max_cycles   = cycles;
+        window->worst.disable_site = window->site;
+        window->worst.restore_site = site;
+        window->worst.cpu_id       = cpu_id;
+    }
+}
+#endif
+
 /**
  * @brief Kernel's spurious interrupt handler.
  *
@@ -125,6 +237,19 @@ void kernel_interrupt_handler(cpu_state_t cpu_state,
                               stack_state_t stack_state)
 {
     void(*handler)(cpu_state_t*, uintptr_t, stack_state_t*);
+#if INTERRUPT_STATS_ENABLED == 1
+    interrupt_line_stats_t* stats;
+    uint64_t                start;
+    uint64_t                cycles;
+    uint32_t                cpu_id;
+#endif
+
+#if INTERRUPT_LATENCY_ENABLED == 1
+    /* Software interrupts raised in a critical section, the scheduler may not
+     * return to the window.
+     */
+    interrupt_close_window(0);
+#endif
 
     /* If interrupts are disabled */
     if(cpu_get_saved_interrupt_state(&cpu_state, &stack_state) == 0 &&
@@ -146,38 +271,52 @@ void kernel_interrupt_handler(cpu_state_t cpu_state,
         panic(&cpu_state, int_id, &stack_state);
     }
 
-#if INTERRUPT_KERNEL_DEBUG == 1
-        kernel_serial_debug("Interrupt %d\n",
-                            int_id);
-#endif
-
     /* Check for spurious interrupt */
     if(interrupt_driver.driver_handle_spurious(int_id) ==
         INTERRUPT_TYPE_SPURIOUS)
     {
+        TRACE(TRACE_INTERRUPT_SPURIOUS, int_id, 0, 0, 0);
         spurious_handler();
         return;
     }
 
-#if INTERRUPT_KERNEL_DEBUG == 1
-    kernel_serial_debug("Non spurious %d\n",
-                        int_id);
-#endif
-
-    /* Select custom handlers */
+    /* Select custom handlers. The table is read without lock, the handler is
+     * only read once so a concurrent removal cannot make us call NULL.
+     */
+    handler = NULL;
     if(int_id < INT_ENTRY_COUNT &&
-       kernel_interrupt_handlers[int_id].enabled == 1 &&
-       kernel_interrupt_handlers[int_id].handler != NULL)
+       kernel_interrupt_handlers[int_id].enabled == 1)
     {
         handler = kernel_interrupt_handlers[int_id].handler;
     }
-    else
+    if(handler == NULL)
     {
         handler = panic;
     }
 
     /* Execute the handler */
+    TRACE(TRACE_INTERRUPT_ENTRY, int_id, 0, 0, 0);
+#if INTERRUPT_STATS_ENABLED == 1
+    start = cpu_rdtsc();
+#endif
     handler(&cpu_state, int_id, &stack_state);
+#if INTERRUPT_STATS_ENABLED == 1
+    cycles = cpu_rdtsc() - start;
+
+    /* The scheduler may have switched thread but not CPU */
+    if(int_id < INT_ENTRY_COUNT)
+    {
+        cpu_id = interrupt_get_cpu();
+        stats  = &interrupt_stats[cpu_id][int_id];
+        ++stats->count;
+        stats->total_cycles += cycles;
+        if(cycles > stats->max_cycles)
+        {
+            stats->max_cycles = cycles;
+        }
+    }
+#endif
+    TRACE(TRACE_INTERRUPT_EXIT, int_id, 0, 0, 0);
 }
 
 OS_RETURN_E kernel_interrupt_init(void)
@@ -389,12 +528,19 @@ void kernel_interrupt_restore(const uint32_t prev_state)
         kernel_serial_debug("--- Enabled HW INT ---\n");
 #endif
 
+#if INTERRUPT_LATENCY_ENABLED == 1
+        interrupt_close_window((uintptr_t)__builtin_return_address(0));
+#endif
+
         cpu_set_interrupt();
     }
 }
 
 uint32_t kernel_interrupt_disable(void)
 {
+#if INTERRUPT_LATENCY_ENABLED == 1
+    interrupt_window_t* window;
+#endif
     uint32_t old_state = kernel_interrupt_get_state();
 
     if(old_state == 0)
@@ -404,6 +550,13 @@ uint32_t kernel_interrupt_disable(void)
 
     cpu_clear_interrupt();
 
+#if INTERRUPT_LATENCY_ENABLED == 1
+    window        = &interrupt_windows[interrupt_get_cpu()];
+    window->site  = (uintptr_t)__builtin_return_address(0);
+    window->open  = 1;
+    window->start = cpu_rdtsc();
+#endif
+
 #if INTERRUPT_KERNEL_DEBUG == 1
     kernel_serial_debug("--- Disabled HW INT ---\n");
 #endif
@@ -434,4 +587,172 @@ OS_RETURN_E kernel_interrupt_set_irq_eoi(const uint32_t irq_number)
     return interrupt_driver.driver_set_irq_eoi(irq_number);
 }
 
+#if INTERRUPT_STATS_ENABLED == 1 || INTERRUPT_LATENCY_ENABLED == 1
+/**
+ * @brief Writes a space and the representation of a value.
+ *
+ * @param[out] buffer The buffer that receives the characters.
+ * @param[in] value The value to write.
+ * @param[in] base The base used to write the value.
+ *
+ * @return The buffer position following the characters.
+ */
+static char* interrupt_put_value(char* buffer, const uint64_t value,
+                                 const uint32_t base)
+{
+    *buffer++ = ' ';
+    uitoa(value, buffer, base);
 
+    return buffer + strlen(buffer);
+}
+#endif
+
+OS_RETURN_E kernel_interrupt_get_stats(const uint32_t interrupt_line,
+                                       interrupt_stats_t* stats)
+{
+#if INTERRUPT_STATS_ENABLED == 1
+    const interrupt_line_stats_t* cpu_stats;
+    uint32_t                      i;
+
+    if(stats == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    if(interrupt_line >= INT_ENTRY_COUNT)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    /* The counters of the other CPUs are read without lock */
+    memset(stats, 0, sizeof(interrupt_stats_t));
+    for(i = 0; i < MAX_CPU_COUNT; ++i)
+    {
+        cpu_stats = &interrupt_stats[i][interrupt_line];
+
+        stats->cpu_count[i]  = cpu_stats->count;
+        stats->count        += cpu_stats->count;
+        stats->total_cycles += cpu_stats->total_cycles;
+        if(cpu_stats->max_cycles > stats->max_cycles)
+        {
+            stats->max_cycles = cpu_stats->max_cycles;
+        }
+    }
+
+    return OS_NO_ERR;
+#else
+    (void)interrupt_line;
+    (void)stats;
+
+    return OS_ERR_NOT_SUPPORTED;
+#endif
+}
+
+OS_RETURN_E kernel_interrupt_get_latency(interrupt_latency_t* latency)
+{
+#if INTERRUPT_LATENCY_ENABLED == 1
+    uint32_t i;
+
+    if(latency == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    memset(latency, 0, sizeof(interrupt_latency_t));
+    for(i = 0; i < MAX_CPU_COUNT; ++i)
+    {
+        if(interrupt_windows[i].worst.max_cycles > latency->max_cycles)
+        {
+            *latency = interrupt_windows[i].worst;
+        }
+    }
+
+    return OS_NO_ERR;
+#else
+    (void)latency;
+
+    return OS_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void kernel_interrupt_reset_stats(void)
+{
+    uint32_t int_state;
+#if INTERRUPT_LATENCY_ENABLED == 1
+    uint32_t i;
+#endif
+
+    int_state = kernel_interrupt_disable();
+
+#if INTERRUPT_STATS_ENABLED == 1
+    memset(interrupt_stats, 0, sizeof(interrupt_stats));
+#endif
+#if INTERRUPT_LATENCY_ENABLED == 1
+    for(i = 0; i < MAX_CPU_COUNT; ++i)
+    {
+        memset(&interrupt_windows[i].worst, 0, sizeof(interrupt_latency_t));
+    }
+#endif
+
+    kernel_interrupt_restore(int_state);
+}
+
+void kernel_interrupt_dump_stats(void)
+{
+#if INTERRUPT_STATS_ENABLED == 1 || INTERRUPT_LATENCY_ENABLED == 1
+    /* Line tag, up to 4 + MAX_CPU_COUNT values of a space and 20 digits, line
+     * feed and terminator.
+     */
+    char                line[15 + (4 + MAX_CPU_COUNT) * 21 + 2];
+    char*               pos;
+#endif
+#if INTERRUPT_STATS_ENABLED == 1
+    interrupt_stats_t   stats;
+    uint32_t            i;
+    uint32_t            j;
+#endif
+#if INTERRUPT_LATENCY_ENABLED == 1
+    interrupt_latency_t latency;
+#endif
+
+    serial_put_string("#INTSTAT BEGIN\n");
+
+#if INTERRUPT_STATS_ENABLED == 1
+    /* #INTSTAT <line> <count> <total> <max> <CPU 0 count> ... */
+    for(i = 0; i < INT_ENTRY_COUNT; ++i)
+    {
+        kernel_interrupt_get_stats(i, &stats);
+        if(stats.count == 0)
+        {
+            continue;
+        }
+
+        memcpy(line, "#INTSTAT", 8);
+        pos = interrupt_put_value(line + 8, i, 10);
+        pos = interrupt_put_value(pos, stats.count, 10);
+        pos = interrupt_put_value(pos, stats.total_cycles, 10);
+        pos = interrupt_put_value(pos, stats.max_cycles, 10);
+        for(j = 0; j < MAX_CPU_COUNT; ++j)
+        {
+            pos = interrupt_put_value(pos, stats.cpu_count[j], 10);
+        }
+        *pos++ = '\n';
+        *pos   = 0;
+        serial_put_string(line);
+    }
+#endif
+
+#if INTERRUPT_LATENCY_ENABLED == 1
+    /* #INTSTAT IRQOFF <max> <CPU> <disable site> <restore site> */
+    kernel_interrupt_get_latency(&latency);
+    memcpy(line, "#INTSTAT IRQOFF", 15);
+    pos = interrupt_put_value(line + 15, latency.max_cycles, 10);
+    pos = interrupt_put_value(pos, latency.cpu_id, 10);
+    pos = interrupt_put_value(pos, latency.disable_site, 16);
+    pos = interrupt_put_value(pos, latency.restore_site, 16);
+    *pos++ = '\n';
+    *pos   = 0;
+    serial_put_string(line);
+#endif
+
+    serial_put_string("#INTSTAT END\n");
+}
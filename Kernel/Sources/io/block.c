@@ -0,0 +1,623 @@
+/*******************************************************************************
+ * @file block.c
+ *
+ * @see block.h
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Block devices abstraction and buffer cache.
+ *
+ * @details Block devices abstraction layer. A block device wraps a storage
+ * driver and exposes ranges of page sized blocks. The accesses go through a
+ * LRU buffer cache shared by all the devices and keyed by (device, block).
+ * Writes are kept in the cache until the device is flushed or the buffer is
+ * evicted. Sequential reads are detected and trigger read-ahead.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#include <lib/stdint.h>        /* Generic int types */
+#include <lib/stddef.h>        /* Standard definitions */
+#include <lib/string.h>        /* String manipulation */
+#include <memory/kheap.h>      /* Kernel heap */
+#include <io/kernel_output.h>  /* Kernel output methods */
+#include <core/kernel_queue.h> /* Kernel queues */
+#include <sync/mutex.h>        /* Mutex */
+
+/* UTK configuration file */
+#include <config.h>
+
+/* Header file */
+#include <io/block.h>
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************/
+
+/** @brief Cache buffers. */
+static block_buffer_t* buffers = NULL;
+/** @brief Buffers that hold no block. */
+static block_buffer_t* free_buffers = NULL;
+/** @brief Hash table of the cached blocks. */
+static block_buffer_t* hash_table[1 << BLOCK_CACHE_HASH_BITS];
+/** @brief Cached blocks, most recently used first. */
+static kernel_queue_t lru;
+/** @brief Staging area used to move runs of blocks with a single command. */
+static uint8_t* staging = NULL;
+/** @brief Cache lock, the driver calls are done with the lock held. */
+static mutex_t cache_lock;
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Returns the hash table bucket of a block.
+ *
+ * @param[in] device The block device.
+ * @param[in] block The block.
+ *
+ * @return The bucket index.
+ */
+__inline__ static uint32_t block_hash(const block_device_t* device,
+                                      const uint32_t block)
+{
+    return (((uint32_t)(uintptr_t)device ^ block) * 0x9E3779B1) >>
+           (32 - BLOCK_CACHE_HASH_BITS);
+}
+
+/**
+ * @brief Looks up a cached block.
+ *
+ * @param[in] device The block device.
+ * @param[in] block The block.
+ *
+ * @return The buffer holding the block, NULL if the block is not cached.
+ */
+static block_buffer_t* block_lookup(const block_device_t* device,
+                                    const uint32_t block)
+{
+    block_buffer_t* buffer;
+
+    buffer = hash_table[block_hash(device, block)];
+    while(buffer != NULL)
+    {
+        if(buffer->device == device && buffer->block == block)
+        {
+            return buffer;
+        }
+        buffer = buffer->next;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Removes a buffer from the hash table.
+ *
+ * @param[in] buffer The buffer to remove.
+ */
+static void block_unhash(block_buffer_t* buffer)
+{
+    block_buffer_t** cursor;
+
+    cursor = &hash_table[block_hash(buffer->device, buffer->block)];
+    while(*cursor != NULL)
+    {
+        if(*cursor == buffer)
+        {
+            *cursor = buffer->next;
+            break;
+        }
+        cursor = &(*cursor)->next;
+    }
+    buffer->next = NULL;
+}
+
+/**
+ * @brief Binds a buffer to a block and makes it the most recently used one.
+ *
+ * @param[in, out] buffer The buffer, it must not be in the LRU list.
+ * @param[in] device The block device.
+ * @param[in] block The block.
+ */
+static void block_bind(block_buffer_t* buffer, block_device_t* device,
+                       const uint32_t block)
+{
+    uint32_t index;
+
+    buffer->device = device;
+    buffer->block  = block;
+    buffer->dirty  = 0;
+
+    index             = block_hash(device, block);
+    buffer->next      = hash_table[index];
+    hash_table[index] = buffer;
+
+    kernel_queue_push(&buffer->lru_node, &lru);
+}
+
+/**
+ * @brief Makes a cached buffer the most recently used one.
+ *
+ * @param[in, out] buffer The buffer to touch.
+ */
+static void block_touch(block_buffer_t* buffer)
+{
+    kernel_queue_remove(&lru, &buffer->lru_node);
+    kernel_queue_push(&buffer->lru_node, &lru);
+}
+
+/**
+ * @brief Writes a dirty buffer to its device.
+ *
+ * @param[in, out] buffer The buffer to write.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E block_writeback(block_buffer_t* buffer)
+{
+    block_device_t* device;
+    OS_RETURN_E     err;
+
+    device = buffer->device;
+    err = device->driver->write(device->device,
+                                buffer->block * device->sectors_per_block,
+                                buffer->data, device->sectors_per_block);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    buffer->dirty = 0;
+    ++device->stats.writebacks;
+    ++device->stats.device_writes;
+
+    return OS_NO_ERR;
+}
+
+/**
+ * @brief Gets a buffer to cache a new block.
+ *
+ * @details Returns a free buffer or evicts the least recently used block. A
+ * dirty block is written to its device before its buffer is reused. The
+ * returned buffer is not in the LRU list.
+ *
+ * @param[out] err The error return pointer.
+ *
+ * @return The buffer, NULL on error.
+ */
+static block_buffer_t* block_get_buffer(OS_RETURN_E* err)
+{
+    block_buffer_t*      buffer;
+    kernel_queue_node_t* node;
+
+    *err = OS_NO_ERR;
+
+    if(free_buffers != NULL)
+    {
+        buffer       = free_buffers;
+        free_buffers = buffer->next;
+        buffer->next = NULL;
+        return buffer;
+    }
+
+    node = kernel_queue_pop(&lru, err);
+    if(node == NULL || *err != OS_NO_ERR)
+    {
+        return NULL;
+    }
+    buffer = node->data;
+
+    if(buffer->dirty == 1)
+    {
+        *err = block_writeback(buffer);
+        if(*err != OS_NO_ERR)
+        {
+            kernel_queue_push(&buffer->lru_node, &lru);
+            return NULL;
+        }
+    }
+
+    block_unhash(buffer);
+    buffer->device = NULL;
+
+    return buffer;
+}
+
+OS_RETURN_E block_cache_init(void)
+{
+    OS_RETURN_E err;
+    uint8_t*    data;
+    uint32_t    i;
+
+    buffers = kmalloc(sizeof(block_buffer_t) * BLOCK_CACHE_SIZE);
+    data    = kmalloc(BLOCK_SIZE * BLOCK_CACHE_SIZE);
+    staging = kmalloc(BLOCK_SIZE * BLOCK_READ_AHEAD_MAX);
+    if(buffers == NULL || data == NULL || staging == NULL)
+    {
+        return OS_ERR_MALLOC;
+    }
+
+    memset(hash_table, 0, sizeof(hash_table));
+    err = kernel_queue_init_queue(&lru);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    free_buffers = NULL;
+    for(i = 0; i < BLOCK_CACHE_SIZE; ++i)
+    {
+        buffers[i].device = NULL;
+        buffers[i].block  = 0;
+        buffers[i].dirty  = 0;
+        buffers[i].data   = data + i * BLOCK_SIZE;
+        buffers[i].next   = free_buffers;
+        free_buffers      = &buffers[i];
+
+        err = kernel_queue_init_node(&buffers[i].lru_node, &buffers[i]);
+        if(err != OS_NO_ERR)
+        {
+            return err;
+        }
+    }
+
+    return mutex_init(&cache_lock, MUTEX_FLAG_NONE,
+                      MUTEX_PRIORITY_ELEVATION_NONE);
+}
+
+OS_RETURN_E block_device_init(block_device_t* device, void* driver_device,
+                              const block_driver_t* driver,
+                              const uint32_t sector_size,
+                              const uint32_t sector_count)
+{
+    if(device == NULL || driver == NULL ||
+       driver->read == NULL || driver->write == NULL || driver->flush == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    if(sector_size == 0 || sector_size > BLOCK_SIZE ||
+       BLOCK_SIZE % sector_size != 0)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    memset(device, 0, sizeof(block_device_t));
+    device->device            = driver_device;
+    device->driver            = driver;
+    device->sectors_per_block = BLOCK_SIZE / sector_size;
+    device->block_count       = sector_count / device->sectors_per_block;
+    device->ra_next           = BLOCK_NO_BLOCK;
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E block_read(block_device_t* device, const uint32_t block,
+                       void* buffer, const uint32_t count)
+{
+    block_buffer_t* cached;
+    uint8_t*        out;
+    uint32_t        i;
+    uint32_t        j;
+    uint32_t        run;
+    uint32_t        ahead;
+    OS_RETURN_E     err;
+
+    if(device == NULL || buffer == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    if(block >= device->block_count || count > device->block_count - block)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    err = mutex_pend(&cache_lock);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    /* Sequential accesses grow the read-ahead window */
+    if(block == device->ra_next)
+    {
+        device->ra_window = (device->ra_window == 0) ?
+                            BLOCK_READ_AHEAD_MIN : device->ra_window * 2;
+        if(device->ra_window > BLOCK_READ_AHEAD_MAX)
+        {
+            device->ra_window = BLOCK_READ_AHEAD_MAX;
+        }
+    }
+    else
+    {
+        device->ra_window = 0;
+    }
+    device->ra_next = block + count;
+
+    out = buffer;
+    i   = 0;
+    while(i < count && err == OS_NO_ERR)
+    {
+        cached = block_lookup(device, block + i);
+        if(cached != NULL)
+        {
+            memcpy(out + i * BLOCK_SIZE, cached->data, BLOCK_SIZE);
+            block_touch(cached);
+            ++device->stats.hits;
+            ++i;
+            continue;
+        }
+
+        /* Gather the run of missing blocks */
+        run = 1;
+        while(i + run < count && run < BLOCK_READ_AHEAD_MAX &&
+              block_lookup(device, block + i + run) == NULL)
+        {
+            ++run;
+        }
+
+        /* The last run of the request is extended by the read-ahead window */
+        ahead = 0;
+        if(i + run == count)
+        {
+            while(ahead < device->ra_window &&
+                  run + ahead < BLOCK_READ_AHEAD_MAX &&
+                  block + count + ahead < device->block_count &&
+                  block_lookup(device, block + count + ahead) == NULL)
+            {
+                ++ahead;
+            }
+        }
+
+        err = device->driver->read(device->device,
+                                   (block + i) * device->sectors_per_block,
+                                   staging,
+                                   (run + ahead) * device->sectors_per_block);
+        if(err != OS_NO_ERR)
+        {
+            break;
+        }
+        ++device->stats.device_reads;
+        device->stats.misses     += run;
+        device->stats.read_ahead += ahead;
+
+        for(j = 0; j < run + ahead; ++j)
+        {
+            cached = block_get_buffer(&err);
+            if(cached == NULL)
+            {
+                break;
+            }
+            memcpy(cached->data, staging + j * BLOCK_SIZE, BLOCK_SIZE);
+            block_bind(cached, device, block + i + j);
+
+            if(j < run)
+            {
+                memcpy(out + (i + j) * BLOCK_SIZE, staging + j * BLOCK_SIZE,
+                       BLOCK_SIZE);
+            }
+        }
+
+        i += run;
+    }
+
+    mutex_post(&cache_lock);
+
+    return err;
+}
+
+OS_RETURN_E block_write(block_device_t* device, const uint32_t block,
+                        const void* buffer, const uint32_t count)
+{
+    block_buffer_t* cached;
+    const uint8_t*  in;
+    uint32_t        i;
+    OS_RETURN_E     err;
+
+    if(device == NULL || buffer == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    if(block >= device->block_count || count > device->block_count - block)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    err = mutex_pend(&cache_lock);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    in = buffer;
+    for(i = 0; i < count; ++i)
+    {
+        cached = block_lookup(device, block + i);
+        if(cached != NULL)
+        {
+            block_touch(cached);
+        }
+        else
+        {
+            /* The whole block is overwritten, no need to read it */
+            cached = block_get_buffer(&err);
+            if(cached == NULL)
+            {
+                break;
+            }
+            block_bind(cached, device, block + i);
+        }
+
+        memcpy(cached->data, in + i * BLOCK_SIZE, BLOCK_SIZE);
+        cached->dirty = 1;
+    }
+
+    mutex_post(&cache_lock);
+
+    return err;
+}
+
+/**
+ * @brief Writes the dirty blocks of a device.
+ *
+ * @details Writes the dirty blocks of a device in ascending order, runs of
+ * adjacent dirty blocks are written with a single driver command. The cache
+ * lock must be held by the caller.
+ *
+ * @param[in, out] device The block device.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E block_write_dirty(block_device_t* device)
+{
+    block_buffer_t* first;
+    block_buffer_t* cached;
+    uint32_t        run;
+    uint32_t        i;
+    OS_RETURN_E     err;
+
+    while(1)
+    {
+        /* Lowest dirty block of the device */
+        first = NULL;
+        for(i = 0; i < BLOCK_CACHE_SIZE; ++i)
+        {
+            if(buffers[i].device == device && buffers[i].dirty == 1 &&
+               (first == NULL || buffers[i].block < first->block))
+            {
+                first = &buffers[i];
+            }
+        }
+        if(first == NULL)
+        {
+            return OS_NO_ERR;
+        }
+
+        /* Coalesce the following dirty blocks */
+        memcpy(staging, first->data, BLOCK_SIZE);
+        run = 1;
+        while(run < BLOCK_READ_AHEAD_MAX)
+        {
+            cached = block_lookup(device, first->block + run);
+            if(cached == NULL || cached->dirty == 0)
+            {
+                break;
+            }
+            memcpy(staging + run * BLOCK_SIZE, cached->data, BLOCK_SIZE);
+            ++run;
+        }
+
+        err = device->driver->write(device->device,
+                                    first->block * device->sectors_per_block,
+                                    staging, run * device->sectors_per_block);
+        if(err != OS_NO_ERR)
+        {
+            return err;
+        }
+        ++device->stats.device_writes;
+        device->stats.writebacks += run;
+
+        for(i = 0; i < run; ++i)
+        {
+            block_lookup(device, first->block + i)->dirty = 0;
+        }
+    }
+}
+
+OS_RETURN_E block_flush(block_device_t* device)
+{
+    OS_RETURN_E err;
+
+    if(device == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    err = mutex_pend(&cache_lock);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    err = block_write_dirty(device);
+    if(err == OS_NO_ERR)
+    {
+        err = device->driver->flush(device->device);
+    }
+
+    mutex_post(&cache_lock);
+
+    return err;
+}
+
+OS_RETURN_E block_invalidate(block_device_t* device)
+{
+    OS_RETURN_E err;
+    uint32_t    i;
+
+    if(device == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    err = mutex_pend(&cache_lock);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    err = block_write_dirty(device);
+    if(err == OS_NO_ERR)
+    {
+        err = device->driver->flush(device->device);
+    }
+
+    if(err == OS_NO_ERR)
+    {
+        for(i = 0; i < BLOCK_CACHE_SIZE; ++i)
+        {
+            if(buffers[i].device == device)
+            {
+                kernel_queue_remove(&lru, &buffers[i].lru_node);
+                block_unhash(&buffers[i]);
+                buffers[i].device = NULL;
+                buffers[i].next   = free_buffers;
+                free_buffers      = &buffers[i];
+            }
+        }
+        device->ra_next   = BLOCK_NO_BLOCK;
+        device->ra_window = 0;
+    }
+
+    mutex_post(&cache_lock);
+
+    return err;
+}
+
+OS_RETURN_E block_get_stats(block_device_t* device, block_stats_t* stats)
+{
+    OS_RETURN_E err;
+
+    if(device == NULL || stats == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    err = mutex_pend(&cache_lock);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    *stats = device->stats;
+
+    mutex_post(&cache_lock);
+
+    return OS_NO_ERR;
+}
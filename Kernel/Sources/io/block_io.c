@@ -0,0 +1,532 @@
+/*******************************************************************************
+ * @file block_io.c
+ *
+ * @see block_io.h
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Asynchronous block I/O request queues.
+ *
+ * @details Asynchronous block I/O request queues. Requests are submitted to the
+ * queue of a storage device and processed by the queue's worker thread. The
+ * worker serves the pending requests in ascending sector order (C-LOOK
+ * elevator) and merges the adjacent requests of the same direction into a
+ * single driver command. A request that waited more than BLOCK_IO_DEADLINE
+ * milliseconds is served first to avoid starvation.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#include <lib/stdint.h>            /* Generic int types */
+#include <lib/stddef.h>            /* Standard definitions */
+#include <lib/string.h>            /* String manipulation */
+#include <memory/kheap.h>          /* Kernel heap */
+#include <io/kernel_output.h>      /* Kernel output methods */
+#include <core/panic.h>            /* Kernel panic */
+#include <core/scheduler.h>        /* Kernel scheduler */
+#include <core/kernel_queue.h>     /* Kernel queues */
+#include <time/time_management.h>  /* Uptime */
+#include <sync/mutex.h>            /* Mutex */
+#include <sync/semaphore.h>        /* Semaphores */
+#include <sync/futex.h>            /* Futex */
+
+/* UTK configuration file */
+#include <config.h>
+
+/* Header file */
+#include <io/block_io.h>
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Selects the first request of the next driver command.
+ *
+ * @details Returns the oldest request if its deadline expired. Otherwise
+ * returns the request with the lowest sector following the queue head, or the
+ * request with the lowest sector if none follows the head. The queue lock must
+ * be held and the queue must not be empty.
+ *
+ * @param[in, out] queue The queue.
+ *
+ * @return The first request of the next driver command.
+ */
+static kernel_queue_node_t* block_io_select(block_io_queue_t* queue)
+{
+    kernel_queue_node_t* cursor;
+    block_io_request_t*  oldest;
+
+    oldest = queue->fifo.tail->data;
+    if(oldest->deadline <= time_get_current_uptime())
+    {
+        ++queue->stats.expired;
+        return &oldest->sort_node;
+    }
+
+    /* The sorted list is walked from the tail, the lowest sector */
+    cursor = queue->sorted.tail;
+    while(cursor != NULL &&
+          ((block_io_request_t*)cursor->data)->sector < queue->head)
+    {
+        cursor = cursor->prev;
+    }
+
+    return (cursor != NULL) ? cursor : queue->sorted.tail;
+}
+
+/**
+ * @brief Removes a request from the queue pending lists.
+ *
+ * @param[in, out] queue The queue.
+ * @param[in, out] request The request to remove.
+ */
+static void block_io_dequeue(block_io_queue_t* queue,
+                             block_io_request_t* request)
+{
+    OS_RETURN_E err;
+
+    err = kernel_queue_remove(&queue->sorted, &request->sort_node);
+    if(err == OS_NO_ERR)
+    {
+        err = kernel_queue_remove(&queue->fifo, &request->fifo_node);
+    }
+    if(err != OS_NO_ERR)
+    {
+        kernel_error("Could not dequeue block I/O request[%d]\n", err);
+        kernel_panic(err);
+    }
+}
+
+/**
+ * @brief Removes the next batch of requests from the queue.
+ *
+ * @details Selects the first request with block_io_select then merges the
+ * following requests while they are adjacent, of the same direction and fit in
+ * the staging buffer. The queue lock must be held and the queue must not be
+ * empty.
+ *
+ * @param[in, out] queue The queue.
+ * @param[out] sectors The total number of sectors of the batch.
+ *
+ * @return The first request of the batch, the requests are linked by their
+ * merge_next field.
+ */
+static block_io_request_t* block_io_get_batch(block_io_queue_t* queue,
+                                              uint32_t* sectors)
+{
+    kernel_queue_node_t* cursor;
+    block_io_request_t*  first;
+    block_io_request_t*  last;
+    block_io_request_t*  next;
+
+    cursor = block_io_select(queue);
+    first  = cursor->data;
+    last   = first;
+    *sectors = first->count;
+
+    /* Merge the adjacent requests that follow in sector order */
+    cursor = cursor->prev;
+    while(cursor != NULL)
+    {
+        next = cursor->data;
+        if(next->write != first->write ||
+           next->sector != last->sector + last->count ||
+           *sectors + next->count > queue->staging_sectors)
+        {
+            break;
+        }
+
+        cursor           = cursor->prev;
+        last->merge_next = next;
+        last             = next;
+        *sectors        += next->count;
+        ++queue->stats.merged;
+    }
+    last->merge_next = NULL;
+
+    for(next = first; next != NULL; next = next->merge_next)
+    {
+        block_io_dequeue(queue, next);
+    }
+
+    queue->head = first->sector + *sectors;
+    ++queue->stats.dispatched;
+
+    return first;
+}
+
+/**
+ * @brief Issues the driver command of a batch of requests.
+ *
+ * @param[in, out] queue The queue.
+ * @param[in] batch The first request of the batch.
+ * @param[in] sectors The total number of sectors of the batch.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E block_io_dispatch(block_io_queue_t* queue,
+                                     block_io_request_t* batch,
+                                     const uint32_t sectors)
+{
+    block_io_request_t* request;
+    uint8_t*            cursor;
+    OS_RETURN_E         err;
+
+    /* Single requests are moved without the staging buffer */
+    if(batch->merge_next == NULL)
+    {
+        if(batch->write == 1)
+        {
+            return queue->driver->write(queue->device, batch->sector,
+                                        batch->buffer, batch->count);
+        }
+        return queue->driver->read(queue->device, batch->sector,
+                                   batch->buffer, batch->count);
+    }
+
+    if(batch->write == 1)
+    {
+        cursor = queue->staging;
+        for(request = batch; request != NULL; request = request->merge_next)
+        {
+            memcpy(cursor, request->buffer,
+                   request->count * queue->sector_size);
+            cursor += request->count * queue->sector_size;
+        }
+        return queue->driver->write(queue->device, batch->sector,
+                                    queue->staging, sectors);
+    }
+
+    err = queue->driver->read(queue->device, batch->sector,
+                              queue->staging, sectors);
+    if(err == OS_NO_ERR)
+    {
+        cursor = queue->staging;
+        for(request = batch; request != NULL; request = request->merge_next)
+        {
+            memcpy(request->buffer, cursor,
+                   request->count * queue->sector_size);
+            cursor += request->count * queue->sector_size;
+        }
+    }
+
+    return err;
+}
+
+/**
+ * @brief Request queue worker thread routine.
+ *
+ * @param[in] args The request queue.
+ *
+ * @return NULL, the routine never returns.
+ */
+static void* block_io_worker(void* args)
+{
+    block_io_queue_t*   queue;
+    block_io_request_t* batch;
+    block_io_request_t* next;
+    semaphore_t*        done;
+    uint32_t            sectors;
+    OS_RETURN_E         err;
+
+    queue = args;
+
+    while(1)
+    {
+        err = sem_pend(&queue->pending);
+        if(err != OS_NO_ERR)
+        {
+            kernel_error("Block I/O worker could not wait requests[%d]\n", err);
+            kernel_panic(err);
+        }
+
+        err = mutex_pend(&queue->lock);
+        if(err != OS_NO_ERR)
+        {
+            kernel_error("Block I/O worker could not lock queue[%d]\n", err);
+            kernel_panic(err);
+        }
+
+        /* Merged requests were served with a previous batch */
+        if(queue->sorted.size == 0)
+        {
+            mutex_post(&queue->lock);
+            continue;
+        }
+
+        batch = block_io_get_batch(queue, &sectors);
+        mutex_post(&queue->lock);
+
+        err = block_io_dispatch(queue, batch, sectors);
+
+        while(batch != NULL)
+        {
+            next          = batch->merge_next;
+            done          = batch->done;
+            batch->status = err;
+            if(batch->callback != NULL)
+            {
+                batch->callback(batch, batch->args);
+            }
+            if(done != NULL)
+            {
+                sem_post(done);
+            }
+
+            /* The request may be released by its owner once completed, it is
+             * not accessed after this store. The wake only uses the address as
+             * a key.
+             */
+            __atomic_store_n(&batch->completed, 1, __ATOMIC_RELEASE);
+            futex_wake(&batch->completed, FUTEX_WAKE_ALL, NULL);
+            batch = next;
+        }
+    }
+
+    return NULL;
+}
+
+OS_RETURN_E block_io_queue_init(block_io_queue_t* queue, void* driver_device,
+                                const block_driver_t* driver,
+                                const uint32_t sector_size)
+{
+    OS_RETURN_E err;
+
+    if(queue == NULL || driver == NULL ||
+       driver->read == NULL || driver->write == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    if(sector_size == 0 || sector_size > BLOCK_IO_MERGE_SIZE)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    memset(queue, 0, sizeof(block_io_queue_t));
+    queue->device          = driver_device;
+    queue->driver          = driver;
+    queue->sector_size     = sector_size;
+    queue->staging_sectors = BLOCK_IO_MERGE_SIZE / sector_size;
+
+    queue->staging = kmalloc(queue->staging_sectors * sector_size);
+    if(queue->staging == NULL)
+    {
+        return OS_ERR_MALLOC;
+    }
+
+    err = kernel_queue_init_queue(&queue->sorted);
+    if(err == OS_NO_ERR)
+    {
+        err = kernel_queue_init_queue(&queue->fifo);
+    }
+    if(err == OS_NO_ERR)
+    {
+        err = mutex_init(&queue->lock, MUTEX_FLAG_NONE,
+                         MUTEX_PRIORITY_ELEVATION_NONE);
+    }
+    if(err == OS_NO_ERR)
+    {
+        err = sem_init(&queue->pending, 0);
+    }
+    if(err == OS_NO_ERR)
+    {
+        err = sched_create_kernel_thread(&queue->worker,
+                                         BLOCK_IO_THREAD_PRIORITY,
+                                         "block_io",
+                                         BLOCK_IO_THREAD_STACK_SIZE,
+                                         0,
+                                         block_io_worker,
+                                         queue);
+    }
+    if(err != OS_NO_ERR)
+    {
+        kfree(queue->staging);
+        queue->staging = NULL;
+    }
+
+    return err;
+}
+
+OS_RETURN_E block_io_submit(block_io_queue_t* queue,
+                            block_io_request_t* request)
+{
+    OS_RETURN_E err;
+
+    if(queue == NULL || request == NULL || request->buffer == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    if(request->count == 0)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    err = kernel_queue_init_node(&request->sort_node, request);
+    if(err == OS_NO_ERR)
+    {
+        err = kernel_queue_init_node(&request->fifo_node, request);
+    }
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+    request->merge_next = NULL;
+    request->status     = OS_NO_ERR;
+    request->completed  = 0;
+    request->deadline   = time_get_current_uptime() + BLOCK_IO_DEADLINE;
+
+    err = mutex_pend(&queue->lock);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    err = kernel_queue_push_prio(&request->sort_node, &queue->sorted,
+                                 request->sector);
+    if(err == OS_NO_ERR)
+    {
+        err = kernel_queue_push(&request->fifo_node, &queue->fifo);
+        if(err != OS_NO_ERR)
+        {
+            kernel_queue_remove(&queue->sorted, &request->sort_node);
+        }
+    }
+    if(err == OS_NO_ERR)
+    {
+        ++queue->stats.submitted;
+    }
+
+    mutex_post(&queue->lock);
+
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    return sem_post(&queue->pending);
+}
+
+OS_RETURN_E block_io_sync(block_io_queue_t* queue, const uint32_t write,
+                          const uint32_t sector, void* buffer,
+                          const uint32_t count)
+{
+    block_io_request_t request;
+    OS_RETURN_E        err;
+
+    request.write    = write;
+    request.sector   = sector;
+    request.count    = count;
+    request.buffer   = buffer;
+    request.callback = NULL;
+    request.args     = NULL;
+    request.done     = NULL;
+
+    err = block_io_submit(queue, &request);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+
+    /* The request lives on this stack, only leave once the worker set the
+     * completion flag, it does not access the request after.
+     */
+    while(__atomic_load_n(&request.completed, __ATOMIC_ACQUIRE) == 0)
+    {
+        err = futex_wait(&request.completed, 0);
+        if(err != OS_NO_ERR && err != OS_FUTEX_VALUE_MISMATCH)
+        {
+            kernel_error("Could not wait block I/O request[%d]\n", err);
+            kernel_panic(err);
+        }
+    }
+
+    return request.status;
+}
+
+OS_RETURN_E block_io_get_stats(block_io_queue_t* queue,
+                               block_io_stats_t* stats)
+{
+    OS_RETURN_E err;
+
+    if(queue == NULL || stats == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    err = mutex_pend(&queue->lock);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
+    *stats = queue->stats;
+    mutex_post(&queue->lock);
+
+    return OS_NO_ERR;
+}
+
+/**
+ * @brief Block driver read function.
+ *
+ * @param[in] device The request queue.
+ * @param[in] sector The first sector to read.
+ * @param[out] buffer The buffer that receives the data.
+ * @param[in] count The number of sectors to read.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E block_io_driver_read(void* device, const uint32_t sector,
+                                        void* buffer, const uint32_t count)
+{
+    return block_io_sync(device, 0, sector, buffer, count);
+}
+
+/**
+ * @brief Block driver write function.
+ *
+ * @param[in] device The request queue.
+ * @param[in] sector The first sector to write.
+ * @param[in] buffer The buffer that contains the data.
+ * @param[in] count The number of sectors to write.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E block_io_driver_write(void* device, const uint32_t sector,
+                                         const void* buffer,
+                                         const uint32_t count)
+{
+    return block_io_sync(device, 1, sector, (void*)buffer, count);
+}
+
+/**
+ * @brief Block driver flush function, the completed writes are flushed by the
+ * queue's driver.
+ *
+ * @param[in] device The request queue.
+ *
+ * @return The success state or the error code.
+ */
+static OS_RETURN_E block_io_driver_flush(void* device)
+{
+    block_io_queue_t* queue;
+
+    queue = device;
+    if(queue->driver->flush == NULL)
+    {
+        return OS_NO_ERR;
+    }
+    return queue->driver->flush(queue->device);
+}
+
+/**
+ * @brief Request queue block driver instance.
+ */
+block_driver_t block_io_driver = {
+    .read  = block_io_driver_read,
+    .write = block_io_driver_write,
+    .flush = block_io_driver_flush
+};
@@ -15,14 +15,20 @@
  * really basic output too allow early kernel boot output and debug. These 
  * functions can be used in interrupts handlers since no lock is required to use
  * them. This also makes them non thread safe.
+ *
+ * The deferred output appends the messages to per CPU rings. A ring is only
+ * written by its CPU with the interrupts disabled and only read by the flusher,
+ * its indexes are published with release stores so no lock is needed.
  * 
  * @copyright Alexy Torres Aurora Dugo
  ******************************************************************************/
 
-#include <lib/string.h>   /* memset, strlen */
-#include <lib/stdlib.h>   /* uitoa, itoa */
-#include <serial.h>       /* Serial driver */
-#include <io/graphic.h>   /* Graphic definitions */
+#include <cpu.h>                  /* cpu_get_id, cpu_rdtsc */
+#include <lib/string.h>           /* memcpy, strlen */
+#include <serial.h>               /* Serial driver */
+#include <io/graphic.h>           /* Graphic definitions */
+#include <core/scheduler.h>       /* Kernel scheduler */
+#include <interrupt/interrupts.h> /* Interrupt state */
 
 /* UTK configuration file */
 #include <config.h>
@@ -30,6 +36,68 @@
 /* Header file */
 #include <io/kernel_output.h>
 
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/**
+ * @brief Formated string arguments source, either a variable arguments list or
+ * the packed arguments of a record.
+ */
+struct format_args
+{
+    /** @brief The variable arguments list, NULL when reading a record. */
+    __builtin_va_list* list;
+
+    /** @brief The packed arguments. */
+    const uint8_t* packed;
+    /** @brief Size in bytes of the packed arguments. */
+    size_t size;
+    /** @brief Offset of the next packed argument. */
+    size_t offset;
+};
+
+/**
+ * @brief Defines format_args_t type as a shorcut for struct format_args.
+ */
+typedef struct format_args format_args_t;
+
+/** @brief Conversion specification of a formated string. */
+struct format_spec
+{
+    /** @brief FORMAT_FLAG_* flags. */
+    uint32_t flags;
+    /** @brief Minimal field width. */
+    int32_t width;
+    /** @brief Precision, -1 if not specified. */
+    int32_t precision;
+    /** @brief Size in bytes of the integer argument. */
+    uint8_t length;
+    /** @brief Conversion specifier, 0 if the string ended. */
+    char conversion;
+};
+
+/**
+ * @brief Defines format_spec_t type as a shorcut for struct format_spec.
+ */
+typedef struct format_spec format_spec_t;
+
+/** @brief Formater output buffer, flushed by runs to the output. */
+struct format_buffer
+{
+    /** @brief The buffered characters, NULL terminated when flushed. */
+    char data[KERNEL_OUTPUT_FORMAT_BUFFER_SIZE + 1];
+    /** @brief Number of buffered characters. */
+    size_t size;
+    /** @brief The output the buffer is flushed to. */
+    output_t output;
+};
+
+/**
+ * @brief Defines format_buffer_t type as a shorcut for struct format_buffer.
+ */
+typedef struct format_buffer format_buffer_t;
+
 /*******************************************************************************
  * GLOBAL VARIABLES
  ******************************************************************************/
@@ -37,336 +105,974 @@
 /** @brief Stores the current output type. */
 static output_t current_output;
 
+/** @brief Screen output levels tags. */
+static const char* level_tags[] = {
+    NULL,
+    "[ERROR] ",
+    "[OK] ",
+    "[INFO] ",
+    "[DEBUG] ",
+    "[DEBUG] "
+};
+
+/** @brief Screen output levels tags colors. */
+static const uint32_t level_colors[] = {
+    FG_BLACK,
+    FG_RED,
+    FG_GREEN,
+    FG_CYAN,
+    FG_YELLOW,
+    FG_BLACK
+};
+
+/** @brief Per CPU deferred output rings. */
+static kernel_output_ring_t output_rings[MAX_CPU_COUNT];
+
+/** @brief Set to 1 when the output is deferred. */
+static volatile uint32_t output_deferred = 0;
+
+/** @brief Set to 1 once the flusher thread is started. */
+static uint32_t output_flusher_started = 0;
+
+/** @brief Set to 1 while a flush is in progress. */
+static volatile uint32_t output_flushing = 0;
+
+/** @brief Number of flushed records. */
+static uint64_t output_flushed = 0;
+
 /*******************************************************************************
  * FUNCTIONS
  ******************************************************************************/
 
-#define PAD_SEQ                         \
-{                                       \
-    str_size = strlen(tmp_seq);         \
-                                        \
-    while(padding_mod > str_size)       \
-    {                                   \
-        used_output.putc(pad_char_mod); \
-        --padding_mod;                  \
-    }                                   \
+/**
+ * @brief Writes the buffered characters to the output.
+ *
+ * @param[in, out] buffer The formater output buffer.
+ */
+static void format_flush(format_buffer_t* buffer)
+{
+    if(buffer->size != 0)
+    {
+        buffer->data[buffer->size] = 0;
+        buffer->output.puts(buffer->data);
+        buffer->size = 0;
+    }
 }
 
 /**
- * @brief Converts a string to upper case characters.
- * 
- * @details Transforms all lowercase character of a NULL terminated string to 
- * uppercase characters.
- * 
- * @param[in,out] string The string to tranform.
+ * @brief Appends characters to the formater output buffer.
+ *
+ * @param[in, out] buffer The formater output buffer.
+ * @param[in] str The characters to append, not NULL terminated.
+ * @param[in] length The number of characters to append.
  */
-static void toupper(char* string)
+static void format_append(format_buffer_t* buffer, const char* str,
+                          size_t length)
 {
-    /* For each character of the string */
-    while(*string != 0)
+    size_t size;
+
+    while(length != 0)
     {
-        /* If the character is lowercase, makes it uppercase */
-        if(*string > 96 && *string < 123)
+        size = KERNEL_OUTPUT_FORMAT_BUFFER_SIZE - buffer->size;
+        if(size > length)
         {
-            *string = *string - 32;
+            size = length;
+        }
+        memcpy(buffer->data + buffer->size, str, size);
+        buffer->size += size;
+        str          += size;
+        length       -= size;
+
+        if(buffer->size == KERNEL_OUTPUT_FORMAT_BUFFER_SIZE)
+        {
+            format_flush(buffer);
         }
-        ++string;
     }
 }
 
 /**
- * @brief Converts a string to upper case characters.
- * 
- * @details Transforms all uppercase character of a NULL terminated string to 
- * lowercase characters.
- * 
- * @param[in,out] string The string to tranform.
+ * @brief Appends a character repeated to the formater output buffer.
+ *
+ * @param[in, out] buffer The formater output buffer.
+ * @param[in] character The character to append.
+ * @param[in] count The number of times the character is appended.
  */
-static void tolower(char* string)
+static void format_pad(format_buffer_t* buffer, const char character,
+                       int32_t count)
 {
-    /* For each character of the string */
-    while(*string != 0)
+    for(; count > 0; --count)
     {
-        /* If the character is uppercase, makes it lowercase */
-        if(*string > 64 && *string < 91)
+        buffer->data[buffer->size++] = character;
+        if(buffer->size == KERNEL_OUTPUT_FORMAT_BUFFER_SIZE)
         {
-            *string = *string + 32;
+            format_flush(buffer);
         }
-        ++string;
     }
 }
 
-#define GET_SEQ_VAL(val, args, length_mod)                     \
-{                                                              \
-                                                               \
-    /* Harmonize length */                                     \
-    if(length_mod > 8)                                         \
-    {                                                          \
-        length_mod = 8;                                        \
-    }                                                          \
-                                                               \
-    switch(length_mod)                                         \
-    {                                                          \
-        case 1:                                                \
-            val = (__builtin_va_arg(args, uint32_t) & 0xFF);   \
-            break;                                             \
-        case 2:                                                \
-            val = (__builtin_va_arg(args, uint32_t) & 0xFFFF); \
-            break;                                             \
-        case 4:                                                \
-            val = __builtin_va_arg(args, uint32_t);            \
-            break;                                             \
-        case 8:                                                \
-            val = __builtin_va_arg(args, uint64_t);            \
-            break;                                             \
-        default:                                               \
-           val = __builtin_va_arg(args, uint32_t);             \
-    }                                                          \
-                                                               \
+/**
+ * @brief Parses a conversion specification.
+ *
+ * @details Parses the flags, width, precision, length and conversion of the
+ * specification following a '%' character. A '*' width or precision is
+ * reported as FORMAT_STAR, the caller fetches it from the arguments.
+ *
+ * @param[in] str The specification, after the '%' character.
+ * @param[out] spec The parsed specification.
+ *
+ * @return The position following the specification.
+ */
+static const char* format_parse_spec(const char* str, format_spec_t* spec)
+{
+    spec->flags      = 0;
+    spec->width      = 0;
+    spec->precision  = -1;
+    spec->length     = sizeof(int);
+    spec->conversion = 0;
+
+    /* Flags */
+    while(*str == '-' || *str == '0' || *str == '+' || *str == ' ' ||
+          *str == '#')
+    {
+        switch(*str++)
+        {
+            case '-':
+                spec->flags |= FORMAT_FLAG_LEFT;
+                break;
+            case '0':
+                spec->flags |= FORMAT_FLAG_ZERO;
+                break;
+            case '+':
+                spec->flags |= FORMAT_FLAG_PLUS;
+                break;
+            case ' ':
+                spec->flags |= FORMAT_FLAG_SPACE;
+                break;
+            default:
+                spec->flags |= FORMAT_FLAG_ALT;
+                break;
+        }
+    }
+
+    /* Width */
+    if(*str == '*')
+    {
+        spec->width = FORMAT_STAR;
+        ++str;
+    }
+    else
+    {
+        while(*str >= '0' && *str <= '9')
+        {
+            spec->width = spec->width * 10 + (*str++ - '0');
+        }
+    }
+
+    /* Precision */
+    if(*str == '.')
+    {
+        ++str;
+        spec->precision = 0;
+        if(*str == '*')
+        {
+            spec->precision = FORMAT_STAR;
+            ++str;
+        }
+        else
+        {
+            while(*str >= '0' && *str <= '9')
+            {
+                spec->precision = spec->precision * 10 + (*str++ - '0');
+            }
+        }
+    }
+
+    /* Length */
+    switch(*str)
+    {
+        case 'h':
+            ++str;
+            spec->length = sizeof(short);
+            if(*str == 'h')
+            {
+                ++str;
+                spec->length = sizeof(char);
+            }
+            break;
+        case 'l':
+            ++str;
+            spec->length = sizeof(long);
+            if(*str == 'l')
+            {
+                ++str;
+                spec->length = sizeof(long long);
+            }
+            break;
+        case 'j':
+            ++str;
+            spec->length = sizeof(int64_t);
+            break;
+        case 'z':
+        case 't':
+            ++str;
+            spec->length = sizeof(size_t);
+            break;
+        default:
+            break;
+    }
+
+    if(*str == 0)
+    {
+        return str;
+    }
+
+    spec->conversion = *str;
+    if(spec->conversion == 'p' || spec->conversion == 'P')
+    {
+        spec->length = sizeof(uintptr_t);
+    }
+    else if(spec->conversion == 'c')
+    {
+        spec->length = sizeof(int);
+    }
+
+    return str + 1;
 }
 
+/**
+ * @brief Returns the size of a packed integer argument.
+ *
+ * @param[in] length The argument length in bytes.
+ *
+ * @return The size in bytes of the argument in the packed arguments.
+ */
+static size_t format_arg_size(const uint8_t length)
+{
+    return (length > sizeof(uint32_t)) ? sizeof(uint64_t) : sizeof(uint32_t);
+}
+
+/**
+ * @brief Gets the next integer argument of a formated string.
+ *
+ * @param[in, out] args The formated string arguments.
+ * @param[in] length The argument length in bytes.
+ *
+ * @return The argument value zero extended, 0 if the packed arguments are
+ * exhausted.
+ */
+static uint64_t format_get_value(format_args_t* args, const uint8_t length)
+{
+    uint64_t val;
+    uint32_t val32;
+    size_t   size;
+
+    size = format_arg_size(length);
+
+    if(args->list == NULL)
+    {
+        if(args->offset + size > args->size)
+        {
+            args->offset = args->size;
+            return 0;
+        }
+        if(size == sizeof(uint64_t))
+        {
+            memcpy(&val, args->packed + args->offset, size);
+        }
+        else
+        {
+            memcpy(&val32, args->packed + args->offset, size);
+            val = val32;
+        }
+        args->offset += size;
+    }
+    else if(size == sizeof(uint64_t))
+    {
+        val = __builtin_va_arg(*args->list, uint64_t);
+    }
+    else
+    {
+        val = __builtin_va_arg(*args->list, uint32_t);
+    }
+
+    switch(length)
+    {
+        case 1:
+            return val & 0xFF;
+        case 2:
+            return val & 0xFFFF;
+        case 4:
+            return val & 0xFFFFFFFF;
+        default:
+            return val;
+    }
+}
+
+/**
+ * @brief Gets the next string argument of a formated string.
+ *
+ * @param[in, out] args The formated string arguments.
+ *
+ * @return The argument value, an empty string if the packed arguments are
+ * exhausted.
+ */
+static const char* format_get_string(format_args_t* args)
+{
+    const char* str;
+
+    if(args->list != NULL)
+    {
+        str = __builtin_va_arg(*args->list, char*);
+        return (str != NULL) ? str : "(null)";
+    }
+
+    if(args->offset >= args->size)
+    {
+        return "";
+    }
+
+    /* Packed strings are NULL terminated */
+    str = (const char*)args->packed + args->offset;
+    args->offset += strlen(str) + 1;
+
+    return str;
+}
+
+/**
+ * @brief Formats an integer conversion.
+ *
+ * @details Converts the value from its least significant digit in a local
+ * buffer, then appends the sign or prefix, the padding and the digits to the
+ * formater output buffer.
+ *
+ * @param[in, out] buffer The formater output buffer.
+ * @param[in] spec The conversion specification.
+ * @param[in] value The argument value, zero extended.
+ */
+static void format_integer(format_buffer_t* buffer, const format_spec_t* spec,
+                           uint64_t value)
+{
+    char        digits[FORMAT_MAX_DIGITS];
+    const char* table;
+    const char* prefix;
+    uint32_t    base;
+    uint32_t    value32;
+    int32_t     count;
+    int32_t     zeros;
+    int32_t     pad;
+    int32_t     prefix_len;
+    int32_t     precision;
+
+    table      = "0123456789abcdef";
+    prefix     = "";
+    prefix_len = 0;
+    precision  = spec->precision;
+    base       = 10;
+
+    switch(spec->conversion)
+    {
+        case 'd':
+        case 'i':
+            /* Sign extend the argument */
+            switch(spec->length)
+            {
+                case 1:
+                    value = (uint64_t)(int64_t)(int8_t)value;
+                    break;
+                case 2:
+                    value = (uint64_t)(int64_t)(int16_t)value;
+                    break;
+                case 4:
+                    value = (uint64_t)(int64_t)(int32_t)value;
+                    break;
+                default:
+                    break;
+            }
+            if((int64_t)value < 0)
+            {
+                value      = -value;
+                prefix     = "-";
+                prefix_len = 1;
+            }
+            else if((spec->flags & FORMAT_FLAG_PLUS) != 0)
+            {
+                prefix     = "+";
+                prefix_len = 1;
+            }
+            else if((spec->flags & FORMAT_FLAG_SPACE) != 0)
+            {
+                prefix     = " ";
+                prefix_len = 1;
+            }
+            break;
+        case 'o':
+            base = 8;
+            if((spec->flags & FORMAT_FLAG_ALT) != 0 && value != 0)
+            {
+                prefix     = "0";
+                prefix_len = 1;
+            }
+            break;
+        case 'X':
+            table = "0123456789ABCDEF";
+            __attribute__ ((fallthrough));
+        case 'x':
+            base = 16;
+            if((spec->flags & FORMAT_FLAG_ALT) != 0 && value != 0)
+            {
+                prefix     = (spec->conversion == 'X') ? "0X" : "0x";
+                prefix_len = 2;
+            }
+            break;
+        case 'P':
+            table = "0123456789ABCDEF";
+            __attribute__ ((fallthrough));
+        case 'p':
+            /* Pointers are always printed with all their digits */
+            base = 16;
+            if(precision < 0)
+            {
+                precision = 2 * sizeof(uintptr_t);
+            }
+            break;
+        default:
+            break;
+    }
+
+    /* Convert, 32 bits divisions are used as soon as the value fits */
+    count = FORMAT_MAX_DIGITS;
+    while(value > 0xFFFFFFFF)
+    {
+        digits[--count] = table[value % base];
+        value /= base;
+    }
+    value32 = (uint32_t)value;
+    while(value32 != 0)
+    {
+        digits[--count] = table[value32 % base];
+        value32 /= base;
+    }
+    count = FORMAT_MAX_DIGITS - count;
+
+    /* Default precision is one digit, a 0 precision prints nothing for 0 */
+    if(precision < 0)
+    {
+        precision = 1;
+    }
+    zeros = (precision > count) ? precision - count : 0;
+    pad   = spec->width - prefix_len - zeros - count;
+
+    /* Zero padding is ignored with a precision or a left justification */
+    if((spec->flags & FORMAT_FLAG_ZERO) != 0 && spec->precision < 0 &&
+       (spec->flags & FORMAT_FLAG_LEFT) == 0 && pad > 0)
+    {
+        zeros += pad;
+        pad    = 0;
+    }
+
+    if((spec->flags & FORMAT_FLAG_LEFT) == 0)
+    {
+        format_pad(buffer, ' ', pad);
+    }
+    format_append(buffer, prefix, prefix_len);
+    format_pad(buffer, '0', zeros);
+    format_append(buffer, digits + FORMAT_MAX_DIGITS - count, count);
+    if((spec->flags & FORMAT_FLAG_LEFT) != 0)
+    {
+        format_pad(buffer, ' ', pad);
+    }
+}
+
+/**
+ * @brief Formats a string or character conversion.
+ *
+ * @param[in, out] buffer The formater output buffer.
+ * @param[in] spec The conversion specification.
+ * @param[in] str The characters to output.
+ * @param[in] length The number of characters to output.
+ */
+static void format_string(format_buffer_t* buffer, const format_spec_t* spec,
+                          const char* str, size_t length)
+{
+    int32_t pad;
+
+    pad = spec->width - (int32_t)length;
+
+    if((spec->flags & FORMAT_FLAG_LEFT) == 0)
+    {
+        format_pad(buffer, ' ', pad);
+    }
+    format_append(buffer, str, length);
+    if((spec->flags & FORMAT_FLAG_LEFT) != 0)
+    {
+        format_pad(buffer, ' ', pad);
+    }
+}
 
 /**
  * @brief Prints a formated string.
  * 
  * @details Prints a formated string to the output and managing the formated 
- * string arguments.
+ * string arguments. The characters are formated in a local buffer that is
+ * written to the output by runs.
  * 
  * @param[in] str The formated string to output.
- * @param[in] args The arguments to use with the formated string.
+ * @param[in, out] args The arguments to use with the formated string.
  * @param[in] used_output The output to use.
  */
-static void formater(const char* str, __builtin_va_list args, 
+static void formater(const char* str, format_args_t* args,
                      output_t used_output)
 {
-    size_t pos;
-    size_t str_length;
-    size_t seq_val;
-    size_t str_size;
-
-   
-    uint8_t  modifier;
-
-    uint8_t  length_mod;
-    uint8_t  padding_mod;
-    uint8_t  upper_mod;
-    char     pad_char_mod;
-
-    char tmp_seq[128];
+    format_buffer_t buffer;
+    format_spec_t   spec;
+    const char*     run;
+    const char*     arg_str;
+    size_t          length;
+    char            character;
 
-    char* args_value;
+    buffer.size   = 0;
+    buffer.output = used_output;
 
-    modifier     = 0;
-    length_mod   = 4;
-    padding_mod  = 0;
-    upper_mod    = 0;
-    pad_char_mod = ' ';
-    str_length   = strlen(str);
-
-    for(pos = 0; pos < str_length; ++pos)
+    while(*str != 0)
     {
-        if(str[pos] == '%')
+        /* Literal run */
+        run = str;
+        while(*str != 0 && *str != '%')
         {
-            /* If we encouter this character in a modifier sequence, it was 
-             * just an escape one.
-             */
-            modifier = !modifier;
-            if(modifier)
-            {
-                continue;
-            }
-            else 
+            ++str;
+        }
+        format_append(&buffer, run, str - run);
+        if(*str == 0)
+        {
+            break;
+        }
+
+        str = format_parse_spec(str + 1, &spec);
+        if(spec.width == FORMAT_STAR)
+        {
+            spec.width = (int32_t)format_get_value(args, sizeof(int));
+            if(spec.width < 0)
             {
-                used_output.putc(str[pos]);
+                spec.flags |= FORMAT_FLAG_LEFT;
+                spec.width  = -spec.width;
             }
         }
-        else if(modifier)
+        if(spec.precision == FORMAT_STAR)
         {
-            switch(str[pos]) 
+            spec.precision = (int32_t)format_get_value(args, sizeof(int));
+            if(spec.precision < 0)
             {
-                /* Length mods */
-                case 'h': 
-                    length_mod /= 2;
-                    continue;
-                case 'l':
-                    length_mod *= 2;
-                    continue;
-
-                /* Specifier mods */
-                case 's':
-					args_value = __builtin_va_arg(args, char*);
-					current_output.puts(args_value);
-                    break;
-                case 'd':
-                case 'i':
-                    GET_SEQ_VAL(seq_val, args, length_mod);
-					memset(tmp_seq, 0, sizeof(tmp_seq));
-					itoa(seq_val, tmp_seq, 10);
-                    PAD_SEQ
-					used_output.puts(tmp_seq);
-                    break;
-                case 'u':
-                    GET_SEQ_VAL(seq_val, args, length_mod);
-					memset(tmp_seq, 0, sizeof(tmp_seq));
-					uitoa(seq_val, tmp_seq, 10);
-                    PAD_SEQ
-					used_output.puts(tmp_seq);
-                    break;
-                case 'X': 
-                    upper_mod = 1;
-                    __attribute__ ((fallthrough));
-                case 'x':
-                    GET_SEQ_VAL(seq_val, args, length_mod);
-					memset(tmp_seq, 0, sizeof(tmp_seq));
-					uitoa(seq_val, tmp_seq, 16);
-                    PAD_SEQ
-                    if(upper_mod)
-                    {
-                        toupper(tmp_seq);
-                    }
-                    else 
-                    {
-                        tolower(tmp_seq);
-                    }
-					used_output.puts(tmp_seq);
-                    break;                    
-                case 'P': 
-                    upper_mod = 1;
-                    __attribute__ ((fallthrough));
-                case 'p':
-                    padding_mod  = 2 * sizeof(uintptr_t);
-                    pad_char_mod = '0';
-                    length_mod = sizeof(uintptr_t);
-                    GET_SEQ_VAL(seq_val, args, length_mod);
-					memset(tmp_seq, 0, sizeof(tmp_seq));
-					uitoa(seq_val, tmp_seq, 16);
-                    PAD_SEQ
-                    if(upper_mod)
-                    {
-                        toupper(tmp_seq);
-                    }
-                    else 
-                    {
-                        tolower(tmp_seq);
-                    }
-					used_output.puts(tmp_seq);
-                    break;
-                case 'c':
-                    length_mod = sizeof(char);
-                    GET_SEQ_VAL(tmp_seq[0], args, length_mod);
-					used_output.putc(tmp_seq[0]);
-                    break;
-
-                /* Padding mods */
-                case '0':
-                    if(padding_mod == 0)
-                    {
-                        pad_char_mod = '0';
-                    }
-                    else 
-                    {
-                        padding_mod *= 10;
-                    }
-                    continue;
-                case '1':
-                    padding_mod = padding_mod * 10 + 1;
-                    continue;
-                case '2':
-                    padding_mod = padding_mod * 10 + 2;
-                    continue;
-                case '3':
-                    padding_mod = padding_mod * 10 + 3;
-                    continue;
-                case '4':
-                    padding_mod = padding_mod * 10 + 4;
-                    continue;
-                case '5':
-                    padding_mod = padding_mod * 10 + 5;
-                    continue;
-                case '6':
-                    padding_mod = padding_mod * 10 + 6;
-                    continue;
-                case '7':
-                    padding_mod = padding_mod * 10 + 7;
-                    continue;
-                case '8':
-                    padding_mod = padding_mod * 10 + 8;
-                    continue;
-                case '9':
-                    padding_mod = padding_mod * 10 + 9;
-                    continue;
-                default:
-                    continue;
+                spec.precision = -1;
             }
         }
-        else 
+
+        switch(spec.conversion)
         {
-            used_output.putc(str[pos]);
+            case 0:
+                break;
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'p':
+            case 'P':
+                format_integer(&buffer, &spec,
+                               format_get_value(args, spec.length));
+                break;
+            case 's':
+                arg_str = format_get_string(args);
+                length  = 0;
+                while(arg_str[length] != 0 &&
+                      (spec.precision < 0 ||
+                       length < (size_t)spec.precision))
+                {
+                    ++length;
+                }
+                format_string(&buffer, &spec, arg_str, length);
+                break;
+            case 'c':
+                character = (char)format_get_value(args, spec.length);
+                format_string(&buffer, &spec, &character, 1);
+                break;
+            default:
+                /* '%' and unknown conversions are output as is */
+                format_append(&buffer, &spec.conversion, 1);
+                break;
         }
+    }
+
+    format_flush(&buffer);
+}
+
+/**
+ * @brief Packs an integer argument.
+ *
+ * @param[in, out] args The variable arguments list.
+ * @param[in] length The argument length in bytes.
+ * @param[out] buffer The buffer that receives the packed arguments.
+ * @param[in, out] offset The offset of the argument in the buffer.
+ *
+ * @return 0 if the argument was packed, -1 if the buffer is full.
+ */
+static int32_t pack_value(__builtin_va_list* args, const uint8_t length,
+                          uint8_t* buffer, size_t* offset)
+{
+    size_t   size;
+    uint32_t val32;
+    uint64_t val;
 
-        /* Reinit mods */
-        length_mod   = 4;
-        padding_mod  = 0;
-        upper_mod    = 0;
-        pad_char_mod = ' ';
-        modifier     = 0;
-        
+    size = format_arg_size(length);
+    if(*offset + size > KERNEL_OUTPUT_ARGS_SIZE)
+    {
+        return -1;
+    }
+    if(size == sizeof(uint64_t))
+    {
+        val = __builtin_va_arg(*args, uint64_t);
+        memcpy(buffer + *offset, &val, size);
     }
+    else
+    {
+        val32 = __builtin_va_arg(*args, uint32_t);
+        memcpy(buffer + *offset, &val32, size);
+    }
+    *offset += size;
+
+    return 0;
 }
 
 /**
- * @brief Prints a formated string.
- * 
- * @details Prints a formated string to the output and managing the formated 
- * string arguments.
- * 
- * @param[in] str The formated string to output.
- * @param[in] args The arguments to use with the formated string.
+ * @brief Packs the arguments of a formated string.
+ *
+ * @details Parses the formated string the same way the formater does and
+ * copies the arguments in the buffer. Integers are stored on 32 or 64 bits and
+ * strings are copied with their NULL terminator. The packing stops when the
+ * buffer is full, the last string is truncated.
+ *
+ * @param[in] str The formated string.
+ * @param[in, out] args The variable arguments list.
+ * @param[out] buffer The buffer that receives the packed arguments.
+ *
+ * @return The size in bytes of the packed arguments.
  */
-static void kprint_fmt(const char* str, __builtin_va_list args)
+static size_t pack_args(const char* str, __builtin_va_list* args,
+                        uint8_t* buffer)
 {
-    formater(str, args, current_output);
+    format_spec_t spec;
+    size_t        offset;
+    size_t        size;
+    const char*   arg_str;
+
+    offset = 0;
+
+    while(*str != 0 && offset < KERNEL_OUTPUT_ARGS_SIZE)
+    {
+        if(*str++ != '%')
+        {
+            continue;
+        }
+
+        str = format_parse_spec(str, &spec);
+        if((spec.width == FORMAT_STAR &&
+            pack_value(args, sizeof(int), buffer, &offset) != 0) ||
+           (spec.precision == FORMAT_STAR &&
+            pack_value(args, sizeof(int), buffer, &offset) != 0))
+        {
+            break;
+        }
+
+        switch(spec.conversion)
+        {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'p':
+            case 'P':
+            case 'c':
+                if(pack_value(args, spec.length, buffer, &offset) != 0)
+                {
+                    return offset;
+                }
+                break;
+            case 's':
+                arg_str = __builtin_va_arg(*args, char*);
+                if(arg_str == NULL)
+                {
+                    arg_str = "(null)";
+                }
+                size = strlen(arg_str);
+                if(size > KERNEL_OUTPUT_ARGS_SIZE - offset - 1)
+                {
+                    size = KERNEL_OUTPUT_ARGS_SIZE - offset - 1;
+                }
+                memcpy(buffer + offset, arg_str, size);
+                buffer[offset + size] = 0;
+                offset += size + 1;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return offset;
 }
 
 /**
- * @brief Prints a formated string to serial output.
- * 
- * @details Prints a formated string to the serial output and managing the 
- * formated string arguments.
- * 
+ * @brief Outputs a message.
+ *
+ * @details Outputs the tag of the level and the formated string to the devices
+ * of the level.
+ *
+ * @param[in] level The output level.
  * @param[in] str The formated string to output.
- * @param[in] args The arguments to use with the formated string.
+ * @param[in, out] args The arguments to use with the formated string.
  */
-static void kprint_fmt_serial(const char* str, __builtin_va_list args)
+static void output_write(const KERNEL_OUTPUT_LEVEL_E level, const char* str,
+                         format_args_t* args)
 {
-    output_t ser_out = {
+    colorscheme_t buffer;
+    colorscheme_t new_scheme;
+    output_t      ser_out = {
         .putc = serial_put_char,
         .puts = serial_put_string
     };
 
-    formater(str, args, ser_out);
+    if(level == KERNEL_OUTPUT_LEVEL_SERIAL_DEBUG)
+    {
+        ser_out.puts(level_tags[level]);
+        formater(str, args, ser_out);
+        return;
+    }
+
+    current_output.putc = graphic_put_char;
+    current_output.puts = graphic_put_string;
+
+    if(level_tags[level] != NULL)
+    {
+        new_scheme.foreground = level_colors[level];
+        new_scheme.background = BG_BLACK;
+        new_scheme.vga_color  = 1;
+
+        /* No need to test return value */
+        graphic_save_color_scheme(&buffer);
+
+        /* Set the tag color scheme */
+        graphic_set_color_scheme(new_scheme);
+
+        /* Print tag */
+        current_output.puts(level_tags[level]);
+
+        /* Restore original screen color scheme */
+        graphic_set_color_scheme(buffer);
+    }
+
+    formater(str, args, current_output);
 }
 
 /**
- * @brief Prints the tag for kernel output functions.
- * 
- * @details Prints the tag for kernel output functions.
- * 
- * @param[in] fmt The formated string to print.
- * @param[in] ... The associated arguments to the formated string.
+ * @brief Outputs a deferred record.
+ *
+ * @details Outputs the record with the screen color scheme that was used when
+ * the record was logged.
+ *
+ * @param[in] record The record to output.
  */
-static void tag_printf(const char* fmt, ...)
+static void output_record(const kernel_output_record_t* record)
 {
-    __builtin_va_list args;
+    colorscheme_t buffer;
+    format_args_t args;
+    uint32_t      restore;
 
-    if(fmt == NULL)
+    args.list   = NULL;
+    args.packed = record->args;
+    args.size   = record->size;
+    args.offset = 0;
+
+    restore = 0;
+    if(record->level != KERNEL_OUTPUT_LEVEL_SERIAL_DEBUG)
+    {
+        /* No need to test return value */
+        graphic_save_color_scheme(&buffer);
+        if(buffer.foreground != record->scheme.foreground ||
+           buffer.background != record->scheme.background ||
+           buffer.vga_color  != record->scheme.vga_color)
+        {
+            graphic_set_color_scheme(record->scheme);
+            restore = 1;
+        }
+    }
+
+    output_write(record->level, record->fmt, &args);
+
+    if(restore != 0)
     {
+        graphic_set_color_scheme(buffer);
+    }
+}
+
+/**
+ * @brief Appends a record to the ring of the current CPU.
+ *
+ * @details Appends a record containing the time stamp, the current color scheme
+ * and the packed arguments. The record is dropped if the ring is full.
+ *
+ * @param[in] level The output level.
+ * @param[in] str The formated string to output.
+ * @param[in, out] args The arguments to use with the formated string.
+ */
+static void output_log(const KERNEL_OUTPUT_LEVEL_E level, const char* str,
+                       __builtin_va_list* args)
+{
+    kernel_output_ring_t*   ring;
+    kernel_output_record_t* record;
+    uint32_t                int_state;
+    uint32_t                head;
+    int32_t                 cpu_id;
+
+    /* The ring is only written by its CPU, disabling the interrupts is enough
+     * to own it.
+     */
+    int_state = kernel_interrupt_disable();
+
+    cpu_id = cpu_get_id();
+    if(cpu_id < 0 || cpu_id >= MAX_CPU_COUNT)
+    {
+        cpu_id = 0;
+    }
+    ring = &output_rings[cpu_id];
+
+    head = ring->head;
+    if(head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >=
+       KERNEL_OUTPUT_BUFFER_SIZE)
+    {
+        ++ring->lost;
+        kernel_interrupt_restore(int_state);
         return;
     }
-    /* Prtinf format string */
-    __builtin_va_start(args, fmt);
-    kprint_fmt(fmt, args);
-    __builtin_va_end(args);
+
+    record = &ring->records[head & (KERNEL_OUTPUT_BUFFER_SIZE - 1)];
+
+    record->timestamp = cpu_rdtsc();
+    record->fmt       = str;
+    record->level     = level;
+    record->cpu       = cpu_id;
+    record->size      = pack_args(str, args, record->args);
+    if(level != KERNEL_OUTPUT_LEVEL_SERIAL_DEBUG)
+    {
+        graphic_save_color_scheme(&record->scheme);
+    }
+
+    ++ring->logged;
+
+    /* Publish the record */
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    kernel_interrupt_restore(int_state);
+}
+
+/**
+ * @brief Outputs or logs a message depending on the output mode.
+ *
+ * @param[in] level The output level.
+ * @param[in] str The formated string to output.
+ * @param[in, out] args The arguments to use with the formated string.
+ */
+static void output_message(const KERNEL_OUTPUT_LEVEL_E level, const char* str,
+                           __builtin_va_list* args)
+{
+    format_args_t format_args;
+
+    if(output_deferred != 0)
+    {
+        output_log(level, str, args);
+        return;
+    }
+
+    format_args.list   = args;
+    format_args.packed = NULL;
+    format_args.size   = 0;
+    format_args.offset = 0;
+
+    output_write(level, str, &format_args);
+}
+
+/**
+ * @brief Outputs the pending records of all the CPUs.
+ *
+ * @details Outputs the pending records in time stamp order until the rings are
+ * empty. The caller must be the only consumer of the rings.
+ */
+static void output_drain(void)
+{
+    kernel_output_ring_t*   ring;
+    kernel_output_ring_t*   oldest;
+    kernel_output_record_t* record;
+    uint32_t                i;
+    uint32_t                tail;
+
+    while(1)
+    {
+        /* Get the oldest pending record of all the CPUs */
+        oldest = NULL;
+        for(i = 0; i < MAX_CPU_COUNT; ++i)
+        {
+            ring = &output_rings[i];
+            tail = ring->tail;
+            if(tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE))
+            {
+                continue;
+            }
+
+            record = &ring->records[tail & (KERNEL_OUTPUT_BUFFER_SIZE - 1)];
+            if(oldest == NULL ||
+               record->timestamp <
+               oldest->records[oldest->tail &
+                               (KERNEL_OUTPUT_BUFFER_SIZE - 1)].timestamp)
+            {
+                oldest = ring;
+            }
+        }
+
+        if(oldest == NULL)
+        {
+            break;
+        }
+
+        tail = oldest->tail;
+        output_record(&oldest->records[tail & (KERNEL_OUTPUT_BUFFER_SIZE - 1)]);
+        ++output_flushed;
+
+        /* Release the record to the producer */
+        __atomic_store_n(&oldest->tail, tail + 1, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * @brief Log flusher thread routine.
+ *
+ * @details Flushes the pending records every KERNEL_OUTPUT_FLUSH_PERIOD
+ * milliseconds.
+ *
+ * @param[in] args Unused.
+ *
+ * @return NULL, the thread never returns.
+ */
+static void* output_flusher(void* args)
+{
+    (void)args;
+
+    while(1)
+    {
+        kernel_output_flush();
+        sched_sleep(KERNEL_OUTPUT_FLUSH_PERIOD);
+    }
+
+    return NULL;
 }
 
 void kernel_printf(const char* fmt, ...)
@@ -380,181 +1086,184 @@ void kernel_printf(const char* fmt, ...)
 
     /* Prtinf format string */
     __builtin_va_start(args, fmt);
-    current_output.putc = graphic_put_char;
-    current_output.puts = graphic_put_string;
-    kprint_fmt(fmt, args);
+    output_message(KERNEL_OUTPUT_LEVEL_PRINTF, fmt, &args);
     __builtin_va_end(args);
 }
 
 void kernel_error(const char* fmt, ...)
 {
     __builtin_va_list args;
-    colorscheme_t     buffer;
-    colorscheme_t     new_scheme;
 
     if(fmt == NULL)
     {
         return;
     }
 
-    new_scheme.foreground = FG_RED;
-    new_scheme.background = BG_BLACK;
-    new_scheme.vga_color  = 1;
-
-    current_output.putc = graphic_put_char;
-    current_output.puts = graphic_put_string;
-
-    /* No need to test return value */
-    graphic_save_color_scheme(&buffer);
-
-    /* Set REG on BLACK color scheme */
-    graphic_set_color_scheme(new_scheme);
-
-    /* Print tag */
-    tag_printf("[ERROR] ");
-
-    /* Restore original screen color scheme */
-    graphic_set_color_scheme(buffer);
-
-    /* Printf format string */
     __builtin_va_start(args, fmt);
-    kprint_fmt(fmt, args);
+    output_message(KERNEL_OUTPUT_LEVEL_ERROR, fmt, &args);
     __builtin_va_end(args);
 }
 
 void kernel_success(const char* fmt, ...)
 {
-    __builtin_va_list    args;
-    colorscheme_t        buffer;
-    colorscheme_t        new_scheme;
+    __builtin_va_list args;
 
     if(fmt == NULL)
     {
         return;
     }
 
-    new_scheme.foreground = FG_GREEN;
-    new_scheme.background = BG_BLACK;
-    new_scheme.vga_color  = 1;
-
-    current_output.putc = graphic_put_char;
-    current_output.puts = graphic_put_string;
-
-    /* No need to test return value */
-    graphic_save_color_scheme(&buffer);
-
-    /* Set REG on BLACK color scheme */
-    graphic_set_color_scheme(new_scheme);
-
-    /* Print tag */
-    tag_printf("[OK] ");
-
-    /* Restore original screen color scheme */
-    graphic_set_color_scheme(buffer);
-
-    /* Printf format string */
     __builtin_va_start(args, fmt);
-    kprint_fmt(fmt, args);
+    output_message(KERNEL_OUTPUT_LEVEL_SUCCESS, fmt, &args);
     __builtin_va_end(args);
 }
 
 void kernel_info(const char* fmt, ...)
 {
-    __builtin_va_list    args;
-    colorscheme_t        buffer;
-    colorscheme_t        new_scheme;
+    __builtin_va_list args;
 
     if(fmt == NULL)
     {
         return;
     }
 
-    new_scheme.foreground = FG_CYAN;
-    new_scheme.background = BG_BLACK;
-    new_scheme.vga_color  = 1;
+    __builtin_va_start(args, fmt);
+    output_message(KERNEL_OUTPUT_LEVEL_INFO, fmt, &args);
+    __builtin_va_end(args);
+}
 
-    current_output.putc = graphic_put_char;
-    current_output.puts = graphic_put_string;
+void kernel_debug(const char* fmt, ...)
+{
+    __builtin_va_list args;
 
-    /* No need to test return value */
-    graphic_save_color_scheme(&buffer);
+    if(fmt == NULL)
+    {
+        return;
+    }
 
-    /* Set REG on BLACK color scheme */
-    graphic_set_color_scheme(new_scheme);
+    __builtin_va_start(args, fmt);
+    output_message(KERNEL_OUTPUT_LEVEL_DEBUG, fmt, &args);
+    __builtin_va_end(args);
+}
 
-    /* Print tag */
-    tag_printf("[INFO] ");
+void kernel_serial_debug(const char* fmt, ...)
+{
+    __builtin_va_list args;
 
-    /* Restore original screen color scheme */
-    graphic_set_color_scheme(buffer);
+    if(fmt == NULL)
+    {
+        return;
+    }
 
-    /* Printf format string */
     __builtin_va_start(args, fmt);
-    kprint_fmt(fmt, args);
+    output_message(KERNEL_OUTPUT_LEVEL_SERIAL_DEBUG, fmt, &args);
     __builtin_va_end(args);
 }
 
-void kernel_debug(const char* fmt, ...)
+void kernel_doprint(const char* str, __builtin_va_list args)
 {
-    __builtin_va_list    args;
-    colorscheme_t        buffer;
-    colorscheme_t        new_scheme;
+    format_args_t format_args;
 
-    if(fmt == NULL)
+    if(str == NULL)
     {
         return;
     }
 
-    new_scheme.foreground = FG_YELLOW;
-    new_scheme.background = BG_BLACK;
-    new_scheme.vga_color  = 1;
+    /* The format string may not outlive the call, flush the pending records
+     * and output immediately.
+     */
+    if(output_deferred != 0)
+    {
+        kernel_output_flush();
+    }
 
-    current_output.putc = graphic_put_char;
-    current_output.puts = graphic_put_string;
+    format_args.list   = &args;
+    format_args.packed = NULL;
+    format_args.size   = 0;
+    format_args.offset = 0;
 
-    /* No need to test return value */
-    graphic_save_color_scheme(&buffer);
+    output_write(KERNEL_OUTPUT_LEVEL_PRINTF, str, &format_args);
+}
 
-    /* Set REG on BLACK color scheme */
-    graphic_set_color_scheme(new_scheme);
+OS_RETURN_E kernel_output_init(void)
+{
+    OS_RETURN_E err;
 
-    /* Print tag */
-    tag_printf("[DEBUG] ");
+    err = sched_create_kernel_thread(NULL, KERNEL_OUTPUT_THREAD_PRIORITY,
+                                     "klog_flush",
+                                     KERNEL_OUTPUT_THREAD_STACK_SIZE,
+                                     0, output_flusher, NULL);
+    if(err != OS_NO_ERR)
+    {
+        return err;
+    }
 
-    /* Restore original screen color scheme */
-    graphic_set_color_scheme(buffer);
+    output_flusher_started = 1;
 
-    /* Printf format string */
-    __builtin_va_start(args, fmt);
-    kprint_fmt(fmt, args);
-    __builtin_va_end(args);
+#if KERNEL_OUTPUT_DEFERRED == 1 && TEST_MODE_ENABLED == 0
+    output_deferred = 1;
+#endif
+
+    return OS_NO_ERR;
 }
 
-void kernel_serial_debug(const char* fmt, ...)
+OS_RETURN_E kernel_output_set_deferred(const uint32_t enabled)
 {
-    __builtin_va_list args;
+    if(enabled != 0)
+    {
+        if(output_flusher_started == 0)
+        {
+            return OS_ERR_UNAUTHORIZED_ACTION;
+        }
+        output_deferred = 1;
+        return OS_NO_ERR;
+    }
 
-    if(fmt == NULL)
+    output_deferred = 0;
+    kernel_output_flush();
+
+    return OS_NO_ERR;
+}
+
+void kernel_output_flush(void)
+{
+    /* Single consumer */
+    if(__atomic_exchange_n(&output_flushing, 1, __ATOMIC_ACQUIRE) != 0)
     {
         return;
     }
 
-    __builtin_va_start(args, fmt);
-    kprint_fmt_serial("[DEBUG] ", args);
+    output_drain();
 
-    kprint_fmt_serial(fmt, args);
-    __builtin_va_end(args);
+    __atomic_store_n(&output_flushing, 0, __ATOMIC_RELEASE);
+}
 
+void kernel_output_panic_flush(void)
+{
+    /* A flush interrupted by the panic never completes, the rings are drained
+     * regardless of the consumer flag.
+     */
+    output_deferred = 0;
+    output_drain();
 }
 
-void kernel_doprint(const char* str, __builtin_va_list args)
+OS_RETURN_E kernel_output_get_stats(kernel_output_stats_t* stats)
 {
-    if(str == NULL)
+    uint32_t i;
+
+    if(stats == NULL)
     {
-        return;
+        return OS_ERR_NULL_POINTER;
     }
 
-    current_output.putc = graphic_put_char;
-    current_output.puts = graphic_put_string;
-    kprint_fmt(str, args);
+    stats->logged  = 0;
+    stats->lost    = 0;
+    stats->flushed = output_flushed;
+    for(i = 0; i < MAX_CPU_COUNT; ++i)
+    {
+        stats->logged += output_rings[i].logged;
+        stats->lost   += output_rings[i].lost;
+    }
+
+    return OS_NO_ERR;
 }
@@ -0,0 +1,150 @@
+/*******************************************************************************
+ * @file scrollback.c
+ *
+ * @see scrollback.h
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Console scrollback history.
+ *
+ * @details Console scrollback history. Only one console driver is active at a
+ * time, the history is shared by the drivers.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#include <lib/stdint.h>    /* Generic int types */
+#include <lib/stddef.h>    /* Standard definitions */
+#include <lib/string.h>    /* memcpy */
+#include <sync/critical.h> /* Critical sections */
+
+/* UTK configuration file */
+#include <config.h>
+
+/* Header file */
+#include <io/scrollback.h>
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************/
+
+/** @brief History lines cells. */
+static scrollback_cell_t lines[SCROLLBACK_LINE_COUNT][SCROLLBACK_LINE_SIZE];
+/** @brief History lines sizes. */
+static uint32_t          line_sizes[SCROLLBACK_LINE_COUNT];
+/** @brief Index of the next line to write. */
+static uint32_t          head  = 0;
+/** @brief Number of valid lines. */
+static uint32_t          count = 0;
+
+#if MAX_CPU_COUNT > 1
+/** @brief History lock. */
+static spinlock_t scrollback_lock = SPINLOCK_INIT_VALUE;
+#endif
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+void scrollback_push(const scrollback_cell_t* cells, const uint32_t size)
+{
+    uint32_t int_state;
+    uint32_t line_size;
+    uint32_t index;
+
+    if(cells == NULL)
+    {
+        return;
+    }
+
+    line_size = size > SCROLLBACK_LINE_SIZE ? SCROLLBACK_LINE_SIZE : size;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &scrollback_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    index = head;
+    head  = (head + 1) % SCROLLBACK_LINE_COUNT;
+    memcpy(lines[index], cells, line_size * sizeof(scrollback_cell_t));
+    line_sizes[index] = line_size;
+    if(count < SCROLLBACK_LINE_COUNT)
+    {
+        ++count;
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &scrollback_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+}
+
+OS_RETURN_E scrollback_get_line(const uint32_t index, scrollback_cell_t* cells,
+                                uint32_t* size)
+{
+    uint32_t    int_state;
+    uint32_t    line;
+    OS_RETURN_E err;
+
+    if(cells == NULL || size == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &scrollback_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    if(index < count)
+    {
+        line  = (head + SCROLLBACK_LINE_COUNT - 1 - index) %
+                SCROLLBACK_LINE_COUNT;
+        *size = line_sizes[line];
+        memcpy(cells, lines[line], *size * sizeof(scrollback_cell_t));
+        err = OS_NO_ERR;
+    }
+    else
+    {
+        err = OS_ERR_OUT_OF_BOUND;
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &scrollback_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return err;
+}
+
+uint32_t scrollback_get_count(void)
+{
+    return count;
+}
+
+void scrollback_clear(void)
+{
+    uint32_t int_state;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &scrollback_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    count = 0;
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &scrollback_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+}
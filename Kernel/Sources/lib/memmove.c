@@ -28,7 +28,7 @@ void *memmove(void *dst, const void *src, size_t n)
     } else {
         p += (n - 1);
         q += (n - 1);
-        __asm__ __volatile__("std ; rep ; movsb"
+        __asm__ __volatile__("std ; rep ; movsb ; cld"
                  : "+c" (n), "+S"(p), "+D"(q));
     }
 #else
@@ -143,6 +143,9 @@ divide your request into mulstiple read/write");
         case OS_ERR_KERNEL_MEM_OFFSET_UNALIGNED:
             printf("Kernel alignment error");
             break;
+        case OS_ERR_TIMEOUT:
+            printf("Operation timed out");
+            break;
         default:
             printf("Unknown error");
     }
@@ -25,6 +25,7 @@
 #include <lib/string.h>       /* memset */
 #include <io/kernel_output.h> /* kernel_success */
 #include <sync/critical.h>    /* Critical sections */
+#include <core/trace.h>       /* Trace events */
 
 /* UTK configuration file */
 #include <config.h>
@@ -425,12 +426,7 @@ void* kmalloc(size_t size)
     mem_free -= size2;
     kheap_mem_used += size2 - len - HEADER_SIZE;
 
-#if KHEAP_KERNEL_DEBUG == 1
-    kernel_serial_debug("Kheap allocated 0x%p -> %uB (%uB free, %uB used)\n",
-                        chunk->data,
-                        size2 - len - HEADER_SIZE,
-                        mem_free, kheap_mem_used);
-#endif
+    TRACE(TRACE_KHEAP_ALLOC, chunk->data, size, size2 - len - HEADER_SIZE, 0);
 
 #if MAX_CPU_COUNT > 1
     EXIT_CRITICAL(int_state, &lock);
@@ -492,9 +488,7 @@ void kfree(void* ptr)
 		push_free(chunk);
     }
 
-#if KHEAP_KERNEL_DEBUG == 1
-    kernel_serial_debug("Kheap freed 0x%p -> %uB\n", ptr, used);
-#endif
+    TRACE(TRACE_KHEAP_FREE, ptr, used, 0, 0);
 
 #if MAX_CPU_COUNT > 1
     EXIT_CRITICAL(int_state, &lock);
@@ -0,0 +1,200 @@
+/*******************************************************************************
+ * @file barrier.c
+ *
+ * @see barrier.h
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Barrier synchronization primitive.
+ *
+ * @details Reusable barrier synchronization primitive. A barrier blocks the
+ * threads that reach it until a given number of threads, possibly running on
+ * different CPUs, reached it. The barrier is then released and can be used
+ * again for the next round. The waiting threads sleep on the barrier generation
+ * futex word.
+ *
+ * @warning Barriers can only be used when the current system is running and
+ * the scheduler initialized.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#include <lib/stddef.h>       /* Standard definitions */
+#include <lib/stdint.h>       /* Generic int types */
+#include <lib/string.h>       /* String manipulation */
+#include <core/scheduler.h>   /* Kernel scheduler */
+#include <io/kernel_output.h> /* Kernel output methods */
+#include <core/panic.h>       /* Kernel panic */
+#include <sync/critical.h>    /* Critical sections */
+#include <sync/futex.h>       /* Futex wait / wake */
+
+/* UTK configuration file */
+#include <config.h>
+
+/* Header file */
+#include <sync/barrier.h>
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+OS_RETURN_E barrier_init(barrier_t* barrier, const uint32_t count)
+{
+    if(barrier == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+    if(count == 0)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+
+    memset(barrier, 0, sizeof(barrier_t));
+
+    barrier->count = count;
+
+#if MAX_CPU_COUNT > 1
+    INIT_SPINLOCK(&barrier->lock);
+#endif
+
+    barrier->init = 1;
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E barrier_destroy(barrier_t* barrier)
+{
+    OS_RETURN_E err;
+    uint32_t    int_state;
+
+    if(barrier == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &barrier->lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    if(barrier->init != 1)
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &barrier->lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+        return OS_ERR_BARRIER_UNINITIALIZED;
+    }
+
+    /* Changing the generation releases the waiting threads and makes the
+     * threads that are about to wait fail their futex value check.
+     */
+    barrier->init = 0;
+    ++barrier->generation;
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &barrier->lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    err = futex_wake(&barrier->generation, FUTEX_WAKE_ALL, NULL);
+    if(err != OS_NO_ERR)
+    {
+        kernel_error("Could not unlock threads from barrier[%d]\n", err);
+        kernel_panic(err);
+    }
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E barrier_wait(barrier_t* barrier)
+{
+    OS_RETURN_E err;
+    int32_t     generation;
+    uint32_t    woken;
+    uint32_t    int_state;
+
+    if(barrier == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &barrier->lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    if(barrier->init != 1)
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &barrier->lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+        return OS_ERR_BARRIER_UNINITIALIZED;
+    }
+
+    generation = barrier->generation;
+
+    /* Last thread to arrive, release the others */
+    if(++barrier->arrived == barrier->count)
+    {
+        barrier->arrived = 0;
+        ++barrier->generation;
+
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &barrier->lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+
+        err = futex_wake(&barrier->generation, FUTEX_WAKE_ALL, &woken);
+        if(err != OS_NO_ERR)
+        {
+            kernel_error("Could not unlock threads from barrier[%d]\n", err);
+            kernel_panic(err);
+        }
+
+        if(woken != 0)
+        {
+            sched_schedule();
+        }
+
+        return OS_NO_ERR;
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &barrier->lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    /* Sleep until the generation changes */
+    while(barrier->generation == generation)
+    {
+        err = futex_wait(&barrier->generation, generation);
+        if(err != OS_NO_ERR && err != OS_FUTEX_VALUE_MISMATCH)
+        {
+            return err;
+        }
+    }
+
+    if(barrier->init != 1)
+    {
+        return OS_ERR_BARRIER_UNINITIALIZED;
+    }
+
+    return OS_NO_ERR;
+}
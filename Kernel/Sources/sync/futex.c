@@ -0,0 +1,285 @@
+/*******************************************************************************
+ * @file futex.c
+ *
+ * @see futex.h
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Address keyed wait / wake synchronization primitive.
+ *
+ * @details Address keyed wait / wake synchronization primitive. A thread can
+ * wait on the address of a 32 bits word as long as the word contains an
+ * expected value, and other threads can wake the threads waiting on that
+ * address. The waiting threads are stored in a global hashed table of wait
+ * queues, the synchronization objects built on top of the futex only need to
+ * store their state in a single word and do not allocate any memory.
+ *
+ * @warning Futexes can only be used when the current system is running and the
+ * scheduler initialized.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#include <lib/stddef.h>        /* Standard definitions */
+#include <lib/stdint.h>        /* Generic int types */
+#include <lib/string.h>        /* String manipulation */
+#include <core/kernel_queue.h> /* Kernel queues */
+#include <core/scheduler.h>    /* Kernel scheduler */
+#include <io/kernel_output.h>  /* Kernel output methods */
+#include <core/panic.h>        /* Kernel panic */
+#include <sync/critical.h>     /* Critical sections */
+#include <core/trace.h>        /* Trace events */
+
+/* UTK configuration file */
+#include <config.h>
+
+/* Header file */
+#include <sync/futex.h>
+
+/*******************************************************************************
+ * STRUCTURES
+ ******************************************************************************/
+
+/** @brief Futex waiter record, lives on the waiting thread's stack. */
+struct futex_waiter
+{
+    /** @brief Address the thread is waiting on. */
+    volatile int32_t* addr;
+
+    /** @brief Scheduler node of the waiting thread. */
+    kernel_queue_node_t* thread_node;
+
+    /** @brief Block type the thread was locked with. */
+    THREAD_WAIT_TYPE_E block_type;
+};
+
+/**
+ * @brief Defines futex_waiter_t type as a shorcut for struct futex_waiter.
+ */
+typedef struct futex_waiter futex_waiter_t;
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************/
+
+/** @brief Futex global wait table. */
+static futex_bucket_t futex_table[FUTEX_HASH_TABLE_SIZE];
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Returns the wait table bucket of an address.
+ *
+ * @details Returns the wait table bucket of an address. The address is hashed
+ * with a multiplicative hash, the two lowest bits are ignored since futex words
+ * are 32 bits aligned.
+ *
+ * @param[in] addr The address to hash.
+ *
+ * @return The bucket that stores the waiters of the address.
+ */
+__inline__ static futex_bucket_t* futex_get_bucket(volatile int32_t* addr)
+{
+    uint32_t hash;
+
+    hash = ((uint32_t)(uintptr_t)addr >> 2) * 0x9E3779B1;
+
+    return &futex_table[hash >> (32 - FUTEX_HASH_TABLE_BITS)];
+}
+
+OS_RETURN_E futex_init(void)
+{
+    uint32_t i;
+
+    memset(futex_table, 0, sizeof(futex_table));
+
+    for(i = 0; i < FUTEX_HASH_TABLE_SIZE; ++i)
+    {
+        kernel_queue_init_queue(&futex_table[i].waiters);
+#if MAX_CPU_COUNT > 1
+        INIT_SPINLOCK(&futex_table[i].lock);
+#endif
+    }
+
+#if FUTEX_KERNEL_DEBUG == 1
+    kernel_serial_debug("Futex table initialized\n");
+#endif
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E futex_wait(volatile int32_t* addr, const int32_t value)
+{
+    return futex_wait_type(addr, value, THREAD_WAIT_TYPE_FUTEX);
+}
+
+OS_RETURN_E futex_wait_type(volatile int32_t* addr, const int32_t value,
+                            const THREAD_WAIT_TYPE_E block_type)
+{
+    futex_bucket_t*     bucket;
+    futex_waiter_t      waiter;
+    kernel_queue_node_t waiter_node;
+    OS_RETURN_E         err;
+    uint32_t            int_state;
+
+    if(addr == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    bucket = futex_get_bucket(addr);
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &bucket->lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    /* The value check is done under the bucket lock, a waker that modifies the
+     * word before waking cannot miss us.
+     */
+    if(*addr != value)
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &bucket->lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+        return OS_FUTEX_VALUE_MISMATCH;
+    }
+
+    waiter.addr        = addr;
+    waiter.block_type  = block_type;
+    waiter.thread_node = sched_lock_thread(block_type);
+    if(waiter.thread_node == NULL)
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &bucket->lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+        return OS_ERR_UNAUTHORIZED_ACTION;
+    }
+
+    /* The waiter node stays valid on our stack until we are woken up */
+    kernel_queue_init_node(&waiter_node, &waiter);
+
+    err = kernel_queue_push(&waiter_node, &bucket->waiters);
+    if(err != OS_NO_ERR)
+    {
+#if MAX_CPU_COUNT > 1
+        EXIT_CRITICAL(int_state, &bucket->lock);
+#else
+        EXIT_CRITICAL(int_state);
+#endif
+        kernel_error("Could not enqueue thread to futex[%d]\n", err);
+        kernel_panic(err);
+    }
+
+    TRACE(TRACE_SYNC_FUTEX_WAIT, addr, value,
+          ((kernel_thread_t*)waiter.thread_node->data)->tid, 0);
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &bucket->lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    sched_schedule();
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E futex_wake(volatile int32_t* addr, const uint32_t count,
+                       uint32_t* woken)
+{
+    futex_bucket_t*      bucket;
+    futex_waiter_t*      waiter;
+    kernel_queue_node_t* cursor;
+    kernel_queue_node_t* prev;
+    kernel_queue_node_t* thread_node;
+    THREAD_WAIT_TYPE_E   block_type;
+    uint32_t             woken_count;
+    OS_RETURN_E          err;
+    uint32_t             int_state;
+
+    if(addr == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    bucket      = futex_get_bucket(addr);
+    woken_count = 0;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &bucket->lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    /* Oldest waiters are at the tail of the queue */
+    cursor = bucket->waiters.tail;
+    while(cursor != NULL && woken_count < count)
+    {
+        prev   = cursor->prev;
+        waiter = (futex_waiter_t*)cursor->data;
+
+        if(waiter->addr == addr)
+        {
+            /* The waiter record is released as soon as the thread is unlocked
+             * get everything we need before.
+             */
+            thread_node = waiter->thread_node;
+            block_type  = waiter->block_type;
+
+            err = kernel_queue_remove(&bucket->waiters, cursor);
+            if(err != OS_NO_ERR)
+            {
+#if MAX_CPU_COUNT > 1
+                EXIT_CRITICAL(int_state, &bucket->lock);
+#else
+                EXIT_CRITICAL(int_state);
+#endif
+                kernel_error("Could not dequeue thread from futex[%d]\n", err);
+                kernel_panic(err);
+            }
+
+            err = sched_unlock_thread(thread_node, block_type, 0);
+            if(err != OS_NO_ERR)
+            {
+#if MAX_CPU_COUNT > 1
+                EXIT_CRITICAL(int_state, &bucket->lock);
+#else
+                EXIT_CRITICAL(int_state);
+#endif
+                kernel_error("Could not unlock thread from futex[%d]\n", err);
+                kernel_panic(err);
+            }
+
+            ++woken_count;
+        }
+
+        cursor = prev;
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &bucket->lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    TRACE(TRACE_SYNC_FUTEX_WAKE, addr, count, woken_count, 0);
+
+    if(woken != NULL)
+    {
+        *woken = woken_count;
+    }
+
+    return OS_NO_ERR;
+}
@@ -27,11 +27,12 @@
 #include <lib/stddef.h>        /* Standard definitions */
 #include <lib/stdint.h>        /* Generic int types */
 #include <lib/string.h>        /* String manipulation */
-#include <core/kernel_queue.h> /* Kernel queues */
 #include <core/scheduler.h>    /* Kernel scheduler */
 #include <io/kernel_output.h>  /* Kernel output methods */
 #include <core/panic.h>        /* Kernel panic */
 #include <sync/critical.h>     /* Critical sections */
+#include <sync/futex.h>        /* Futex wait / wake */
+#include <core/trace.h>        /* Trace events */
 
 /* UTK configuration file */
 #include <config.h>
@@ -50,8 +51,6 @@
 OS_RETURN_E mutex_init(mutex_t* mutex, const uint32_t flags,
                        const uint16_t priority)
 {
-    OS_RETURN_E err;
-
     if(mutex == NULL)
     {
         return OS_ERR_NULL_POINTER;
@@ -74,12 +73,6 @@ OS_RETURN_E mutex_init(mutex_t* mutex, const uint32_t flags,
     INIT_SPINLOCK(&mutex->lock);
 #endif
 
-    mutex->waiting_threads = kernel_queue_create_queue(&err);
-    if(err != OS_NO_ERR)
-    {
-        return err;
-    }
-
     mutex->init = 1;
 
 #if MUTEX_KERNEL_DEBUG == 1
@@ -91,9 +84,8 @@ OS_RETURN_E mutex_init(mutex_t* mutex, const uint32_t flags,
 
 OS_RETURN_E mutex_destroy(mutex_t* mutex)
 {
-    kernel_queue_node_t* node;
-    OS_RETURN_E          err;
-    uint32_t             int_state;
+    OS_RETURN_E err;
+    uint32_t    int_state;
 
     /* Check if mutex is initialized */
     if(mutex == NULL)
@@ -117,70 +109,38 @@ OS_RETURN_E mutex_destroy(mutex_t* mutex)
         return OS_ERR_MUTEX_UNINITIALIZED;
     }
 
-    /* Unlock all threads */
-    while((node = kernel_queue_pop(mutex->waiting_threads, &err))
-        != NULL)
-    {
-        if(err != OS_NO_ERR)
-        {
-#if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &mutex->lock);
-#else
-            EXIT_CRITICAL(int_state);
-#endif
-            kernel_error("Could not dequeue thread from mutex[%d]\n", err);
-            kernel_panic(err);
-        }
+    mutex->init = 0;
+
+    /* Threads only wait while the mutex is locked, releasing it makes the
+     * threads that are about to wait fail their futex value check.
+     */
+    mutex->state = 1;
 
-        err = sched_unlock_thread(node, THREAD_WAIT_TYPE_MUTEX, 0);
-        if(err != OS_NO_ERR)
-        {
 #if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &mutex->lock);
+    EXIT_CRITICAL(int_state, &mutex->lock);
 #else
-            EXIT_CRITICAL(int_state);
+    EXIT_CRITICAL(int_state);
 #endif
-            kernel_error("Could not unlock thread from mutex[%d]\n", err);
-            kernel_panic(err);
-        }
 
-#if MUTEX_KERNEL_DEBUG == 1
-        kernel_serial_debug("Mutex 0x%p unlocked thead %d\n",
-                            mutex,
-                            ((kernel_thread_t*)node->data)->tid);
-#endif
-    }
+    /* Unlock all threads */
+    err = futex_wake(&mutex->state, FUTEX_WAKE_ALL, NULL);
     if(err != OS_NO_ERR)
     {
-#if MAX_CPU_COUNT > 1
-        EXIT_CRITICAL(int_state, &mutex->lock);
-#else
-        EXIT_CRITICAL(int_state);
-#endif
-        kernel_error("Could not dequeue thread from mutex[%d]\n", err);
+        kernel_error("Could not unlock threads from mutex[%d]\n", err);
         kernel_panic(err);
     }
 
-
-    err = kernel_queue_delete_queue(&mutex->waiting_threads);
-    mutex->init = 0;
-
 #if MUTEX_KERNEL_DEBUG == 1
     kernel_serial_debug("Mutex 0x%p destroyed\n", mutex);
 #endif
 
-#if MAX_CPU_COUNT > 1
-    EXIT_CRITICAL(int_state, &mutex->lock);
-#else
-    EXIT_CRITICAL(int_state);
-#endif
-
     return OS_NO_ERR;
 }
 
 OS_RETURN_E mutex_pend(mutex_t* mutex)
 {
     OS_RETURN_E err;
+    int32_t     state;
     uint32_t    prio;
     uint32_t    int_state;
 
@@ -212,8 +172,6 @@ OS_RETURN_E mutex_pend(mutex_t* mutex)
     while(mutex->init == 1 &&
           mutex->state != 1)
     {
-        kernel_queue_node_t* active_thread;
-
         /* If the mutex is recursive and the thread acuired the mutex,
          * then don't block the thread
          */
@@ -223,36 +181,9 @@ OS_RETURN_E mutex_pend(mutex_t* mutex)
             break;
         }
 
-        active_thread = sched_lock_thread(THREAD_WAIT_TYPE_MUTEX);
-        if(active_thread == NULL)
-        {
-#if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &mutex->lock);
-#else
-            EXIT_CRITICAL(int_state);
-#endif
-            kernel_error("Could not lock this thread to mutex[%d]\n",
-                         OS_ERR_NULL_POINTER);
-            kernel_panic(OS_ERR_NULL_POINTER);
-        }
+        state = mutex->state;
 
-        err = kernel_queue_push(active_thread, mutex->waiting_threads);
-        if(err != OS_NO_ERR)
-        {
-#if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &mutex->lock);
-#else
-            EXIT_CRITICAL(int_state);
-#endif
-            kernel_error("Could not enqueue thread to mutex[%d]\n", err);
-            kernel_panic(err);
-        }
-
-#if MUTEX_KERNEL_DEBUG == 1
-        kernel_serial_debug("Mutex 0x%p locked thead %d\n",
-                            mutex,
-                            ((kernel_thread_t*)active_thread->data)->tid);
-#endif
+        TRACE(TRACE_SYNC_MUTEX_BLOCK, mutex, sched_get_tid(), 0, 0);
 
 #if MAX_CPU_COUNT > 1
         EXIT_CRITICAL(int_state, &mutex->lock);
@@ -260,7 +191,14 @@ OS_RETURN_E mutex_pend(mutex_t* mutex)
         EXIT_CRITICAL(int_state);
 #endif
 
-        sched_schedule();
+        /* Sleep until a post releases the mutex */
+        err = futex_wait_type(&mutex->state, state,
+                              THREAD_WAIT_TYPE_MUTEX);
+        if(err != OS_NO_ERR && err != OS_FUTEX_VALUE_MISMATCH)
+        {
+            kernel_error("Could not lock this thread to mutex[%d]\n", err);
+            kernel_panic(err);
+        }
 
 #if MAX_CPU_COUNT > 1
         ENTER_CRITICAL(int_state, &mutex->lock);
@@ -301,11 +239,7 @@ OS_RETURN_E mutex_pend(mutex_t* mutex)
             kernel_panic(err);
         }
     }
-#if MUTEX_KERNEL_DEBUG == 1
-    kernel_serial_debug("Mutex 0x%p aquired by thread %d\n",
-                        mutex,
-                        sched_get_tid());
-#endif
+    TRACE(TRACE_SYNC_MUTEX_ACQUIRE, mutex, mutex->locker_tid, 0, 0);
 
 #if MAX_CPU_COUNT > 1
     EXIT_CRITICAL(int_state, &mutex->lock);
@@ -318,11 +252,11 @@ OS_RETURN_E mutex_pend(mutex_t* mutex)
 
 OS_RETURN_E mutex_post(mutex_t* mutex)
 {
-    kernel_queue_node_t* node;
-    OS_RETURN_E          err;
-    uint32_t              do_sched;
-    uint32_t             prio;
-    uint32_t             int_state;
+    OS_RETURN_E err;
+    uint32_t    do_sched;
+    uint32_t    woken;
+    uint32_t    prio;
+    uint32_t    int_state;
 
     /* Check if mutex is initialized */
     if(mutex == NULL)
@@ -370,72 +304,23 @@ OS_RETURN_E mutex_post(mutex_t* mutex)
         do_sched = 1;
     }
 
-    /* Check if we can unlock a blocked thread on the mutex */
-    if((node = kernel_queue_pop(mutex->waiting_threads, &err)) != NULL)
-    {
-        if(err != OS_NO_ERR)
-        {
-#if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &mutex->lock);
-#else
-            EXIT_CRITICAL(int_state);
-#endif
-            kernel_error("Could not dequeue thread from mutex[%d]\n", err);
-            kernel_panic(err);
-        }
-
-#if MUTEX_KERNEL_DEBUG == 1
-        kernel_serial_debug("Mutex 0x%p unlocked thead %d\n",
-                            mutex,
-                            ((kernel_thread_t*)node->data)->tid);
-#endif
+    TRACE(TRACE_SYNC_MUTEX_RELEASE, mutex, sched_get_tid(), 0, 0);
 
 #if MAX_CPU_COUNT > 1
-        EXIT_CRITICAL(int_state, &mutex->lock);
+    EXIT_CRITICAL(int_state, &mutex->lock);
 #else
-        EXIT_CRITICAL(int_state);
-#endif
-
-        err = sched_unlock_thread(node, THREAD_WAIT_TYPE_MUTEX, 1);
-        if(err != OS_NO_ERR)
-        {
-            kernel_error("Could not unlock thread from mutex[%d]\n", err);
-            kernel_panic(err);
-        }
-
-#if MUTEX_KERNEL_DEBUG == 1
-        kernel_serial_debug("Mutex 0x%p released by thead %d\n",
-                            mutex,
-                            sched_get_tid());
+    EXIT_CRITICAL(int_state);
 #endif
 
-        return OS_NO_ERR;
-    }
+    /* Check if we can unlock a blocked thread on the mutex */
+    err = futex_wake(&mutex->state, 1, &woken);
     if(err != OS_NO_ERR)
     {
-#if MAX_CPU_COUNT > 1
-        EXIT_CRITICAL(int_state, &mutex->lock);
-#else
-        EXIT_CRITICAL(int_state);
-#endif
-        kernel_error("Could not dequeue thread from mutex[%d]\n", err);
+        kernel_error("Could not unlock thread from mutex[%d]\n", err);
         kernel_panic(err);
     }
 
-#if MUTEX_KERNEL_DEBUG == 1
-    kernel_serial_debug("Mutex 0x%p released by thead %d\n",
-                        mutex,
-                        sched_get_tid());
-#endif
-
-    /* If here, we did not find any waiting process */
-#if MAX_CPU_COUNT > 1
-    EXIT_CRITICAL(int_state, &mutex->lock);
-#else
-    EXIT_CRITICAL(int_state);
-#endif
-
-    if(do_sched)
+    if(do_sched || woken != 0)
     {
         sched_schedule();
     }
@@ -0,0 +1,340 @@
+/*******************************************************************************
+ * @file rcu.c
+ *
+ * @see rcu.h
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Quiescent state based read-copy-update.
+ *
+ * @details Quiescent state based read-copy-update (RCU) implementation. Readers
+ * access the shared structures without taking any lock, writers unpublish the
+ * data and defer its release until a grace period elapsed. A grace period is
+ * over once every CPU that runs the scheduler went through the scheduler
+ * interrupt, which is a quiescent state since RCU readers run with interrupts
+ * disabled.
+ *
+ * @warning A reader must never block nor call the scheduler while in a read
+ * side critical section.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#include <lib/stddef.h>       /* Standard definitions */
+#include <lib/stdint.h>       /* Generic int types */
+#include <io/kernel_output.h> /* Kernel output methods */
+#include <core/panic.h>       /* Kernel panic */
+#include <sync/critical.h>    /* Critical sections */
+#include <sync/futex.h>       /* Futex wait / wake */
+
+/* UTK configuration file */
+#include <config.h>
+
+/* Header file */
+#include <sync/rcu.h>
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************/
+
+/** @brief Deferred callbacks list head, oldest callback first. */
+static rcu_head_t* rcu_cb_head = NULL;
+/** @brief Deferred callbacks list tail. */
+static rcu_head_t* rcu_cb_tail = NULL;
+/** @brief Number of deferred callbacks not executed yet. */
+static volatile uint32_t rcu_cb_count = 0;
+
+/**
+ * @brief Number of completed grace periods. This is also the futex word the
+ * threads waiting in rcu_synchronize wait on.
+ */
+static volatile int32_t rcu_gp_completed = 0;
+/** @brief Last grace period number that was requested. */
+static volatile uint32_t rcu_gp_requested = 0;
+/** @brief Tells if a grace period is in progress. */
+static volatile uint32_t rcu_gp_in_progress = 0;
+/** @brief CPUs that did not report a quiescent state for the current period. */
+static volatile uint32_t rcu_gp_pending_mask = 0;
+/** @brief CPUs that run the scheduler and take part in the grace periods. */
+static volatile uint32_t rcu_online_mask = 0;
+
+#if MAX_CPU_COUNT > 1
+/** @brief Critical section spinlock. */
+static spinlock_t rcu_lock = SPINLOCK_INIT_VALUE;
+#endif
+
+/*******************************************************************************
+ * FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * @brief Tells if a grace period is completed.
+ *
+ * @param[in] target The grace period number to check.
+ *
+ * @return 1 if the grace period is completed, 0 otherwise.
+ */
+__inline__ static int32_t rcu_gp_done(const uint32_t target)
+{
+    return (int32_t)((uint32_t)rcu_gp_completed - target) >= 0;
+}
+
+/**
+ * @brief Starts a new grace period.
+ *
+ * @details Starts a new grace period, all the online CPUs will have to report a
+ * quiescent state. The RCU lock must be held by the caller.
+ */
+__inline__ static void rcu_start_gp(void)
+{
+    rcu_gp_in_progress  = 1;
+    rcu_gp_pending_mask = rcu_online_mask;
+
+#if RCU_KERNEL_DEBUG == 1
+    kernel_serial_debug("RCU grace period %u started\n",
+                        (uint32_t)rcu_gp_completed + 1);
+#endif
+}
+
+/**
+ * @brief Requests a grace period that starts after the call.
+ *
+ * @details Requests a grace period that starts after the call and returns its
+ * number. When a grace period is already in progress, it may have started
+ * before the caller unpublished its data, the next one is requested. The RCU
+ * lock must be held by the caller.
+ *
+ * @return The number of the grace period to wait for.
+ */
+static uint32_t rcu_request_gp(void)
+{
+    uint32_t target;
+
+    target = (uint32_t)rcu_gp_completed + (rcu_gp_in_progress != 0 ? 2 : 1);
+
+    if((int32_t)(target - rcu_gp_requested) > 0)
+    {
+        rcu_gp_requested = target;
+    }
+    if(rcu_gp_in_progress == 0)
+    {
+        rcu_start_gp();
+    }
+
+    return target;
+}
+
+OS_RETURN_E call_rcu(rcu_head_t* head, void (*func)(rcu_head_t*))
+{
+    uint32_t int_state;
+
+    if(head == NULL || func == NULL)
+    {
+        return OS_ERR_NULL_POINTER;
+    }
+
+    head->func = func;
+    head->next = NULL;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &rcu_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    head->gp_target = rcu_request_gp();
+
+    if(rcu_cb_tail == NULL)
+    {
+        rcu_cb_head = head;
+    }
+    else
+    {
+        rcu_cb_tail->next = head;
+    }
+    rcu_cb_tail = head;
+    ++rcu_cb_count;
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &rcu_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    return OS_NO_ERR;
+}
+
+OS_RETURN_E rcu_synchronize(void)
+{
+    OS_RETURN_E err;
+    uint32_t    target;
+    int32_t     seen;
+    uint32_t    int_state;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &rcu_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    target = rcu_request_gp();
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &rcu_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    while(rcu_gp_done(target) == 0)
+    {
+        seen = rcu_gp_completed;
+        if(rcu_gp_done(target) != 0)
+        {
+            break;
+        }
+
+        err = futex_wait(&rcu_gp_completed, seen);
+        if(err != OS_NO_ERR && err != OS_FUTEX_VALUE_MISMATCH)
+        {
+            return err;
+        }
+    }
+
+    rcu_process_callbacks();
+
+    return OS_NO_ERR;
+}
+
+void rcu_report_qs(const int32_t cpu_id)
+{
+    OS_RETURN_E err;
+    uint32_t    cpu_mask;
+    uint32_t    completed;
+    uint32_t    int_state;
+
+    cpu_mask = 1 << cpu_id;
+
+    /* Nothing to report, this is the path taken on most schedules */
+    if((rcu_online_mask & cpu_mask) != 0 &&
+       (rcu_gp_pending_mask & cpu_mask) == 0)
+    {
+        return;
+    }
+
+    completed = 0;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &rcu_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    rcu_online_mask |= cpu_mask;
+
+    if(rcu_gp_in_progress != 0)
+    {
+        rcu_gp_pending_mask &= ~cpu_mask;
+        if(rcu_gp_pending_mask == 0)
+        {
+            ++rcu_gp_completed;
+            rcu_gp_in_progress = 0;
+            completed          = 1;
+
+#if RCU_KERNEL_DEBUG == 1
+            kernel_serial_debug("RCU grace period %u completed\n",
+                                (uint32_t)rcu_gp_completed);
+#endif
+
+            if(rcu_gp_done(rcu_gp_requested) == 0)
+            {
+                rcu_start_gp();
+            }
+        }
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &rcu_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    if(completed != 0)
+    {
+        err = futex_wake(&rcu_gp_completed, FUTEX_WAKE_ALL, NULL);
+        if(err != OS_NO_ERR)
+        {
+            kernel_error("Could not wake RCU waiting threads[%d]\n", err);
+            kernel_panic(err);
+        }
+    }
+}
+
+void rcu_process_callbacks(void)
+{
+    rcu_head_t* list;
+    rcu_head_t* last;
+    rcu_head_t* next;
+    uint32_t    int_state;
+
+    if(rcu_cb_head == NULL)
+    {
+        return;
+    }
+
+    last = NULL;
+
+#if MAX_CPU_COUNT > 1
+    ENTER_CRITICAL(int_state, &rcu_lock);
+#else
+    ENTER_CRITICAL(int_state);
+#endif
+
+    /* Grace period targets never decrease along the list, the ready callbacks
+     * are the head of the list.
+     */
+    list = rcu_cb_head;
+    while(rcu_cb_head != NULL && rcu_gp_done(rcu_cb_head->gp_target) != 0)
+    {
+        last        = rcu_cb_head;
+        rcu_cb_head = rcu_cb_head->next;
+        --rcu_cb_count;
+    }
+    if(rcu_cb_head == NULL)
+    {
+        rcu_cb_tail = NULL;
+    }
+
+#if MAX_CPU_COUNT > 1
+    EXIT_CRITICAL(int_state, &rcu_lock);
+#else
+    EXIT_CRITICAL(int_state);
+#endif
+
+    if(last == NULL)
+    {
+        return;
+    }
+    last->next = NULL;
+
+    /* The callback may release the head, get the next one before calling it */
+    while(list != NULL)
+    {
+        next = list->next;
+
+#if RCU_KERNEL_DEBUG == 1
+        kernel_serial_debug("RCU callback 0x%p called\n", list);
+#endif
+
+        list->func(list);
+        list = next;
+    }
+}
+
+uint32_t rcu_get_pending_count(void)
+{
+    return rcu_cb_count;
+}
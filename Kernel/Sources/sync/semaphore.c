@@ -24,11 +24,12 @@
 #include <lib/stddef.h>        /* Standard definitions */
 #include <lib/stdint.h>        /* Generic int types */
 #include <lib/string.h>        /* String manipulation */
-#include <core/kernel_queue.h> /* Kernel queues */
 #include <core/scheduler.h>    /* Kernel scheduler */
 #include <io/kernel_output.h>  /* Kernel output methods */
 #include <core/panic.h>        /* Kernel panic */
 #include <sync/critical.h>     /* Critical sections */
+#include <sync/futex.h>        /* Futex wait / wake */
+#include <core/trace.h>        /* Trace events */
 
 /* UTK configuration file */
 #include <config.h>
@@ -46,7 +47,6 @@
 
 OS_RETURN_E sem_init(semaphore_t* sem, const int32_t init_level)
 {
-    OS_RETURN_E err;
     if(sem == NULL)
     {
         return OS_ERR_NULL_POINTER;
@@ -61,12 +61,6 @@ OS_RETURN_E sem_init(semaphore_t* sem, const int32_t init_level)
     INIT_SPINLOCK(&sem->lock);
 #endif
 
-    sem->waiting_threads = kernel_queue_create_queue(&err);
-    if(err != OS_NO_ERR)
-    {
-        return err;
-    }
-
     sem->init = 1;
 
 #if SEMAPHORE_KERNEL_DEBUG == 1
@@ -78,9 +72,8 @@ OS_RETURN_E sem_init(semaphore_t* sem, const int32_t init_level)
 
 OS_RETURN_E sem_destroy(semaphore_t* sem)
 {
-    kernel_queue_node_t* node;
-    OS_RETURN_E          err;
-    uint32_t             int_state;
+    OS_RETURN_E err;
+    uint32_t    int_state;
 
     /* Check if semaphore is initialized */
     if(sem == NULL)
@@ -106,65 +99,36 @@ OS_RETURN_E sem_destroy(semaphore_t* sem)
 
     sem->init = 0;
 
-    /* Unlock all threead*/
-    while((node = kernel_queue_pop(sem->waiting_threads, &err)) != NULL)
-    {
-        if(err != OS_NO_ERR)
-        {
-#if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &sem->lock);
-#else
-            EXIT_CRITICAL(int_state);
-#endif
-            kernel_error("Could not dequeue thread from semaphore[%d]\n", err);
-            kernel_panic(err);
-        }
-        err = sched_unlock_thread(node, THREAD_WAIT_TYPE_SEM, 0);
-        if(err != OS_NO_ERR)
-        {
+    /* Threads only wait while the level is lower than 1, changing it makes the
+     * threads that are about to wait fail their futex value check.
+     */
+    sem->sem_level = 1;
+
 #if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &sem->lock);
+    EXIT_CRITICAL(int_state, &sem->lock);
 #else
-            EXIT_CRITICAL(int_state);
+    EXIT_CRITICAL(int_state);
 #endif
-            kernel_error("Could not unlock thread from semaphore[%d]\n", err);
-            kernel_panic(err);
-        }
 
-#if SEMAPHORE_KERNEL_DEBUG == 1
-        kernel_serial_debug("Semaphore 0x%p unlocked thead %d\n",
-                            sem,
-                            ((kernel_thread_t*)node->data)->tid);
-#endif
-    }
+    /* Unlock all threead*/
+    err = futex_wake(&sem->sem_level, FUTEX_WAKE_ALL, NULL);
     if(err != OS_NO_ERR)
     {
-#if MAX_CPU_COUNT > 1
-        EXIT_CRITICAL(int_state, &sem->lock);
-#else
-        EXIT_CRITICAL(int_state);
-#endif
-        kernel_error("Could not dequeue thread from semaphore[%d]\n", err);
+        kernel_error("Could not unlock threads from semaphore[%d]\n", err);
         kernel_panic(err);
     }
 
 #if SEMAPHORE_KERNEL_DEBUG == 1
-
     kernel_serial_debug("Semaphore 0x%p destroyed\n", sem);
 #endif
 
-#if MAX_CPU_COUNT > 1
-    EXIT_CRITICAL(int_state, &sem->lock);
-#else
-    EXIT_CRITICAL(int_state);
-#endif
-
     return OS_NO_ERR;
 }
 
 OS_RETURN_E sem_pend(semaphore_t* sem)
 {
     OS_RETURN_E err;
+    int32_t     level;
     uint32_t    int_state;
 
     /* Check if semaphore is initialized */
@@ -195,38 +159,9 @@ OS_RETURN_E sem_pend(semaphore_t* sem)
     while(sem->init == 1 &&
           sem->sem_level < 1)
     {
-        kernel_queue_node_t* active_thread = sched_lock_thread(THREAD_WAIT_TYPE_SEM);
+        level = sem->sem_level;
 
-        if(active_thread == NULL)
-        {
-#if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &sem->lock);
-#else
-            EXIT_CRITICAL(int_state);
-#endif
-            kernel_error("Could not lock this thread to semaphore[%d]\n",
-                         OS_ERR_NULL_POINTER);
-            kernel_panic(OS_ERR_NULL_POINTER);
-        }
-
-        err = kernel_queue_push(active_thread, sem->waiting_threads);
-
-        if(err != OS_NO_ERR)
-        {
-#if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &sem->lock);
-#else
-            EXIT_CRITICAL(int_state);
-#endif
-            kernel_error("Could not enqueue thread from semaphore[%d]\n", err);
-            kernel_panic(err);
-        }
-
-#if SEMAPHORE_KERNEL_DEBUG == 1
-        kernel_serial_debug("Semaphore 0x%p locked thead %d\n",
-                            sem,
-                            ((kernel_thread_t*)active_thread->data)->tid);
-#endif
+        TRACE(TRACE_SYNC_SEM_BLOCK, sem, sched_get_tid(), 0, 0);
 
 #if MAX_CPU_COUNT > 1
         EXIT_CRITICAL(int_state, &sem->lock);
@@ -234,7 +169,15 @@ OS_RETURN_E sem_pend(semaphore_t* sem)
         EXIT_CRITICAL(int_state);
 #endif
 
-        sched_schedule();
+        /* Sleep until a post modifies the level */
+        err = futex_wait_type(&sem->sem_level, level,
+                              THREAD_WAIT_TYPE_SEM);
+        if(err != OS_NO_ERR && err != OS_FUTEX_VALUE_MISMATCH)
+        {
+            kernel_error("Could not lock this thread to semaphore[%d]\n",
+                         err);
+            kernel_panic(err);
+        }
 
 #if MAX_CPU_COUNT > 1
         ENTER_CRITICAL(int_state, &sem->lock);
@@ -256,11 +199,7 @@ OS_RETURN_E sem_pend(semaphore_t* sem)
     /* Decrement sem level */
     --(sem->sem_level);
 
-#if SEMAPHORE_KERNEL_DEBUG == 1
-    kernel_serial_debug("Semaphore 0x%p aquired by thead %d\n",
-                        sem,
-                        sched_get_tid());
-#endif
+    TRACE(TRACE_SYNC_SEM_ACQUIRE, sem, sched_get_tid(), sem->sem_level, 0);
 
 #if MAX_CPU_COUNT > 1
     EXIT_CRITICAL(int_state, &sem->lock);
@@ -274,6 +213,8 @@ OS_RETURN_E sem_pend(semaphore_t* sem)
 OS_RETURN_E sem_post(semaphore_t* sem)
 {
     OS_RETURN_E err;
+    int32_t     level;
+    uint32_t    woken;
     uint32_t    int_state;
 
     /* Check if semaphore is initialized */
@@ -300,93 +241,32 @@ OS_RETURN_E sem_post(semaphore_t* sem)
 
     /* Increment sem level */
     ++sem->sem_level;
+    level = sem->sem_level;
 
-    /* Check if we can unlock a blocked thread on the semaphore */
-    if(sem->sem_level > 0)
-    {
-        kernel_queue_node_t* node;
-
-        if((node = kernel_queue_pop(sem->waiting_threads, &err))
-            != NULL)
-        {
-            if(err != OS_NO_ERR)
-            {
-#if MAX_CPU_COUNT > 1
-                EXIT_CRITICAL(int_state, &sem->lock);
-#else
-                EXIT_CRITICAL(int_state);
-#endif
-                kernel_error("Could not dequeue thread from semaphore[%d]\n",
-                             err);
-                kernel_panic(err);
-            }
-
-#if SEMAPHORE_KERNEL_DEBUG == 1
-            kernel_serial_debug("Semaphore 0x%p unlocked thead %d\n",
-                                sem,
-                                ((kernel_thread_t*)node->data)->tid);
-#endif
-
-#if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &sem->lock);
-#else
-            EXIT_CRITICAL(int_state);
-#endif
+    TRACE(TRACE_SYNC_SEM_POST, sem, sched_get_tid(), level, 0);
 
-            /* Do not schedule in interrupt handlers */
-            if(kernel_interrupt_get_state() > 0)
-            {
-                err = sched_unlock_thread(node, THREAD_WAIT_TYPE_SEM, 0);
-            }
-            else
-            {
-                err = sched_unlock_thread(node, THREAD_WAIT_TYPE_SEM, 1);
-            }
-
-            if(err != OS_NO_ERR)
-            {
 #if MAX_CPU_COUNT > 1
-                EXIT_CRITICAL(int_state, &sem->lock);
+    EXIT_CRITICAL(int_state, &sem->lock);
 #else
-                EXIT_CRITICAL(int_state);
-#endif
-                kernel_error("Could not unlock thread from semaphore[%d]\n",
-                             err);
-                kernel_panic(err);
-            }
-
-#if SEMAPHORE_KERNEL_DEBUG == 1
-            kernel_serial_debug("Semaphore 0x%p released by thead %d\n",
-                                sem,
-                                sched_get_tid());
+    EXIT_CRITICAL(int_state);
 #endif
 
-            return OS_NO_ERR;
-        }
+    /* Check if we can unlock a blocked thread on the semaphore */
+    if(level > 0)
+    {
+        err = futex_wake(&sem->sem_level, 1, &woken);
         if(err != OS_NO_ERR)
         {
-#if MAX_CPU_COUNT > 1
-            EXIT_CRITICAL(int_state, &sem->lock);
-#else
-            EXIT_CRITICAL(int_state);
-#endif
-            kernel_error("Could not dequeue thread from semaphore[%d]\n", err);
+            kernel_error("Could not unlock thread from semaphore[%d]\n", err);
             kernel_panic(err);
         }
-    }
 
-#if SEMAPHORE_KERNEL_DEBUG == 1
-    kernel_serial_debug("Semaphore 0x%p released by thead %d\n",
-                        sem,
-                        sched_get_tid());
-#endif
-
-    /* If here, we did not find any waiting process */
-#if MAX_CPU_COUNT > 1
-    EXIT_CRITICAL(int_state, &sem->lock);
-#else
-    EXIT_CRITICAL(int_state);
-#endif
+        /* Do not schedule in interrupt handlers */
+        if(woken != 0 && kernel_interrupt_get_state() == 0)
+        {
+            sched_schedule();
+        }
+    }
 
     return OS_NO_ERR;
 }
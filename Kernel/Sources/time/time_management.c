@@ -25,7 +25,7 @@
 #include <lib/string.h>   /* String manipulation */
 #include <cpu_structs.h>  /* CPU structures */
 #include <cpu.h>          /* CPU management */
-#include <rtc.h>          /* rtc_update_time */
+#include <rtc.h>          /* rtc_schedule_update */
 
 /* UTK configuration file */
 #include <config.h>
@@ -269,7 +269,7 @@ void time_rtc_timer_handler(cpu_state_t* cpu_state, uintptr_t int_id,
     (void)int_id;
     (void)stack;
 
-    rtc_update_time();
+    rtc_schedule_update();
 
 #if TIME_KERNEL_DEBUG == 1
     kernel_serial_debug("Time manager RTC handler\n");
@@ -0,0 +1,31 @@
+#include <lib/stdint.h>
+#include <keyboard.h>
+#include <cpu.h>
+
+#include <Tests/test_bank.h>
+#include <Fixtures/i386/test_keyboard.h>
+
+#if KEYBOARD_TEST == 1 || DEFERRED_TEST == 1 || IRQ_AFFINITY_TEST == 1
+
+/* PS/2 controller command writing the next data byte as keyboard input */
+#define TEST_KEYBOARD_WRITE_INPUT 0xD2
+
+static void test_keyboard_wait_controller(void)
+{
+    while((cpu_inb(KEYBOARD_COMM_PORT) & 0x2) != 0);
+}
+
+void test_keyboard_inject(const uint8_t scancode)
+{
+    test_keyboard_wait_controller();
+    cpu_outb(TEST_KEYBOARD_WRITE_INPUT, KEYBOARD_COMM_PORT);
+    test_keyboard_wait_controller();
+    cpu_outb(scancode, KEYBOARD_DATA_PORT);
+}
+
+void test_keyboard_type_a(void)
+{
+    test_keyboard_inject(TEST_KEYBOARD_A_PRESS);
+    test_keyboard_inject(TEST_KEYBOARD_A_RELEASE);
+}
+#endif
@@ -0,0 +1,42 @@
+/*******************************************************************************
+ * @file test_keyboard.h
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief Keyboard input injection shared by the keyboard interrupt tests.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#ifndef __TEST_KEYBOARD_H_
+#define __TEST_KEYBOARD_H_
+
+#include <lib/stdint.h>
+
+/** @brief Scancode of the 'a' key press. */
+#define TEST_KEYBOARD_A_PRESS   0x1E
+/** @brief Scancode of the 'a' key release. */
+#define TEST_KEYBOARD_A_RELEASE 0x9E
+/** @brief Scancode of the return key press. */
+#define TEST_KEYBOARD_RETURN    0x1C
+
+/**
+ * @brief Injects a scancode as if it was sent by the keyboard.
+ *
+ * @details The PS/2 controller raises the keyboard interrupt for the injected
+ * scancode.
+ *
+ * @param[in] scancode The scancode to inject.
+ */
+void test_keyboard_inject(const uint8_t scancode);
+
+/**
+ * @brief Injects the press and the release of the 'a' key.
+ */
+void test_keyboard_type_a(void);
+
+#endif /* #ifndef __TEST_KEYBOARD_H_ */
@@ -0,0 +1,74 @@
+#include <lib/string.h>
+#include <memory/kheap.h>
+#include <Tests/test_bank.h>
+#include <Fixtures/test_ram_disk.h>
+
+#if BLOCK_TEST == 1 || BLOCK_IO_TEST == 1
+
+static OS_RETURN_E ram_read(void* device, const uint32_t sector, void* buffer,
+                            const uint32_t count)
+{
+    test_ram_disk_t* disk = device;
+
+    if(sector + count > disk->sectors)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+    memcpy(buffer, disk->data + sector * TEST_RAM_DISK_SECTOR_SIZE,
+           count * TEST_RAM_DISK_SECTOR_SIZE);
+    ++disk->reads;
+    return OS_NO_ERR;
+}
+
+static OS_RETURN_E ram_write(void* device, const uint32_t sector,
+                             const void* buffer, const uint32_t count)
+{
+    test_ram_disk_t* disk = device;
+
+    if(sector + count > disk->sectors)
+    {
+        return OS_ERR_OUT_OF_BOUND;
+    }
+    memcpy(disk->data + sector * TEST_RAM_DISK_SECTOR_SIZE, buffer,
+           count * TEST_RAM_DISK_SECTOR_SIZE);
+    ++disk->writes;
+    return OS_NO_ERR;
+}
+
+static OS_RETURN_E ram_flush(void* device)
+{
+    test_ram_disk_t* disk = device;
+
+    ++disk->flushes;
+    return OS_NO_ERR;
+}
+
+block_driver_t test_ram_disk_driver = {
+    .read  = ram_read,
+    .write = ram_write,
+    .flush = ram_flush
+};
+
+OS_RETURN_E test_ram_disk_init(test_ram_disk_t* disk, const uint32_t sectors)
+{
+    disk->data = kmalloc(sectors * TEST_RAM_DISK_SECTOR_SIZE);
+    if(disk->data == NULL)
+    {
+        return OS_ERR_MALLOC;
+    }
+    memset(disk->data, 0, sectors * TEST_RAM_DISK_SECTOR_SIZE);
+
+    disk->sectors = sectors;
+    disk->reads   = 0;
+    disk->writes  = 0;
+    disk->flushes = 0;
+
+    return OS_NO_ERR;
+}
+
+void test_ram_disk_destroy(test_ram_disk_t* disk)
+{
+    kfree(disk->data);
+    disk->data = NULL;
+}
+#endif
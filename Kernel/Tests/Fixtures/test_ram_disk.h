@@ -0,0 +1,67 @@
+/*******************************************************************************
+ * @file test_ram_disk.h
+ *
+ * @author Alexy Torres Aurora Dugo
+ *
+ * @date 18/10/2026
+ *
+ * @version 1.0
+ *
+ * @brief RAM disk block driver shared by the block layer tests.
+ *
+ * @copyright Alexy Torres Aurora Dugo
+ ******************************************************************************/
+
+#ifndef __TEST_RAM_DISK_H_
+#define __TEST_RAM_DISK_H_
+
+#include <lib/stdint.h>
+#include <lib/stddef.h>
+#include <io/block.h>
+
+/** @brief Sector size of the RAM disk. */
+#define TEST_RAM_DISK_SECTOR_SIZE 512
+
+/** @brief RAM disk state, used as the driver device. */
+struct test_ram_disk
+{
+    /** @brief Disk content. */
+    uint8_t* data;
+    /** @brief Number of sectors of the disk. */
+    uint32_t sectors;
+
+    /** @brief Number of read commands received. */
+    volatile uint32_t reads;
+    /** @brief Number of write commands received. */
+    volatile uint32_t writes;
+    /** @brief Number of flush commands received. */
+    volatile uint32_t flushes;
+};
+
+/**
+ * @brief Defines test_ram_disk_t type as a shorcut for struct test_ram_disk.
+ */
+typedef struct test_ram_disk test_ram_disk_t;
+
+/** @brief RAM disk driver, the out of bound accesses are rejected. */
+extern block_driver_t test_ram_disk_driver;
+
+/**
+ * @brief Allocates a zeroed RAM disk.
+ *
+ * @param[out] disk The disk to initialize.
+ * @param[in] sectors The number of sectors of the disk.
+ *
+ * @return OS_NO_ERR on success, OS_ERR_MALLOC if the disk could not be
+ * allocated.
+ */
+OS_RETURN_E test_ram_disk_init(test_ram_disk_t* disk, const uint32_t sectors);
+
+/**
+ * @brief Releases the memory of a RAM disk.
+ *
+ * @param[in, out] disk The disk to release.
+ */
+void test_ram_disk_destroy(test_ram_disk_t* disk);
+
+#endif /* #ifndef __TEST_RAM_DISK_H_ */
@@ -0,0 +1,149 @@
+#include <io/kernel_output.h>
+#include <core/scheduler.h>
+#include <interrupt/interrupts.h>
+#include <Tests/test_bank.h>
+#include <cpu.h>
+#include <sync/barrier.h>
+
+#if BARRIER_TEST == 1
+
+#define BARRIER_THREAD_COUNT 3
+#define BARRIER_ROUND_COUNT  3
+
+static thread_t  thread_barrier[BARRIER_THREAD_COUNT];
+static barrier_t barrier;
+
+static volatile uint32_t barrier_round[BARRIER_THREAD_COUNT + 1];
+static volatile uint32_t barrier_error;
+
+static void barrier_check_round(const uint32_t round)
+{
+    uint32_t i;
+
+    /* Nobody can be released before everybody arrived */
+    for(i = 0; i < BARRIER_THREAD_COUNT + 1; ++i)
+    {
+        if(barrier_round[i] < round)
+        {
+            barrier_error = 1;
+        }
+    }
+}
+
+void* barrier_thread(void *args)
+{
+    uint32_t id;
+    uint32_t i;
+
+    id = (uint32_t)args;
+
+    for(i = 1; i <= BARRIER_ROUND_COUNT; ++i)
+    {
+        barrier_round[id] = i;
+        if(barrier_wait(&barrier) != OS_NO_ERR)
+        {
+            barrier_error = 1;
+        }
+        barrier_check_round(i);
+    }
+
+    /* Destroying the barrier releases this one */
+    if(barrier_wait(&barrier) != OS_ERR_BARRIER_UNINITIALIZED)
+    {
+        barrier_error = 1;
+    }
+
+    return NULL;
+}
+
+void barrier_test(void)
+{
+    OS_RETURN_E err;
+    uint32_t    cpu_count;
+    uint32_t    i;
+
+    barrier_error = 0;
+    for(i = 0; i < BARRIER_THREAD_COUNT + 1; ++i)
+    {
+        barrier_round[i] = 0;
+    }
+
+    if(barrier_init(NULL, 1) == OS_ERR_NULL_POINTER &&
+       barrier_init(&barrier, 0) == OS_ERR_OUT_OF_BOUND)
+    {
+        kernel_printf("[TESTMODE] Barrier init errors OK\n");
+    }
+
+    err = barrier_init(&barrier, BARRIER_THREAD_COUNT + 1);
+    if(err != OS_NO_ERR)
+    {
+        kernel_error(" Error while initializing barrier! [%d]\n", err);
+        return;
+    }
+
+    /* Spread the threads on the CPUs */
+    cpu_count = cpu_get_booted_cpu_count();
+    for(i = 0; i < BARRIER_THREAD_COUNT; ++i)
+    {
+        err = sched_create_kernel_thread(&thread_barrier[i], 1, "barrier",
+                                         0x1000, (i + 1) % cpu_count,
+                                         barrier_thread,
+                                         (void*)i);
+        if(err != OS_NO_ERR)
+        {
+            kernel_error(" Error while creating barrier thread! [%d]\n", err);
+            return;
+        }
+    }
+
+    for(i = 1; i <= BARRIER_ROUND_COUNT; ++i)
+    {
+        /* Arrive late so the other threads have to block */
+        sched_sleep(50);
+
+        barrier_round[BARRIER_THREAD_COUNT] = i;
+        if(barrier_wait(&barrier) != OS_NO_ERR)
+        {
+            barrier_error = 1;
+        }
+        barrier_check_round(i);
+
+        if(barrier_error == 0)
+        {
+            kernel_printf("[TESTMODE] Barrier round %d OK\n", i);
+        }
+    }
+
+    /* Let the threads block again and destroy the barrier */
+    sched_sleep(50);
+    if(barrier_destroy(&barrier) == OS_NO_ERR &&
+       barrier_destroy(&barrier) == OS_ERR_BARRIER_UNINITIALIZED)
+    {
+        kernel_printf("[TESTMODE] Barrier destroy OK\n");
+    }
+
+    for(i = 0; i < BARRIER_THREAD_COUNT; ++i)
+    {
+        if((err = sched_wait_thread(thread_barrier[i], NULL, NULL)) != OS_NO_ERR)
+        {
+            kernel_error("Error while waiting thread! [%d]\n", err);
+        }
+    }
+
+    if(barrier_error == 0)
+    {
+        kernel_printf("[TESTMODE] Barrier test passed\n");
+    }
+
+    /* Kill QEMU */
+    cpu_outw(0x2000, 0x604);
+    while(1)
+    {
+        __asm__ ("hlt");
+    }
+}
+#else
+void barrier_test(void)
+{
+}
+#endif
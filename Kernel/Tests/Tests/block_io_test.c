@@ -0,0 +1,148 @@
+#include <io/kernel_output.h>
+#include <io/block_io.h>
+#include <lib/string.h>
+#include <memory/kheap.h>
+#include <sync/semaphore.h>
+#include <sync/futex.h>
+#include <Tests/test_bank.h>
+#include <Fixtures/test_ram_disk.h>
+
+#if BLOCK_IO_TEST == 1
+
+#define BLOCK_IO_TEST_SECTORS     256
+#define BLOCK_IO_TEST_REQUESTS    32
+
+/* The queue worker outlives the test function */
+static block_io_queue_t  queue;
+static test_ram_disk_t   disk;
+static volatile uint32_t callbacks;
+
+static void block_io_test_callback(block_io_request_t* request, void* args)
+{
+    if(request->status == OS_NO_ERR && args == &disk)
+    {
+        ++callbacks;
+    }
+}
+
+void block_io_test(void)
+{
+    block_io_request_t requests[BLOCK_IO_TEST_REQUESTS];
+    block_io_stats_t   stats;
+    semaphore_t        done;
+    uint8_t*           data;
+    uint32_t           i;
+    uint32_t           sector;
+    uint32_t           ok;
+    OS_RETURN_E        err;
+
+    err  = test_ram_disk_init(&disk, BLOCK_IO_TEST_SECTORS);
+    data = kmalloc(BLOCK_IO_TEST_REQUESTS * TEST_RAM_DISK_SECTOR_SIZE);
+    if(err != OS_NO_ERR || data == NULL)
+    {
+        kernel_error("Failed to allocate the RAM disk\n");
+        return;
+    }
+
+    /* Errors */
+    ok = 1;
+    ok &= block_io_queue_init(NULL, &disk, &test_ram_disk_driver,
+                              TEST_RAM_DISK_SECTOR_SIZE) == OS_ERR_NULL_POINTER;
+    ok &= block_io_queue_init(&queue, &disk, NULL,
+                              TEST_RAM_DISK_SECTOR_SIZE) == OS_ERR_NULL_POINTER;
+    ok &= block_io_queue_init(&queue, &disk, &test_ram_disk_driver, 0) ==
+          OS_ERR_OUT_OF_BOUND;
+    ok &= block_io_queue_init(&queue, &disk, &test_ram_disk_driver,
+                              TEST_RAM_DISK_SECTOR_SIZE) == OS_NO_ERR;
+    ok &= block_io_submit(&queue, NULL) == OS_ERR_NULL_POINTER;
+    ok &= block_io_sync(&queue, 0, 0, data, 0) == OS_ERR_OUT_OF_BOUND;
+    ok &= block_io_sync(&queue, 0, BLOCK_IO_TEST_SECTORS, data, 1) ==
+          OS_ERR_OUT_OF_BOUND;
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] Block I/O errors OK\n");
+    }
+    else
+    {
+        kernel_error("Block I/O wrong error codes\n");
+    }
+
+    /* Small writers submitted out of order are merged */
+    err = sem_init(&done, 0);
+    for(i = 0; i < BLOCK_IO_TEST_REQUESTS * TEST_RAM_DISK_SECTOR_SIZE; ++i)
+    {
+        data[i] = (uint8_t)(i * 3 + i / TEST_RAM_DISK_SECTOR_SIZE);
+    }
+    for(i = 0; i < BLOCK_IO_TEST_REQUESTS && err == OS_NO_ERR; ++i)
+    {
+        sector = (i * 7) % BLOCK_IO_TEST_REQUESTS;
+
+        requests[i].write    = 1;
+        requests[i].sector   = 64 + sector;
+        requests[i].count    = 1;
+        requests[i].buffer   = data + sector * TEST_RAM_DISK_SECTOR_SIZE;
+        requests[i].callback = block_io_test_callback;
+        requests[i].args     = &disk;
+        requests[i].done     = &done;
+        err = block_io_submit(&queue, &requests[i]);
+    }
+    for(i = 0; i < BLOCK_IO_TEST_REQUESTS && err == OS_NO_ERR; ++i)
+    {
+        err = sem_pend(&done);
+    }
+    /* The worker may still post the semaphore, wait for the completions */
+    for(i = 0; i < BLOCK_IO_TEST_REQUESTS && err == OS_NO_ERR; ++i)
+    {
+        while(requests[i].completed == 0)
+        {
+            futex_wait(&requests[i].completed, 0);
+        }
+    }
+    sem_destroy(&done);
+    if(err == OS_NO_ERR && callbacks == BLOCK_IO_TEST_REQUESTS &&
+       memcmp(disk.data + 64 * TEST_RAM_DISK_SECTOR_SIZE, data,
+              BLOCK_IO_TEST_REQUESTS * TEST_RAM_DISK_SECTOR_SIZE) == 0)
+    {
+        kernel_printf("[TESTMODE] Block I/O async write OK\n");
+    }
+    else
+    {
+        kernel_error("Block I/O async write failed [%d]\n", err);
+    }
+
+    err = block_io_get_stats(&queue, &stats);
+    if(err == OS_NO_ERR && stats.merged != 0 &&
+       disk.writes < BLOCK_IO_TEST_REQUESTS)
+    {
+        kernel_printf("[TESTMODE] Block I/O merge OK\n");
+    }
+    else
+    {
+        kernel_error("Block I/O merge failed (%d writes)\n", disk.writes);
+    }
+    kernel_printf("Block I/O %d requests, %d commands\n",
+                  (uint32_t)stats.submitted, (uint32_t)stats.dispatched);
+
+    /* Synchronous read */
+    memset(data, 0, BLOCK_IO_TEST_REQUESTS * TEST_RAM_DISK_SECTOR_SIZE);
+    err = block_io_sync(&queue, 0, 64, data, BLOCK_IO_TEST_REQUESTS);
+    if(err == OS_NO_ERR &&
+       memcmp(disk.data + 64 * TEST_RAM_DISK_SECTOR_SIZE, data,
+              BLOCK_IO_TEST_REQUESTS * TEST_RAM_DISK_SECTOR_SIZE) == 0)
+    {
+        kernel_printf("[TESTMODE] Block I/O sync read OK\n");
+    }
+    else
+    {
+        kernel_error("Block I/O sync read failed [%d]\n", err);
+    }
+
+    kfree(data);
+
+    kernel_printf("[TESTMODE] Block I/O test passed\n");
+}
+#else
+void block_io_test(void)
+{
+}
+#endif
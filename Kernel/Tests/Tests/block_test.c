@@ -0,0 +1,194 @@
+#include <io/kernel_output.h>
+#include <io/block.h>
+#include <lib/string.h>
+#include <memory/kheap.h>
+#include <Tests/test_bank.h>
+#include <Fixtures/test_ram_disk.h>
+
+#if BLOCK_TEST == 1
+
+/* RAM disk of 128 blocks */
+#define BLOCK_TEST_BLOCKS  128
+#define BLOCK_TEST_SECTORS \
+    (BLOCK_TEST_BLOCKS * (BLOCK_SIZE / TEST_RAM_DISK_SECTOR_SIZE))
+
+static uint32_t block_test_check(const uint8_t* data, const uint32_t block,
+                                 const uint32_t count, const uint8_t seed)
+{
+    uint32_t i;
+
+    for(i = 0; i < count * BLOCK_SIZE; ++i)
+    {
+        if(data[i] != (uint8_t)((block * BLOCK_SIZE + i) * 7 + seed))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void block_test_fill(uint8_t* data, const uint32_t block,
+                            const uint32_t count, const uint8_t seed)
+{
+    uint32_t i;
+
+    for(i = 0; i < count * BLOCK_SIZE; ++i)
+    {
+        data[i] = (uint8_t)((block * BLOCK_SIZE + i) * 7 + seed);
+    }
+}
+
+void block_test(void)
+{
+    block_device_t  dev;
+    block_stats_t   stats;
+    test_ram_disk_t disk;
+    uint8_t*        buffer;
+    uint32_t        i;
+    uint32_t        reads;
+    uint32_t        ok;
+    OS_RETURN_E     err;
+
+    err    = test_ram_disk_init(&disk, BLOCK_TEST_SECTORS);
+    buffer = kmalloc(BLOCK_TEST_BLOCKS * BLOCK_SIZE);
+    if(err != OS_NO_ERR || buffer == NULL)
+    {
+        kernel_error("Failed to allocate the RAM disk\n");
+        return;
+    }
+    block_test_fill(disk.data, 0, BLOCK_TEST_BLOCKS, 0);
+
+    /* Errors */
+    ok = 1;
+    ok &= block_device_init(NULL, &disk, &test_ram_disk_driver,
+                            TEST_RAM_DISK_SECTOR_SIZE, BLOCK_TEST_SECTORS) ==
+          OS_ERR_NULL_POINTER;
+    ok &= block_device_init(&dev, &disk, NULL,
+                            TEST_RAM_DISK_SECTOR_SIZE, BLOCK_TEST_SECTORS) ==
+          OS_ERR_NULL_POINTER;
+    ok &= block_device_init(&dev, &disk, &test_ram_disk_driver,
+                            3000, BLOCK_TEST_SECTORS) == OS_ERR_OUT_OF_BOUND;
+    ok &= block_device_init(&dev, &disk, &test_ram_disk_driver,
+                            TEST_RAM_DISK_SECTOR_SIZE, BLOCK_TEST_SECTORS) ==
+          OS_NO_ERR;
+    ok &= block_read(&dev, BLOCK_TEST_BLOCKS, buffer, 1) ==
+          OS_ERR_OUT_OF_BOUND;
+    ok &= block_read(&dev, BLOCK_TEST_BLOCKS - 1, buffer, 2) ==
+          OS_ERR_OUT_OF_BOUND;
+    ok &= block_write(&dev, 0, NULL, 1) == OS_ERR_NULL_POINTER;
+    ok &= block_get_stats(&dev, NULL) == OS_ERR_NULL_POINTER;
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] Block errors OK\n");
+    }
+    else
+    {
+        kernel_error("Block wrong error codes\n");
+    }
+
+    /* Miss then hit */
+    err = block_read(&dev, 10, buffer, 1);
+    reads = disk.reads;
+    err |= block_read(&dev, 50, buffer, 1);
+    err |= block_read(&dev, 10, buffer, 1);
+    err |= block_get_stats(&dev, &stats);
+    if(err == OS_NO_ERR && disk.reads == reads + 1 &&
+       stats.hits == 1 && stats.misses == 2 &&
+       block_test_check(buffer, 10, 1, 0) == 1)
+    {
+        kernel_printf("[TESTMODE] Block cache hit OK\n");
+    }
+    else
+    {
+        kernel_error("Block cache hit failed\n");
+    }
+
+    /* Sequential reads trigger read-ahead */
+    reads = disk.reads;
+    ok    = 1;
+    for(i = 20; i < 36; ++i)
+    {
+        err = block_read(&dev, i, buffer, 1);
+        ok &= (err == OS_NO_ERR && block_test_check(buffer, i, 1, 0) == 1);
+    }
+    err = block_get_stats(&dev, &stats);
+    if(ok == 1 && err == OS_NO_ERR && disk.reads - reads <= 3 &&
+       stats.read_ahead != 0)
+    {
+        kernel_printf("[TESTMODE] Block read-ahead OK\n");
+    }
+    else
+    {
+        kernel_error("Block read-ahead failed (%d reads)\n",
+                     disk.reads - reads);
+    }
+
+    /* Writes stay in the cache until flushed */
+    block_test_fill(buffer, 60, 4, 1);
+    err = block_write(&dev, 60, buffer, 4);
+    memset(buffer, 0, 4 * BLOCK_SIZE);
+    err |= block_read(&dev, 60, buffer, 4);
+    if(err == OS_NO_ERR && disk.writes == 0 &&
+       block_test_check(buffer, 60, 4, 1) == 1 &&
+       block_test_check(disk.data + 60 * BLOCK_SIZE, 60, 4, 0) == 1)
+    {
+        kernel_printf("[TESTMODE] Block write-back OK\n");
+    }
+    else
+    {
+        kernel_error("Block write-back failed\n");
+    }
+
+    /* Adjacent dirty blocks are written by a single command */
+    err = block_flush(&dev);
+    if(err == OS_NO_ERR && disk.writes == 1 && disk.flushes == 1 &&
+       block_test_check(disk.data + 60 * BLOCK_SIZE, 60, 4, 1) == 1)
+    {
+        kernel_printf("[TESTMODE] Block flush OK\n");
+    }
+    else
+    {
+        kernel_error("Block flush failed (%d writes)\n", disk.writes);
+    }
+
+    /* Invalidated blocks are read again */
+    err = block_invalidate(&dev);
+    reads = disk.reads;
+    err |= block_read(&dev, 10, buffer, 1);
+    if(err == OS_NO_ERR && disk.reads == reads + 1)
+    {
+        kernel_printf("[TESTMODE] Block invalidate OK\n");
+    }
+    else
+    {
+        kernel_error("Block invalidate failed\n");
+    }
+
+    /* Dirty blocks are written when evicted */
+    block_test_fill(buffer, 0, BLOCK_TEST_BLOCKS, 2);
+    err = block_write(&dev, 0, buffer, BLOCK_TEST_BLOCKS);
+    err |= block_flush(&dev);
+    if(err == OS_NO_ERR &&
+       block_test_check(disk.data, 0, BLOCK_TEST_BLOCKS, 2) == 1)
+    {
+        kernel_printf("[TESTMODE] Block eviction OK\n");
+    }
+    else
+    {
+        kernel_error("Block eviction failed\n");
+    }
+
+    err = block_invalidate(&dev);
+    kfree(buffer);
+    test_ram_disk_destroy(&disk);
+
+    if(err == OS_NO_ERR)
+    {
+        kernel_printf("[TESTMODE] Block test passed\n");
+    }
+}
+#else
+void block_test(void)
+{
+}
+#endif
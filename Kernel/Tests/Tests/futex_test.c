@@ -0,0 +1,118 @@
+#include <io/kernel_output.h>
+#include <core/scheduler.h>
+#include <interrupt/interrupts.h>
+#include <Tests/test_bank.h>
+#include <cpu.h>
+#include <sync/futex.h>
+
+#if FUTEX_TEST == 1
+
+static thread_t thread_futex[3];
+
+static volatile int32_t futex_word;
+static volatile int32_t futex_other_word;
+static volatile uint32_t woken_res;
+
+void* futex_thread(void *args)
+{
+    while(futex_word == 0)
+    {
+        if(futex_wait(&futex_word, 0) == OS_ERR_UNAUTHORIZED_ACTION)
+        {
+            kernel_printf("[TESTMODE] Futex wait failed\n");
+            return NULL;
+        }
+    }
+
+    kernel_printf("[TESTMODE] Futex waiter %d woken\n", (int32_t)args);
+    ++woken_res;
+
+    return NULL;
+}
+
+void futex_test(void)
+{
+    OS_RETURN_E err;
+    uint32_t    woken;
+    int32_t     i;
+
+    futex_word       = 0;
+    futex_other_word = 0;
+    woken_res        = 0;
+
+    /* Mismatching value must not block */
+    if(futex_wait(&futex_word, 1) == OS_FUTEX_VALUE_MISMATCH)
+    {
+        kernel_printf("[TESTMODE] Futex mismatch OK\n");
+    }
+
+    if(futex_wait(NULL, 0) == OS_ERR_NULL_POINTER)
+    {
+        kernel_printf("[TESTMODE] Futex NULL OK\n");
+    }
+
+    for(i = 0; i < 3; ++i)
+    {
+        err = sched_create_kernel_thread(&thread_futex[i], 1, "futex",
+                                         0x1000, 0, futex_thread,
+                                         (void*)i);
+        if(err != OS_NO_ERR)
+        {
+            kernel_error(" Error while creating futex thread! [%d]\n", err);
+            return;
+        }
+    }
+
+    /* Let the threads block */
+    sched_sleep(100);
+
+    /* Waking an other address must not wake anyone */
+    if(futex_wake(&futex_other_word, FUTEX_WAKE_ALL, &woken) == OS_NO_ERR &&
+       woken == 0 && woken_res == 0)
+    {
+        kernel_printf("[TESTMODE] Futex wake other OK\n");
+    }
+
+    futex_word = 1;
+
+    /* Wake the oldest waiter */
+    err = futex_wake(&futex_word, 1, &woken);
+    sched_sleep(100);
+    if(err == OS_NO_ERR && woken == 1 && woken_res == 1)
+    {
+        kernel_printf("[TESTMODE] Futex wake one OK\n");
+    }
+
+    /* Wake the remaining waiters */
+    err = futex_wake(&futex_word, FUTEX_WAKE_ALL, &woken);
+    sched_sleep(100);
+    if(err == OS_NO_ERR && woken == 2 && woken_res == 3)
+    {
+        kernel_printf("[TESTMODE] Futex wake all OK\n");
+    }
+
+    for(i = 0; i < 3; ++i)
+    {
+        if((err = sched_wait_thread(thread_futex[i], NULL, NULL)) != OS_NO_ERR)
+        {
+            kernel_error("Error while waiting thread! [%d]\n", err);
+        }
+    }
+
+    if(woken_res == 3)
+    {
+        kernel_printf("[TESTMODE] Futex test passed\n");
+    }
+
+    /* Kill QEMU */
+    cpu_outw(0x2000, 0x604);
+    while(1)
+    {
+        __asm__ ("hlt");
+    }
+}
+#else
+void futex_test(void)
+{
+}
+#endif
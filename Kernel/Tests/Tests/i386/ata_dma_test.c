@@ -0,0 +1,158 @@
+#include <lib/stdio.h>
+#include <lib/string.h>
+#include <io/kernel_output.h>
+#include <interrupt/interrupts.h>
+#include <memory/kheap.h>
+#include <cpu.h>
+#include <ata_pio.h>
+#include <ata_dma.h>
+
+#include <Tests/test_bank.h>
+
+#if ATA_DMA_TEST == 1
+
+/* 300 sectors, the range crosses a command and a PRD boundary */
+#define ATA_DMA_SECTORS 300
+#define ATA_DMA_START   2000
+/* 1MB benchmark */
+#define ATA_DMA_BENCH_SECTORS 2048
+
+void ata_dma_test(void)
+{
+    ata_pio_device_t dev;
+    uint8_t*         wbuf;
+    uint8_t*         rbuf;
+    uint64_t         start;
+    uint64_t         dma_time;
+    uint64_t         pio_time;
+    uint32_t         i;
+    uint32_t         error;
+    OS_RETURN_E      err;
+
+    kernel_interrupt_restore(1);
+
+    kernel_printf("[TESTMODE] ATA DMA tests starts\n");
+
+    dev.port = PRIMARY_PORT;
+    dev.type = MASTER;
+    dev.multiple_sectors = 0;
+    INIT_SPINLOCK(&dev.lock);
+
+    if((err = ata_pio_identify_device(&dev)) != OS_NO_ERR)
+    {
+        kernel_error("Failed to identify [%d]\n", err);
+        return;
+    }
+
+    if(ata_dma_is_available(&dev) != 1)
+    {
+        kernel_error("Bus master DMA not available\n");
+        return;
+    }
+    kernel_printf("[TESTMODE] ATA DMA available\n");
+
+    wbuf = kmalloc(ATA_DMA_BENCH_SECTORS * ATA_PIO_SECTOR_SIZE);
+    rbuf = kmalloc(ATA_DMA_BENCH_SECTORS * ATA_PIO_SECTOR_SIZE);
+    if(wbuf == NULL || rbuf == NULL)
+    {
+        kernel_error("Failed to allocate buffers\n");
+        return;
+    }
+    for(i = 0; i < ATA_DMA_SECTORS * ATA_PIO_SECTOR_SIZE; ++i)
+    {
+        wbuf[i] = (uint8_t)(i * 11 + i / ATA_PIO_SECTOR_SIZE);
+    }
+
+    /* DMA write, PIO read */
+    error = 0;
+    err = ata_dma_write_sectors(&dev, ATA_DMA_START, wbuf, ATA_DMA_SECTORS);
+    if(err == OS_NO_ERR)
+    {
+        memset(rbuf, 0, ATA_DMA_SECTORS * ATA_PIO_SECTOR_SIZE);
+        err = ata_pio_read_sectors(&dev, ATA_DMA_START, rbuf, ATA_DMA_SECTORS);
+    }
+    if(err == OS_NO_ERR &&
+       memcmp(wbuf, rbuf, ATA_DMA_SECTORS * ATA_PIO_SECTOR_SIZE) == 0)
+    {
+        kernel_printf("[TESTMODE] ATA DMA write OK\n");
+    }
+    else
+    {
+        kernel_error("Failed to DMA write [%d]\n", err);
+        ++error;
+    }
+
+    /* PIO write, DMA read */
+    for(i = 0; i < ATA_DMA_SECTORS * ATA_PIO_SECTOR_SIZE; ++i)
+    {
+        wbuf[i] = (uint8_t)(i * 5 + 3);
+    }
+    err = ata_pio_write_sectors(&dev, ATA_DMA_START, wbuf, ATA_DMA_SECTORS);
+    if(err == OS_NO_ERR)
+    {
+        memset(rbuf, 0, ATA_DMA_SECTORS * ATA_PIO_SECTOR_SIZE);
+        err = ata_dma_read_sectors(&dev, ATA_DMA_START, rbuf, ATA_DMA_SECTORS);
+    }
+    if(err == OS_NO_ERR &&
+       memcmp(wbuf, rbuf, ATA_DMA_SECTORS * ATA_PIO_SECTOR_SIZE) == 0)
+    {
+        kernel_printf("[TESTMODE] ATA DMA read OK\n");
+    }
+    else
+    {
+        kernel_error("Failed to DMA read [%d]\n", err);
+        ++error;
+    }
+
+    /* Errors */
+    if(ata_dma_read_sectors(NULL, 0, rbuf, 1) == OS_ERR_NULL_POINTER &&
+       ata_dma_read_sectors(&dev, 0, NULL, 1) == OS_ERR_NULL_POINTER &&
+       ata_dma_write_sectors(&dev, 0x0FFFFFFF, wbuf, 2) ==
+       OS_ERR_ATA_BAD_SECTOR_NUMBER &&
+       ata_dma_read_sectors(&dev, 0x10000000, rbuf, 1) ==
+       OS_ERR_ATA_BAD_SECTOR_NUMBER)
+    {
+        kernel_printf("[TESTMODE] ATA DMA errors OK\n");
+    }
+    else
+    {
+        kernel_error("ATA DMA wrong error codes\n");
+        ++error;
+    }
+
+    /* Benchmark */
+    start = cpu_rdtsc();
+    err = ata_dma_read_sectors(&dev, 0, rbuf, ATA_DMA_BENCH_SECTORS);
+    dma_time = cpu_rdtsc() - start;
+    if(err == OS_NO_ERR)
+    {
+        start = cpu_rdtsc();
+        err = ata_pio_read_sectors(&dev, 0, wbuf, ATA_DMA_BENCH_SECTORS);
+        pio_time = cpu_rdtsc() - start;
+    }
+    if(err == OS_NO_ERR &&
+       memcmp(wbuf, rbuf, ATA_DMA_BENCH_SECTORS * ATA_PIO_SECTOR_SIZE) == 0)
+    {
+        kernel_printf("ATA 1MB read: DMA %u Kcycles, PIO %u Kcycles\n",
+                      (uint32_t)(dma_time / 1000),
+                      (uint32_t)(pio_time / 1000));
+    }
+    else
+    {
+        kernel_error("ATA DMA benchmark failed [%d]\n", err);
+        ++error;
+    }
+
+    kfree(wbuf);
+    kfree(rbuf);
+
+    if(error == 0)
+    {
+        kernel_printf("[TESTMODE] ATA DMA tests passed\n");
+    }
+}
+#else
+void ata_dma_test(void)
+{
+}
+#endif
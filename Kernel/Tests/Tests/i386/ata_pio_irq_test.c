@@ -0,0 +1,180 @@
+#include <lib/stdio.h>
+#include <lib/string.h>
+#include <io/kernel_output.h>
+#include <core/scheduler.h>
+#include <interrupt/interrupts.h>
+#include <memory/kheap.h>
+#include <time/time_management.h>
+#include <cpu.h>
+#include <ata_pio.h>
+
+#include <Tests/test_bank.h>
+
+#if ATA_PIO_IRQ_TEST == 1
+
+/* 512KB transfers, each one takes several timer ticks */
+#define ATA_IRQ_SECTORS 1024
+#define ATA_IRQ_START   600
+#define ATA_IRQ_LOOPS   4
+
+static volatile uint32_t counter_run;
+static volatile uint32_t counter;
+
+static void* counter_th(void* args)
+{
+    (void)args;
+
+    while(counter_run == 1)
+    {
+        ++counter;
+    }
+
+    return NULL;
+}
+
+void ata_pio_irq_test(void)
+{
+    ata_pio_device_t dev;
+    thread_t         counter_thread;
+    uint8_t*         wbuf;
+    uint8_t*         rbuf;
+    uint8_t          small[16];
+    uint64_t         ticks;
+    uint64_t         start;
+    uint32_t         i;
+    uint32_t         error;
+    OS_RETURN_E      err;
+
+    kernel_interrupt_restore(1);
+
+    kernel_printf("[TESTMODE] ATA IRQ tests starts\n");
+
+    dev.port = PRIMARY_PORT;
+    dev.type = MASTER;
+    dev.multiple_sectors = 0;
+    INIT_SPINLOCK(&dev.lock);
+
+    if((err = ata_pio_identify_device(&dev)) != OS_NO_ERR)
+    {
+        kernel_error("Failed to identify [%d]\n", err);
+        return;
+    }
+
+    wbuf = kmalloc(ATA_IRQ_SECTORS * ATA_PIO_SECTOR_SIZE);
+    rbuf = kmalloc(ATA_IRQ_SECTORS * ATA_PIO_SECTOR_SIZE);
+    if(wbuf == NULL || rbuf == NULL)
+    {
+        kernel_error("Failed to allocate buffers\n");
+        return;
+    }
+    for(i = 0; i < ATA_IRQ_SECTORS * ATA_PIO_SECTOR_SIZE; ++i)
+    {
+        wbuf[i] = (uint8_t)(i * 13 + i / ATA_PIO_SECTOR_SIZE);
+    }
+
+    /* Interrupt driven range write and read */
+    error = 0;
+    err = ata_pio_write_sectors(&dev, ATA_IRQ_START, wbuf, ATA_IRQ_SECTORS);
+    if(err == OS_NO_ERR)
+    {
+        memset(rbuf, 0, ATA_IRQ_SECTORS * ATA_PIO_SECTOR_SIZE);
+        err = ata_pio_read_sectors(&dev, ATA_IRQ_START, rbuf, ATA_IRQ_SECTORS);
+    }
+    if(err == OS_NO_ERR &&
+       memcmp(wbuf, rbuf, ATA_IRQ_SECTORS * ATA_PIO_SECTOR_SIZE) == 0)
+    {
+        kernel_printf("[TESTMODE] ATA IRQ range write/read OK\n");
+    }
+    else
+    {
+        kernel_error("Failed to write/read range [%d]\n", err);
+        ++error;
+    }
+
+    /* Partial sectors go through a bounce buffer */
+    err = ata_pio_write_sector(&dev, ATA_IRQ_START, "UTK ATA IRQ mode", 16);
+    if(err == OS_NO_ERR)
+    {
+        memset(small, 0, 16);
+        err = ata_pio_read_sector(&dev, ATA_IRQ_START, small, 16);
+    }
+    if(err == OS_NO_ERR && memcmp(small, "UTK ATA IRQ mode", 16) == 0)
+    {
+        err = ata_pio_read_sector(&dev, ATA_IRQ_START, rbuf,
+                                  ATA_PIO_SECTOR_SIZE);
+        if(err == OS_NO_ERR && rbuf[16] == 0 &&
+           rbuf[ATA_PIO_SECTOR_SIZE - 1] == 0)
+        {
+            kernel_printf("[TESTMODE] ATA IRQ single sector OK\n");
+        }
+        else
+        {
+            kernel_error("Failed to read padding [%d]\n", err);
+            ++error;
+        }
+    }
+    else
+    {
+        kernel_error("Failed to write/read sector [%d]\n", err);
+        ++error;
+    }
+
+    /* Other threads run and the timer ticks during the transfers */
+    counter     = 0;
+    counter_run = 1;
+    err = sched_create_kernel_thread(&counter_thread,
+                                     KERNEL_LOWEST_PRIORITY - 1, "ata_counter",
+                                     1024, 0, counter_th, NULL);
+    if(err == OS_NO_ERR)
+    {
+        ticks = time_get_tick_count();
+        start = cpu_rdtsc();
+        for(i = 0; i < ATA_IRQ_LOOPS && err == OS_NO_ERR; ++i)
+        {
+            err = ata_pio_read_sectors(&dev, ATA_IRQ_START, rbuf,
+                                       ATA_IRQ_SECTORS);
+        }
+        start = cpu_rdtsc() - start;
+        ticks = time_get_tick_count() - ticks;
+
+        counter_run = 0;
+        if(sched_wait_thread(counter_thread, NULL, NULL) != OS_NO_ERR)
+        {
+            kernel_error("Cannot join thread\n");
+            ++error;
+        }
+
+        kernel_printf("ATA IRQ read %dKB in %u Kcycles, %u ticks, "
+                      "counter %u\n",
+                      ATA_IRQ_LOOPS * ATA_IRQ_SECTORS / 2,
+                      (uint32_t)(start / 1000), (uint32_t)ticks, counter);
+
+        if(err == OS_NO_ERR && counter != 0 && ticks != 0)
+        {
+            kernel_printf("[TESTMODE] ATA IRQ concurrent thread OK\n");
+        }
+        else
+        {
+            kernel_error("Counter thread did not run [%d]\n", err);
+            ++error;
+        }
+    }
+    else
+    {
+        kernel_error("Cannot create thread [%d]\n", err);
+        ++error;
+    }
+
+    kfree(wbuf);
+    kfree(rbuf);
+
+    if(error == 0)
+    {
+        kernel_printf("[TESTMODE] ATA IRQ tests passed\n");
+    }
+}
+#else
+void ata_pio_irq_test(void)
+{
+}
+#endif
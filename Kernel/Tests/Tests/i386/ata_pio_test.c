@@ -4,15 +4,159 @@
 #include <io/kernel_output.h>
 #include <cpu.h>
 #include <ata_pio.h>
+#include <memory/kheap.h>
 
 #include <Tests/test_bank.h>
 
 #if ATA_PIO_TEST  == 1
+
+/* 264 sectors, the range crosses a command boundary */
+#define ATA_RANGE_SECTORS 264
+#define ATA_RANGE_START   16
+/* 1MB benchmark */
+#define ATA_BENCH_SECTORS 2048
+
+static uint32_t ata_pio_range_test(ata_pio_device_t* dev)
+{
+    uint8_t*    wbuf;
+    uint8_t*    rbuf;
+    uint32_t    i;
+    uint32_t    error;
+    uint16_t    multiple;
+    uint64_t    start;
+    uint64_t    single_time;
+    uint64_t    range_time;
+    OS_RETURN_E err;
+
+    error = 0;
+
+    if((err = ata_pio_identify_device(dev)) != OS_NO_ERR)
+    {
+        kernel_error("Failed to identify [%d]\n", err);
+        return 1;
+    }
+    kernel_printf("ATA multiple mode: %d sectors per block\n",
+                  dev->multiple_sectors);
+
+    wbuf = kmalloc(ATA_BENCH_SECTORS * ATA_PIO_SECTOR_SIZE);
+    rbuf = kmalloc(ATA_BENCH_SECTORS * ATA_PIO_SECTOR_SIZE);
+    if(wbuf == NULL || rbuf == NULL)
+    {
+        kernel_error("Failed to allocate buffers\n");
+        return 1;
+    }
+
+    for(i = 0; i < ATA_RANGE_SECTORS * ATA_PIO_SECTOR_SIZE; ++i)
+    {
+        wbuf[i] = (uint8_t)(i * 7 + i / ATA_PIO_SECTOR_SIZE);
+    }
+
+    /* Range write then range read */
+    err = ata_pio_write_sectors(dev, ATA_RANGE_START, wbuf, ATA_RANGE_SECTORS);
+    if(err != OS_NO_ERR)
+    {
+        kernel_error("Failed to write range [%d]\n", err);
+        ++error;
+    }
+    memset(rbuf, 0, ATA_RANGE_SECTORS * ATA_PIO_SECTOR_SIZE);
+    err = ata_pio_read_sectors(dev, ATA_RANGE_START, rbuf, ATA_RANGE_SECTORS);
+    if(err != OS_NO_ERR ||
+       memcmp(wbuf, rbuf, ATA_RANGE_SECTORS * ATA_PIO_SECTOR_SIZE) != 0)
+    {
+        kernel_error("Failed to read range [%d]\n", err);
+        ++error;
+    }
+    else
+    {
+        kernel_debug("[TESTMODE] ATA range write/read OK\n");
+    }
+
+    /* The single sector API sees the same data */
+    memset(rbuf, 0, ATA_PIO_SECTOR_SIZE);
+    err = ata_pio_read_sector(dev, ATA_RANGE_START + 260, rbuf,
+                              ATA_PIO_SECTOR_SIZE);
+    if(err != OS_NO_ERR ||
+       memcmp(wbuf + 260 * ATA_PIO_SECTOR_SIZE, rbuf,
+              ATA_PIO_SECTOR_SIZE) != 0)
+    {
+        kernel_error("Failed to read single sector [%d]\n", err);
+        ++error;
+    }
+    else
+    {
+        kernel_debug("[TESTMODE] ATA range single sector OK\n");
+    }
+
+    /* One sector per data request when multiple mode is not used */
+    multiple = dev->multiple_sectors;
+    dev->multiple_sectors = 0;
+    memset(rbuf, 0, ATA_RANGE_SECTORS * ATA_PIO_SECTOR_SIZE);
+    err = ata_pio_read_sectors(dev, ATA_RANGE_START, rbuf, ATA_RANGE_SECTORS);
+    dev->multiple_sectors = multiple;
+    if(err != OS_NO_ERR ||
+       memcmp(wbuf, rbuf, ATA_RANGE_SECTORS * ATA_PIO_SECTOR_SIZE) != 0)
+    {
+        kernel_error("Failed to read range without multiple [%d]\n", err);
+        ++error;
+    }
+    else
+    {
+        kernel_debug("[TESTMODE] ATA range fallback OK\n");
+    }
+
+    if(ata_pio_read_sectors(dev, 0, NULL, 1) == OS_ERR_NULL_POINTER &&
+       ata_pio_write_sectors(NULL, 0, wbuf, 1) == OS_ERR_NULL_POINTER &&
+       ata_pio_read_sectors(dev, 0x0FFFFFFF, rbuf, 2) ==
+       OS_ERR_ATA_BAD_SECTOR_NUMBER)
+    {
+        kernel_debug("[TESTMODE] ATA range errors OK\n");
+    }
+    else
+    {
+        kernel_error("Failed range parameters checks\n");
+        ++error;
+    }
+
+    /* Throughput: 1MB read sector by sector then as a range */
+    start = cpu_rdtsc();
+    for(i = 0; i < ATA_BENCH_SECTORS && err == OS_NO_ERR; ++i)
+    {
+        err = ata_pio_read_sector(dev, i, rbuf + i * ATA_PIO_SECTOR_SIZE,
+                                  ATA_PIO_SECTOR_SIZE);
+    }
+    single_time = cpu_rdtsc() - start;
+
+    start = cpu_rdtsc();
+    if(err == OS_NO_ERR)
+    {
+        err = ata_pio_read_sectors(dev, 0, wbuf, ATA_BENCH_SECTORS);
+    }
+    range_time = cpu_rdtsc() - start;
+
+    if(err != OS_NO_ERR ||
+       memcmp(wbuf, rbuf, ATA_BENCH_SECTORS * ATA_PIO_SECTOR_SIZE) != 0)
+    {
+        kernel_error("Failed benchmark reads [%d]\n", err);
+        ++error;
+    }
+    kernel_printf("ATA 1MB read: %u Kcycles per sector, %u Kcycles as range\n",
+                  (uint32_t)(single_time >> 10), (uint32_t)(range_time >> 10));
+
+    kfree(wbuf);
+    kfree(rbuf);
+
+    return error;
+}
+
 void ata_pio_test(void)
 {
     ata_pio_device_t dev;
     dev.port = PRIMARY_PORT;
     dev.type = MASTER;
+    dev.multiple_sectors = 0;
+#if MAX_CPU_COUNT > 1
+    INIT_SPINLOCK(&dev.lock);
+#endif
 
     OS_RETURN_E err;
     uint32_t error = 0;
@@ -73,6 +217,8 @@ void ata_pio_test(void)
         ++error;
     }
 
+    error += ata_pio_range_test(&dev);
+
     if(error == 0)
         kernel_debug("[TESTMODE] ATA tests passed\n");
 
@@ -0,0 +1,232 @@
+#include <lib/stdint.h>
+#include <lib/string.h>
+#include <io/kernel_output.h>
+#include <interrupt/interrupts.h>
+#include <interrupt/deferred.h>
+#include <interrupt_settings.h>
+#include <core/scheduler.h>
+#include <core/trace.h>
+#include <keyboard.h>
+#include <cpu.h>
+
+#include <Tests/test_bank.h>
+#include <Fixtures/i386/test_keyboard.h>
+
+/* The test needs TRACE_ENABLED set to 1 */
+#if DEFERRED_TEST == 1
+
+#define DEFERRED_BENCH_KEYS 16
+#define DEFERRED_BENCH_SIZE 64
+
+static deferred_work_t   work_a;
+static deferred_work_t   work_b;
+static deferred_work_t   tasklet_a;
+static volatile uint32_t run_count[3];
+static volatile uint32_t run_order[4];
+static volatile uint32_t run_index;
+static volatile int32_t  run_tid;
+static volatile uint32_t run_int_state;
+
+static trace_event_t bench_events[DEFERRED_BENCH_SIZE];
+
+static void deferred_test_routine(void* args)
+{
+    uint32_t id;
+
+    id = (uint32_t)args;
+
+    ++run_count[id];
+    if(run_index < 4)
+    {
+        run_order[run_index++] = id;
+    }
+    run_tid       = sched_get_tid();
+    run_int_state = kernel_interrupt_get_state();
+}
+
+/* Measures the keyboard interrupt handler with the decoding configured by
+ * KEYBOARD_DEFERRED_DECODE, run the test with both values to compare.
+ */
+static uint32_t deferred_test_bench(void)
+{
+    trace_event_t* entry;
+    uint64_t       irq_cycles;
+    uint64_t       irq_max;
+    uint64_t       cycles;
+    uint32_t       irq_count;
+    uint32_t       count;
+    uint32_t       cpu;
+    uint32_t       i;
+
+    trace_clear();
+    trace_enable(TRACE_CATEGORY_INTERRUPT);
+    for(i = 0; i < DEFERRED_BENCH_KEYS; ++i)
+    {
+        test_keyboard_type_a();
+    }
+    test_keyboard_inject(TEST_KEYBOARD_RETURN);
+    trace_disable(TRACE_CATEGORY_INTERRUPT);
+
+    /* Let the decoding tasklet run */
+    sched_sleep(50);
+
+    /* Keyboard interrupt handler duration, the handlers are not nested */
+    irq_cycles = 0;
+    irq_max    = 0;
+    irq_count  = 0;
+    for(cpu = 0; cpu < MAX_CPU_COUNT; ++cpu)
+    {
+        entry = NULL;
+        while(trace_read(cpu, bench_events, DEFERRED_BENCH_SIZE,
+                         &count, NULL) == OS_NO_ERR && count != 0)
+        {
+            for(i = 0; i < count; ++i)
+            {
+                if(bench_events[i].args[0] != INT_PIC_IRQ_OFFSET +
+                                              KBD_IRQ_LINE &&
+                   bench_events[i].args[0] != INT_IOAPIC_IRQ_OFFSET +
+                                              KBD_IRQ_LINE)
+                {
+                    continue;
+                }
+                if(bench_events[i].id == TRACE_INTERRUPT_ENTRY)
+                {
+                    entry = &bench_events[i];
+                }
+                else if(bench_events[i].id == TRACE_INTERRUPT_EXIT &&
+                        entry != NULL)
+                {
+                    cycles = bench_events[i].timestamp - entry->timestamp;
+                    irq_cycles += cycles;
+                    if(cycles > irq_max)
+                    {
+                        irq_max = cycles;
+                    }
+                    ++irq_count;
+                    entry = NULL;
+                }
+            }
+            /* The pairs are not split between two reads */
+            entry = NULL;
+        }
+    }
+
+    if(irq_count == 0)
+    {
+        kernel_error("Keyboard benchmark: no interrupt traced\n");
+        return 0;
+    }
+
+    kernel_printf("Keyboard interrupts disabled time (cycles per interrupt, "
+                  "%u interrupts, %s decoding): avg %llu max %llu\n",
+                  irq_count,
+                  KEYBOARD_DEFERRED_DECODE == 1 ? "deferred" : "inline",
+                  irq_cycles / irq_count, irq_max);
+
+    return 1;
+}
+
+void deferred_test(void)
+{
+    uint32_t    int_state;
+    uint32_t    passed;
+    uint32_t    i;
+    OS_RETURN_E err;
+
+    for(i = 0; i < 3; ++i)
+    {
+        run_count[i] = 0;
+    }
+    run_index = 0;
+    passed    = 1;
+
+    deferred_work_init(&work_a, deferred_test_routine, (void*)0);
+    deferred_work_init(&work_b, deferred_test_routine, (void*)1);
+    deferred_work_init(&tasklet_a, deferred_test_routine, (void*)2);
+
+    /* A work item runs in the worker thread with the interrupts enabled */
+    run_tid = sched_get_tid();
+    err = deferred_work_queue(&work_a);
+    sched_sleep(20);
+    if(err == OS_NO_ERR && run_count[0] == 1 && run_tid != sched_get_tid() &&
+       run_int_state != 0)
+    {
+        kernel_printf("[TESTMODE] Work item run by the worker\n");
+    }
+    else
+    {
+        kernel_error("Work item run %u times\n", run_count[0]);
+        passed = 0;
+    }
+
+    /* A pending work item runs once */
+    int_state = kernel_interrupt_disable();
+    deferred_work_queue(&work_a);
+    deferred_work_queue(&work_a);
+    deferred_work_queue(&work_a);
+    kernel_interrupt_restore(int_state);
+    sched_sleep(20);
+    if(run_count[0] == 2)
+    {
+        kernel_printf("[TESTMODE] Pending work item coalesced\n");
+    }
+    else
+    {
+        kernel_error("Pending work item run %u times\n", run_count[0] - 1);
+        passed = 0;
+    }
+
+    /* The tasklets run before the work items */
+    run_index = 0;
+    int_state = kernel_interrupt_disable();
+    deferred_work_queue(&work_b);
+    deferred_tasklet_schedule(&tasklet_a);
+    kernel_interrupt_restore(int_state);
+    sched_sleep(20);
+    if(run_index == 2 && run_order[0] == 2 && run_order[1] == 1)
+    {
+        kernel_printf("[TESTMODE] Tasklet run before work item\n");
+    }
+    else
+    {
+        kernel_error("Deferred run order failed\n");
+        passed = 0;
+    }
+
+    if(deferred_work_queue(NULL) == OS_ERR_NULL_POINTER &&
+       deferred_tasklet_schedule(NULL) == OS_ERR_NULL_POINTER &&
+       deferred_work_queue_on(&work_a, MAX_CPU_COUNT) == OS_ERR_OUT_OF_BOUND &&
+       deferred_work_init(&work_a, NULL, NULL) == OS_ERR_NULL_POINTER)
+    {
+        kernel_printf("[TESTMODE] Deferred parameters OK\n");
+    }
+    else
+    {
+        kernel_error("Deferred parameters checks failed\n");
+        passed = 0;
+    }
+
+    /* Keyboard interrupts benchmark */
+    passed &= deferred_test_bench();
+
+    if(passed == 1)
+    {
+        kernel_printf("[TESTMODE] Deferred tests passed\n");
+    }
+    else
+    {
+        kernel_error("Deferred tests failed\n");
+    }
+
+    /* Kill QEMU */
+    cpu_outw(0x2000, 0x604);
+    while(1)
+    {
+        __asm__ ("hlt");
+    }
+}
+#else
+void deferred_test(void)
+{
+}
+#endif
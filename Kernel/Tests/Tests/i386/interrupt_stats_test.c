@@ -0,0 +1,131 @@
+#include <lib/stdint.h>
+#include <io/kernel_output.h>
+#include <interrupt/interrupts.h>
+#include <interrupt_settings.h>
+#include <core/scheduler.h>
+#include <cpu.h>
+
+#include <Tests/test_bank.h>
+
+/* The test needs INTERRUPT_STATS_ENABLED and INTERRUPT_LATENCY_ENABLED set to
+ * 1
+ */
+#if INTERRUPT_STATS_TEST == 1
+
+#define INTERRUPT_STATS_SCHEDULE 16
+#define INTERRUPT_STATS_DELAY    5000000
+
+/* The window is opened in this function, keep it out of the test function */
+__attribute__((noinline))
+static void interrupt_stats_test_window(void)
+{
+    uint32_t int_state;
+    uint64_t start;
+
+    int_state = kernel_interrupt_disable();
+    start = cpu_rdtsc();
+    while(cpu_rdtsc() - start < INTERRUPT_STATS_DELAY);
+    kernel_interrupt_restore(int_state);
+}
+
+void interrupt_stats_test(void)
+{
+    interrupt_stats_t   stats;
+    interrupt_latency_t latency;
+    uint64_t            hw_count;
+    uint64_t            cpu_count;
+    uintptr_t           window;
+    uint32_t            i;
+    uint32_t            ok;
+
+    /* Software interrupts */
+    kernel_interrupt_reset_stats();
+    for(i = 0; i < INTERRUPT_STATS_SCHEDULE; ++i)
+    {
+        sched_schedule();
+    }
+    ok = kernel_interrupt_get_stats(SCHEDULER_SW_INT_LINE, &stats) ==
+         OS_NO_ERR;
+    cpu_count = 0;
+    for(i = 0; i < MAX_CPU_COUNT; ++i)
+    {
+        cpu_count += stats.cpu_count[i];
+    }
+    if(ok == 1 && stats.count >= INTERRUPT_STATS_SCHEDULE &&
+       cpu_count == stats.count && stats.max_cycles != 0 &&
+       stats.total_cycles >= stats.max_cycles)
+    {
+        kernel_printf("[TESTMODE] Software interrupts counted\n");
+    }
+    else
+    {
+        kernel_error("Scheduler interrupt counted %u times\n",
+                     (uint32_t)stats.count);
+    }
+
+    /* The timer interrupts are counted while sleeping */
+    sched_sleep(50);
+    hw_count = 0;
+    for(i = MIN_INTERRUPT_LINE; i < INT_ENTRY_COUNT; ++i)
+    {
+        if(i != SCHEDULER_SW_INT_LINE &&
+           kernel_interrupt_get_stats(i, &stats) == OS_NO_ERR)
+        {
+            hw_count += stats.count;
+        }
+    }
+    if(hw_count != 0)
+    {
+        kernel_printf("[TESTMODE] Hardware interrupts counted\n");
+    }
+    else
+    {
+        kernel_error("No hardware interrupt counted\n");
+    }
+
+    /* Longest interrupts disabled window */
+    interrupt_stats_test_window();
+    window = (uintptr_t)interrupt_stats_test_window;
+    if(kernel_interrupt_get_latency(&latency) == OS_NO_ERR &&
+       latency.max_cycles >= INTERRUPT_STATS_DELAY &&
+       latency.disable_site > window &&
+       latency.disable_site < window + 0x100 &&
+       latency.restore_site > latency.disable_site &&
+       latency.restore_site < window + 0x100)
+    {
+        kernel_printf("[TESTMODE] Interrupts disabled window OK\n");
+    }
+    else
+    {
+        kernel_error("Interrupts disabled window: %u cycles at 0x%p\n",
+                     (uint32_t)latency.max_cycles, latency.disable_site);
+    }
+
+    if(kernel_interrupt_get_stats(0, NULL) == OS_ERR_NULL_POINTER &&
+       kernel_interrupt_get_stats(INT_ENTRY_COUNT, &stats) ==
+       OS_ERR_OUT_OF_BOUND &&
+       kernel_interrupt_get_latency(NULL) == OS_ERR_NULL_POINTER)
+    {
+        kernel_printf("[TESTMODE] Interrupt statistics parameters OK\n");
+    }
+    else
+    {
+        kernel_error("Interrupt statistics parameters checks failed\n");
+    }
+
+    kernel_interrupt_dump_stats();
+
+    kernel_printf("[TESTMODE] Interrupt statistics tests passed\n");
+
+    /* Kill QEMU */
+    cpu_outw(0x2000, 0x604);
+    while(1)
+    {
+        __asm__ ("hlt");
+    }
+}
+#else
+void interrupt_stats_test(void)
+{
+}
+#endif
@@ -0,0 +1,163 @@
+#include <lib/stdint.h>
+#include <io/kernel_output.h>
+#include <interrupt/interrupts.h>
+#include <interrupt_settings.h>
+#include <core/scheduler.h>
+#include <io_apic.h>
+#include <keyboard.h>
+#include <cpu.h>
+
+#include <Tests/test_bank.h>
+#include <Fixtures/i386/test_keyboard.h>
+
+/* The test needs the IO-APIC and INTERRUPT_STATS_ENABLED set to 1 */
+#if IRQ_AFFINITY_TEST == 1
+
+#define IRQ_AFFINITY_TEST_KEYS 4
+
+/* Returns the CPUs that received the keyboard interrupts */
+static uint32_t irq_affinity_test_deliveries(uint64_t* count)
+{
+    interrupt_stats_t stats;
+    uint32_t          cpu_mask;
+    uint32_t          i;
+
+    kernel_interrupt_reset_stats();
+    for(i = 0; i < IRQ_AFFINITY_TEST_KEYS; ++i)
+    {
+        test_keyboard_type_a();
+    }
+    sched_sleep(20);
+
+    kernel_interrupt_get_stats(INT_IOAPIC_IRQ_OFFSET + KBD_IRQ_LINE, &stats);
+
+    cpu_mask = 0;
+    for(i = 0; i < MAX_CPU_COUNT; ++i)
+    {
+        if(stats.cpu_count[i] != 0)
+        {
+            cpu_mask |= 1 << i;
+        }
+    }
+    *count = stats.count;
+
+    return cpu_mask;
+}
+
+void irq_affinity_test(void)
+{
+    uint32_t booted;
+    uint32_t booted_mask;
+    uint32_t target;
+    uint32_t cpu_mask;
+    uint32_t ok;
+    uint32_t i;
+    uint64_t count;
+
+    booted = cpu_get_booted_cpu_count();
+    if(booted > MAX_CPU_COUNT)
+    {
+        booted = MAX_CPU_COUNT;
+    }
+    booted_mask = (1 << booted) - 1;
+    target      = booted - 1;
+
+    /* Single CPU destination */
+    ok = io_apic_set_irq_affinity(KBD_IRQ_LINE, target) == OS_NO_ERR;
+    ok &= io_apic_get_irq_affinity(KBD_IRQ_LINE, &cpu_mask) == OS_NO_ERR;
+    if(ok == 1 && cpu_mask == (1U << target))
+    {
+        kernel_printf("[TESTMODE] IRQ affinity set\n");
+    }
+    else
+    {
+        kernel_error("IRQ affinity set failed\n");
+    }
+
+    cpu_mask = irq_affinity_test_deliveries(&count);
+    if(count != 0 && cpu_mask == (1U << target))
+    {
+        kernel_printf("[TESTMODE] IRQ delivered to its CPU\n");
+    }
+    else
+    {
+        kernel_error("IRQ delivered %u times to CPUs 0x%x\n",
+                     (uint32_t)count, cpu_mask);
+    }
+
+    /* Logical destination set */
+    ok = io_apic_set_irq_affinity_mask(KBD_IRQ_LINE, booted_mask) ==
+         OS_NO_ERR;
+    cpu_mask = irq_affinity_test_deliveries(&count);
+    if(ok == 1 && count != 0 && (cpu_mask & ~booted_mask) == 0)
+    {
+        kernel_printf("[TESTMODE] IRQ delivered to its CPU set\n");
+    }
+    else
+    {
+        kernel_error("IRQ delivered %u times to CPUs 0x%x\n",
+                     (uint32_t)count, cpu_mask);
+    }
+
+    if(io_apic_set_irq_affinity(KBD_IRQ_LINE, MAX_CPU_COUNT) ==
+       OS_ERR_OUT_OF_BOUND &&
+       io_apic_set_irq_affinity_mask(KBD_IRQ_LINE, 0) == OS_ERR_OUT_OF_BOUND &&
+       io_apic_set_irq_affinity_mask(KBD_IRQ_LINE, booted_mask + 1) ==
+       OS_ERR_OUT_OF_BOUND &&
+       io_apic_set_irq_affinity(IO_APIC_MAX_IRQ_LINE + 1, 0) ==
+       OS_ERR_NO_SUCH_IRQ_LINE &&
+       io_apic_get_irq_affinity(KBD_IRQ_LINE, NULL) == OS_ERR_NULL_POINTER)
+    {
+        kernel_printf("[TESTMODE] IRQ affinity parameters OK\n");
+    }
+    else
+    {
+        kernel_error("IRQ affinity parameters checks failed\n");
+    }
+
+    /* Balancing keeps the IRQs away from CPU 0 when an other CPU is booted,
+     * the keyboard IRQ affinity is kept.
+     */
+    ok = io_apic_balance_irqs(0x1) == OS_NO_ERR;
+    for(i = 0; i <= IO_APIC_MAX_IRQ_LINE; ++i)
+    {
+        if(io_apic_get_irq_affinity(i, &cpu_mask) != OS_NO_ERR)
+        {
+            continue;
+        }
+        if(i == KBD_IRQ_LINE)
+        {
+            ok &= cpu_mask == booted_mask;
+        }
+        else if(booted > 1)
+        {
+            ok &= (cpu_mask & 0x1) == 0 && (cpu_mask & ~booted_mask) == 0;
+        }
+        else
+        {
+            ok &= cpu_mask == 0x1;
+        }
+    }
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] IRQs balanced\n");
+    }
+    else
+    {
+        kernel_error("IRQs balancing failed\n");
+    }
+
+    kernel_printf("[TESTMODE] IRQ affinity tests passed\n");
+
+    /* Kill QEMU */
+    cpu_outw(0x2000, 0x604);
+    while(1)
+    {
+        __asm__ ("hlt");
+    }
+}
+#else
+void irq_affinity_test(void)
+{
+}
+#endif
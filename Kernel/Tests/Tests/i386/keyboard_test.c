@@ -0,0 +1,149 @@
+#include <lib/stdint.h>
+#include <io/kernel_output.h>
+#include <core/scheduler.h>
+#include <keyboard.h>
+#include <cpu.h>
+
+#include <Tests/test_bank.h>
+#include <Fixtures/i386/test_keyboard.h>
+
+#if KEYBOARD_TEST == 1
+
+static thread_t          reader_thread;
+static volatile uint32_t reader_state;
+static char              reader_char;
+
+void* keyboard_test_reader(void* args)
+{
+    size_t      read;
+    OS_RETURN_E err;
+
+    (void)args;
+
+    reader_state = 1;
+    err = keyboard_receive(&reader_char, 1, &read);
+    if(err == OS_NO_ERR && read == 1)
+    {
+        reader_state = 2;
+    }
+    else
+    {
+        reader_state = 3;
+    }
+
+    return NULL;
+}
+
+void keyboard_test(void)
+{
+    char        buffer[8];
+    size_t      read;
+    uint32_t    dropped;
+    OS_RETURN_E err;
+
+    keyboard_disable_display();
+
+    /* Drop the characters typed during the boot */
+    while(keyboard_poll(buffer, sizeof(buffer)) != 0);
+    dropped = keyboard_get_dropped();
+
+    /* Non blocking and timed reads on an empty buffer */
+    if(keyboard_poll(buffer, sizeof(buffer)) == 0)
+    {
+        kernel_printf("[TESTMODE] Keyboard poll empty OK\n");
+    }
+    else
+    {
+        kernel_error("Keyboard poll returned characters\n");
+    }
+
+    err = keyboard_receive_timeout(buffer, sizeof(buffer), &read, 50);
+    if(err == OS_ERR_TIMEOUT && read == 0)
+    {
+        kernel_printf("[TESTMODE] Keyboard timeout OK\n");
+    }
+    else
+    {
+        kernel_error("Keyboard timed read returned %d\n", err);
+    }
+
+    if(keyboard_receive(NULL, 1, &read) == OS_ERR_NULL_POINTER &&
+       keyboard_receive(buffer, 0, &read) == OS_ERR_OUT_OF_BOUND)
+    {
+        kernel_printf("[TESTMODE] Keyboard parameters OK\n");
+    }
+    else
+    {
+        kernel_error("Keyboard parameters checks failed\n");
+    }
+
+    /* A blocked reader is woken up by the interrupt handler */
+    reader_state = 0;
+    err = sched_create_kernel_thread(&reader_thread, 1, "kbd_reader",
+                                     0x1000, 0, keyboard_test_reader, NULL);
+    if(err != OS_NO_ERR)
+    {
+        kernel_error("Error while creating keyboard thread! [%d]\n", err);
+        return;
+    }
+
+    sched_sleep(50);
+    if(reader_state == 1)
+    {
+        kernel_printf("[TESTMODE] Keyboard reader blocked\n");
+    }
+    else
+    {
+        kernel_error("Keyboard reader state %u\n", reader_state);
+    }
+
+    test_keyboard_type_a();
+    sched_sleep(50);
+    if(reader_state == 2 && reader_char == 'a')
+    {
+        kernel_printf("[TESTMODE] Keyboard reader woken\n");
+    }
+    else
+    {
+        kernel_error("Keyboard reader state %u\n", reader_state);
+    }
+
+    if((err = sched_wait_thread(reader_thread, NULL, NULL)) != OS_NO_ERR)
+    {
+        kernel_error("Error while waiting thread! [%d]\n", err);
+    }
+
+    /* The keys typed without reader are kept in the buffer */
+    test_keyboard_type_a();
+    test_keyboard_type_a();
+    test_keyboard_type_a();
+    sched_sleep(50);
+    err = keyboard_receive_timeout(buffer, sizeof(buffer), &read, 50);
+    if(err == OS_NO_ERR && read == 3 &&
+       buffer[0] == 'a' && buffer[1] == 'a' && buffer[2] == 'a' &&
+       keyboard_get_dropped() == dropped)
+    {
+        kernel_printf("[TESTMODE] Keyboard buffered input OK\n");
+    }
+    else
+    {
+        kernel_error("Keyboard buffered input read %u characters\n",
+                     (uint32_t)read);
+    }
+
+    keyboard_enable_display();
+
+    kernel_printf("[TESTMODE] Keyboard tests passed\n");
+
+    /* Kill QEMU */
+    cpu_outw(0x2000, 0x604);
+    while(1)
+    {
+        __asm__ ("hlt");
+    }
+}
+#else
+void keyboard_test(void)
+{
+}
+#endif
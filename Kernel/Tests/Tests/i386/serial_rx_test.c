@@ -0,0 +1,59 @@
+#include <lib/stdio.h>
+#include <io/kernel_output.h>
+#include <time/time_management.h>
+#include <serial.h>
+
+#include <Tests/test_bank.h>
+
+#if SERIAL_RX_TEST == 1
+
+#define SERIAL_RX_TIMEOUT 50
+
+void serial_rx_test(void)
+{
+    uint8_t     buffer[16];
+    size_t      read;
+    uint64_t    start;
+    uint64_t    elapsed;
+    uint32_t    ok;
+    OS_RETURN_E err;
+
+    kernel_printf("[TESTMODE] Serial RX tests starts\n");
+
+    ok = 1;
+    ok &= serial_receive(COM1, NULL, 16, &read) == OS_ERR_NULL_POINTER;
+    ok &= serial_receive(COM1, buffer, 16, NULL) == OS_ERR_NULL_POINTER;
+    ok &= serial_receive(0x1234, buffer, 16, &read) == OS_ERR_OUT_OF_BOUND;
+    ok &= serial_receive_timeout(COM1, buffer, 0, &read, 10) ==
+          OS_ERR_OUT_OF_BOUND;
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] Serial RX errors OK\n");
+    }
+    else
+    {
+        kernel_error("Serial RX wrong error codes\n");
+    }
+
+    /* Nothing is sent to the kernel, the read must sleep then time out */
+    start   = time_get_current_uptime();
+    err     = serial_receive_timeout(COM2, buffer, 16, &read,
+                                     SERIAL_RX_TIMEOUT);
+    elapsed = time_get_current_uptime() - start;
+    if(err == OS_ERR_TIMEOUT && read == 0 && elapsed >= SERIAL_RX_TIMEOUT)
+    {
+        kernel_printf("[TESTMODE] Serial RX timeout OK\n");
+    }
+    else
+    {
+        kernel_error("Serial RX timeout failed [%d] %dms\n", err,
+                     (uint32_t)elapsed);
+    }
+
+    kernel_printf("[TESTMODE] Serial RX tests passed\n");
+}
+#else
+void serial_rx_test(void)
+{
+}
+#endif
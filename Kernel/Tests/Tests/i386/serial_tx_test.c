@@ -0,0 +1,75 @@
+#include <lib/stdint.h>
+#include <io/kernel_output.h>
+#include <time/time_management.h>
+#include <serial.h>
+#include <cpu.h>
+
+#include <Tests/test_bank.h>
+
+#if SERIAL_TX_TEST == 1
+
+/* Modem control register loopback flag */
+#define SERIAL_TX_LOOPBACK 0x10
+
+#define SERIAL_TX_SIZE    64
+#define SERIAL_TX_TIMEOUT 100
+
+void serial_tx_test(void)
+{
+    uint8_t     buffer[SERIAL_TX_SIZE];
+    uint8_t     mcr;
+    size_t      received;
+    size_t      read;
+    uint64_t    deadline;
+    uint32_t    ok;
+    uint32_t    i;
+    OS_RETURN_E err;
+
+    kernel_printf("[TESTMODE] Serial TX tests starts\n");
+
+    /* The COM2 transmitter output is looped back to its receiver */
+    mcr = cpu_inb(SERIAL_MODEM_COMMAND_PORT(COM2));
+    cpu_outb(mcr | SERIAL_TX_LOOPBACK, SERIAL_MODEM_COMMAND_PORT(COM2));
+
+    /* More bytes than the transmitter FIFO, the TX ring feeds it */
+    for(i = 0; i < SERIAL_TX_SIZE; ++i)
+    {
+        serial_write(COM2, (uint8_t)(i * 7 + 1));
+    }
+
+    received = 0;
+    err      = OS_NO_ERR;
+    deadline = time_get_current_uptime() + SERIAL_TX_TIMEOUT;
+    while(received < SERIAL_TX_SIZE && err == OS_NO_ERR &&
+          time_get_current_uptime() < deadline)
+    {
+        err = serial_receive_timeout(COM2, buffer + received,
+                                     SERIAL_TX_SIZE - received, &read,
+                                     SERIAL_TX_TIMEOUT);
+        received += read;
+    }
+
+    cpu_outb(mcr, SERIAL_MODEM_COMMAND_PORT(COM2));
+
+    ok = received == SERIAL_TX_SIZE;
+    for(i = 0; i < received; ++i)
+    {
+        ok &= buffer[i] == (uint8_t)(i * 7 + 1);
+    }
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] Serial TX loopback OK\n");
+    }
+    else
+    {
+        kernel_error("Serial TX loopback received %u bytes [%d]\n",
+                     (uint32_t)received, err);
+    }
+
+    kernel_printf("[TESTMODE] Serial TX tests passed\n");
+}
+#else
+void serial_tx_test(void)
+{
+}
+#endif
@@ -0,0 +1,298 @@
+#include <lib/stdint.h>
+#include <io/kernel_output.h>
+#include <core/panic.h>
+#include <vesa.h>
+#include <fonts/fonts.h>
+#include <cpu.h>
+
+#include <Tests/test_bank.h>
+
+/* The test needs DISPLAY_TYPE set to a VESA display and a 32 bits mode */
+#if VESA_BLIT_TEST == 1
+
+#define VESA_BLIT_X          400
+#define VESA_BLIT_Y          300
+#define VESA_BLIT_BENCH_SIZE 64
+#define VESA_BLIT_BENCH_ITER 64
+
+static uint32_t blit_image[VESA_BLIT_BENCH_SIZE * VESA_BLIT_BENCH_SIZE];
+
+static uint32_t vesa_blit_test_pixel(const uint32_t x, const uint32_t y)
+{
+    uint8_t a;
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+
+    vesa_get_pixel(x, y, &a, &r, &g, &b);
+
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+static uint32_t vesa_blit_test_char(const unsigned char character,
+                                    const uint32_t x, const uint32_t y,
+                                    const uint32_t fgcolor,
+                                    const uint32_t bgcolor)
+{
+    const uint8_t* glyph;
+    uint32_t       expected;
+    uint32_t       i;
+    uint32_t       j;
+
+    glyph = font_bitmap + (character - 31) * VESA_GLYPH_HEIGHT;
+    for(j = 0; j < VESA_GLYPH_HEIGHT; ++j)
+    {
+        for(i = 0; i < VESA_GLYPH_WIDTH; ++i)
+        {
+            expected = (glyph[j] & (0x80 >> i)) != 0 ? fgcolor : bgcolor;
+            if(vesa_blit_test_pixel(x + i, y + j) != (expected & 0x00FFFFFF))
+            {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+static uint32_t vesa_blit_test_check(const uint32_t x, const uint32_t y,
+                                     const uint32_t width,
+                                     const uint32_t height,
+                                     const uint32_t color)
+{
+    uint32_t i;
+    uint32_t j;
+
+    for(j = y; j < y + height; ++j)
+    {
+        for(i = x; i < x + width; ++i)
+        {
+            if(vesa_blit_test_pixel(i, j) != color)
+            {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+void vesa_blit_test(void)
+{
+    uint8_t                  glyph[4] = {0xA5, 0xFF, 0x00, 0x81};
+    vesa_glyph_cache_stats_t cache_start;
+    vesa_glyph_cache_stats_t cache_end;
+    uint32_t                 expected;
+    uint32_t                 ok;
+    uint32_t                 i;
+    uint32_t                 j;
+    uint64_t                 start;
+    uint64_t                 fill_cycles;
+    uint64_t                 blend_cycles;
+    uint64_t                 copy_cycles;
+    uint64_t                 glyph_cycles;
+    uint64_t                 pixel_cycles;
+
+    if(vesa_get_screen_bpp() != 32)
+    {
+        kernel_error("VESA 32 bits mode is not enabled\n");
+        kernel_panic(OS_ERR_NOT_SUPPORTED);
+    }
+
+    /* Fill */
+    vesa_fill_rectangle(VESA_BLIT_X, VESA_BLIT_Y, 37, 9, 0xFF123456);
+    if(vesa_blit_test_check(VESA_BLIT_X, VESA_BLIT_Y, 37, 9, 0x123456) == 1)
+    {
+        kernel_printf("[TESTMODE] Fill rectangle OK\n");
+    }
+    else
+    {
+        kernel_error("Fill rectangle failed\n");
+    }
+
+    /* Blend, the components are (color * alpha + pixel * (255 - alpha)) / 256
+     */
+    vesa_blend_rectangle(VESA_BLIT_X + 1, VESA_BLIT_Y, 35, 9, 0x80FF0000);
+    expected = (((0xFF * 0x80 + 0x12 * 0x7F) >> 8) << 16) |
+               (((0x34 * 0x7F) >> 8) << 8) |
+               ((0x56 * 0x7F) >> 8);
+    if(vesa_blit_test_check(VESA_BLIT_X + 1, VESA_BLIT_Y, 35, 9,
+                            expected) == 1 &&
+       vesa_blit_test_check(VESA_BLIT_X, VESA_BLIT_Y, 1, 9, 0x123456) == 1)
+    {
+        kernel_printf("[TESTMODE] Blend rectangle OK\n");
+    }
+    else
+    {
+        kernel_error("Blend rectangle failed\n");
+    }
+
+    /* Copy */
+    for(i = 0; i < VESA_BLIT_BENCH_SIZE * VESA_BLIT_BENCH_SIZE; ++i)
+    {
+        blit_image[i] = (i * 0x010203) & 0x00FFFFFF;
+    }
+    vesa_copy_rectangle(VESA_BLIT_X + 3, VESA_BLIT_Y + 2, 13, 5,
+                        blit_image, VESA_BLIT_BENCH_SIZE);
+    ok = 1;
+    for(j = 0; j < 5; ++j)
+    {
+        for(i = 0; i < 13; ++i)
+        {
+            if(vesa_blit_test_pixel(VESA_BLIT_X + 3 + i,
+                                    VESA_BLIT_Y + 2 + j) !=
+               blit_image[j * VESA_BLIT_BENCH_SIZE + i])
+            {
+                ok = 0;
+            }
+        }
+    }
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] Copy rectangle OK\n");
+    }
+    else
+    {
+        kernel_error("Copy rectangle failed\n");
+    }
+
+    /* Glyph, the most significant bit is the leftmost pixel */
+    vesa_blit_glyph(glyph, VESA_BLIT_X + 5, VESA_BLIT_Y, 4,
+                    0xFFFFFFFF, 0xFF000080);
+    ok = 1;
+    for(j = 0; j < 4; ++j)
+    {
+        for(i = 0; i < 8; ++i)
+        {
+            expected = (glyph[j] & (0x80 >> i)) != 0 ? 0xFFFFFF : 0x000080;
+            if(vesa_blit_test_pixel(VESA_BLIT_X + 5 + i,
+                                    VESA_BLIT_Y + j) != expected)
+            {
+                ok = 0;
+            }
+        }
+    }
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] Glyph blit OK\n");
+    }
+    else
+    {
+        kernel_error("Glyph blit failed\n");
+    }
+
+    /* Glyph cache, the second character is copied from the cache */
+    ok = vesa_get_glyph_cache_stats(&cache_start) == OS_NO_ERR;
+    vesa_drawchar('Q', VESA_BLIT_X + 16, VESA_BLIT_Y, 0xFF00FF00, 0xFF000010);
+    vesa_drawchar('Q', VESA_BLIT_X + 24, VESA_BLIT_Y, 0xFF00FF00, 0xFF000010);
+    vesa_get_glyph_cache_stats(&cache_end);
+    ok &= cache_end.hits - cache_start.hits >= 1;
+    ok &= vesa_blit_test_char('Q', VESA_BLIT_X + 16, VESA_BLIT_Y,
+                              0xFF00FF00, 0xFF000010);
+    ok &= vesa_blit_test_char('Q', VESA_BLIT_X + 24, VESA_BLIT_Y,
+                              0xFF00FF00, 0xFF000010);
+    /* Other colors are rendered again */
+    vesa_drawchar('Q', VESA_BLIT_X + 32, VESA_BLIT_Y, 0xFF0000FF, 0xFF000010);
+    ok &= vesa_blit_test_char('Q', VESA_BLIT_X + 32, VESA_BLIT_Y,
+                              0xFF0000FF, 0xFF000010);
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] Glyph cache OK\n");
+    }
+    else
+    {
+        kernel_error("Glyph cache failed\n");
+    }
+
+    /* Bounds */
+    ok = 1;
+    ok &= vesa_fill_rectangle(vesa_get_screen_width() - 4, 0, 5, 1, 0) ==
+          OS_ERR_OUT_OF_BOUND;
+    ok &= vesa_blend_rectangle(0, vesa_get_screen_height(), 1, 1, 0) ==
+          OS_ERR_OUT_OF_BOUND;
+    ok &= vesa_copy_rectangle(0, 0, 1, 1, NULL, 1) == OS_ERR_NULL_POINTER;
+    ok &= vesa_blit_glyph(glyph, vesa_get_screen_width() - 7, 0, 4, 0, 0) ==
+          OS_ERR_OUT_OF_BOUND;
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] Bounds OK\n");
+    }
+    else
+    {
+        kernel_error("Bounds checks failed\n");
+    }
+
+    /* Microbenchmark, 64x64 areas */
+    start = cpu_rdtsc();
+    for(i = 0; i < VESA_BLIT_BENCH_ITER; ++i)
+    {
+        vesa_fill_rectangle(VESA_BLIT_X, VESA_BLIT_Y,
+                            VESA_BLIT_BENCH_SIZE, VESA_BLIT_BENCH_SIZE,
+                            0xFF000000 | i);
+    }
+    fill_cycles = (cpu_rdtsc() - start) / VESA_BLIT_BENCH_ITER;
+
+    start = cpu_rdtsc();
+    for(i = 0; i < VESA_BLIT_BENCH_ITER; ++i)
+    {
+        vesa_blend_rectangle(VESA_BLIT_X, VESA_BLIT_Y,
+                             VESA_BLIT_BENCH_SIZE, VESA_BLIT_BENCH_SIZE,
+                             0x40FFFFFF);
+    }
+    blend_cycles = (cpu_rdtsc() - start) / VESA_BLIT_BENCH_ITER;
+
+    start = cpu_rdtsc();
+    for(i = 0; i < VESA_BLIT_BENCH_ITER; ++i)
+    {
+        vesa_copy_rectangle(VESA_BLIT_X, VESA_BLIT_Y,
+                            VESA_BLIT_BENCH_SIZE, VESA_BLIT_BENCH_SIZE,
+                            blit_image, VESA_BLIT_BENCH_SIZE);
+    }
+    copy_cycles = (cpu_rdtsc() - start) / VESA_BLIT_BENCH_ITER;
+
+    /* 64 glyphs of 8x16 pixels, as many pixels as a 64x64 area */
+    start = cpu_rdtsc();
+    for(i = 0; i < VESA_BLIT_BENCH_ITER; ++i)
+    {
+        for(j = 0; j < 64; ++j)
+        {
+            vesa_drawchar('A' + (j % 26), VESA_BLIT_X + (j % 8) * 8,
+                          VESA_BLIT_Y + (j / 8) * 16,
+                          0xFFFFFFFF, 0xFF000000);
+        }
+    }
+    glyph_cycles = (cpu_rdtsc() - start) / VESA_BLIT_BENCH_ITER;
+
+    /* Reference: per pixel fill */
+    start = cpu_rdtsc();
+    for(i = 0; i < VESA_BLIT_BENCH_ITER; ++i)
+    {
+        for(j = 0; j < VESA_BLIT_BENCH_SIZE * VESA_BLIT_BENCH_SIZE; ++j)
+        {
+            vesa_draw_pixel(VESA_BLIT_X + j % VESA_BLIT_BENCH_SIZE,
+                            VESA_BLIT_Y + j / VESA_BLIT_BENCH_SIZE,
+                            0xFF, 0x00, 0x00, i);
+        }
+    }
+    pixel_cycles = (cpu_rdtsc() - start) / VESA_BLIT_BENCH_ITER;
+
+    kernel_printf("VESA blit benchmark (cycles per 64x64 area, SSE %u): "
+                  "fill %llu, blend %llu, copy %llu, glyphs %llu, "
+                  "per pixel fill %llu\n",
+                  cpu_is_sse_enabled(), fill_cycles, blend_cycles,
+                  copy_cycles, glyph_cycles, pixel_cycles);
+
+    kernel_printf("[TESTMODE] VESA blit tests passed\n");
+
+    /* Kill QEMU */
+    cpu_outw(0x2000, 0x604);
+    while(1)
+    {
+        __asm__ ("hlt");
+    }
+}
+#else
+void vesa_blit_test(void)
+{
+}
+#endif
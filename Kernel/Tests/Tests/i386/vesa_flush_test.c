@@ -0,0 +1,182 @@
+#include <lib/stdint.h>
+#include <io/kernel_output.h>
+#include <interrupt/interrupts.h>
+#include <core/panic.h>
+#include <core/scheduler.h>
+#include <vesa.h>
+#include <cpu.h>
+
+#include <Tests/test_bank.h>
+
+/* The test needs DISPLAY_TYPE set to DISPLAY_VESA_BUF and a 32 bits mode */
+#if VESA_FLUSH_TEST == 1
+
+#define VESA_FLUSH_BENCH_FRAMES 64
+#define VESA_FLUSH_BENCH_CHARS  80
+
+static void vesa_flush_test_start(vesa_flush_stats_t* stats)
+{
+    /* Drop the areas drawn by the previous messages */
+    vesa_flush_buffer();
+    vesa_get_flush_stats(stats);
+}
+
+static uint32_t vesa_flush_test_end(const vesa_flush_stats_t* start)
+{
+    vesa_flush_stats_t stats;
+
+    vesa_flush_buffer();
+    vesa_get_flush_stats(&stats);
+
+    return (uint32_t)(stats.bytes - start->bytes);
+}
+
+void vesa_flush_test(void)
+{
+    vesa_flush_stats_t stats;
+    vesa_flush_stats_t end;
+    uint32_t           frame_size;
+    uint32_t           int_state;
+    uint32_t           bytes;
+    uint32_t           i;
+    uint32_t           j;
+    uint64_t           start;
+    uint64_t           cycles;
+
+    if(vesa_get_flush_stats(&stats) != OS_NO_ERR)
+    {
+        kernel_error("VESA buffer is not enabled\n");
+        kernel_panic(OS_ERR_NOT_SUPPORTED);
+    }
+
+    frame_size = vesa_get_screen_width() * vesa_get_screen_height() *
+                 (vesa_get_screen_bpp() / 8);
+
+    /* Nothing changed, the flush is skipped */
+    vesa_flush_test_start(&stats);
+    vesa_flush_buffer();
+    vesa_get_flush_stats(&end);
+    if(end.bytes == stats.bytes && end.skipped > stats.skipped)
+    {
+        kernel_printf("[TESTMODE] Empty flush skipped\n");
+    }
+    else
+    {
+        kernel_error("Empty flush copied %u bytes\n",
+                     (uint32_t)(end.bytes - stats.bytes));
+    }
+
+    /* One pixel, copied as a 16 bytes chunk */
+    vesa_flush_test_start(&stats);
+    vesa_draw_pixel(12, 12, 0xFF, 0xFF, 0x00, 0x00);
+    kernel_printf("[TESTMODE] Pixel flush: %u bytes\n",
+                  vesa_flush_test_end(&stats));
+
+    /* One character */
+    vesa_flush_test_start(&stats);
+    vesa_drawchar('A', 16, 32, 0xFFFFFFFF, 0xFF000000);
+    kernel_printf("[TESTMODE] Character flush: %u bytes\n",
+                  vesa_flush_test_end(&stats));
+
+    /* Overlapping characters are merged, the buffer thread must not flush
+     * between the two draws.
+     */
+    vesa_flush_test_start(&stats);
+    int_state = kernel_interrupt_disable();
+    vesa_drawchar('B', 0, 0, 0xFFFFFFFF, 0xFF000000);
+    vesa_drawchar('C', 4, 0, 0xFFFFFFFF, 0xFF000000);
+    kernel_interrupt_restore(int_state);
+    kernel_printf("[TESTMODE] Merged flush: %u bytes\n",
+                  vesa_flush_test_end(&stats));
+
+    /* Distant characters are copied separately */
+    vesa_flush_test_start(&stats);
+    vesa_drawchar('D', 0, 0, 0xFFFFFFFF, 0xFF000000);
+    vesa_drawchar('E', 512, 256, 0xFFFFFFFF, 0xFF000000);
+    kernel_printf("[TESTMODE] Split flush: %u bytes\n",
+                  vesa_flush_test_end(&stats));
+
+    /* Scrolling changes the whole screen */
+    vesa_flush_test_start(&stats);
+    vesa_scroll(SCROLL_DOWN, 1);
+    bytes = vesa_flush_test_end(&stats);
+    if(bytes == frame_size)
+    {
+        kernel_printf("[TESTMODE] Scroll flush: full frame\n");
+    }
+    else
+    {
+        kernel_error("Scroll flush copied %u bytes, frame is %u bytes\n",
+                     bytes, frame_size);
+    }
+
+    /* A static screen does not wake the buffer thread, the messages printed
+     * before are flushed first.
+     */
+    sched_sleep(VESA_FRAME_PERIOD * 2);
+    vesa_flush_test_start(&stats);
+    sched_sleep(VESA_FRAME_PERIOD * 4);
+    vesa_get_flush_stats(&end);
+    if(end.frames == stats.frames && end.skipped == stats.skipped)
+    {
+        kernel_printf("[TESTMODE] Static screen not flushed\n");
+    }
+    else
+    {
+        kernel_error("Static screen flushed %u times\n",
+                     (uint32_t)(end.frames + end.skipped -
+                                stats.frames - stats.skipped));
+    }
+
+    /* A presented frame is flushed by the buffer thread */
+    vesa_flush_test_start(&stats);
+    vesa_drawchar('F', 16, 32, 0xFFFFFFFF, 0xFF000000);
+    vesa_present();
+    sched_sleep(VESA_FRAME_PERIOD * 2);
+    vesa_get_flush_stats(&end);
+    if(end.frames == stats.frames + 1 && end.bytes - stats.bytes == 512)
+    {
+        kernel_printf("[TESTMODE] Present flushed by the buffer thread\n");
+    }
+    else
+    {
+        kernel_error("Present flushed %u frames, %u bytes\n",
+                     (uint32_t)(end.frames - stats.frames),
+                     (uint32_t)(end.bytes - stats.bytes));
+    }
+
+    /* Console line benchmark */
+    vesa_flush_test_start(&stats);
+    cycles = 0;
+    for(i = 0; i < VESA_FLUSH_BENCH_FRAMES; ++i)
+    {
+        for(j = 0; j < VESA_FLUSH_BENCH_CHARS; ++j)
+        {
+            vesa_drawchar('a' + (i + j) % 26, j * 8, (i % 16) * 16,
+                          0xFFFFFFFF, 0xFF000000);
+        }
+        start = cpu_rdtsc();
+        vesa_flush_buffer();
+        cycles += cpu_rdtsc() - start;
+    }
+    vesa_get_flush_stats(&end);
+    kernel_printf("VESA flush benchmark: %u bytes per frame, full frame %u "
+                  "bytes, %llu cycles per frame\n",
+                  (uint32_t)((end.bytes - stats.bytes) /
+                             VESA_FLUSH_BENCH_FRAMES),
+                  frame_size, cycles / VESA_FLUSH_BENCH_FRAMES);
+
+    kernel_printf("[TESTMODE] VESA flush tests passed\n");
+
+    /* Kill QEMU */
+    cpu_outw(0x2000, 0x604);
+    while(1)
+    {
+        __asm__ ("hlt");
+    }
+}
+#else
+void vesa_flush_test(void)
+{
+}
+#endif
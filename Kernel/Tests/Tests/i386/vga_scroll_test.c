@@ -0,0 +1,169 @@
+#include <lib/stdint.h>
+#include <io/kernel_output.h>
+#include <io/scrollback.h>
+#include <vga_text.h>
+#include <cpu.h>
+
+#include <Tests/test_bank.h>
+
+/* The test needs DISPLAY_TYPE set to DISPLAY_VGA */
+#if VGA_SCROLL_TEST == 1
+
+#define VGA_SCROLL_BENCH_ITER 64
+
+static void vga_scroll_test_fill(void)
+{
+    uint16_t* line;
+    uint32_t  i;
+    uint32_t  j;
+
+    for(i = 0; i < VGA_TEXT_SCREEN_LINE_SIZE; ++i)
+    {
+        line = vga_get_framebuffer(i, 0);
+        for(j = 0; j < VGA_TEXT_SCREEN_COL_SIZE; ++j)
+        {
+            line[j] = ('a' + i) | 0x0700;
+        }
+    }
+}
+
+static uint32_t vga_scroll_test_line(const uint32_t line, const char character)
+{
+    uint16_t* screen_line;
+    uint32_t  i;
+
+    screen_line = vga_get_framebuffer(line, 0);
+    for(i = 0; i < VGA_TEXT_SCREEN_COL_SIZE; ++i)
+    {
+        if((screen_line[i] & 0xFF) != (uint8_t)character)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+void vga_scroll_test(void)
+{
+    scrollback_cell_t cells[SCROLLBACK_LINE_SIZE];
+    uint32_t          count;
+    uint32_t          size;
+    uint32_t          ok;
+    uint16_t*         hw_cell;
+    uint16_t*         cell;
+    uint32_t          i;
+    uint64_t          start;
+    uint64_t          line_cycles;
+    uint64_t          block_cycles;
+
+    /* Scroll three lines at once */
+    vga_scroll_test_fill();
+    count = scrollback_get_count();
+    vga_scroll(SCROLL_DOWN, 3);
+    ok = 1;
+    for(i = 0; i < VGA_TEXT_SCREEN_LINE_SIZE - 3; ++i)
+    {
+        ok &= vga_scroll_test_line(i, 'a' + i + 3);
+    }
+    for(; i < VGA_TEXT_SCREEN_LINE_SIZE; ++i)
+    {
+        ok &= vga_scroll_test_line(i, ' ');
+    }
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] Bulk scroll OK\n");
+    }
+    else
+    {
+        kernel_error("Bulk scroll failed\n");
+    }
+
+    /* The lines leaving the screen are in the history */
+    ok = scrollback_get_count() == count + 3 ||
+         scrollback_get_count() == SCROLLBACK_LINE_COUNT;
+    for(i = 0; i < 3; ++i)
+    {
+        size = 0;
+        ok &= scrollback_get_line(i, cells, &size) == OS_NO_ERR;
+        ok &= size == VGA_TEXT_SCREEN_COL_SIZE;
+        ok &= cells[0].character == 'c' - i;
+        ok &= cells[0].fgcolor == FG_GREY && cells[0].bgcolor == BG_BLACK;
+    }
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] Scrollback lines OK\n");
+    }
+    else
+    {
+        kernel_error("Scrollback lines failed\n");
+    }
+
+    /* Display the history then the screen content again */
+    ok = vga_show_scrollback(2) == OS_NO_ERR;
+    ok &= vga_scroll_test_line(0, 'b');
+    ok &= vga_scroll_test_line(1, 'c');
+    ok &= vga_scroll_test_line(2, 'd');
+    ok &= vga_show_scrollback(0) == OS_NO_ERR;
+    ok &= vga_scroll_test_line(0, 'd');
+    ok &= vga_scroll_test_line(VGA_TEXT_SCREEN_LINE_SIZE - 4, 'y');
+    ok &= vga_show_scrollback(scrollback_get_count() + 1) ==
+          OS_ERR_OUT_OF_BOUND;
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] Scrollback display OK\n");
+    }
+    else
+    {
+        kernel_error("Scrollback display failed\n");
+    }
+
+    /* The shadow buffer reaches the screen when flushed */
+    cell    = vga_get_framebuffer(4, 2);
+    hw_cell = (uint16_t*)VGA_TEXT_FRAMEBUFFER +
+              4 * VGA_TEXT_SCREEN_COL_SIZE + 2;
+    *cell   = 'Z' | 0x0700;
+    ok = *hw_cell != *cell;
+    vga_flush();
+    ok &= *hw_cell == *cell;
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] Shadow buffer OK\n");
+    }
+    else
+    {
+        kernel_error("Shadow buffer failed\n");
+    }
+
+    /* Microbenchmark */
+    start = cpu_rdtsc();
+    for(i = 0; i < VGA_SCROLL_BENCH_ITER; ++i)
+    {
+        vga_scroll(SCROLL_DOWN, 1);
+    }
+    line_cycles = (cpu_rdtsc() - start) / VGA_SCROLL_BENCH_ITER;
+
+    start = cpu_rdtsc();
+    for(i = 0; i < VGA_SCROLL_BENCH_ITER; ++i)
+    {
+        vga_scroll(SCROLL_DOWN, 10);
+    }
+    block_cycles = (cpu_rdtsc() - start) / VGA_SCROLL_BENCH_ITER;
+
+    kernel_printf("VGA scroll benchmark: %llu cycles per line, %llu cycles "
+                  "per 10 lines\n", line_cycles, block_cycles);
+
+    kernel_printf("[TESTMODE] VGA scroll tests passed\n");
+
+    /* Kill QEMU */
+    cpu_outw(0x2000, 0x604);
+    while(1)
+    {
+        __asm__ ("hlt");
+    }
+}
+#else
+void vga_scroll_test(void)
+{
+}
+#endif
@@ -11,6 +11,9 @@ void kernel_queue_test(void)
     OS_RETURN_E error = OS_ERR_NULL_POINTER;
     kernel_queue_node_t* nodes[40] = { NULL };
     kernel_queue_t*      queue = NULL;
+    kernel_queue_t       embedded_queue;
+    kernel_queue_t       embedded_queue_other;
+    kernel_queue_node_t  embedded_nodes[3];
     uint32_t   sorted[40];
     uint32_t   unsorted[10] = {0, 3, 5, 7, 4, 1, 8, 9, 6, 2};
 
@@ -394,6 +397,93 @@ void kernel_queue_test(void)
             kernel_printf("[TESTMODE] Kernel Queue %d passed.\n", test_count);
         } 
     }
+    ++test_count;
+
+    /* Embedded queue and nodes */
+    error = kernel_queue_init_queue(&embedded_queue);
+    if(error == OS_NO_ERR)
+    {
+        error = kernel_queue_init_queue(&embedded_queue_other);
+    }
+    for(uint8_t i = 0; i < 3 && error == OS_NO_ERR; ++i)
+    {
+        error = kernel_queue_init_node(&embedded_nodes[i], (void*)(uint32_t)i);
+        if(error == OS_NO_ERR)
+        {
+            error = kernel_queue_push(&embedded_nodes[i], &embedded_queue);
+        }
+    }
+    if(error == OS_NO_ERR)
+    {
+        error = kernel_queue_remove(&embedded_queue, &embedded_nodes[1]);
+    }
+    if(error != OS_NO_ERR || embedded_queue.size != 2 ||
+       embedded_nodes[1].enlisted != 0)
+    {
+        kernel_error("TEST_KQUEUE 30\n");
+    }
+    else 
+    {
+        kernel_printf("[TESTMODE] Kernel Queue %d passed.\n", test_count++);
+    } 
+
+    /* Remove a node that is not enlisted */
+    error = kernel_queue_remove(&embedded_queue, &embedded_nodes[1]);
+    if(error != OS_ERR_NO_SUCH_ID || embedded_queue.size != 2)
+    {
+        kernel_error("TEST_KQUEUE 31\n");
+    }
+    else 
+    {
+        kernel_printf("[TESTMODE] Kernel Queue %d passed.\n", test_count++);
+    } 
+
+    /* Remove a node enlisted in an other queue */
+    error = kernel_queue_push(&embedded_nodes[1], &embedded_queue_other);
+    if(error == OS_NO_ERR)
+    {
+        error = kernel_queue_remove(&embedded_queue, &embedded_nodes[1]);
+    }
+    if(error != OS_ERR_NO_SUCH_ID || embedded_queue.size != 2 ||
+       embedded_queue_other.size != 1)
+    {
+        kernel_error("TEST_KQUEUE 32\n");
+    }
+    else 
+    {
+        kernel_printf("[TESTMODE] Kernel Queue %d passed.\n", test_count++);
+    } 
+
+    /* Embedded nodes keep the FIFO order */
+    find = kernel_queue_pop(&embedded_queue, &error);
+    if(find != &embedded_nodes[0] || error != OS_NO_ERR)
+    {
+        kernel_error("TEST_KQUEUE 33\n");
+    }
+    else 
+    {
+        find = kernel_queue_pop(&embedded_queue, &error);
+        if(find != &embedded_nodes[2] || error != OS_NO_ERR ||
+           embedded_queue.size != 0)
+        {
+            kernel_error("TEST_KQUEUE 34\n");
+        }
+        else
+        {
+            kernel_printf("[TESTMODE] Kernel Queue %d passed.\n", test_count++);
+        }
+    } 
+
+    /* Init NULL node and queue */
+    if(kernel_queue_init_node(NULL, NULL) != OS_ERR_NULL_POINTER ||
+       kernel_queue_init_queue(NULL) != OS_ERR_NULL_POINTER)
+    {
+        kernel_error("TEST_KQUEUE 35\n");
+    }
+    else 
+    {
+        kernel_printf("[TESTMODE] Kernel Queue %d passed.\n", test_count++);
+    } 
 
     kernel_printf("[TESTMODE] Kernel queues tests passed\n");
 
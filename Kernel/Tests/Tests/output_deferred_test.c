@@ -0,0 +1,99 @@
+#include <lib/stdio.h>
+#include <io/kernel_output.h>
+#include <core/scheduler.h>
+#include <cpu.h>
+
+#include <Tests/test_bank.h>
+
+#if OUTPUT_DEFERRED_TEST == 1
+
+#define OUTPUT_DEFERRED_TEST_COUNT 16
+
+void output_deferred_test(void)
+{
+    kernel_output_stats_t before;
+    kernel_output_stats_t stats;
+    uint64_t              start;
+    uint64_t              sync_cycles;
+    uint64_t              log_cycles;
+    uint32_t              i;
+    OS_RETURN_E           err;
+
+    kernel_printf("[TESTMODE] Deferred output tests starts\n");
+
+    if(kernel_output_get_stats(NULL) == OS_ERR_NULL_POINTER)
+    {
+        kernel_printf("[TESTMODE] Deferred output errors OK\n");
+    }
+    else
+    {
+        kernel_error("Deferred output wrong error codes\n");
+    }
+
+    kernel_output_get_stats(&before);
+
+    /* Immediate output cost */
+    start = cpu_rdtsc();
+    for(i = 0; i < OUTPUT_DEFERRED_TEST_COUNT; ++i)
+    {
+        kernel_serial_debug("Output benchmark %d\n", i);
+    }
+    sync_cycles = cpu_rdtsc() - start;
+
+    err = kernel_output_set_deferred(1);
+    if(err != OS_NO_ERR)
+    {
+        kernel_error("Could not defer the output [%d]\n", err);
+    }
+
+    /* Deferred output cost */
+    start = cpu_rdtsc();
+    for(i = 0; i < OUTPUT_DEFERRED_TEST_COUNT; ++i)
+    {
+        kernel_serial_debug("Output benchmark %d\n", i);
+    }
+    log_cycles = cpu_rdtsc() - start;
+
+    /* Records keep their arguments and order */
+    kernel_printf("[TESTMODE] Deferred args %d %u %x %X %c %s\n",
+                  42, 1024, 0xbeef, 0xcafe, 'c', "string");
+    kernel_info("[TESTMODE] Deferred info %s %s\n", "first", "second");
+    kernel_printf("[TESTMODE] Deferred padding %08x %4d\n", 0x1234, 7);
+
+    kernel_output_get_stats(&stats);
+    if(stats.logged - before.logged == OUTPUT_DEFERRED_TEST_COUNT + 3)
+    {
+        kernel_printf("[TESTMODE] Deferred records logged\n");
+    }
+    else
+    {
+        kernel_error("Deferred records not logged\n");
+    }
+
+    /* Let the flusher output the records */
+    sched_sleep(KERNEL_OUTPUT_FLUSH_PERIOD * 5);
+
+    kernel_output_get_stats(&stats);
+    err = kernel_output_set_deferred(0);
+    if(err == OS_NO_ERR && stats.lost == before.lost &&
+       stats.flushed - before.flushed == OUTPUT_DEFERRED_TEST_COUNT + 4)
+    {
+        kernel_printf("[TESTMODE] Deferred records flushed\n");
+    }
+    else
+    {
+        kernel_error("Deferred records not flushed [%d] %d\n", err,
+                     (uint32_t)(stats.flushed - before.flushed));
+    }
+
+    kernel_printf("Output %d messages: immediate %d cycles, deferred %d "
+                  "cycles\n", OUTPUT_DEFERRED_TEST_COUNT,
+                  (uint32_t)sync_cycles, (uint32_t)log_cycles);
+
+    kernel_printf("[TESTMODE] Deferred output tests passed\n");
+}
+#else
+void output_deferred_test(void)
+{
+}
+#endif
@@ -5,9 +5,14 @@
 #include <Tests/test_bank.h>
 
 #if OUTPUT_TEST  == 1
+
+#define OUTPUT_TEST_BENCH_LINES 32
+
 void output_test(void)
 {
     uint32_t i = 0;
+    uint64_t start;
+    uint64_t cycles;
 
     kernel_printf("[TESTMODE] This tag should be empty: %d.\n", i++);
 
@@ -21,7 +26,28 @@ void output_test(void)
 
     kernel_serial_debug("[TESTMODE] This should only out in serial: %d.\n", 
                         i++);
-    
+
+    kernel_printf("[TESTMODE] Width: [%5d] [%-5d] [%05d] [%+d] [%5s]\n",
+                  42, 42, 42, 42, "ab");
+    kernel_printf("[TESTMODE] Precision: [%.3d] [%.2s] [%8.3x] [%*d]\n",
+                  7, "abc", 0xab, 4, 9);
+    kernel_printf("[TESTMODE] 64 bits: %llu %lld %llx\n",
+                  0x123456789ULL, -5000000000LL, 0xFEDCBA9876543210ULL);
+    kernel_printf("[TESTMODE] Signed: %d %hhd %hu %#x %p\n",
+                  -1, 255, 65537, 0xff, (void*)0xB8000);
+
+    /* Formater benchmark */
+    start = cpu_rdtsc();
+    for(i = 0; i < OUTPUT_TEST_BENCH_LINES; ++i)
+    {
+        kernel_serial_debug("Output benchmark %u: %08x %-6d %s %llu\n",
+                            i, i * 0x1234, -(int32_t)i, "formated",
+                            0x100000000ULL * i);
+    }
+    cycles = cpu_rdtsc() - start;
+    kernel_printf("Output benchmark: %llu cycles per line\n",
+                  cycles / OUTPUT_TEST_BENCH_LINES);
+
     /* Kill QEMU */
     cpu_outw(0x2000, 0x604);    
     while(1)
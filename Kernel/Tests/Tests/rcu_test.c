@@ -0,0 +1,92 @@
+#include <io/kernel_output.h>
+#include <core/scheduler.h>
+#include <core/kernel_queue.h>
+#include <interrupt/interrupts.h>
+#include <Tests/test_bank.h>
+#include <cpu.h>
+#include <sync/rcu.h>
+
+#if RCU_TEST == 1
+
+static rcu_head_t        rcu_test_head;
+static volatile uint32_t rcu_test_called;
+
+static void rcu_test_callback(rcu_head_t* head)
+{
+    if(head == &rcu_test_head)
+    {
+        ++rcu_test_called;
+    }
+}
+
+void rcu_test(void)
+{
+    kernel_queue_t* queue;
+    OS_RETURN_E     err;
+    uint32_t        pending;
+    uint32_t        state;
+
+    rcu_test_called = 0;
+
+    if(call_rcu(NULL, rcu_test_callback) == OS_ERR_NULL_POINTER &&
+       call_rcu(&rcu_test_head, NULL) == OS_ERR_NULL_POINTER)
+    {
+        kernel_printf("[TESTMODE] RCU NULL OK\n");
+    }
+
+    /* The grace period cannot end while we are in a read section */
+    state = rcu_read_lock();
+    err = call_rcu(&rcu_test_head, rcu_test_callback);
+    rcu_process_callbacks();
+    if(err == OS_NO_ERR && rcu_test_called == 0)
+    {
+        kernel_printf("[TESTMODE] RCU deferred OK\n");
+    }
+    rcu_read_unlock(state);
+
+    err = rcu_synchronize();
+    if(err == OS_NO_ERR && rcu_test_called == 1)
+    {
+        kernel_printf("[TESTMODE] RCU callback OK\n");
+    }
+
+    /* Queues are released after a grace period */
+    queue = kernel_queue_create_queue(&err);
+    if(err != OS_NO_ERR)
+    {
+        kernel_error(" Error while creating queue! [%d]\n", err);
+        return;
+    }
+    state   = rcu_read_lock();
+    pending = rcu_get_pending_count();
+    err     = kernel_queue_delete_queue(&queue);
+    if(err == OS_NO_ERR && queue == NULL &&
+       rcu_get_pending_count() == pending + 1)
+    {
+        kernel_printf("[TESTMODE] RCU queue deferred OK\n");
+    }
+    rcu_read_unlock(state);
+
+    err = rcu_synchronize();
+    if(err == OS_NO_ERR && rcu_get_pending_count() == 0)
+    {
+        kernel_printf("[TESTMODE] RCU queue released OK\n");
+    }
+
+    if(rcu_test_called == 1)
+    {
+        kernel_printf("[TESTMODE] RCU test passed\n");
+    }
+
+    /* Kill QEMU */
+    cpu_outw(0x2000, 0x604);
+    while(1)
+    {
+        __asm__ ("hlt");
+    }
+}
+#else
+void rcu_test(void)
+{
+}
+#endif
@@ -6,6 +6,10 @@
 
 #if SCHEDULER_LOAD_TEST == 1
 
+#define SCALE_THREAD_COUNT 2048
+
+static thread_t scale_thread[SCALE_THREAD_COUNT];
+
 static void* print_th(void*args)
 {
     int i = 0;
@@ -20,6 +24,136 @@ static void* print_th(void*args)
     return NULL;
 }
 
+static void* scale_th(void* args)
+{
+    (void)args;
+    return NULL;
+}
+
+/* Returns the average number of cycles needed to look up a thread by TID */
+static uint32_t scale_lookup(const int count, uint32_t* ok)
+{
+    thread_info_t info;
+    OS_RETURN_E   err;
+    uint64_t      start;
+    uint32_t      cycles;
+
+    start = cpu_rdtsc();
+    for(int i = 0; i < count; ++i)
+    {
+        err = sched_get_thread_info(scale_thread[i]->tid, &info);
+        *ok &= (err == OS_NO_ERR && info.tid == scale_thread[i]->tid);
+    }
+    cycles = (uint32_t)(cpu_rdtsc() - start);
+
+    return cycles / count;
+}
+
+static uint32_t scheduler_scale_test(void)
+{
+    thread_info_t info;
+    OS_RETURN_E   err;
+    uint32_t      cycles;
+    uint32_t      ok;
+    uint32_t      passed;
+    int           created;
+    int           checkpoint;
+
+    /* Threads do not run until the interrupts are restored, the lookups and
+     * priority changes are done on threads that are in the active tables.
+     */
+    kernel_interrupt_disable();
+
+    ok         = 1;
+    checkpoint = 64;
+    for(created = 0; created < SCALE_THREAD_COUNT; ++created)
+    {
+        err = sched_create_kernel_thread(&scale_thread[created], 32, "scale",
+                                         1024, 0, scale_th, NULL);
+        if(err != OS_NO_ERR)
+        {
+            kernel_error("Cannot create threads %d\n", err);
+            ok = 0;
+            break;
+        }
+
+        if(created + 1 == checkpoint)
+        {
+            cycles = scale_lookup(checkpoint, &ok);
+            kernel_printf("TID lookup with %d threads: %u cycles\n",
+                          checkpoint, cycles);
+            checkpoint *= 4;
+        }
+    }
+    if(ok == 1)
+    {
+        cycles = scale_lookup(SCALE_THREAD_COUNT, &ok);
+        kernel_printf("TID lookup with %d threads: %u cycles\n",
+                      SCALE_THREAD_COUNT, cycles);
+    }
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] TID lookup OK\n");
+    }
+    else
+    {
+        kernel_error("TID lookup failed\n");
+    }
+    passed = ok;
+
+    /* Move all the threads to a new priority */
+    ok = (created != 0);
+    for(int i = 0; i < created; ++i)
+    {
+        err = sched_set_thread_priority(scale_thread[i]->tid, i % 64);
+        ok &= (err == OS_NO_ERR);
+    }
+    for(int i = 0; i < created; ++i)
+    {
+        err = sched_get_thread_info(scale_thread[i]->tid, &info);
+        ok &= (err == OS_NO_ERR && info.priority == (uint32_t)(i % 64) &&
+               info.init_prio == 32);
+    }
+    if(ok == 1)
+    {
+        err = sched_set_thread_priority(scale_thread[0]->tid,
+                                        KERNEL_LOWEST_PRIORITY + 1);
+        ok &= (err == OS_ERR_FORBIDEN_PRIORITY);
+    }
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] TID priority change OK\n");
+    }
+    else
+    {
+        kernel_error("TID priority change failed\n");
+    }
+    passed &= ok;
+
+    kernel_interrupt_restore(1);
+
+    ok = 1;
+    for(int i = 0; i < created; ++i)
+    {
+        info.tid = scale_thread[i]->tid;
+        err = sched_wait_thread(scale_thread[i], NULL, NULL);
+        ok &= (err == OS_NO_ERR);
+        err = sched_get_thread_info(info.tid, &info);
+        ok &= (err == OS_ERR_NO_SUCH_ID);
+    }
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] TID table join OK\n");
+    }
+    else
+    {
+        kernel_error("TID table join failed\n");
+    }
+    passed &= ok;
+
+    return passed;
+}
+
 void scheduler_load_test(void)
 {
     thread_t thread[1024];
@@ -55,6 +189,15 @@ void scheduler_load_test(void)
 
     kernel_printf("\n[TESTMODE] Scheduler thread load tests passed\n");
 
+    if(scheduler_scale_test() == 1)
+    {
+        kernel_printf("[TESTMODE] Scheduler TID table scaling tests passed\n");
+    }
+    else
+    {
+        kernel_error("Scheduler TID table scaling tests failed\n");
+    }
+
     kernel_interrupt_disable();
 
     /* Kill QEMU */
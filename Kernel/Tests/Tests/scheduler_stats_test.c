@@ -0,0 +1,200 @@
+#include <io/kernel_output.h>
+#include <core/scheduler.h>
+#include <interrupt/interrupts.h>
+#include <Tests/test_bank.h>
+#include <cpu.h>
+#include <time/time_management.h>
+
+#if SCHEDULER_STATS_TEST == 1
+
+static void* busy_th(void* args)
+{
+    uint64_t end;
+
+    (void)args;
+
+    end = time_get_current_uptime() + 100;
+    while(time_get_current_uptime() < end);
+
+    return NULL;
+}
+
+static void* sleep_th(void* args)
+{
+    (void)args;
+
+    sched_sleep(100);
+
+    return NULL;
+}
+
+static OS_RETURN_E wait_zombie(const int32_t tid, thread_info_t* info)
+{
+    OS_RETURN_E err;
+
+    while(1)
+    {
+        err = sched_get_thread_info(tid, info);
+        if(err != OS_NO_ERR || info->state == THREAD_STATE_ZOMBIE)
+        {
+            return err;
+        }
+        sched_sleep(10);
+    }
+}
+
+void scheduler_stats_test(void)
+{
+    thread_t      busy[2];
+    thread_t      sleeper;
+    thread_info_t info[2];
+    thread_info_t sleep_info;
+    thread_info_t all_info[16];
+    uint64_t      hist[SCHED_RUNQUEUE_HIST_SIZE];
+    uint64_t      samples;
+    size_t        size;
+    OS_RETURN_E   err;
+    uint32_t      passed;
+    uint32_t      i;
+
+    kernel_interrupt_restore(1);
+
+    kernel_printf("[TESTMODE] Scheduler statistics tests starts\n");
+
+    /* Two busy threads with the same priority preempt each other */
+    err = OS_NO_ERR;
+    for(i = 0; i < 2 && err == OS_NO_ERR; ++i)
+    {
+        err = sched_create_kernel_thread(&busy[i], 10, "busy",
+                                         1024, 0, busy_th, NULL);
+    }
+    if(err == OS_NO_ERR)
+    {
+        err = sched_create_kernel_thread(&sleeper, 5, "sleeper",
+                                         1024, 0, sleep_th, NULL);
+    }
+    if(err != OS_NO_ERR)
+    {
+        kernel_error("Cannot create threads %d\n", err);
+        /* Kill QEMU */
+        cpu_outw(0x2000, 0x604);
+        while(1)
+        {
+            __asm__ ("hlt");
+        }
+    }
+
+    err = wait_zombie(busy[0]->tid, &info[0]);
+    if(err == OS_NO_ERR)
+    {
+        err = wait_zombie(busy[1]->tid, &info[1]);
+    }
+    if(err == OS_NO_ERR)
+    {
+        err = wait_zombie(sleeper->tid, &sleep_info);
+    }
+    passed = (err == OS_NO_ERR);
+    if(passed == 0)
+    {
+        kernel_error("Cannot get thread info %d\n", err);
+    }
+
+    kernel_printf("Busy thread: run %u cycles, ready %u cycles, "
+                  "%u preemptions\n",
+                  (uint32_t)info[0].run_time, (uint32_t)info[0].ready_time,
+                  info[0].involuntary_switches);
+
+    if(passed == 1 &&
+       info[0].run_time > info[0].wait_time &&
+       info[1].run_time > info[1].wait_time &&
+       info[0].ready_time != 0 && info[1].ready_time != 0)
+    {
+        kernel_printf("[TESTMODE] Run time OK\n");
+    }
+    else
+    {
+        kernel_error("Run time failed\n");
+        passed = 0;
+    }
+    if(passed == 1 &&
+       info[0].involuntary_switches + info[1].involuntary_switches != 0)
+    {
+        kernel_printf("[TESTMODE] Involuntary switches OK\n");
+    }
+    else
+    {
+        kernel_error("Involuntary switches failed\n");
+        passed = 0;
+    }
+    if(passed == 1 &&
+       sleep_info.wait_time > sleep_info.run_time &&
+       sleep_info.voluntary_switches != 0)
+    {
+        kernel_printf("[TESTMODE] Wait time OK\n");
+    }
+    else
+    {
+        kernel_error("Wait time failed\n");
+        passed = 0;
+    }
+
+    size = 16;
+    err = sched_get_threads_info(all_info, &size);
+    if(err == OS_NO_ERR && size != 0 && size <= 16 &&
+       sched_get_threads_info(NULL, &size) == OS_ERR_NULL_POINTER)
+    {
+        kernel_printf("[TESTMODE] Threads info OK\n");
+    }
+    else
+    {
+        kernel_error("Threads info failed %d\n", err);
+        passed = 0;
+    }
+
+    err = sched_get_runqueue_histogram(0, hist);
+    samples = 0;
+    for(i = 0; i < SCHED_RUNQUEUE_HIST_SIZE; ++i)
+    {
+        samples += hist[i];
+    }
+    if(err == OS_NO_ERR && samples != 0 && samples - hist[0] != 0 &&
+       sched_get_runqueue_histogram(0, NULL) == OS_ERR_NULL_POINTER &&
+       sched_get_runqueue_histogram(MAX_CPU_COUNT, hist) ==
+       OS_ERR_OUT_OF_BOUND)
+    {
+        kernel_printf("[TESTMODE] Run queue histogram OK\n");
+    }
+    else
+    {
+        kernel_error("Run queue histogram failed %d\n", err);
+        passed = 0;
+    }
+
+    sched_wait_thread(busy[0], NULL, NULL);
+    sched_wait_thread(busy[1], NULL, NULL);
+    sched_wait_thread(sleeper, NULL, NULL);
+
+    if(passed == 1)
+    {
+        kernel_printf("[TESTMODE] Scheduler statistics tests passed\n");
+    }
+    else
+    {
+        kernel_error("Scheduler statistics tests failed\n");
+    }
+
+    kernel_interrupt_disable();
+
+    /* Kill QEMU */
+    cpu_outw(0x2000, 0x604);
+    while(1)
+    {
+        __asm__ ("hlt");
+    }
+}
+#else
+void scheduler_stats_test(void)
+{
+
+}
+#endif
@@ -17,6 +17,8 @@
 
 /* Set here the test that should run (only one at a time) */
 #define SERIAL_TEST 0
+#define SERIAL_RX_TEST 0
+#define SERIAL_TX_TEST 0
 #define IDT_TEST 0
 #define GDT_TEST 0
 #define TSS_TEST 0
@@ -39,6 +41,8 @@
 #define PANIC_TEST 0
 #define BIOS_CALL_TEST 0
 #define ATA_PIO_TEST 0
+#define ATA_PIO_IRQ_TEST 0
+#define ATA_DMA_TEST 0
 #define CPU_SMP_TEST 0
 #define SSE_TEST 0
 #define CRITICAL_TEST 0
@@ -49,6 +53,7 @@
 #define SCHEDULER_PREEMT_TEST 0
 #define SCHEDULER_SLEEP_TEST 0
 #define SCHEDULER_SLEEP_MC_TEST 0
+#define SCHEDULER_STATS_TEST 0
 #define MUTEX_TEST 0
 #define SEMAPHORE_TEST 0
 #define SEMAPHORE_MC_TEST 0
@@ -57,9 +62,25 @@
 #define PAGING_ALLOC_TEST 0
 #define MUTEX_MC_TEST 0
 #define SPINLOCK_TEST 0
+#define FUTEX_TEST 0
+#define RCU_TEST 0
+#define BARRIER_TEST 0
+#define BLOCK_TEST 0
+#define BLOCK_IO_TEST 0
+#define OUTPUT_DEFERRED_TEST 0
+#define TRACE_TEST 0
+#define VESA_FLUSH_TEST 0
+#define VESA_BLIT_TEST 0
+#define VGA_SCROLL_TEST 0
+#define KEYBOARD_TEST 0
+#define DEFERRED_TEST 0
+#define INTERRUPT_STATS_TEST 0
+#define IRQ_AFFINITY_TEST 0
 
 /* Put tests declarations here */
 void serial_test(void);
+void serial_rx_test(void);
+void serial_tx_test(void);
 void idt_test(void);
 void gdt_test(void);
 void tss_test(void);
@@ -82,6 +103,8 @@ void time_test(void);
 void panic_test(void);
 void bios_call_test(void);
 void ata_pio_test(void);
+void ata_pio_irq_test(void);
+void ata_dma_test(void);
 void cpu_smp_test(void);
 void sse_test(void);
 void critical_test(void);
@@ -92,6 +115,7 @@ void scheduler_load_mc_test(void);
 void scheduler_preemt_test(void);
 void scheduler_sleep_test(void);
 void scheduler_sleep_mc_test(void);
+void scheduler_stats_test(void);
 void mutex_test(void);
 void mutex_mc_test(void);
 void semaphore_test(void);
@@ -99,5 +123,19 @@ void semaphore_mc_test(void);
 void mailbox_test(void);
 void userqueue_test(void);
 void spinlock_test(void);
+void futex_test(void);
+void rcu_test(void);
+void barrier_test(void);
+void block_test(void);
+void block_io_test(void);
+void output_deferred_test(void);
+void trace_test(void);
+void vesa_flush_test(void);
+void vesa_blit_test(void);
+void vga_scroll_test(void);
+void keyboard_test(void);
+void deferred_test(void);
+void interrupt_stats_test(void);
+void irq_affinity_test(void);
 
 #endif /* __TEST_BANK_H_ */
@@ -0,0 +1,123 @@
+#include <lib/stdio.h>
+#include <io/kernel_output.h>
+#include <memory/kheap.h>
+#include <sync/mutex.h>
+#include <core/scheduler.h>
+#include <core/trace.h>
+#include <cpu.h>
+
+#include <Tests/test_bank.h>
+
+#if TRACE_TEST == 1
+
+#define TRACE_TEST_EVENTS 16
+
+void trace_test(void)
+{
+    trace_event_t events[TRACE_TEST_EVENTS];
+    uint32_t      count;
+    uint32_t      lost;
+    uint32_t      cpu_id;
+    uint32_t      ok;
+    void*         ptr;
+    mutex_t       mutex;
+    OS_RETURN_E   err;
+
+    kernel_printf("[TESTMODE] Trace tests starts\n");
+
+    ok = 1;
+    ok &= trace_read(0, NULL, 1, &count, NULL) == OS_ERR_NULL_POINTER;
+    ok &= trace_read(0, events, 1, NULL, NULL) == OS_ERR_NULL_POINTER;
+    ok &= trace_read(MAX_CPU_COUNT, events, 1, &count, NULL) ==
+          OS_ERR_OUT_OF_BOUND;
+    if(ok == 1)
+    {
+        kernel_printf("[TESTMODE] Trace errors OK\n");
+    }
+    else
+    {
+        kernel_error("Trace wrong error codes\n");
+    }
+
+    /* The test thread does not migrate, its events are in its CPU ring */
+    cpu_id = cpu_get_id();
+    mutex_init(&mutex, MUTEX_FLAG_NONE, MUTEX_PRIORITY_ELEVATION_NONE);
+
+    /* Only the enabled categories are recorded */
+    trace_clear();
+    trace_enable(TRACE_CATEGORY_KHEAP);
+    ptr = kmalloc(64);
+    mutex_pend(&mutex);
+    mutex_post(&mutex);
+    kfree(ptr);
+    trace_disable(TRACE_CATEGORY_KHEAP);
+
+    err = trace_read(cpu_id, events, TRACE_TEST_EVENTS, &count, &lost);
+    if(err == OS_NO_ERR && count == 2 && lost == 0 &&
+       events[0].id == TRACE_KHEAP_ALLOC &&
+       events[0].args[0] == (uintptr_t)ptr && events[0].args[1] == 64 && events[1].id == TRACE_KHEAP_FREE &&
+       events[1].args[0] == (uintptr_t)ptr &&
+       events[0].timestamp <= events[1].timestamp &&
+       events[0].cpu == cpu_id)
+    {
+        kernel_printf("[TESTMODE] Trace categories OK\n");
+    }
+    else
+    {
+        kernel_error("Trace categories failed [%d] %d events\n", err, count);
+    }
+
+    /* Sync events */
+    trace_enable(TRACE_CATEGORY_SYNC);
+    mutex_pend(&mutex);
+    mutex_post(&mutex);
+    trace_disable(TRACE_CATEGORY_SYNC);
+
+    err = trace_read(cpu_id, events, TRACE_TEST_EVENTS, &count, &lost);
+    if(err == OS_NO_ERR && count >= 2 &&
+       events[0].id == TRACE_SYNC_MUTEX_ACQUIRE &&
+       events[0].args[0] == (uintptr_t)&mutex &&
+       events[1].id == TRACE_SYNC_MUTEX_RELEASE)
+    {
+        kernel_printf("[TESTMODE] Trace sync events OK\n");
+    }
+    else
+    {
+        kernel_error("Trace sync events failed [%d] %d events\n", err, count);
+    }
+
+    /* Overwritten events are reported */
+    trace_enable(TRACE_CATEGORY_KHEAP);
+    for(count = 0; count < TRACE_BUFFER_SIZE; ++count)
+    {
+        kfree(kmalloc(16));
+    }
+    trace_disable(TRACE_CATEGORY_KHEAP);
+
+    err = trace_read(cpu_id, events, TRACE_TEST_EVENTS, &count, &lost);
+    if(err == OS_NO_ERR && count == TRACE_TEST_EVENTS &&
+       lost == TRACE_BUFFER_SIZE)
+    {
+        kernel_printf("[TESTMODE] Trace overwrite OK\n");
+    }
+    else
+    {
+        kernel_error("Trace overwrite failed [%d] %d lost\n", err, lost);
+    }
+
+    /* Export the scheduler events of a sleep */
+    trace_clear();
+    trace_enable(TRACE_CATEGORY_SCHED | TRACE_CATEGORY_INTERRUPT);
+    sched_sleep(20);
+    trace_dump();
+    trace_disable(TRACE_CATEGORY_ALL);
+
+    mutex_destroy(&mutex);
+
+    kernel_printf("[TESTMODE] Trace tests passed\n");
+}
+#else
+void trace_test(void)
+{
+}
+#endif
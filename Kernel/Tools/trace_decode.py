@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+################################################################################
+# Created: 18/10/2026
+#
+# Original author: Alexy Torres Aurora Dugo
+#
+# Last modified: 18/10/2026
+#
+# Last author: Alexy Torres Aurora Dugo
+#
+# UTK trace events decoder. Reads a serial output capture containing a
+# trace_dump export and prints the events timeline. The events can also be
+# exported in the Chrome trace event format (chrome://tracing, Perfetto).
+#
+# Usage: trace_decode.py [--tsc-mhz MHZ] [--chrome OUT.json] [capture]
+################################################################################
+
+import argparse
+import json
+import sys
+
+# Event id -> (name, argument names), keep in sync with Includes/core/trace.h
+EVENTS = {
+    0x0000: ("sched_switch",     ("prev_tid", "next_tid", "prev_state",
+                                  "next_prio")),
+    0x0001: ("sched_wakeup",     ("tid",)),
+    0x0002: ("sched_sleep",      ("tid", "ms")),
+    0x0003: ("sched_block",      ("tid", "wait_type")),
+    0x0004: ("sched_unblock",    ("tid", "wait_type")),
+    0x0005: ("sched_create",     ("tid", "prio", "cpu")),
+    0x0006: ("sched_exit",       ("tid",)),
+    0x0100: ("irq_entry",        ("line",)),
+    0x0101: ("irq_exit",         ("line",)),
+    0x0102: ("irq_spurious",     ("line",)),
+    0x0200: ("kheap_alloc",      ("addr", "size", "chunk")),
+    0x0201: ("kheap_free",       ("addr", "chunk")),
+    0x0300: ("mutex_block",      ("mutex", "tid")),
+    0x0301: ("mutex_acquire",    ("mutex", "tid")),
+    0x0302: ("mutex_release",    ("mutex", "tid")),
+    0x0303: ("sem_block",        ("sem", "tid")),
+    0x0304: ("sem_acquire",      ("sem", "tid", "level")),
+    0x0305: ("sem_post",         ("sem", "tid", "level")),
+    0x0306: ("futex_wait",       ("addr", "value", "tid")),
+    0x0307: ("futex_wake",       ("addr", "count", "woken")),
+}
+
+# Arguments printed in hexadecimal
+HEX_ARGS = ("addr", "mutex", "sem")
+
+
+def parse(lines):
+    """Returns the events and the lost counts found in the capture."""
+    events = []
+    lost = {}
+    for line in lines:
+        start = line.find("#TRACE ")
+        if start < 0:
+            continue
+        fields = line[start:].split()
+        if len(fields) == 4 and fields[1] == "LOST":
+            cpu = int(fields[2], 16)
+            lost[cpu] = lost.get(cpu, 0) + int(fields[3], 16)
+            continue
+        if len(fields) != 8:
+            continue
+        try:
+            values = [int(field, 16) for field in fields[1:]]
+        except ValueError:
+            continue
+        events.append({
+            "cpu": values[0],
+            "tsc": values[1],
+            "id": values[2],
+            "args": values[3:],
+        })
+    events.sort(key=lambda event: event["tsc"])
+    return events, lost
+
+
+def describe(event):
+    """Returns the name and the decoded arguments of an event."""
+    name, arg_names = EVENTS.get(event["id"],
+                                 ("event_%04x" % event["id"], ()))
+    args = {}
+    for i, arg_name in enumerate(arg_names):
+        value = event["args"][i]
+        args[arg_name] = ("0x%08x" % value) if arg_name in HEX_ARGS else value
+    return name, args
+
+
+def print_timeline(events, lost, tsc_mhz):
+    """Prints one line per event, time relative to the first event."""
+    if not events:
+        print("No trace event found")
+        return
+    origin = events[0]["tsc"]
+    unit = "us" if tsc_mhz else "cycles"
+    for event in events:
+        delta = event["tsc"] - origin
+        if tsc_mhz:
+            stamp = "%14.3f" % (delta / tsc_mhz)
+        else:
+            stamp = "%14d" % delta
+        name, args = describe(event)
+        text = " ".join("%s=%s" % (key, value) for key, value in args.items())
+        print("%s %s  CPU%d  %-14s %s" % (stamp, unit, event["cpu"], name,
+                                          text))
+    for cpu, count in sorted(lost.items()):
+        print("CPU%d: %d events overwritten" % (cpu, count))
+
+
+def export_chrome(events, tsc_mhz, path):
+    """Writes the events in the Chrome trace event format."""
+    origin = events[0]["tsc"] if events else 0
+    scale = tsc_mhz if tsc_mhz else 1.0
+    out = []
+    for event in events:
+        name, args = describe(event)
+        record = {
+            "name": name,
+            "pid": 0,
+            "tid": event["cpu"],
+            "ts": (event["tsc"] - origin) / scale,
+            "args": args,
+        }
+        if event["id"] == 0x0100:
+            record["ph"] = "B"
+            record["name"] = "irq %d" % event["args"][0]
+        elif event["id"] == 0x0101:
+            record["ph"] = "E"
+            record["name"] = "irq %d" % event["args"][0]
+        else:
+            record["ph"] = "i"
+            record["s"] = "t"
+        out.append(record)
+    with open(path, "w") as output:
+        json.dump({"traceEvents": out}, output)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="UTK trace events decoder")
+    parser.add_argument("capture", nargs="?",
+                        help="serial output capture, stdin if omitted")
+    parser.add_argument("--tsc-mhz", type=float, default=0.0,
+                        help="TSC frequency in MHz to print microseconds")
+    parser.add_argument("--chrome", metavar="OUT",
+                        help="also write a Chrome trace event JSON file")
+    options = parser.parse_args()
+
+    if options.capture:
+        with open(options.capture, errors="replace") as capture:
+            events, lost = parse(capture)
+    else:
+        events, lost = parse(sys.stdin)
+
+    print_timeline(events, lost, options.tsc_mhz)
+    if options.chrome:
+        export_chrome(events, options.tsc_mhz, options.chrome)
+
+
+if __name__ == "__main__":
+    main()